@@ -32,6 +32,74 @@
 
 #include "core/os/os.h"
 
+#include <thread>
+
+struct CommandQueueMT::Block {
+	// Starts at BLOCK_OWNED while a producer writes to it. The consumer takes
+	// one for each command flushed and the producer gives back BLOCK_OWNED
+	// minus the commands it wrote when moving on to another block, so it
+	// reaches zero exactly when the block can be reused.
+	std::atomic<int64_t> balance;
+	uint32_t used = 0;
+	uint32_t size = 0;
+	Block *next_free = nullptr;
+	Block *next_alloc = nullptr;
+
+	_FORCE_INLINE_ uint8_t *get_data() { return (uint8_t *)(this + 1); }
+};
+
+static const int64_t BLOCK_OWNED = int64_t(1) << 48;
+
+// Block each thread is currently writing to, for the last few queues it used.
+struct CommandQueueMT::ProducerCache {
+	enum {
+		MAX_QUEUES = 4
+	};
+
+	struct Entry {
+		CommandQueueMT *queue = nullptr;
+		uint64_t id = 0;
+		Block *block = nullptr;
+		int64_t count = 0;
+	};
+
+	Entry entries[MAX_QUEUES];
+	uint32_t next_evict = 0;
+
+	void release(uint32_t p_entry);
+
+	~ProducerCache() {
+		for (uint32_t i = 0; i < MAX_QUEUES; i++) {
+			release(i);
+		}
+	}
+};
+
+thread_local CommandQueueMT::ProducerCache CommandQueueMT::producer_cache;
+
+// Queues may be gone by the time a thread lets go of its blocks, so the live
+// ones are tracked to check against.
+static SpinLock live_lock;
+static CommandQueueMT *live_queues = nullptr;
+static std::atomic<uint64_t> last_queue_id(0);
+
+void CommandQueueMT::ProducerCache::release(uint32_t p_entry) {
+	Entry &e = entries[p_entry];
+	if (e.queue && e.block) {
+		live_lock.lock();
+		for (CommandQueueMT *q = live_queues; q; q = q->next_live) {
+			if (q == e.queue && q->id == e.id) {
+				if (q->_retire_block(e.block, e.count)) {
+					q->_free_block(e.block);
+				}
+				break;
+			}
+		}
+		live_lock.unlock();
+	}
+	e = Entry();
+}
+
 void CommandQueueMT::lock() {
 	mutex.lock();
 }
@@ -69,6 +137,185 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 	return &sync_sems[idx];
 }
 
+CommandQueueMT::Node *CommandQueueMT::_alloc_node(uint32_t p_size) {
+	uint32_t alloc_size = NODE_SIZE + ((p_size + 8 - 1) & ~(8 - 1));
+
+	ProducerCache &cache = producer_cache;
+	uint32_t entry = ProducerCache::MAX_QUEUES;
+	for (uint32_t i = 0; i < ProducerCache::MAX_QUEUES; i++) {
+		if (cache.entries[i].queue == this && cache.entries[i].id == id) {
+			entry = i;
+			break;
+		}
+	}
+
+	Block *block;
+	if (likely(entry != ProducerCache::MAX_QUEUES)) {
+		block = cache.entries[entry].block;
+		if (unlikely(block->used + alloc_size > block->size)) {
+			block = _renew_block(entry, alloc_size);
+		}
+	} else {
+		// First command from this thread, take a free or stale entry.
+		for (uint32_t i = 0; i < ProducerCache::MAX_QUEUES; i++) {
+			if (!cache.entries[i].queue) {
+				entry = i;
+				break;
+			}
+		}
+		if (entry == ProducerCache::MAX_QUEUES) {
+			entry = cache.next_evict;
+			cache.next_evict = (cache.next_evict + 1) % ProducerCache::MAX_QUEUES;
+		}
+		cache.release(entry);
+		cache.entries[entry].queue = this;
+		cache.entries[entry].id = id;
+		block = _renew_block(entry, alloc_size);
+	}
+
+	Node *node = (Node *)(block->get_data() + block->used);
+	block->used += alloc_size;
+	cache.entries[entry].count++;
+
+	node->next.store(nullptr, std::memory_order_relaxed);
+	node->block = block;
+	return node;
+}
+
+CommandQueueMT::Block *CommandQueueMT::_renew_block(uint32_t p_entry, uint32_t p_size) {
+	ProducerCache::Entry &e = producer_cache.entries[p_entry];
+	Block *block = e.block;
+
+	if (block && _retire_block(block, e.count)) {
+		if (block->size >= p_size) {
+			// Everything in it was flushed already, just write over it.
+			block->used = 0;
+			block->balance.store(BLOCK_OWNED, std::memory_order_relaxed);
+			e.count = 0;
+			return block;
+		}
+		_free_block(block);
+	}
+
+	block = nullptr;
+	block_lock.lock();
+	if (free_blocks && free_blocks->size >= p_size) {
+		block = free_blocks;
+		free_blocks = block->next_free;
+	}
+	block_lock.unlock();
+
+	if (!block) {
+		uint32_t size = MAX(uint32_t(BLOCK_SIZE), p_size);
+		block = memnew_placement(memalloc(sizeof(Block) + size), Block);
+		block->size = size;
+
+		block_lock.lock();
+		block->next_alloc = all_blocks;
+		all_blocks = block;
+		block_lock.unlock();
+	}
+
+	block->used = 0;
+	block->balance.store(BLOCK_OWNED, std::memory_order_relaxed);
+	e.block = block;
+	e.count = 0;
+	return block;
+}
+
+bool CommandQueueMT::_retire_block(Block *p_block, int64_t p_count) {
+	int64_t owned = BLOCK_OWNED - p_count;
+	return p_block->balance.fetch_sub(owned, std::memory_order_acq_rel) == owned;
+}
+
+void CommandQueueMT::_free_block(Block *p_block) {
+	block_lock.lock();
+	p_block->next_free = free_blocks;
+	free_blocks = p_block;
+	block_lock.unlock();
+}
+
+void CommandQueueMT::_push_node(Node *p_node) {
+	Node *prev = head.exchange(p_node, std::memory_order_acq_rel);
+	// Until this store, the consumer can't see this node (or any pushed after).
+	prev->next.store(p_node, std::memory_order_release);
+}
+
+CommandQueueMT::Node *CommandQueueMT::_pop_node(bool &r_pending) {
+	r_pending = false;
+
+	Node *node = tail;
+	Node *next = node->next.load(std::memory_order_acquire);
+
+	if (node == &stub) {
+		if (!next) {
+			r_pending = head.load(std::memory_order_acquire) != &stub;
+			return nullptr;
+		}
+		tail = next;
+		node = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next) {
+		tail = next;
+		return node;
+	}
+
+	if (node != head.load(std::memory_order_acquire)) {
+		// A producer swapped the head but didn't link it yet.
+		r_pending = true;
+		return nullptr;
+	}
+
+	// Last node, push the stub behind it so it can be unlinked. The stub still
+	// links to the node that was after it, which is the one being returned.
+	stub.next.store(nullptr, std::memory_order_relaxed);
+	_push_node(&stub);
+
+	next = node->next.load(std::memory_order_acquire);
+	if (next) {
+		tail = next;
+		return node;
+	}
+
+	r_pending = true;
+	return nullptr;
+}
+
+bool CommandQueueMT::_flush_one_lock_free() {
+	Node *node;
+	while (true) {
+		bool pending;
+		consumer_lock.lock();
+		node = _pop_node(pending);
+		consumer_lock.unlock();
+
+		if (node || !pending) {
+			break;
+		}
+		// Only a few instructions are left for the producer, unless it was
+		// preempted right in between.
+		std::this_thread::yield();
+	}
+
+	if (!node) {
+		return false;
+	}
+
+	CommandBase *cmd = reinterpret_cast<CommandBase *>((uint8_t *)node + NODE_SIZE);
+	Block *block = node->block;
+
+	cmd->call();
+	cmd->post();
+	cmd->~CommandBase();
+
+	if (block->balance.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		_free_block(block);
+	}
+	return true;
+}
+
 bool CommandQueueMT::dealloc_one() {
 tryagain:
 	if (dealloc_ptr == write_ptr) {
@@ -79,7 +326,12 @@ tryagain:
 	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
 
 	if (size == 0) {
-		// End of command buffer wrap down
+		// End of command buffer wrap down, but not before the reader did.
+		// Otherwise write_ptr could catch up with read_ptr and a full
+		// buffer would look empty.
+		if (read_ptr == dealloc_ptr) {
+			return false;
+		}
 		dealloc_ptr = 0;
 		goto tryagain;
 	}
@@ -93,15 +345,49 @@ tryagain:
 	return true;
 }
 
-CommandQueueMT::CommandQueueMT(bool p_sync) {
+CommandQueueMT::CommandQueueMT(bool p_sync, bool p_lock_free) {
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	}
+
+	lock_free = p_lock_free;
+	if (lock_free) {
+		stub.next.store(nullptr, std::memory_order_relaxed);
+		stub.block = nullptr;
+		head.store(&stub, std::memory_order_relaxed);
+		tail = &stub;
+
+		id = ++last_queue_id;
+		live_lock.lock();
+		next_live = live_queues;
+		live_queues = this;
+		live_lock.unlock();
+	} else {
+		command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
+	}
 }
 
 CommandQueueMT::~CommandQueueMT() {
 	if (sync) {
 		memdelete(sync);
 	}
-	memfree(command_mem);
+
+	if (lock_free) {
+		live_lock.lock();
+		CommandQueueMT **q = &live_queues;
+		while (*q != this) {
+			q = &(*q)->next_live;
+		}
+		*q = next_live;
+		live_lock.unlock();
+
+		while (all_blocks) {
+			Block *block = all_blocks;
+			all_blocks = block->next_alloc;
+			block->~Block();
+			memfree(block);
+		}
+	} else {
+		memfree(command_mem);
+	}
 }
@@ -35,6 +35,7 @@
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
 #include "core/simple_type.h"
+#include "core/spin_lock.h"
 #include "core/typedefs.h"
 
 #define COMMA(N) _COMMA_##N
@@ -252,7 +253,7 @@
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
+		commit_and_unlock(cmd);                                              \
 		if (sync)                                                            \
 			sync->post();                                                    \
 	}
@@ -269,7 +270,7 @@
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
+		commit_and_unlock(cmd);                                                                \
 		if (sync)                                                                              \
 			sync->post();                                                                      \
 		ss->sem.wait();                                                                        \
@@ -287,7 +288,7 @@
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
+		commit_and_unlock(cmd);                                                       \
 		if (sync)                                                                     \
 			sync->post();                                                             \
 		ss->sem.wait();                                                               \
@@ -299,7 +300,7 @@
 class CommandQueueMT {
 	struct SyncSemaphore {
 		Semaphore sem;
-		bool in_use = false;
+		std::atomic<bool> in_use = { false };
 	};
 
 	struct CommandBase {
@@ -335,7 +336,7 @@ class CommandQueueMT {
 		SYNC_SEMAPHORES = 8
 	};
 
-	uint8_t *command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
+	uint8_t *command_mem = nullptr;
 	uint32_t read_ptr = 0;
 	uint32_t write_ptr = 0;
 	uint32_t dealloc_ptr = 0;
@@ -343,6 +344,48 @@ class CommandQueueMT {
 	Mutex mutex;
 	Semaphore *sync = nullptr;
 
+	/***** LOCK-FREE *******/
+
+	// Instead of the shared ring buffer, each producer thread writes commands
+	// to blocks of its own and links them to an intrusive MPSC list with a
+	// single atomic exchange. Blocks return to a free list once all their
+	// commands have been flushed, and new ones are allocated as needed, so
+	// producers never wait for the consumer to make room.
+
+	struct Block;
+	struct ProducerCache;
+
+	struct Node {
+		std::atomic<Node *> next;
+		Block *block;
+	};
+
+	enum {
+		NODE_SIZE = (sizeof(Node) + 8 - 1) & ~(8 - 1),
+		BLOCK_SIZE = 64 * 1024
+	};
+
+	bool lock_free = false;
+	uint64_t id = 0;
+	std::atomic<Node *> head; // Last pushed, producers swap it.
+	Node *tail = nullptr; // Next to pop, owned by the consumer.
+	Node stub;
+	SpinLock consumer_lock;
+	SpinLock block_lock;
+	Block *free_blocks = nullptr;
+	Block *all_blocks = nullptr;
+	CommandQueueMT *next_live = nullptr;
+
+	static thread_local ProducerCache producer_cache;
+
+	Node *_alloc_node(uint32_t p_size);
+	Block *_renew_block(uint32_t p_entry, uint32_t p_size);
+	bool _retire_block(Block *p_block, int64_t p_count);
+	void _free_block(Block *p_block);
+	void _push_node(Node *p_node);
+	Node *_pop_node(bool &r_pending);
+	bool _flush_one_lock_free();
+
 	template <class T>
 	T *allocate() {
 		// alloc size is size+T+safeguard
@@ -399,6 +442,11 @@ class CommandQueueMT {
 
 	template <class T>
 	T *allocate_and_lock() {
+		if (lock_free) {
+			Node *node = _alloc_node(sizeof(T));
+			return memnew_placement((uint8_t *)node + NODE_SIZE, T);
+		}
+
 		lock();
 		T *ret;
 
@@ -412,7 +460,20 @@ class CommandQueueMT {
 		return ret;
 	}
 
+	template <class T>
+	void commit_and_unlock(T *p_cmd) {
+		if (lock_free) {
+			_push_node((Node *)((uint8_t *)p_cmd - NODE_SIZE));
+		} else {
+			unlock();
+		}
+	}
+
 	bool flush_one(bool p_lock = true) {
+		if (lock_free) {
+			return _flush_one_lock_free();
+		}
+
 		if (p_lock) {
 			lock();
 		}
@@ -486,13 +547,21 @@ public:
 
 	void flush_all() {
 		//ERR_FAIL_COND(sync);
+		if (lock_free) {
+			while (_flush_one_lock_free()) {
+			}
+			return;
+		}
+
 		lock();
 		while (flush_one(false)) {
 		}
 		unlock();
 	}
 
-	CommandQueueMT(bool p_sync);
+	bool is_lock_free() const { return lock_free; }
+
+	CommandQueueMT(bool p_sync, bool p_lock_free = false);
 	~CommandQueueMT();
 };
 
@@ -0,0 +1,518 @@
+/*************************************************************************/
+/*  flat_hash_map.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include "core/error_macros.h"
+#include "core/hashfuncs.h"
+#include "core/list.h"
+#include "core/os/copymem.h"
+#include "core/os/memory.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * A HashMap implementation with the same interface as HashMap, but storing
+ * the entries inplace in a flat array (open addressing) instead of allocating
+ * one element per entry.
+ *
+ * Slots are organized in groups of 16. Each slot has a control byte, which is
+ * either empty, deleted (a tombstone) or 7 bits of the key hash. Lookups test
+ * all 16 control bytes of a group at once (with SSE2 where available) and only
+ * compare keys for the slots whose hash bits match, so most probes never touch
+ * the key and value storage at all. Groups are probed quadratically.
+ *
+ * Only used keys and values are constructed. For free positions there's space
+ * in the array for each, but that memory is kept uninitialized.
+ *
+ * Unlike HashMap, pointers to keys and values are invalidated when inserting
+ * new keys (the table may be rehashed). Erasing keeps all other entries in place.
+ */
+template <class TKey, class TData, class Hasher = HashMapHasherDefault, class Comparator = HashMapComparatorDefault<TKey>>
+class FlatHashMap {
+public:
+	struct Pair {
+		TKey key;
+		TData data;
+
+		Pair() {}
+		Pair(const TKey &p_key, const TData &p_data) :
+				key(p_key),
+				data(p_data) {
+		}
+	};
+
+	struct Element {
+	private:
+		friend class FlatHashMap;
+
+		Pair pair;
+		Element(const TKey &p_key, const TData &p_data) :
+				pair(p_key, p_data) {}
+
+	public:
+		const TKey &key() const {
+			return pair.key;
+		}
+
+		TData &value() {
+			return pair.data;
+		}
+
+		const TData &value() const {
+			return pair.data;
+		}
+	};
+
+private:
+	enum {
+		GROUP_WIDTH = 16,
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE,
+	};
+
+	struct Group {
+		const uint8_t *ctrl;
+
+		_FORCE_INLINE_ uint32_t match(uint8_t p_h2) const {
+#ifdef FLAT_HASH_MAP_SSE2
+			__m128i c = _mm_loadu_si128((const __m128i *)ctrl);
+			return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)p_h2), c));
+#else
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < GROUP_WIDTH; i++) {
+				mask |= uint32_t(ctrl[i] == p_h2) << i;
+			}
+			return mask;
+#endif
+		}
+
+		_FORCE_INLINE_ uint32_t match_empty() const {
+			return match(CTRL_EMPTY);
+		}
+
+		// Both empty and deleted slots have the high bit set.
+		_FORCE_INLINE_ uint32_t match_free() const {
+#ifdef FLAT_HASH_MAP_SSE2
+			return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < GROUP_WIDTH; i++) {
+				mask |= uint32_t(ctrl[i] >> 7) << i;
+			}
+			return mask;
+#endif
+		}
+
+		_FORCE_INLINE_ uint32_t match_full() const {
+			return ~match_free() & 0xFFFF;
+		}
+	};
+
+	uint8_t *ctrl = nullptr;
+	Element *slots = nullptr;
+
+	uint32_t capacity = 0; // Always a multiple of GROUP_WIDTH (and a power of two).
+	uint32_t elements = 0;
+	uint32_t growth_left = 0; // Free slots that can be used before rehashing.
+
+	static _FORCE_INLINE_ uint32_t _first_bit(uint32_t p_mask) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, p_mask);
+		return index;
+#else
+		return __builtin_ctz(p_mask);
+#endif
+	}
+
+	static _FORCE_INLINE_ uint8_t _h2(uint32_t p_hash) {
+		return p_hash & 0x7F;
+	}
+
+	static _FORCE_INLINE_ uint32_t _max_load(uint32_t p_capacity) {
+		return p_capacity - p_capacity / 8; // 87.5% maximum load factor.
+	}
+
+	template <class K>
+	_FORCE_INLINE_ int64_t _find(const K &p_key, uint32_t p_hash) const {
+		if (unlikely(!ctrl)) {
+			return -1;
+		}
+
+		uint32_t group_mask = capacity / GROUP_WIDTH - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+		uint8_t h2 = _h2(p_hash);
+
+		for (uint32_t step = 1;; step++) {
+			Group g = { &ctrl[group * GROUP_WIDTH] };
+			uint32_t mask = g.match(h2);
+			while (mask) {
+				uint32_t pos = group * GROUP_WIDTH + _first_bit(mask);
+				if (Comparator::compare(slots[pos].pair.key, p_key)) {
+					return pos;
+				}
+				mask &= mask - 1;
+			}
+			if (g.match_empty() || step > group_mask) {
+				return -1;
+			}
+			group = (group + step) & group_mask;
+		}
+	}
+
+	_FORCE_INLINE_ uint32_t _find_free(uint32_t p_hash) const {
+		uint32_t group_mask = capacity / GROUP_WIDTH - 1;
+		uint32_t group = (p_hash >> 7) & group_mask;
+
+		for (uint32_t step = 1;; step++) {
+			Group g = { &ctrl[group * GROUP_WIDTH] };
+			uint32_t mask = g.match_free();
+			if (mask) {
+				return group * GROUP_WIDTH + _first_bit(mask);
+			}
+			group = (group + step) & group_mask;
+		}
+	}
+
+	void _allocate(uint32_t p_capacity) {
+		capacity = p_capacity;
+		ctrl = (uint8_t *)Memory::alloc_static(capacity);
+		slots = (Element *)Memory::alloc_static(sizeof(Element) * capacity);
+		CRASH_COND_MSG(!ctrl || !slots, "Out of memory.");
+		for (uint32_t i = 0; i < capacity; i++) {
+			ctrl[i] = CTRL_EMPTY;
+		}
+		growth_left = _max_load(capacity);
+	}
+
+	void _resize_and_rehash(uint32_t p_capacity) {
+		uint8_t *old_ctrl = ctrl;
+		Element *old_slots = slots;
+		uint32_t old_capacity = capacity;
+
+		_allocate(p_capacity);
+
+		if (!old_ctrl) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < old_capacity; i++) {
+			if (old_ctrl[i] & CTRL_EMPTY) {
+				continue;
+			}
+			uint32_t hash = Hasher::hash(old_slots[i].pair.key);
+			uint32_t pos = _find_free(hash);
+			ctrl[pos] = _h2(hash);
+			memnew_placement(&slots[pos], Element(old_slots[i]));
+			old_slots[i].~Element();
+		}
+		growth_left -= elements;
+
+		Memory::free_static(old_ctrl);
+		Memory::free_static(old_slots);
+	}
+
+	Element *_insert(const TKey &p_key, const TData &p_data, uint32_t p_hash) {
+		if (unlikely(!ctrl)) {
+			_allocate(GROUP_WIDTH);
+		}
+
+		uint32_t pos = _find_free(p_hash);
+		if (unlikely(growth_left == 0 && ctrl[pos] != CTRL_DELETED)) {
+			// Out of room. Grow, unless most of the used slots are just tombstones.
+			_resize_and_rehash(elements >= _max_load(capacity) / 2 ? capacity * 2 : capacity);
+			pos = _find_free(p_hash);
+		}
+
+		if (ctrl[pos] == CTRL_EMPTY) {
+			growth_left--;
+		}
+		ctrl[pos] = _h2(p_hash);
+		memnew_placement(&slots[pos], Element(p_key, p_data));
+		elements++;
+
+		return &slots[pos];
+	}
+
+	void _erase_pos(uint32_t p_pos) {
+		// When the group still has empty slots no probe sequence went past it,
+		// so the slot can be freed instead of leaving a tombstone.
+		Group g = { &ctrl[p_pos & ~uint32_t(GROUP_WIDTH - 1)] };
+		if (g.match_empty()) {
+			ctrl[p_pos] = CTRL_EMPTY;
+			growth_left++;
+		} else {
+			ctrl[p_pos] = CTRL_DELETED;
+		}
+		slots[p_pos].~Element();
+		elements--;
+	}
+
+	void _copy_from(const FlatHashMap &p_from) {
+		if (&p_from == this) {
+			return;
+		}
+
+		clear();
+
+		if (!p_from.ctrl) {
+			return;
+		}
+
+		capacity = p_from.capacity;
+		ctrl = (uint8_t *)Memory::alloc_static(capacity);
+		slots = (Element *)Memory::alloc_static(sizeof(Element) * capacity);
+		copymem(ctrl, p_from.ctrl, capacity);
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY)) {
+				memnew_placement(&slots[i], Element(p_from.slots[i]));
+			}
+		}
+		elements = p_from.elements;
+		growth_left = p_from.growth_left;
+	}
+
+	_FORCE_INLINE_ const TKey *_next_from(uint32_t p_pos) const {
+		uint32_t base = p_pos & ~uint32_t(GROUP_WIDTH - 1);
+		uint32_t from_mask = 0xFFFF << (p_pos - base);
+		for (; base < capacity; base += GROUP_WIDTH) {
+			Group g = { &ctrl[base] };
+			uint32_t mask = g.match_full() & from_mask;
+			if (mask) {
+				return &slots[base + _first_bit(mask)].pair.key;
+			}
+			from_mask = 0xFFFF;
+		}
+		return nullptr;
+	}
+
+public:
+	Element *set(const TKey &p_key, const TData &p_data) {
+		uint32_t hash = Hasher::hash(p_key);
+		int64_t pos = _find(p_key, hash);
+		if (pos >= 0) {
+			slots[pos].pair.data = p_data;
+			return &slots[pos];
+		}
+		return _insert(p_key, p_data, hash);
+	}
+
+	Element *set(const Pair &p_pair) {
+		return set(p_pair.key, p_pair.data);
+	}
+
+	bool has(const TKey &p_key) const {
+		return _find(p_key, Hasher::hash(p_key)) >= 0;
+	}
+
+	/**
+	 * Get a key from data, return a const reference.
+	 * WARNING: this doesn't check errors, use either getptr and check nullptr, or check
+	 * first with has(key)
+	 */
+
+	const TData &get(const TKey &p_key) const {
+		const TData *res = getptr(p_key);
+		CRASH_COND_MSG(!res, "FlatHashMap key not found.");
+		return *res;
+	}
+
+	TData &get(const TKey &p_key) {
+		TData *res = getptr(p_key);
+		CRASH_COND_MSG(!res, "FlatHashMap key not found.");
+		return *res;
+	}
+
+	/**
+	 * Same as get, except it can return nullptr when item was not found.
+	 * This is mainly used for speed purposes.
+	 */
+
+	_FORCE_INLINE_ TData *getptr(const TKey &p_key) {
+		int64_t pos = _find(p_key, Hasher::hash(p_key));
+		return pos >= 0 ? &slots[pos].pair.data : nullptr;
+	}
+
+	_FORCE_INLINE_ const TData *getptr(const TKey &p_key) const {
+		int64_t pos = _find(p_key, Hasher::hash(p_key));
+		return pos >= 0 ? &slots[pos].pair.data : nullptr;
+	}
+
+	/**
+	 * Same as get, except it can return nullptr when item was not found.
+	 * This version is custom, will take a hash and a custom key (that should support operator==()
+	 */
+
+	template <class C>
+	_FORCE_INLINE_ TData *custom_getptr(C p_custom_key, uint32_t p_custom_hash) {
+		int64_t pos = _find(p_custom_key, p_custom_hash);
+		return pos >= 0 ? &slots[pos].pair.data : nullptr;
+	}
+
+	template <class C>
+	_FORCE_INLINE_ const TData *custom_getptr(C p_custom_key, uint32_t p_custom_hash) const {
+		int64_t pos = _find(p_custom_key, p_custom_hash);
+		return pos >= 0 ? &slots[pos].pair.data : nullptr;
+	}
+
+	/**
+	 * Erase an item, return true if erasing was successful
+	 */
+
+	bool erase(const TKey &p_key) {
+		int64_t pos = _find(p_key, Hasher::hash(p_key));
+		if (pos < 0) {
+			return false;
+		}
+		_erase_pos(pos); // p_key may point into the erased slot, don't use it afterwards.
+		return true;
+	}
+
+	inline const TData &operator[](const TKey &p_key) const { //constref
+
+		return get(p_key);
+	}
+	inline TData &operator[](const TKey &p_key) { //assignment
+
+		uint32_t hash = Hasher::hash(p_key);
+		int64_t pos = _find(p_key, hash);
+		if (pos >= 0) {
+			return slots[pos].pair.data;
+		}
+		return _insert(p_key, TData(), hash)->pair.data;
+	}
+
+	/**
+	 * Get the next key to p_key, and the first key if p_key is null.
+	 * Returns a pointer to the next key if found, nullptr otherwise.
+	 * Adding/Removing elements while iterating will, of course, have unexpected results, don't do it.
+	 *
+	 * Example:
+	 *
+	 * 	const TKey *k=nullptr;
+	 *
+	 * 	while( (k=table.next(k)) ) {
+	 *
+	 * 		print( *k );
+	 * 	}
+	 *
+	 */
+	const TKey *next(const TKey *p_key) const {
+		if (unlikely(!ctrl)) {
+			return nullptr;
+		}
+
+		if (!p_key) {
+			return _next_from(0);
+		}
+
+		// Keys returned by next() point into the slots, so the position is known without hashing.
+		uintptr_t offset = uintptr_t(p_key) - uintptr_t(slots);
+		if (uintptr_t(p_key) >= uintptr_t(slots) && offset < sizeof(Element) * capacity) {
+			uint32_t pos = offset / sizeof(Element);
+			if (&slots[pos].pair.key == p_key) {
+				return _next_from(pos + 1);
+			}
+		}
+
+		int64_t pos = _find(*p_key, Hasher::hash(*p_key));
+		ERR_FAIL_COND_V_MSG(pos < 0, nullptr, "Invalid key supplied.");
+		return _next_from(pos + 1);
+	}
+
+	inline unsigned int size() const {
+		return elements;
+	}
+
+	inline bool empty() const {
+		return elements == 0;
+	}
+
+	void reserve(uint32_t p_elements) {
+		uint32_t new_capacity = GROUP_WIDTH;
+		while (_max_load(new_capacity) < p_elements) {
+			new_capacity *= 2;
+		}
+		if (new_capacity > capacity) {
+			_resize_and_rehash(new_capacity);
+		}
+	}
+
+	void clear() {
+		if (ctrl) {
+			for (uint32_t i = 0; i < capacity; i++) {
+				if (!(ctrl[i] & CTRL_EMPTY)) {
+					slots[i].~Element();
+				}
+			}
+			Memory::free_static(ctrl);
+			Memory::free_static(slots);
+		}
+
+		ctrl = nullptr;
+		slots = nullptr;
+		capacity = 0;
+		elements = 0;
+		growth_left = 0;
+	}
+
+	void operator=(const FlatHashMap &p_table) {
+		_copy_from(p_table);
+	}
+
+	void get_key_list(List<TKey> *r_keys) const {
+		for (uint32_t i = 0; i < capacity; i++) {
+			if (!(ctrl[i] & CTRL_EMPTY)) {
+				r_keys->push_back(slots[i].pair.key);
+			}
+		}
+	}
+
+	FlatHashMap() {}
+
+	FlatHashMap(const FlatHashMap &p_table) {
+		_copy_from(p_table);
+	}
+
+	~FlatHashMap() {
+		clear();
+	}
+};
+
+#endif // FLAT_HASH_MAP_H
@@ -0,0 +1,125 @@
+/*************************************************************************/
+/*  frame_arena.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "frame_arena.h"
+
+#include "core/math/math_funcs.h"
+
+namespace {
+
+struct ThreadArena {
+	FrameArena *arena = nullptr;
+
+	~ThreadArena() {
+		if (arena) {
+			memdelete(arena);
+		}
+	}
+};
+
+thread_local ThreadArena thread_arena;
+
+} // namespace
+
+void *FrameArena::_alloc_chunk(size_t p_bytes, size_t p_align) {
+	size_t size = MAX(chunk_size, p_bytes + p_align);
+	if (current) {
+		size = MAX(size, current->size * 2);
+	}
+
+	Chunk *chunk = (Chunk *)memalloc(sizeof(Chunk) + size);
+	CRASH_COND_MSG(!chunk, "Out of memory.");
+	chunk->prev = current;
+	chunk->size = size;
+	chunk->used = 0;
+	current = chunk;
+
+	return alloc(p_bytes, p_align);
+}
+
+void FrameArena::reset() {
+	max_frame_used = MAX(max_frame_used, frame_used);
+	frame_used = 0;
+
+	if (!current) {
+		return;
+	}
+
+	if (current->prev) {
+		// Needed several chunks this frame, merge them into one that fits it all.
+		size_t total = 0;
+		while (current) {
+			Chunk *prev = current->prev;
+			total += current->size;
+			memfree(current);
+			current = prev;
+		}
+		current = (Chunk *)memalloc(sizeof(Chunk) + total);
+		CRASH_COND_MSG(!current, "Out of memory.");
+		current->prev = nullptr;
+		current->size = total;
+	}
+
+	current->used = 0;
+}
+
+size_t FrameArena::get_capacity() const {
+	size_t capacity = 0;
+	for (const Chunk *c = current; c; c = c->prev) {
+		capacity += c->size;
+	}
+	return capacity;
+}
+
+FrameArena *FrameArena::get_current() {
+	if (unlikely(!thread_arena.arena)) {
+		thread_arena.arena = memnew(FrameArena);
+	}
+	return thread_arena.arena;
+}
+
+void FrameArena::free_current() {
+	if (thread_arena.arena) {
+		memdelete(thread_arena.arena);
+		thread_arena.arena = nullptr;
+	}
+}
+
+FrameArena::FrameArena(size_t p_chunk_size) {
+	chunk_size = p_chunk_size;
+}
+
+FrameArena::~FrameArena() {
+	while (current) {
+		Chunk *prev = current->prev;
+		memfree(current);
+		current = prev;
+	}
+}
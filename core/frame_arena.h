@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  frame_arena.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "core/error_macros.h"
+#include "core/os/copymem.h"
+#include "core/os/memory.h"
+
+// Linear allocator for temporary data that lives for (at most) one frame.
+//
+// Allocating is a pointer bump and nothing is freed individually, all the
+// memory is released at once with reset(). When a frame needs more than one
+// chunk, reset() replaces them with a single chunk big enough for the whole
+// frame, so steady state frames don't touch the heap at all.
+//
+// Each thread has its own arena (get_current()). The main thread's arena is
+// reset at the end of every outermost Main::iteration() (not nested ones), and
+// the render thread's one after every frame drawn. Memory taken from it must not be kept beyond that.
+
+class FrameArena {
+	struct Chunk {
+		Chunk *prev;
+		size_t size;
+		size_t used;
+	};
+
+	Chunk *current = nullptr;
+	size_t chunk_size;
+	size_t frame_used = 0;
+	size_t max_frame_used = 0;
+
+	void *_alloc_chunk(size_t p_bytes, size_t p_align);
+
+public:
+	_FORCE_INLINE_ void *alloc(size_t p_bytes, size_t p_align = 16) {
+		if (likely(current)) {
+			uintptr_t base = uintptr_t(current + 1);
+			uintptr_t ptr = (base + current->used + p_align - 1) & ~uintptr_t(p_align - 1);
+			size_t end = ptr - base + p_bytes;
+			if (likely(end <= current->size)) {
+				frame_used += end - current->used;
+				current->used = end;
+				return (void *)ptr;
+			}
+		}
+		return _alloc_chunk(p_bytes, p_align);
+	}
+
+	template <class T>
+	_FORCE_INLINE_ T *alloc_array(size_t p_count) {
+		return (T *)alloc(sizeof(T) * p_count, alignof(T) > 16 ? alignof(T) : 16);
+	}
+
+	void reset();
+
+	size_t get_used() const { return frame_used; }
+	size_t get_max_used() const { return max_frame_used; }
+	size_t get_capacity() const;
+
+	static FrameArena *get_current();
+	static void free_current();
+
+	FrameArena(size_t p_chunk_size = 64 * 1024);
+	~FrameArena();
+};
+
+// Allocator for List, Map and Set (as their template argument) taking elements
+// from the current thread's frame arena. Freeing is a no-op, so containers
+// using it are cheap to fill and destroy, but must not outlive the frame.
+class FrameAllocator {
+public:
+	_FORCE_INLINE_ static void *alloc(size_t p_memory) { return FrameArena::get_current()->alloc(p_memory); }
+	_FORCE_INLINE_ static void free(void *p_ptr) {}
+};
+
+// Growable array in the style of LocalVector, stored in a frame arena. Growing
+// leaves the old buffer in the arena until it's reset.
+template <class T, class U = uint32_t>
+class FrameVector {
+	FrameArena *arena;
+	U count = 0;
+	U capacity = 0;
+	T *data = nullptr;
+
+	void _grow(U p_size) {
+		if (capacity == 0) {
+			capacity = 8;
+		}
+		while (capacity < p_size) {
+			capacity <<= 1;
+		}
+		T *new_data = arena->alloc_array<T>(capacity);
+		if (data) {
+			if (__has_trivial_copy(T)) {
+				copymem(new_data, data, count * sizeof(T));
+			} else {
+				for (U i = 0; i < count; i++) {
+					memnew_placement(&new_data[i], T(data[i]));
+					data[i].~T();
+				}
+			}
+		}
+		data = new_data;
+	}
+
+public:
+	_FORCE_INLINE_ void push_back(const T &p_elem) {
+		if (unlikely(count == capacity)) {
+			_grow(count + 1);
+		}
+		memnew_placement(&data[count++], T(p_elem));
+	}
+
+	_FORCE_INLINE_ void reserve(U p_size) {
+		if (p_size > capacity) {
+			_grow(p_size);
+		}
+	}
+
+	void resize(U p_size) {
+		if (p_size < count) {
+			if (!__has_trivial_destructor(T)) {
+				for (U i = p_size; i < count; i++) {
+					data[i].~T();
+				}
+			}
+		} else if (p_size > count) {
+			if (p_size > capacity) {
+				_grow(p_size);
+			}
+			for (U i = count; i < p_size; i++) {
+				memnew_placement(&data[i], T);
+			}
+		}
+		count = p_size;
+	}
+
+	_FORCE_INLINE_ void clear() { resize(0); }
+	_FORCE_INLINE_ bool empty() const { return count == 0; }
+	_FORCE_INLINE_ U size() const { return count; }
+	_FORCE_INLINE_ T *ptr() { return data; }
+	_FORCE_INLINE_ const T *ptr() const { return data; }
+
+	_FORCE_INLINE_ const T &operator[](U p_index) const {
+		CRASH_BAD_UNSIGNED_INDEX(p_index, count);
+		return data[p_index];
+	}
+	_FORCE_INLINE_ T &operator[](U p_index) {
+		CRASH_BAD_UNSIGNED_INDEX(p_index, count);
+		return data[p_index];
+	}
+
+	_FORCE_INLINE_ FrameVector(FrameArena *p_arena = FrameArena::get_current()) :
+			arena(p_arena) {}
+	_FORCE_INLINE_ FrameVector(const FrameVector &p_from) :
+			arena(p_from.arena) {
+		reserve(p_from.count);
+		for (U i = 0; i < p_from.count; i++) {
+			push_back(p_from.data[i]);
+		}
+	}
+	void operator=(const FrameVector &p_from) {
+		clear();
+		reserve(p_from.count);
+		for (U i = 0; i < p_from.count; i++) {
+			push_back(p_from.data[i]);
+		}
+	}
+
+	_FORCE_INLINE_ ~FrameVector() {
+		clear();
+	}
+};
+
+#endif // FRAME_ARENA_H
@@ -30,8 +30,11 @@
 
 #include "compression.h"
 
+#include "core/hash_map.h"
 #include "core/io/zip_io.h"
+#include "core/local_vector.h"
 #include "core/os/copymem.h"
+#include "core/os/mutex.h"
 #include "core/project_settings.h"
 
 #include "thirdparty/misc/fastlz.h"
@@ -39,7 +42,23 @@
 #include <zlib.h>
 #include <zstd.h>
 
-int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode) {
+struct ZstdDictionary {
+	Vector<uint8_t> data;
+	ZSTD_CDict *cdict = nullptr;
+	ZSTD_DDict *ddict = nullptr;
+};
+
+// Dictionaries are only freed on shutdown, so pointers stay valid after the lock is released.
+static HashMap<uint32_t, ZstdDictionary *> zstd_dictionaries;
+static Mutex zstd_dictionaries_mutex;
+
+static const ZstdDictionary *_get_zstd_dictionary(uint32_t p_id) {
+	MutexLock lock(zstd_dictionaries_mutex);
+	ZstdDictionary **dict = zstd_dictionaries.getptr(p_id);
+	return dict ? *dict : nullptr;
+}
+
+int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode, uint32_t p_dict_id) {
 	switch (p_mode) {
 		case MODE_FASTLZ: {
 			if (p_src_size < 16) {
@@ -89,6 +108,16 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,
 			ZSTD_freeCCtx(cctx);
 			return ret;
 		} break;
+		case MODE_ZSTD_DICT: {
+			const ZstdDictionary *dict = _get_zstd_dictionary(p_dict_id);
+			ERR_FAIL_COND_V_MSG(!dict, -1, "Unknown Zstandard dictionary: " + itos(p_dict_id) + ".");
+
+			ZSTD_CCtx *cctx = ZSTD_createCCtx();
+			int max_dst_size = get_max_compressed_buffer_size(p_src_size, MODE_ZSTD_DICT);
+			int ret = ZSTD_compress_usingCDict(cctx, p_dst, max_dst_size, p_src, p_src_size, dict->cdict);
+			ZSTD_freeCCtx(cctx);
+			return ret;
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
@@ -120,7 +149,8 @@ int Compression::get_max_compressed_buffer_size(int p_src_size, Mode p_mode) {
 			deflateEnd(&strm);
 			return aout;
 		} break;
-		case MODE_ZSTD: {
+		case MODE_ZSTD:
+		case MODE_ZSTD_DICT: {
 			return ZSTD_compressBound(p_src_size);
 		} break;
 	}
@@ -128,7 +158,7 @@ int Compression::get_max_compressed_buffer_size(int p_src_size, Mode p_mode) {
 	ERR_FAIL_V(-1);
 }
 
-int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode) {
+int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode, uint32_t p_dict_id) {
 	switch (p_mode) {
 		case MODE_FASTLZ: {
 			int ret_size = 0;
@@ -175,11 +205,159 @@ int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p
 			ZSTD_freeDCtx(dctx);
 			return ret;
 		} break;
+		case MODE_ZSTD_DICT: {
+			const ZstdDictionary *dict = _get_zstd_dictionary(p_dict_id);
+			ERR_FAIL_COND_V_MSG(!dict, -1, "Unknown Zstandard dictionary: " + itos(p_dict_id) + ".");
+
+			ZSTD_DCtx *dctx = ZSTD_createDCtx();
+			int ret = ZSTD_decompress_usingDDict(dctx, p_dst, p_dst_max_size, p_src, p_src_size, dict->ddict);
+			ZSTD_freeDCtx(dctx);
+			return ret;
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
 }
 
+uint32_t Compression::add_zstd_dictionary(const Vector<uint8_t> &p_dict) {
+	ERR_FAIL_COND_V_MSG(p_dict.size() < 8, 0, "Zstandard dictionaries must be at least 8 bytes long.");
+
+	uint32_t id = hash_djb2_buffer(p_dict.ptr(), p_dict.size());
+	if (id == 0) {
+		id = 1; // 0 means no dictionary.
+	}
+
+	MutexLock lock(zstd_dictionaries_mutex);
+
+	ZstdDictionary **existing = zstd_dictionaries.getptr(id);
+	if (existing) {
+		const Vector<uint8_t> &data = (*existing)->data;
+		ERR_FAIL_COND_V_MSG(data.size() != p_dict.size() || memcmp(data.ptr(), p_dict.ptr(), data.size()) != 0, 0, "Zstandard dictionary hash collision.");
+		return id;
+	}
+
+	// Dictionaries without zstd's header are used as raw content, as the trained ones are.
+	ZstdDictionary *dict = memnew(ZstdDictionary);
+	dict->data = p_dict;
+	dict->cdict = ZSTD_createCDict(p_dict.ptr(), p_dict.size(), zstd_level);
+	dict->ddict = ZSTD_createDDict(p_dict.ptr(), p_dict.size());
+	if (!dict->cdict || !dict->ddict) {
+		ZSTD_freeCDict(dict->cdict);
+		ZSTD_freeDDict(dict->ddict);
+		memdelete(dict);
+		ERR_FAIL_V_MSG(0, "Invalid Zstandard dictionary.");
+	}
+
+	zstd_dictionaries.set(id, dict);
+	return id;
+}
+
+Vector<uint8_t> Compression::get_zstd_dictionary(uint32_t p_id) {
+	const ZstdDictionary *dict = _get_zstd_dictionary(p_id);
+	ERR_FAIL_COND_V(!dict, Vector<uint8_t>());
+	return dict->data;
+}
+
+bool Compression::has_zstd_dictionary(uint32_t p_id) {
+	return _get_zstd_dictionary(p_id) != nullptr;
+}
+
+void Compression::clear_zstd_dictionaries() {
+	MutexLock lock(zstd_dictionaries_mutex);
+
+	const uint32_t *k = nullptr;
+	while ((k = zstd_dictionaries.next(k))) {
+		ZstdDictionary *dict = zstd_dictionaries[*k];
+		ZSTD_freeCDict(dict->cdict);
+		ZSTD_freeDDict(dict->ddict);
+		memdelete(dict);
+	}
+	zstd_dictionaries.clear();
+}
+
+#define TRAIN_DMER_SIZE 8
+#define TRAIN_SEGMENT_SIZE 256
+#define TRAIN_HASH_BITS 20
+
+static _FORCE_INLINE_ uint32_t _train_hash(const uint8_t *p_dmer) {
+	uint64_t v;
+	memcpy(&v, p_dmer, TRAIN_DMER_SIZE);
+	return (v * 0xCF1BBCDCB7A56463ULL) >> (64 - TRAIN_HASH_BITS);
+}
+
+Vector<uint8_t> Compression::train_zstd_dictionary(const Vector<Vector<uint8_t>> &p_samples, int p_max_size) {
+	// A simplified take on the cover algorithm of zstd's dictionary builder: d-mers are
+	// counted over all the samples, then every epoch of the sample data contributes the
+	// segment whose d-mers are the most frequent ones not covered by the dictionary yet.
+	ERR_FAIL_COND_V(p_max_size < TRAIN_SEGMENT_SIZE, Vector<uint8_t>());
+
+	LocalVector<uint8_t> data;
+	for (int i = 0; i < p_samples.size(); i++) {
+		uint32_t from = data.size();
+		data.resize(from + p_samples[i].size());
+		if (p_samples[i].size()) {
+			memcpy(&data[from], p_samples[i].ptr(), p_samples[i].size());
+		}
+	}
+	ERR_FAIL_COND_V_MSG(data.size() < TRAIN_SEGMENT_SIZE * 2, Vector<uint8_t>(), "Not enough sample data to train a dictionary.");
+
+	const uint32_t dmer_count = data.size() - TRAIN_DMER_SIZE + 1;
+	const uint32_t window = TRAIN_SEGMENT_SIZE - TRAIN_DMER_SIZE + 1;
+
+	LocalVector<uint32_t> hashes;
+	hashes.resize(dmer_count);
+	LocalVector<uint32_t> freqs;
+	freqs.resize(1 << TRAIN_HASH_BITS);
+	memset(&freqs[0], 0, freqs.size() * sizeof(uint32_t));
+
+	for (uint32_t i = 0; i < dmer_count; i++) {
+		hashes[i] = _train_hash(&data[i]);
+		freqs[hashes[i]]++;
+	}
+
+	Vector<uint8_t> dict;
+	dict.resize(p_max_size);
+	int tail = p_max_size;
+
+	uint32_t epochs = p_max_size / TRAIN_SEGMENT_SIZE;
+	uint32_t epoch_size = MAX(dmer_count / epochs, window);
+
+	for (uint32_t begin = 0; begin + window <= dmer_count && tail >= TRAIN_SEGMENT_SIZE; begin += epoch_size) {
+		uint32_t end = MIN(begin + epoch_size, dmer_count);
+
+		uint64_t score = 0;
+		for (uint32_t i = begin; i < begin + window; i++) {
+			score += freqs[hashes[i]];
+		}
+		uint64_t best_score = score;
+		uint32_t best = begin;
+		for (uint32_t i = begin + window; i < end; i++) {
+			score += freqs[hashes[i]];
+			score -= freqs[hashes[i - window]];
+			if (score > best_score) {
+				best_score = score;
+				best = i - window + 1;
+			}
+		}
+
+		if (best_score <= window) {
+			continue; // Nothing in this epoch repeats.
+		}
+
+		// Filled from the back, so the segments of the first epochs end up farthest from the data.
+		tail -= TRAIN_SEGMENT_SIZE;
+		memcpy(dict.ptrw() + tail, &data[best], TRAIN_SEGMENT_SIZE);
+
+		for (uint32_t i = best; i < best + window; i++) {
+			freqs[hashes[i]] = 0;
+		}
+	}
+
+	ERR_FAIL_COND_V_MSG(tail == p_max_size, Vector<uint8_t>(), "The samples have no content in common to train a dictionary from.");
+
+	return dict.subarray(tail, p_max_size - 1);
+}
+
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
 int Compression::zstd_level = 3;
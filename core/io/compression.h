@@ -32,6 +32,7 @@
 #define COMPRESSION_H
 
 #include "core/typedefs.h"
+#include "core/vector.h"
 
 class Compression {
 public:
@@ -45,12 +46,22 @@ public:
 		MODE_FASTLZ,
 		MODE_DEFLATE,
 		MODE_ZSTD,
-		MODE_GZIP
+		MODE_GZIP,
+		MODE_ZSTD_DICT // Zstandard with a dictionary added through add_zstd_dictionary().
 	};
 
-	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD, uint32_t p_dict_id = 0);
 	static int get_max_compressed_buffer_size(int p_src_size, Mode p_mode = MODE_ZSTD);
-	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
+	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD, uint32_t p_dict_id = 0);
+
+	// Dictionaries are digested once and identified by a hash of their contents,
+	// adding the same dictionary twice returns the same ID. Returns 0 on failure.
+	static uint32_t add_zstd_dictionary(const Vector<uint8_t> &p_dict);
+	static Vector<uint8_t> get_zstd_dictionary(uint32_t p_id);
+	static bool has_zstd_dictionary(uint32_t p_id);
+	static void clear_zstd_dictionaries();
+	// Builds a raw content dictionary from the segments most often repeated across the samples.
+	static Vector<uint8_t> train_zstd_dictionary(const Vector<Vector<uint8_t>> &p_samples, int p_max_size = 16384);
 
 	Compression() {}
 };
@@ -43,7 +43,139 @@ void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_
 	}
 
 	cmode = p_mode;
-	block_size = p_block_size;
+	block_size = p_block_size > 0 ? p_block_size : default_block_size;
+}
+
+void FileAccessCompressed::set_zstd_dictionary(uint32_t p_id, bool p_embed) {
+	dict_id = p_id;
+	dict_embedded = p_embed;
+}
+
+int FileAccessCompressed::default_block_size = 4096;
+int FileAccessCompressed::read_ahead_blocks = 4;
+
+void FileAccessCompressed::set_default_block_size(int p_size) {
+	ERR_FAIL_COND(p_size <= 0);
+	default_block_size = p_size;
+}
+
+void FileAccessCompressed::set_read_ahead_blocks(int p_count) {
+	read_ahead_blocks = MAX(p_count, 0);
+}
+
+void FileAccessCompressed::_load_block(int p_block) const {
+	ReadAhead *ahead = nullptr;
+	for (uint32_t i = 0; i < read_ahead.size(); i++) {
+		if (read_ahead[i].block == p_block) {
+			ahead = &read_ahead[i];
+			break;
+		}
+	}
+
+	if (ahead) {
+		ThreadWorkPool::get_singleton()->wait_for_task_completion(ahead->task);
+		ahead->task = ThreadWorkPool::INVALID_TASK_ID;
+		ahead->block = -1;
+
+		// Swap buffers instead of copying.
+		Vector<uint8_t> data = ahead->data;
+		ahead->data = buffer;
+		buffer = data;
+	} else {
+		// Read ahead moves the position, always seek.
+		f->seek(read_blocks[p_block].offset);
+		f->get_buffer(comp_buffer.ptrw(), read_blocks[p_block].csize);
+		Compression::decompress(buffer.ptrw(), block_size, comp_buffer.ptr(), read_blocks[p_block].csize, cmode, dict_id);
+	}
+
+	read_ptr = buffer.ptrw();
+	read_block = p_block;
+	read_block_size = _get_block_size(p_block);
+	read_pos = 0;
+
+	_read_ahead(p_block + 1);
+}
+
+void FileAccessCompressed::_read_ahead(int p_from) const {
+	int to = MIN(p_from + (int)read_ahead.size(), read_block_count);
+
+	for (int block = p_from; block < to; block++) {
+		ReadAhead *ahead = nullptr;
+		ReadAhead *unused = nullptr;
+		for (uint32_t i = 0; i < read_ahead.size(); i++) {
+			if (read_ahead[i].block == block) {
+				ahead = &read_ahead[i];
+				break;
+			}
+			if (!unused && (read_ahead[i].block < p_from || read_ahead[i].block >= to)) {
+				unused = &read_ahead[i];
+			}
+		}
+		if (ahead) {
+			continue; // Already on its way.
+		}
+		if (!unused) {
+			break;
+		}
+
+		if (unused->task != ThreadWorkPool::INVALID_TASK_ID) {
+			// Left behind by a seek.
+			ThreadWorkPool::get_singleton()->wait_for_task_completion(unused->task);
+		}
+
+		// File access stays on this thread, only decompression is offloaded.
+		unused->block = block;
+		unused->comp.resize(read_blocks[block].csize);
+		f->seek(read_blocks[block].offset);
+		f->get_buffer(unused->comp.ptrw(), read_blocks[block].csize);
+		unused->data.resize(block_size);
+		unused->dst = unused->data.ptrw();
+		unused->task = ThreadWorkPool::get_singleton()->add_task(this, &FileAccessCompressed::_decompress_read_ahead, unused);
+	}
+}
+
+void FileAccessCompressed::_clear_read_ahead() const {
+	for (uint32_t i = 0; i < read_ahead.size(); i++) {
+		if (read_ahead[i].task != ThreadWorkPool::INVALID_TASK_ID) {
+			ThreadWorkPool::get_singleton()->wait_for_task_completion(read_ahead[i].task);
+			read_ahead[i].task = ThreadWorkPool::INVALID_TASK_ID;
+		}
+		read_ahead[i].block = -1;
+	}
+}
+
+void FileAccessCompressed::_decompress_read_ahead(ReadAhead *p_read_ahead) const {
+	Compression::decompress(p_read_ahead->dst, block_size, p_read_ahead->comp.ptr(), p_read_ahead->comp.size(), cmode, dict_id);
+}
+
+void FileAccessCompressed::_decompress_bulk(uint32_t p_index, BulkRead *p_bulk) const {
+	int block = p_bulk->first_block + p_index;
+	const uint8_t *src = p_bulk->src + (read_blocks[block].offset - read_blocks[p_bulk->first_block].offset);
+	Compression::decompress(p_bulk->dst + uint64_t(p_index) * block_size, block_size, src, read_blocks[block].csize, cmode, dict_id);
+}
+
+void FileAccessCompressed::_read_blocks(int p_first, int p_count, uint8_t *p_dst) const {
+	// Blocks are stored one after the other, so their compressed data is read at once.
+	int last = p_first + p_count - 1;
+	int csize = read_blocks[last].offset + read_blocks[last].csize - read_blocks[p_first].offset;
+	Vector<uint8_t> comp;
+	comp.resize(csize);
+	f->seek(read_blocks[p_first].offset);
+	f->get_buffer(comp.ptrw(), csize);
+
+	BulkRead bulk;
+	bulk.first_block = p_first;
+	bulk.src = comp.ptr();
+	bulk.dst = p_dst;
+
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (pool && p_count > 1) {
+		pool->do_work(p_count, this, &FileAccessCompressed::_decompress_bulk, &bulk);
+	} else {
+		for (int i = 0; i < p_count; i++) {
+			_decompress_bulk(i, &bulk);
+		}
+	}
 }
 
 #define WRITE_FIT(m_bytes)                                  \
@@ -67,6 +199,25 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with block size 0, it is corrupted.");
 	}
 	read_total = f->get_32();
+	if (cmode == Compression::MODE_ZSTD_DICT) {
+		uint32_t dict_size = f->get_32();
+		if (dict_size > f->get_len() - f->get_position()) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', its Zstandard dictionary is larger than the file.");
+		}
+		if (dict_size) {
+			Vector<uint8_t> dict;
+			dict.resize(dict_size);
+			f->get_buffer(dict.ptrw(), dict_size);
+			dict_id = Compression::add_zstd_dictionary(dict);
+		} else {
+			dict_id = f->get_32();
+		}
+		if (!Compression::has_zstd_dictionary(dict_id)) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', its Zstandard dictionary is missing.");
+		}
+	}
 	int bc = (read_total / block_size) + 1;
 	int acc_ofs = f->get_position() + bc * 4;
 	int max_bs = 0;
@@ -81,16 +232,14 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 
 	comp_buffer.resize(max_bs);
 	buffer.resize(block_size);
-	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
 	at_end = false;
 	read_eof = false;
 	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
 
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
-	read_pos = 0;
+	if (ThreadWorkPool::get_singleton()) {
+		read_ahead.resize(MIN(read_ahead_blocks, bc - 1));
+	}
+	_load_block(0);
 
 	return OK;
 }
@@ -143,11 +292,27 @@ void FileAccessCompressed::close() {
 	if (writing) {
 		//save block table and all compressed blocks
 
+		if (cmode == Compression::MODE_ZSTD_DICT && !Compression::has_zstd_dictionary(dict_id)) {
+			ERR_PRINT("No Zstandard dictionary set for '" + f->get_path() + "', compressing without one.");
+			cmode = Compression::MODE_ZSTD;
+		}
+
 		CharString mgc = magic.utf8();
 		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //write header 4
 		f->store_32(cmode); //write compression mode 4
 		f->store_32(block_size); //write block size 4
 		f->store_32(write_max); //max amount of data written 4
+		if (cmode == Compression::MODE_ZSTD_DICT) {
+			if (dict_embedded) {
+				Vector<uint8_t> dict = Compression::get_zstd_dictionary(dict_id);
+				f->store_32(dict.size());
+				f->store_buffer(dict.ptr(), dict.size());
+			} else {
+				f->store_32(0);
+				f->store_32(dict_id);
+			}
+		}
+		uint64_t table_pos = f->get_position();
 		int bc = (write_max / block_size) + 1;
 
 		for (int i = 0; i < bc; i++) {
@@ -161,13 +326,13 @@ void FileAccessCompressed::close() {
 
 			Vector<uint8_t> cblock;
 			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
+			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode, dict_id);
 
 			f->store_buffer(cblock.ptr(), s);
 			block_sizes.push_back(s);
 		}
 
-		f->seek(16); //ok write block sizes
+		f->seek(table_pos); //ok write block sizes
 		for (int i = 0; i < bc; i++) {
 			f->store_32(block_sizes[i]);
 		}
@@ -177,6 +342,8 @@ void FileAccessCompressed::close() {
 		buffer.clear();
 
 	} else {
+		_clear_read_ahead();
+		read_ahead.clear();
 		comp_buffer.clear();
 		buffer.clear();
 		read_blocks.clear();
@@ -206,11 +373,7 @@ void FileAccessCompressed::seek(size_t p_position) {
 			read_eof = false;
 			int block_idx = p_position / block_size;
 			if (block_idx != read_block) {
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
+				_load_block(block_idx);
 			}
 
 			read_pos = p_position % block_size;
@@ -271,10 +434,7 @@ uint8_t FileAccessCompressed::get_8() const {
 
 		if (read_block < read_block_count) {
 			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			read_pos = 0;
+			_load_block(read_block);
 
 		} else {
 			read_block--;
@@ -294,26 +454,36 @@ int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const {
 		return 0;
 	}
 
-	for (int i = 0; i < p_length; i++) {
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
+	int dst_pos = 0;
+	while (dst_pos < p_length) {
+		int to_copy = MIN(read_block_size - read_pos, p_length - dst_pos);
+		copymem(p_dst + dst_pos, read_ptr + read_pos, to_copy);
+		dst_pos += to_copy;
+		read_pos += to_copy;
+
 		if (read_pos >= read_block_size) {
-			read_block++;
+			int next = read_block + 1;
+
+			// Whole blocks the read covers skip the block buffer (the last block may be shorter).
+			int whole = MIN((p_length - dst_pos) / (int)block_size, read_block_count - 1 - next);
+			if (whole > 0) {
+				_clear_read_ahead();
+				_read_blocks(next, whole, p_dst + dst_pos);
+				dst_pos += whole * block_size;
+				next += whole;
+			}
 
-			if (read_block < read_block_count) {
+			if (next < read_block_count) {
 				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
+				_load_block(next);
 
 			} else {
-				read_block--;
+				read_pos = read_block_size;
 				at_end = true;
-				if (i < p_length - 1) {
+				if (dst_pos < p_length) {
 					read_eof = true;
 				}
-				return i;
+				return dst_pos;
 			}
 		}
 	}
@@ -32,10 +32,14 @@
 #define FILE_ACCESS_COMPRESSED_H
 
 #include "core/io/compression.h"
+#include "core/local_vector.h"
 #include "core/os/file_access.h"
+#include "core/thread_work_pool.h"
 
 class FileAccessCompressed : public FileAccess {
 	Compression::Mode cmode = Compression::MODE_ZSTD;
+	uint32_t dict_id = 0;
+	bool dict_embedded = false;
 	bool writing = false;
 	uint32_t write_pos = 0;
 	uint8_t *write_ptr = nullptr;
@@ -50,8 +54,24 @@ class FileAccessCompressed : public FileAccess {
 		int offset;
 	};
 
+	// Block being decompressed in the ThreadWorkPool before it's read.
+	struct ReadAhead {
+		int block = -1;
+		Vector<uint8_t> comp;
+		Vector<uint8_t> data;
+		uint8_t *dst = nullptr;
+		ThreadWorkPool::TaskID task = ThreadWorkPool::INVALID_TASK_ID;
+	};
+
+	// Whole blocks decompressed straight into the caller's buffer.
+	struct BulkRead {
+		int first_block;
+		const uint8_t *src;
+		uint8_t *dst;
+	};
+
 	mutable Vector<uint8_t> comp_buffer;
-	uint8_t *read_ptr = nullptr;
+	mutable uint8_t *read_ptr = nullptr;
 	mutable int read_block = 0;
 	int read_block_count = 0;
 	mutable int read_block_size = 0;
@@ -59,12 +79,36 @@ class FileAccessCompressed : public FileAccess {
 	Vector<ReadBlock> read_blocks;
 	uint32_t read_total = 0;
 
+	mutable LocalVector<ReadAhead> read_ahead;
+
 	String magic = "GCMP";
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f = nullptr;
 
+	static int default_block_size;
+	static int read_ahead_blocks;
+
+	_FORCE_INLINE_ int _get_block_size(int p_block) const {
+		return p_block == read_block_count - 1 ? read_total % block_size : block_size;
+	}
+	void _load_block(int p_block) const;
+	void _read_ahead(int p_from) const;
+	void _clear_read_ahead() const;
+	void _decompress_read_ahead(ReadAhead *p_read_ahead) const;
+	void _decompress_bulk(uint32_t p_index, BulkRead *p_bulk) const;
+	void _read_blocks(int p_first, int p_count, uint8_t *p_dst) const;
+
 public:
-	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, int p_block_size = 4096);
+	// A block size of 0 uses the default set by the project settings.
+	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, int p_block_size = 0);
+
+	// Dictionary for MODE_ZSTD_DICT, added with Compression::add_zstd_dictionary(). By default
+	// only the ID is stored and the dictionary must be added again before reading (packs add
+	// the one they store when mounted). Embedded dictionaries are stored in each file.
+	void set_zstd_dictionary(uint32_t p_id, bool p_embed = false);
+
+	static void set_default_block_size(int p_size);
+	static void set_read_ahead_blocks(int p_count);
 
 	Error open_after_magic(FileAccess *p_base);
 
@@ -30,11 +30,14 @@
 
 #include "file_access_pack.h"
 
+#include "core/io/compression.h"
+#include "core/io/marshalls.h"
 #include "core/version.h"
 
 #include <stdio.h>
 
 Error PackedData::add_pack(const String &p_path, bool p_replace_files) {
+	pack_count++;
 	for (int i = 0; i < sources.size(); i++) {
 		if (sources[i]->try_open_pack(p_path, p_replace_files)) {
 			return OK;
@@ -44,7 +47,7 @@ Error PackedData::add_pack(const String &p_path, bool p_replace_files) {
 	return ERR_FILE_UNRECOGNIZED;
 }
 
-void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files) {
+void PackedData::add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, const uint8_t *p_mapped) {
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
 
@@ -58,38 +61,150 @@ void PackedData::add_path(const String &pkg_path, const String &path, uint64_t o
 		pf.md5[i] = p_md5[i];
 	}
 	pf.src = p_src;
+	pf.mapped = p_mapped;
+	pf.priority = _get_priority(p_replace_files);
 
 	if (!exists || p_replace_files) {
 		files[pmd5] = pf;
 	}
 
 	if (!exists) {
-		//search for dir
-		String p = path.replace_first("res://", "");
-		PackedDir *cd = root;
-
-		if (p.find("/") != -1) { //in a subdir
-
-			Vector<String> ds = p.get_base_dir().split("/");
-
-			for (int j = 0; j < ds.size(); j++) {
-				if (!cd->subdirs.has(ds[j])) {
-					PackedDir *pd = memnew(PackedDir);
-					pd->name = ds[j];
-					pd->parent = cd;
-					cd->subdirs[pd->name] = pd;
-					cd = pd;
-				} else {
-					cd = cd->subdirs[ds[j]];
-				}
+		MutexLock lock(dirs_mutex);
+		_add_to_dirs(path);
+	}
+}
+
+void PackedData::add_index(const String &p_pack, PackSource *p_src, const uint8_t *p_entries, uint32_t p_count, const Vector<uint8_t> &p_buffer, const uint8_t *p_mapped, bool p_replace_files) {
+	PackIndex *index = memnew(PackIndex);
+	index->pack = p_pack;
+	index->src = p_src;
+	index->buffer = p_buffer;
+	index->entries = p_buffer.size() ? p_buffer.ptr() : p_entries;
+	index->count = p_count;
+	index->mapped = p_mapped;
+	index->priority = _get_priority(p_replace_files);
+
+	uint32_t pos = 0;
+	while (pos < indices.size() && indices[pos]->priority > index->priority) {
+		pos++;
+	}
+	indices.insert(pos, index);
+
+	MutexLock lock(dirs_mutex);
+	dirs_pending = true;
+}
+
+const PackedData::PackIndex *PackedData::_find_in_indices(const Vector<uint8_t> &p_md5, int p_min_priority, PackedFile &r_file) const {
+	uint64_t a, b;
+	PackedSourcePCK::get_path_hash(p_md5, a, b);
+
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		const PackIndex *index = indices[i];
+		if (index->priority <= p_min_priority) {
+			break;
+		}
+
+		uint32_t low = 0;
+		uint32_t high = index->count;
+		while (low < high) {
+			uint32_t middle = (low + high) / 2;
+			const uint8_t *entry = index->entries + uint64_t(middle) * PACK_INDEX_ENTRY_SIZE;
+			uint64_t ea = decode_uint64(entry);
+			uint64_t eb = decode_uint64(entry + 8);
+
+			if (ea == a && eb == b) {
+				r_file.pack = index->pack;
+				r_file.offset = decode_uint64(entry + 16);
+				r_file.size = decode_uint64(entry + 24);
+				r_file.src = index->src;
+				r_file.mapped = index->mapped;
+				r_file.priority = index->priority;
+				memset(r_file.md5, 0, 16); // Only in the file table, not needed to read the file.
+				return index;
+			} else if (ea < a || (ea == a && eb < b)) {
+				low = middle + 1;
+			} else {
+				high = middle;
 			}
 		}
-		String filename = path.get_file();
-		// Don't add as a file if the path points to a directory
-		if (!filename.empty()) {
-			cd->files.insert(filename);
+	}
+
+	return nullptr;
+}
+
+void PackedData::_add_to_dirs(const String &p_path) {
+	//search for dir
+	String p = p_path.replace_first("res://", "");
+	PackedDir *cd = root;
+
+	if (p.find("/") != -1) { //in a subdir
+
+		Vector<String> ds = p.get_base_dir().split("/");
+
+		for (int j = 0; j < ds.size(); j++) {
+			if (!cd->subdirs.has(ds[j])) {
+				PackedDir *pd = memnew(PackedDir);
+				pd->name = ds[j];
+				pd->parent = cd;
+				cd->subdirs[pd->name] = pd;
+				cd = pd;
+			} else {
+				cd = cd->subdirs[ds[j]];
+			}
 		}
 	}
+	String filename = p_path.get_file();
+	// Don't add as a file if the path points to a directory
+	if (!filename.empty()) {
+		cd->files.insert(filename);
+	}
+}
+
+PackedData::PackedDir *PackedData::_get_root() {
+	MutexLock lock(dirs_mutex);
+	if (!dirs_pending) {
+		return root;
+	}
+
+	// Paths of indexed packs are only read the first time directories are listed.
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		PackIndex *index = indices[i];
+		if (index->dirs_added) {
+			continue;
+		}
+		index->dirs_added = true;
+
+		FileAccess *f = nullptr;
+		if (!index->mapped) {
+			f = FileAccess::open(index->pack, FileAccess::READ);
+			ERR_CONTINUE_MSG(!f, "Can't open pack-referenced file '" + index->pack + "'.");
+		}
+
+		CharString cs;
+		for (uint32_t j = 0; j < index->count; j++) {
+			uint64_t record = decode_uint64(index->entries + uint64_t(j) * PACK_INDEX_ENTRY_SIZE + 32);
+			String path;
+			if (f) {
+				f->seek(record);
+				uint32_t sl = f->get_32();
+				cs.resize(sl + 1);
+				f->get_buffer((uint8_t *)cs.ptr(), sl);
+				cs[sl] = 0;
+				path.parse_utf8(cs.ptr());
+			} else {
+				uint32_t sl = decode_uint32(index->mapped + record);
+				path.parse_utf8((const char *)index->mapped + record + 4, sl);
+			}
+			_add_to_dirs(path);
+		}
+
+		if (f) {
+			memdelete(f);
+		}
+	}
+	dirs_pending = false;
+
+	return root;
 }
 
 void PackedData::add_pack_source(PackSource *p_source) {
@@ -115,6 +230,9 @@ void PackedData::_free_packed_dirs(PackedDir *p_dir) {
 }
 
 PackedData::~PackedData() {
+	for (uint32_t i = 0; i < indices.size(); i++) {
+		memdelete(indices[i]);
+	}
 	for (int i = 0; i < sources.size(); i++) {
 		memdelete(sources[i]);
 	}
@@ -123,6 +241,24 @@ PackedData::~PackedData() {
 
 //////////////////////////////////////////////////////////////////
 
+// Reads through a mapping trust the offsets in the pack, so before using one
+// every file and path record the index points to must be inside it.
+static bool _is_index_in_mapping(const uint8_t *p_mapped, uint64_t p_len, const uint8_t *p_entries, uint32_t p_count) {
+	for (uint32_t i = 0; i < p_count; i++) {
+		const uint8_t *entry = p_entries + uint64_t(i) * PACK_INDEX_ENTRY_SIZE;
+		uint64_t ofs = decode_uint64(entry + 16);
+		uint64_t size = decode_uint64(entry + 24);
+		uint64_t record = decode_uint64(entry + 32);
+		if (ofs > p_len || size > p_len - ofs) {
+			return false;
+		}
+		if (p_len < 4 || record > p_len - 4 || decode_uint32(p_mapped + record) > p_len - 4 - record) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files) {
 	FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
 	if (!f) {
@@ -131,6 +267,8 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files)
 
 	uint32_t magic = f->get_32();
 
+	uint64_t pack_start = 0;
+
 	if (magic != PACK_HEADER_MAGIC) {
 		//maybe at the end.... self contained exe
 		f->seek_end();
@@ -146,6 +284,7 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files)
 		uint64_t ds = f->get_64();
 		f->seek(f->get_position() - ds - 8);
 
+		pack_start = f->get_position();
 		magic = f->get_32();
 		if (magic != PACK_HEADER_MAGIC) {
 			f->close();
@@ -170,13 +309,66 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files)
 		ERR_FAIL_V_MSG(false, "Pack created with a newer version of the engine: " + itos(ver_major) + "." + itos(ver_minor) + ".");
 	}
 
-	for (int i = 0; i < 16; i++) {
+	uint64_t index_ofs = f->get_64();
+	uint64_t dict_ofs = f->get_64();
+	for (int i = 0; i < 12; i++) {
 		//reserved
 		f->get_32();
 	}
 
 	int file_count = f->get_32();
 
+	if (dict_ofs) {
+		uint64_t pos = f->get_position();
+		f->seek(pack_start + dict_ofs);
+		Vector<uint8_t> dict;
+		dict.resize(f->get_32());
+		f->get_buffer(dict.ptrw(), dict.size());
+		Compression::add_zstd_dictionary(dict);
+		f->seek(pos);
+	}
+
+	const uint8_t *mapped = nullptr;
+	uint64_t mapped_len = 0;
+	if (PackedData::get_singleton()->is_using_mmap()) {
+		mapped = f->map_contents(); // Doesn't move the read position.
+		mapped_len = f->get_len();
+	}
+
+	if (index_ofs) {
+		// Mount from the index instead of reading the whole file table.
+		uint64_t pos = pack_start + index_ofs;
+		f->seek(pos);
+		uint32_t count = f->get_32();
+		uint64_t len = uint64_t(count) * PACK_INDEX_ENTRY_SIZE;
+
+		if (count == uint32_t(file_count) && pos <= f->get_len() && 8 + len <= f->get_len() - pos) {
+			if (mapped && !_is_index_in_mapping(mapped, mapped_len, mapped + pos + 8, count)) {
+				WARN_PRINT("Pack index points outside of the file, reading it without mapping: " + p_path + ".");
+				mapped = nullptr;
+			}
+
+			Vector<uint8_t> buffer;
+			if (!mapped) {
+				buffer.resize(len);
+				f->seek(pos + 8);
+				f->get_buffer(buffer.ptrw(), len);
+			}
+			PackedData::get_singleton()->add_index(p_path, this, mapped ? mapped + pos + 8 : nullptr, count, buffer, mapped, p_replace_files);
+
+			if (mapped) {
+				mapped_packs.push_back(f);
+			} else {
+				f->close();
+				memdelete(f);
+			}
+			return true;
+		}
+
+		WARN_PRINT("Pack index is invalid, reading the file table instead: " + p_path + ".");
+		f->seek(pack_start + PACK_INDEX_OFFSET_POS + 16 * 4 + 4);
+	}
+
 	for (int i = 0; i < file_count; i++) {
 		uint32_t sl = f->get_32();
 		CharString cs;
@@ -191,11 +383,17 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files)
 		uint64_t size = f->get_64();
 		uint8_t md5[16];
 		f->get_buffer(md5, 16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, p_replace_files);
+		// Files which don't fit in the mapping are read from the pack instead.
+		bool in_mapping = ofs <= mapped_len && size <= mapped_len - ofs;
+		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, p_replace_files, in_mapping ? mapped : nullptr);
 	}
 
-	f->close();
-	memdelete(f);
+	if (mapped) {
+		mapped_packs.push_back(f);
+	} else {
+		f->close();
+		memdelete(f);
+	}
 	return true;
 }
 
@@ -203,6 +401,53 @@ FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFi
 	return memnew(FileAccessPack(p_path, *p_file));
 }
 
+void PackedSourcePCK::get_path_hash(const Vector<uint8_t> &p_md5, uint64_t &r_a, uint64_t &r_b) {
+	r_a = decode_uint64(&p_md5[0]);
+	r_b = decode_uint64(&p_md5[8]);
+}
+
+Error PackedSourcePCK::store_index(FileAccess *p_file, uint64_t p_pack_start, Vector<IndexEntry> &p_entries) {
+	p_entries.sort();
+
+	uint64_t index_pos = p_file->get_position();
+	p_file->store_32(p_entries.size());
+	p_file->store_32(0); // Keeps entries 8 byte aligned.
+	for (int i = 0; i < p_entries.size(); i++) {
+		const IndexEntry &e = p_entries[i];
+		p_file->store_64(e.hash_a);
+		p_file->store_64(e.hash_b);
+		p_file->store_64(e.offset);
+		p_file->store_64(e.size);
+		p_file->store_64(e.record);
+	}
+
+	uint64_t end = p_file->get_position();
+	p_file->seek(p_pack_start + PACK_INDEX_OFFSET_POS);
+	p_file->store_64(index_pos - p_pack_start);
+	p_file->seek(end);
+
+	return p_file->get_error();
+}
+
+Error PackedSourcePCK::store_dictionary(FileAccess *p_file, uint64_t p_pack_start, const Vector<uint8_t> &p_dict) {
+	uint64_t dict_pos = p_file->get_position();
+	p_file->store_32(p_dict.size());
+	p_file->store_buffer(p_dict.ptr(), p_dict.size());
+
+	uint64_t end = p_file->get_position();
+	p_file->seek(p_pack_start + PACK_DICT_OFFSET_POS);
+	p_file->store_64(dict_pos - p_pack_start);
+	p_file->seek(end);
+
+	return p_file->get_error();
+}
+
+PackedSourcePCK::~PackedSourcePCK() {
+	for (int i = 0; i < mapped_packs.size(); i++) {
+		memdelete(mapped_packs[i]);
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -211,11 +456,17 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 }
 
 void FileAccessPack::close() {
-	f->close();
+	if (f) {
+		f->close();
+	}
+	data = nullptr;
 }
 
 bool FileAccessPack::is_open() const {
-	return f->is_open();
+	if (f) {
+		return f->is_open();
+	}
+	return data != nullptr;
 }
 
 void FileAccessPack::seek(size_t p_position) {
@@ -225,7 +476,9 @@ void FileAccessPack::seek(size_t p_position) {
 		eof = false;
 	}
 
-	f->seek(pf.offset + p_position);
+	if (f) {
+		f->seek(pf.offset + p_position);
+	}
 	pos = p_position;
 }
 
@@ -251,6 +504,10 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (data) {
+		return data[pos++];
+	}
+
 	pos++;
 	return f->get_8();
 }
@@ -271,14 +528,30 @@ int FileAccessPack::get_buffer(uint8_t *p_dst, int p_length) const {
 	if (to_read <= 0) {
 		return 0;
 	}
-	f->get_buffer(p_dst, to_read);
+	if (data) {
+		copymem(p_dst, data + pos - p_length, to_read);
+	} else {
+		f->get_buffer(p_dst, to_read);
+	}
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_buffer_span(uint64_t p_length) const {
+	if (!data || eof || pos + p_length > pf.size) {
+		return nullptr;
+	}
+
+	const uint8_t *span = data + pos;
+	pos += p_length;
+	return span;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
-	f->set_endian_swap(p_swap);
+	if (f) {
+		f->set_endian_swap(p_swap);
+	}
 }
 
 Error FileAccessPack::get_error() const {
@@ -305,13 +578,19 @@ bool FileAccessPack::file_exists(const String &p_name) {
 }
 
 FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
-		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
+		pf(p_file) {
+	pos = 0;
+	eof = false;
+
+	if (pf.mapped) {
+		data = pf.mapped + pf.offset;
+		return;
+	}
+
+	f = FileAccess::open(pf.pack, FileAccess::READ);
 	ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + String(pf.pack) + "'.");
 
 	f->seek(pf.offset);
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
@@ -400,7 +679,7 @@ Error DirAccessPack::change_dir(String p_dir) {
 	PackedData::PackedDir *pd;
 
 	if (absolute) {
-		pd = PackedData::get_singleton()->root;
+		pd = PackedData::get_singleton()->_get_root();
 	} else {
 		pd = current;
 	}
@@ -471,5 +750,5 @@ String DirAccessPack::get_filesystem_type() const {
 }
 
 DirAccessPack::DirAccessPack() {
-	current = PackedData::get_singleton()->root;
+	current = PackedData::get_singleton()->_get_root();
 }
@@ -32,15 +32,24 @@
 #define FILE_ACCESS_PACK_H
 
 #include "core/list.h"
+#include "core/local_vector.h"
 #include "core/map.h"
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/os/mutex.h"
 #include "core/print_string.h"
 
 // Godot's packed file magic header ("GDPC" in ASCII).
 #define PACK_HEADER_MAGIC 0x43504447
 // The current packed file format version number.
 #define PACK_FORMAT_VERSION 1
+// Packs may also store a path index after the file data (see PackedSourcePCK::IndexEntry),
+// its offset from the start of the pack goes in the first two reserved header fields.
+#define PACK_INDEX_OFFSET_POS 20
+#define PACK_INDEX_ENTRY_SIZE 40
+// The next two hold the offset of an optional Zstandard dictionary (32 bit size followed
+// by its bytes), added to Compression on mount for the MODE_ZSTD_DICT files in the pack.
+#define PACK_DICT_OFFSET_POS 28
 
 class PackSource;
 
@@ -56,6 +65,8 @@ public:
 		uint64_t size;
 		uint8_t md5[16];
 		PackSource *src;
+		const uint8_t *mapped = nullptr; // Whole pack in memory if it could be mapped, offset is from here.
+		int priority = 0; // Decides between packs having the same path, see _get_priority().
 	};
 
 private:
@@ -89,24 +100,53 @@ private:
 		}
 	};
 
+	// Files of a pack mounted from its index, looked up without a node per file.
+	struct PackIndex {
+		String pack;
+		PackSource *src = nullptr;
+		const uint8_t *entries = nullptr; // Sorted by path hash.
+		uint32_t count = 0;
+		Vector<uint8_t> buffer; // Holds the entries if the pack isn't mapped.
+		const uint8_t *mapped = nullptr;
+		int priority = 0;
+		bool dirs_added = false;
+	};
+
 	Map<PathMD5, PackedFile> files;
+	LocalVector<PackIndex *> indices; // Highest priority first.
 
 	Vector<PackSource *> sources;
 
 	PackedDir *root;
+	bool dirs_pending = false; // Indexed packs whose paths aren't in the tree yet.
+	Mutex dirs_mutex;
+	int pack_count = 0;
 
 	static PackedData *singleton;
 	bool disabled = false;
+	bool use_mmap = true;
 
 	void _free_packed_dirs(PackedDir *p_dir);
+	void _add_to_dirs(const String &p_path);
+	PackedDir *_get_root();
+	_FORCE_INLINE_ int _get_priority(bool p_replace_files) const {
+		// Replacing packs win over everything added before them, others only over what's added after.
+		return p_replace_files ? (1 << 30) + pack_count : -pack_count;
+	}
+	const PackIndex *_find_in_indices(const Vector<uint8_t> &p_md5, int p_min_priority, PackedFile &r_file) const;
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files); // for PackSource
+	void add_path(const String &pkg_path, const String &path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, const uint8_t *p_mapped = nullptr); // for PackSource
+	void add_index(const String &p_pack, PackSource *p_src, const uint8_t *p_entries, uint32_t p_count, const Vector<uint8_t> &p_buffer, const uint8_t *p_mapped, bool p_replace_files); // for PackSource
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
 
+	// Affects packs added afterwards.
+	void set_use_mmap(bool p_enable) { use_mmap = p_enable; }
+	_FORCE_INLINE_ bool is_using_mmap() const { return use_mmap; }
+
 	static PackedData *get_singleton() { return singleton; }
 	Error add_pack(const String &p_path, bool p_replace_files);
 
@@ -125,9 +165,31 @@ public:
 };
 
 class PackedSourcePCK : public PackSource {
+	Vector<FileAccess *> mapped_packs; // Kept open while their contents are mapped.
+
 public:
+	// Path index entry, stored little endian and sorted by hash. Offsets are
+	// from the start of the file containing the pack, as in the file table.
+	struct IndexEntry {
+		uint64_t hash_a = 0; // MD5 of the path.
+		uint64_t hash_b = 0;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t record = 0; // Where the file table entry (path, offset, size, MD5) starts.
+
+		bool operator<(const IndexEntry &p_entry) const {
+			return hash_a == p_entry.hash_a ? hash_b < p_entry.hash_b : hash_a < p_entry.hash_a;
+		}
+	};
+
+	static void get_path_hash(const Vector<uint8_t> &p_md5, uint64_t &r_a, uint64_t &r_b);
+	static Error store_index(FileAccess *p_file, uint64_t p_pack_start, Vector<IndexEntry> &p_entries);
+	static Error store_dictionary(FileAccess *p_file, uint64_t p_pack_start, const Vector<uint8_t> &p_dict);
+
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -136,7 +198,8 @@ class FileAccessPack : public FileAccess {
 	mutable size_t pos;
 	mutable bool eof;
 
-	FileAccess *f;
+	FileAccess *f = nullptr;
+	const uint8_t *data = nullptr; // Used instead of f when the pack is mapped.
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 	virtual uint32_t _get_unix_permissions(const String &p_file) { return 0; }
@@ -156,6 +219,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_buffer_span(uint64_t p_length) const;
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -173,8 +237,17 @@ public:
 };
 
 FileAccess *PackedData::try_open_path(const String &p_path) {
-	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
+	Vector<uint8_t> md5 = p_path.md5_buffer();
+	Map<PathMD5, PackedFile>::Element *E = files.find(PathMD5(md5));
+
+	if (indices.size()) {
+		PackedFile pf;
+		const PackIndex *index = _find_in_indices(md5, E ? E->get().priority : INT32_MIN, pf);
+		if (index) {
+			return index->src->get_file(p_path, &pf);
+		}
+	}
+
 	if (!E) {
 		return nullptr; //not found
 	}
@@ -186,7 +259,12 @@ FileAccess *PackedData::try_open_path(const String &p_path) {
 }
 
 bool PackedData::has_path(const String &p_path) {
-	return files.has(PathMD5(p_path.md5_buffer()));
+	Vector<uint8_t> md5 = p_path.md5_buffer();
+	if (files.has(PathMD5(md5))) {
+		return true;
+	}
+	PackedFile pf;
+	return indices.size() && _find_in_indices(md5, INT32_MIN, pf);
 }
 
 class DirAccessPack : public DirAccess {
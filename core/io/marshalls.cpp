@@ -60,6 +60,22 @@ ObjectID EncodedObjectAsID::get_object_id() const {
 #define ENCODE_FLAG_64 1 << 16
 #define ENCODE_FLAG_OBJECT_AS_ID 1 << 16
 
+// Copies p_count values of p_size bytes between memory and their little endian encoding.
+// Memory is never read as anything but bytes here, so neither side needs to be aligned.
+static _FORCE_INLINE_ void _copy_le(void *p_dst, const void *p_src, int p_count, int p_size) {
+#ifdef BIG_ENDIAN_ENABLED
+	uint8_t *dst = (uint8_t *)p_dst;
+	const uint8_t *src = (const uint8_t *)p_src;
+	for (int i = 0; i < p_count; i++) {
+		for (int j = 0; j < p_size; j++) {
+			dst[i * p_size + j] = src[i * p_size + p_size - 1 - j];
+		}
+	}
+#else
+	copymem(p_dst, p_src, p_count * p_size);
+#endif
+}
+
 static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r_string) {
 	ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
 
@@ -562,16 +578,18 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 				(*r_len) += 4;
 			}
 
+			// Every element takes at least 4 bytes, so this bounds the resize below.
+			ERR_FAIL_COND_V(count > len / 4, ERR_INVALID_DATA);
+
 			Array varr;
+			varr.resize(count);
 
 			for (int i = 0; i < count; i++) {
 				int used = 0;
-				Variant v;
-				Error err = decode_variant(v, buf, len, &used, p_allow_objects);
+				Error err = decode_variant(varr[i], buf, len, &used, p_allow_objects);
 				ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
 				buf += used;
 				len -= used;
-				varr.push_back(v);
 				if (r_len) {
 					(*r_len) += used;
 				}
@@ -593,10 +611,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
 			if (count) {
 				data.resize(count);
-				uint8_t *w = data.ptrw();
-				for (int32_t i = 0; i < count; i++) {
-					w[i] = buf[i];
-				}
+				copymem(data.ptrw(), buf, count);
 			}
 
 			r_variant = data;
@@ -620,12 +635,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 			Vector<int32_t> data;
 
 			if (count) {
-				//const int*rbuf=(const int*)buf;
 				data.resize(count);
-				int32_t *w = data.ptrw();
-				for (int32_t i = 0; i < count; i++) {
-					w[i] = decode_uint32(&buf[i * 4]);
-				}
+				_copy_le(data.ptrw(), buf, count, 4);
 			}
 			r_variant = Variant(data);
 			if (r_len) {
@@ -635,7 +646,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 		} break;
 		case Variant::PACKED_INT64_ARRAY: {
 			ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
-			int64_t count = decode_uint64(buf);
+			int32_t count = decode_uint32(buf);
 			buf += 4;
 			len -= 4;
 			ERR_FAIL_MUL_OF(count, 8, ERR_INVALID_DATA);
@@ -644,12 +655,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 			Vector<int64_t> data;
 
 			if (count) {
-				//const int*rbuf=(const int*)buf;
 				data.resize(count);
-				int64_t *w = data.ptrw();
-				for (int64_t i = 0; i < count; i++) {
-					w[i] = decode_uint64(&buf[i * 8]);
-				}
+				_copy_le(data.ptrw(), buf, count, 8);
 			}
 			r_variant = Variant(data);
 			if (r_len) {
@@ -668,12 +675,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 			Vector<float> data;
 
 			if (count) {
-				//const float*rbuf=(const float*)buf;
 				data.resize(count);
-				float *w = data.ptrw();
-				for (int32_t i = 0; i < count; i++) {
-					w[i] = decode_float(&buf[i * 4]);
-				}
+				_copy_le(data.ptrw(), buf, count, 4);
 			}
 			r_variant = data;
 
@@ -684,7 +687,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 		} break;
 		case Variant::PACKED_FLOAT64_ARRAY: {
 			ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
-			int64_t count = decode_uint64(buf);
+			int32_t count = decode_uint32(buf);
 			buf += 4;
 			len -= 4;
 			ERR_FAIL_MUL_OF(count, 8, ERR_INVALID_DATA);
@@ -693,12 +696,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 			Vector<double> data;
 
 			if (count) {
-				//const double*rbuf=(const double*)buf;
 				data.resize(count);
-				double *w = data.ptrw();
-				for (int64_t i = 0; i < count; i++) {
-					w[i] = decode_double(&buf[i * 8]);
-				}
+				_copy_le(data.ptrw(), buf, count, 8);
 			}
 			r_variant = data;
 
@@ -749,12 +748,16 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
 			if (count) {
 				varray.resize(count);
+#ifdef REAL_T_IS_DOUBLE
 				Vector2 *w = varray.ptrw();
 
 				for (int32_t i = 0; i < count; i++) {
 					w[i].x = decode_float(buf + i * 4 * 2 + 4 * 0);
 					w[i].y = decode_float(buf + i * 4 * 2 + 4 * 1);
 				}
+#else
+				_copy_le(varray.ptrw(), buf, count * 2, 4);
+#endif
 
 				int adv = 4 * 2 * count;
 
@@ -783,6 +786,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
 			if (count) {
 				varray.resize(count);
+#ifdef REAL_T_IS_DOUBLE
 				Vector3 *w = varray.ptrw();
 
 				for (int32_t i = 0; i < count; i++) {
@@ -790,6 +794,9 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 					w[i].y = decode_float(buf + i * 4 * 3 + 4 * 1);
 					w[i].z = decode_float(buf + i * 4 * 3 + 4 * 2);
 				}
+#else
+				_copy_le(varray.ptrw(), buf, count * 3, 4);
+#endif
 
 				int adv = 4 * 3 * count;
 
@@ -818,14 +825,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
 			if (count) {
 				carray.resize(count);
-				Color *w = carray.ptrw();
-
-				for (int32_t i = 0; i < count; i++) {
-					w[i].r = decode_float(buf + i * 4 * 4 + 4 * 0);
-					w[i].g = decode_float(buf + i * 4 * 4 + 4 * 1);
-					w[i].b = decode_float(buf + i * 4 * 4 + 4 * 2);
-					w[i].a = decode_float(buf + i * 4 * 4 + 4 * 3);
-				}
+				_copy_le(carray.ptrw(), buf, count * 4, 4);
 
 				int adv = 4 * 4 * count;
 
@@ -996,7 +996,9 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 					encode_uint32(utf8.length(), buf);
 					buf += 4;
 					copymem(buf, utf8.get_data(), utf8.length());
-					buf += pad + utf8.length();
+					buf += utf8.length();
+					zeromem(buf, pad);
+					buf += pad;
 				}
 
 				r_len += 4 + utf8.length() + pad;
@@ -1353,7 +1355,7 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 			int datasize = sizeof(int64_t);
 
 			if (buf) {
-				encode_uint64(datalen, buf);
+				encode_uint32(datalen, buf);
 				buf += 4;
 				const int64_t *r = data.ptr();
 				for (int64_t i = 0; i < datalen; i++) {
@@ -1511,3 +1513,238 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
 	return OK;
 }
+
+// Largest encoding of a type whose size doesn't depend on its value (TRANSFORM).
+#define ENCODE_MAX_FIXED_SIZE (4 + 12 * 4)
+
+#define ENCODER_GROW(m_ptr, m_bytes) \
+	uint8_t *m_ptr = _grow(m_bytes); \
+	if (unlikely(!m_ptr)) {          \
+		return ERR_OUT_OF_MEMORY;    \
+	}
+
+Error VariantEncoder::_encode_string(const String &p_string, bool p_terminate) {
+	CharString utf8 = p_string.utf8();
+	int len = utf8.length() + (p_terminate ? 1 : 0);
+	int pad = (4 - len % 4) % 4;
+
+	ENCODER_GROW(w, 4 + len + pad);
+	encode_uint32(len, w);
+	copymem(w + 4, utf8.get_data(), len);
+	zeromem(w + 4 + len, pad);
+	return OK;
+}
+
+Error VariantEncoder::_encode(const Variant &p_variant, bool p_full_objects) {
+	Variant::Type type = p_variant.get_type();
+
+	switch (type) {
+		case Variant::STRING:
+		case Variant::STRING_NAME: {
+			ENCODER_GROW(w, 4);
+			encode_uint32(type, w);
+			Error err = _encode_string(p_variant);
+			if (err) {
+				return err;
+			}
+
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary d = p_variant;
+
+			ENCODER_GROW(w, 8);
+			encode_uint32(type, w);
+			encode_uint32(uint32_t(d.size()), w + 4);
+
+			// Walks the dictionary in place, without copying keys and values to arrays.
+			const Variant *key = nullptr;
+			while ((key = d.next(key))) {
+				Error err = _encode(*key, p_full_objects);
+				if (err) {
+					return err;
+				}
+				err = _encode(*d.getptr(*key), p_full_objects);
+				if (err) {
+					return err;
+				}
+			}
+
+		} break;
+		case Variant::ARRAY: {
+			Array a = p_variant;
+
+			ENCODER_GROW(w, 8);
+			encode_uint32(type, w);
+			encode_uint32(uint32_t(a.size()), w + 4);
+
+			for (int i = 0; i < a.size(); i++) {
+				Error err = _encode(a[i], p_full_objects);
+				if (err) {
+					return err;
+				}
+			}
+
+		} break;
+		case Variant::PACKED_BYTE_ARRAY: {
+			Vector<uint8_t> data = p_variant;
+			int len = data.size();
+			int pad = (4 - len % 4) % 4;
+
+			ENCODER_GROW(w, 8 + len + pad);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			copymem(w + 8, data.ptr(), len);
+			zeromem(w + 8 + len, pad);
+
+		} break;
+		case Variant::PACKED_INT32_ARRAY: {
+			Vector<int32_t> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 4);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			_copy_le(w + 8, data.ptr(), len, 4);
+
+		} break;
+		case Variant::PACKED_INT64_ARRAY: {
+			Vector<int64_t> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 8);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			_copy_le(w + 8, data.ptr(), len, 8);
+
+		} break;
+		case Variant::PACKED_FLOAT32_ARRAY: {
+			Vector<float> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 4);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			_copy_le(w + 8, data.ptr(), len, 4);
+
+		} break;
+		case Variant::PACKED_FLOAT64_ARRAY: {
+			Vector<double> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 8);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			_copy_le(w + 8, data.ptr(), len, 8);
+
+		} break;
+		case Variant::PACKED_STRING_ARRAY: {
+			Vector<String> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+
+			const String *r = data.ptr();
+			for (int i = 0; i < len; i++) {
+				Error err = _encode_string(r[i], true);
+				if (err) {
+					return err;
+				}
+			}
+
+		} break;
+		case Variant::PACKED_VECTOR2_ARRAY: {
+			Vector<Vector2> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 4 * 2);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+#ifdef REAL_T_IS_DOUBLE
+			const Vector2 *r = data.ptr();
+			for (int i = 0; i < len; i++) {
+				encode_float(r[i].x, w + 8 + i * 4 * 2 + 4 * 0);
+				encode_float(r[i].y, w + 8 + i * 4 * 2 + 4 * 1);
+			}
+#else
+			_copy_le(w + 8, data.ptr(), len * 2, 4);
+#endif
+
+		} break;
+		case Variant::PACKED_VECTOR3_ARRAY: {
+			Vector<Vector3> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 4 * 3);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+#ifdef REAL_T_IS_DOUBLE
+			const Vector3 *r = data.ptr();
+			for (int i = 0; i < len; i++) {
+				encode_float(r[i].x, w + 8 + i * 4 * 3 + 4 * 0);
+				encode_float(r[i].y, w + 8 + i * 4 * 3 + 4 * 1);
+				encode_float(r[i].z, w + 8 + i * 4 * 3 + 4 * 2);
+			}
+#else
+			_copy_le(w + 8, data.ptr(), len * 3, 4);
+#endif
+
+		} break;
+		case Variant::PACKED_COLOR_ARRAY: {
+			Vector<Color> data = p_variant;
+			int len = data.size();
+
+			ENCODER_GROW(w, 8 + len * 4 * 4);
+			encode_uint32(type, w);
+			encode_uint32(len, w + 4);
+			_copy_le(w + 8, data.ptr(), len * 4, 4);
+
+		} break;
+		case Variant::NODE_PATH:
+		case Variant::OBJECT: {
+			if (type == Variant::NODE_PATH || p_full_objects) {
+				// Uncommon, and full objects can nest anything, so these are still measured first.
+				int len;
+				Error err = encode_variant(p_variant, nullptr, len, p_full_objects);
+				if (err) {
+					return err;
+				}
+				ENCODER_GROW(w, len);
+				return encode_variant(p_variant, w, len, p_full_objects);
+			}
+			[[fallthrough]];
+		}
+		default: {
+			int len;
+			Error err = encode_variant(p_variant, _reserve(ENCODE_MAX_FIXED_SIZE), len, p_full_objects);
+			if (err) {
+				return err;
+			}
+			if (unlikely(len > max_size - position)) {
+				return ERR_OUT_OF_MEMORY;
+			}
+			position += len;
+		}
+	}
+
+	return OK;
+}
+
+Error VariantEncoder::encode(const Variant &p_variant, bool p_full_objects) {
+	int start = position;
+	Error err = _encode(p_variant, p_full_objects);
+	if (err) {
+		position = start;
+	}
+	return err;
+}
+
+Vector<uint8_t> VariantEncoder::get_data() const {
+	Vector<uint8_t> data;
+	if (position) {
+		data.resize(position);
+		copymem(data.ptrw(), buffer.ptr(), position);
+	}
+	return data;
+}
@@ -183,4 +183,53 @@ public:
 Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false);
 Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects = false);
 
+/**
+  * Single pass variant of encode_variant(), producing the same data.
+  * Values are appended to a buffer that grows as needed instead of being
+  * measured first, and packed arrays are copied in bulk on little endian
+  * hosts. The buffer is kept between clear() calls, so an encoder owned
+  * by a peer stops allocating once it has seen its largest message.
+  */
+class VariantEncoder {
+	Vector<uint8_t> buffer;
+	int position = 0;
+	int max_size = 0x7FFFFFFF;
+
+	_FORCE_INLINE_ uint8_t *_reserve(int p_bytes) {
+		if (unlikely(position + p_bytes > buffer.size())) {
+			buffer.resize(next_power_of_2(position + p_bytes));
+		}
+		return buffer.ptrw() + position;
+	}
+
+	// Returns nullptr instead of growing past max_size.
+	_FORCE_INLINE_ uint8_t *_grow(int p_bytes) {
+		if (unlikely(p_bytes > max_size - position)) {
+			return nullptr;
+		}
+		uint8_t *w = _reserve(p_bytes);
+		position += p_bytes;
+		return w;
+	}
+
+	Error _encode_string(const String &p_string, bool p_terminate = false);
+	Error _encode(const Variant &p_variant, bool p_full_objects);
+
+public:
+	Error encode(const Variant &p_variant, bool p_full_objects = false); ///< appends to the buffer, which is left unchanged on error
+
+	void set_max_size(int p_max_size) { max_size = p_max_size; } ///< encode() fails with ERR_OUT_OF_MEMORY instead of going past it
+	int get_max_size() const { return max_size; }
+
+	const uint8_t *ptr() const { return buffer.ptr(); }
+	int size() const { return position; }
+	Vector<uint8_t> get_data() const;
+
+	void clear() { position = 0; } ///< keeps the allocated buffer
+	void reset() {
+		position = 0;
+		buffer.clear();
+	}
+};
+
 #endif // MARSHALLS_H
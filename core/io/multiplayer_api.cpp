@@ -32,6 +32,8 @@
 
 #include "core/debugger/engine_debugger.h"
 #include "core/io/marshalls.h"
+#include "core/local_vector.h"
+#include "core/os/os.h"
 #include "scene/main/node.h"
 
 #include <stdint.h>
@@ -40,9 +42,8 @@
 #define NAME_ID_COMPRESSION_SHIFT 5
 #define BYTE_ONLY_OR_NO_ARGS_SHIFT 6
 
-#ifdef DEBUG_ENABLED
-#include "core/os/os.h"
-#endif
+// Snapshots kept per peer while waiting for (or resolving) acknowledgements.
+#define REPLICATION_MAX_SNAPSHOTS 32
 
 _FORCE_INLINE_ bool _should_call_local(MultiplayerAPI::RPCMode mode, bool is_master, bool &r_skip_rpc) {
 	switch (mode) {
@@ -136,6 +137,8 @@ void MultiplayerAPI::clear() {
 	path_send_cache.clear();
 	packet_cache.clear();
 	last_send_cache_id = 1;
+	replication_peers.clear();
+	replication_sources.clear();
 }
 
 void MultiplayerAPI::set_root_node(Node *p_node) {
@@ -310,6 +313,14 @@ void MultiplayerAPI::_process_packet(int p_from, const uint8_t *p_packet, int p_
 		case NETWORK_COMMAND_RAW: {
 			_process_raw(p_from, p_packet, p_packet_len);
 		} break;
+
+		case NETWORK_COMMAND_REPLICATE_STATE: {
+			_process_replicate_state(p_from, p_packet, p_packet_len);
+		} break;
+
+		case NETWORK_COMMAND_REPLICATE_ACK: {
+			_process_replicate_ack(p_from, p_packet, p_packet_len);
+		} break;
 	}
 }
 
@@ -748,6 +759,149 @@ Error MultiplayerAPI::_decode_and_decompress_variant(Variant &r_variant, const u
 	return OK;
 }
 
+// Replicated values use the same encoding, except that floats and vectors with
+// a quantization step are sent as one zigzag varint per component, counting
+// steps. Those set the otherwise unused bool bit in the meta byte.
+#define VARIANT_META_QUANTIZED_MASK 0x80
+
+static _FORCE_INLINE_ int _encode_varint(uint64_t p_value, uint8_t *p_buffer) {
+	int len = 1;
+	while (p_value >= 0x80) {
+		if (p_buffer) {
+			*(p_buffer++) = (p_value & 0x7F) | 0x80;
+		}
+		p_value >>= 7;
+		len++;
+	}
+	if (p_buffer) {
+		*p_buffer = p_value;
+	}
+	return len;
+}
+
+// Returns the bytes used, or 0 if the buffer ends before the value does.
+static _FORCE_INLINE_ int _decode_varint(const uint8_t *p_buffer, int p_len, uint64_t &r_value) {
+	r_value = 0;
+	for (int i = 0; i < p_len && i < 10; i++) {
+		r_value |= uint64_t(p_buffer[i] & 0x7F) << (7 * i);
+		if (!(p_buffer[i] & 0x80)) {
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+static _FORCE_INLINE_ int64_t _quantize(real_t p_value, real_t p_step) {
+	return (int64_t)Math::round(p_value / p_step);
+}
+
+static _FORCE_INLINE_ real_t _dequantize(int64_t p_steps, real_t p_step) {
+	return p_steps * p_step;
+}
+
+static _FORCE_INLINE_ int _quantized_components(Variant::Type p_type) {
+	switch (p_type) {
+		case Variant::FLOAT:
+			return 1;
+		case Variant::VECTOR2:
+			return 2;
+		case Variant::VECTOR3:
+			return 3;
+		default:
+			return 0;
+	}
+}
+
+// Rounds a value the way the receiving side will see it, so the sender's
+// baselines match the receiver's exactly.
+static Variant _quantize_value(const Variant &p_value, real_t p_step) {
+	if (p_step <= 0) {
+		return p_value;
+	}
+	switch (p_value.get_type()) {
+		case Variant::FLOAT: {
+			return _dequantize(_quantize(p_value, p_step), p_step);
+		}
+		case Variant::VECTOR2: {
+			Vector2 v = p_value;
+			return Vector2(_dequantize(_quantize(v.x, p_step), p_step), _dequantize(_quantize(v.y, p_step), p_step));
+		}
+		case Variant::VECTOR3: {
+			Vector3 v = p_value;
+			return Vector3(_dequantize(_quantize(v.x, p_step), p_step), _dequantize(_quantize(v.y, p_step), p_step), _dequantize(_quantize(v.z, p_step), p_step));
+		}
+		default: {
+			return p_value;
+		}
+	}
+}
+
+Error MultiplayerAPI::_encode_replicated_value(const Variant &p_variant, real_t p_quantization, uint8_t *r_buffer, int &r_len) {
+	int components = p_quantization > 0 ? _quantized_components(p_variant.get_type()) : 0;
+	if (!components) {
+		return _encode_and_compress_variant(p_variant, r_buffer, r_len);
+	}
+
+	real_t values[3];
+	if (components == 1) {
+		values[0] = p_variant;
+	} else if (components == 2) {
+		Vector2 v = p_variant;
+		values[0] = v.x;
+		values[1] = v.y;
+	} else {
+		Vector3 v = p_variant;
+		values[0] = v.x;
+		values[1] = v.y;
+		values[2] = v.z;
+	}
+
+	if (r_buffer) {
+		r_buffer[0] = p_variant.get_type() | VARIANT_META_QUANTIZED_MASK;
+	}
+	r_len = 1;
+	for (int i = 0; i < components; i++) {
+		int64_t steps = _quantize(values[i], p_quantization);
+		uint64_t zigzag = (uint64_t(steps) << 1) ^ uint64_t(steps >> 63);
+		r_len += _encode_varint(zigzag, r_buffer ? r_buffer + r_len : nullptr);
+	}
+
+	return OK;
+}
+
+Error MultiplayerAPI::_decode_replicated_value(Variant &r_variant, real_t p_quantization, const uint8_t *p_buffer, int p_len, int *r_len) {
+	ERR_FAIL_COND_V(p_len < 1, ERR_INVALID_DATA);
+	Variant::Type type = Variant::Type(p_buffer[0] & VARIANT_META_TYPE_MASK);
+	int components = _quantized_components(type);
+	if (!components || !(p_buffer[0] & VARIANT_META_QUANTIZED_MASK)) {
+		return _decode_and_decompress_variant(r_variant, p_buffer, p_len, r_len);
+	}
+	ERR_FAIL_COND_V_MSG(p_quantization <= 0, ERR_INVALID_DATA, "Received a quantized value for a property without quantization. Both sides must use the same replication settings.");
+
+	real_t values[3];
+	int ofs = 1;
+	for (int i = 0; i < components; i++) {
+		uint64_t zigzag;
+		int used = _decode_varint(p_buffer + ofs, p_len - ofs, zigzag);
+		ERR_FAIL_COND_V(!used, ERR_INVALID_DATA);
+		ofs += used;
+		values[i] = _dequantize(int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1), p_quantization);
+	}
+
+	if (components == 1) {
+		r_variant = values[0];
+	} else if (components == 2) {
+		r_variant = Vector2(values[0], values[1]);
+	} else {
+		r_variant = Vector3(values[0], values[1], values[2]);
+	}
+	if (r_len) {
+		*r_len = ofs;
+	}
+
+	return OK;
+}
+
 void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount) {
 	ERR_FAIL_COND_MSG(network_peer.is_null(), "Attempt to remote call/set when networking is not active in SceneTree.");
 
@@ -986,6 +1140,8 @@ void MultiplayerAPI::_del_peer(int p_id) {
 		PathSentCache *psc = path_send_cache.getptr(E->get());
 		psc->confirmed_peers.erase(p_id);
 	}
+	replication_peers.erase(p_id);
+	replication_sources.erase(p_id);
 	emit_signal("network_peer_disconnected", p_id);
 }
 
@@ -1160,6 +1316,448 @@ void MultiplayerAPI::_process_raw(int p_from, const uint8_t *p_packet, int p_pac
 	emit_signal("network_peer_packet", p_from, out);
 }
 
+void MultiplayerAPI::replicate_node(Node *p_node, const PackedStringArray &p_properties) {
+	ERR_FAIL_NULL(p_node);
+	ERR_FAIL_COND_MSG(p_properties.empty(), "Trying to replicate a node without properties.");
+
+	ReplicatedNode replicated;
+	replicated.fields.resize(p_properties.size());
+	for (int i = 0; i < p_properties.size(); i++) {
+		replicated.fields.write[i].property = p_properties[i];
+	}
+	replicated_nodes[p_node->get_instance_id()] = replicated;
+}
+
+void MultiplayerAPI::stop_replicating_node(Node *p_node) {
+	ERR_FAIL_NULL(p_node);
+	replicated_nodes.erase(p_node->get_instance_id());
+}
+
+bool MultiplayerAPI::is_node_replicated(Node *p_node) const {
+	ERR_FAIL_NULL_V(p_node, false);
+	return replicated_nodes.has(p_node->get_instance_id());
+}
+
+void MultiplayerAPI::set_replication_quantization(Node *p_node, const StringName &p_property, real_t p_step) {
+	ERR_FAIL_NULL(p_node);
+	ERR_FAIL_COND_MSG(p_step < 0, "Quantization step can't be negative.");
+	ReplicatedNode *replicated = replicated_nodes.getptr(p_node->get_instance_id());
+	ERR_FAIL_COND_MSG(!replicated, "Node " + String(p_node->get_name()) + " is not replicated.");
+
+	for (int i = 0; i < replicated->fields.size(); i++) {
+		if (replicated->fields[i].property == p_property) {
+			replicated->fields.write[i].quantization = p_step;
+			return;
+		}
+	}
+	ERR_FAIL_MSG("Property '" + String(p_property) + "' is not replicated for node " + String(p_node->get_name()) + ".");
+}
+
+void MultiplayerAPI::send_replication_snapshot() {
+	ERR_FAIL_COND_MSG(!network_peer.is_valid(), "Trying to replicate state while no network peer is active.");
+	ERR_FAIL_COND_MSG(network_peer->get_connection_status() != NetworkedMultiplayerPeer::CONNECTION_CONNECTED, "Trying to replicate state via a network peer which is not connected.");
+	ERR_FAIL_COND_MSG(root_node == nullptr, "Multiplayer root node was not initialized. If you are using custom multiplayer, remember to set the root node via MultiplayerAPI.set_root_node before using it.");
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	int unique_id = network_peer->get_unique_id();
+
+	// Read the nodes we are the master of once, however many peers they go to.
+	struct Source {
+		PathSentCache *psc = nullptr;
+		const ReplicatedNode *replicated = nullptr;
+		Vector<Variant> values;
+	};
+	LocalVector<Source> sources;
+	List<ObjectID> freed;
+
+	const ObjectID *K = nullptr;
+	while ((K = replicated_nodes.next(K))) {
+		Node *node = Object::cast_to<Node>(ObjectDB::get_instance(*K));
+		if (!node) {
+			freed.push_back(*K);
+			continue;
+		}
+		if (node->get_network_master() != unique_id || !node->is_inside_tree()) {
+			continue;
+		}
+
+		NodePath path = (root_node->get_path()).rel_path_to(node->get_path());
+		PathSentCache *psc = path_send_cache.getptr(path);
+		if (!psc) {
+			path_send_cache[path] = PathSentCache();
+			psc = path_send_cache.getptr(path);
+			psc->id = last_send_cache_id++;
+		}
+		// Tells peers which don't know the path yet about it, they get the node once they confirm.
+		_send_confirm_path(node, path, psc, NetworkedMultiplayerPeer::TARGET_PEER_BROADCAST);
+
+		Source source;
+		source.psc = psc;
+		source.replicated = replicated_nodes.getptr(*K);
+		const Vector<ReplicatedField> &fields = source.replicated->fields;
+		source.values.resize(fields.size());
+		Variant *w = source.values.ptrw();
+		for (int i = 0; i < fields.size(); i++) {
+			w[i] = _quantize_value(node->get(fields[i].property), fields[i].quantization);
+		}
+		sources.push_back(source);
+	}
+
+	for (List<ObjectID>::Element *E = freed.front(); E; E = E->next()) {
+		replicated_nodes.erase(E->get());
+	}
+
+	if (sources.empty()) {
+		return;
+	}
+
+	uint32_t snapshot_id = ++last_snapshot_id;
+	network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+	LocalVector<uint32_t> sent;
+
+	// Packet layout: command, snapshot id and the id of the baseline it is a delta
+	// against (0 for none), then for each node its path cache id, the size of the
+	// rest, the field count, a bitmask of the fields which changed and their values.
+	for (Set<int>::Element *E = connected_peers.front(); E; E = E->next()) {
+		int peer = E->get();
+		ReplicationPeer &rp = replication_peers[peer];
+
+		MAKE_ROOM(9);
+		packet_cache.write[0] = NETWORK_COMMAND_REPLICATE_STATE;
+		encode_uint32(snapshot_id, &packet_cache.write[1]);
+		encode_uint32(rp.acked, &packet_cache.write[5]);
+		int ofs = 9;
+		sent.clear();
+
+		for (uint32_t i = 0; i < sources.size(); i++) {
+			const Source &source = sources[i];
+			Map<int, bool>::Element *F = source.psc->confirmed_peers.find(peer);
+			if (!F || !F->get()) {
+				continue; // The peer can't resolve this node yet.
+			}
+
+			const Vector<ReplicatedField> &fields = source.replicated->fields;
+			const Vector<Variant> &values = source.values;
+			const Vector<Variant> *base = rp.baseline.getptr(source.psc->id);
+			if (base && base->size() != values.size()) {
+				base = nullptr; // Registered again with other properties, send everything.
+			}
+
+			int node_ofs = ofs;
+			int mask_len = (values.size() + 7) / 8;
+			MAKE_ROOM(ofs + 5 + 2 + 5 + mask_len);
+			ofs += _encode_varint(source.psc->id, &packet_cache.write[ofs]);
+			int size_ofs = ofs;
+			ofs += 2;
+			int payload_ofs = ofs;
+			ofs += _encode_varint(values.size(), &packet_cache.write[ofs]);
+			int mask_ofs = ofs;
+			zeromem(&packet_cache.write[mask_ofs], mask_len);
+			ofs += mask_len;
+
+			int changed = 0;
+			Error err = OK;
+			for (int j = 0; j < values.size(); j++) {
+				if (base && (*base)[j] == values[j]) {
+					continue;
+				}
+				int len;
+				err = _encode_replicated_value(values[j], fields[j].quantization, nullptr, len);
+				if (err != OK) {
+					break;
+				}
+				MAKE_ROOM(ofs + len);
+				_encode_replicated_value(values[j], fields[j].quantization, &packet_cache.write[ofs], len);
+				ofs += len;
+				packet_cache.write[mask_ofs + j / 8] |= 1 << (j % 8);
+				changed++;
+			}
+
+			if (err != OK || ofs - payload_ofs > UINT16_MAX) {
+				ofs = node_ofs;
+				ERR_PRINT(err != OK ? "Unable to encode replicated value." : "Replicated state of a single node can't exceed 64 KiB.");
+				continue;
+			}
+
+			replication_stats.fields_sent += changed;
+			replication_stats.fields_unchanged += values.size() - changed;
+			if (!changed) {
+				ofs = node_ofs;
+				continue;
+			}
+
+			encode_uint16(ofs - payload_ofs, &packet_cache.write[size_ofs]);
+			sent.push_back(i);
+		}
+
+		if (sent.empty()) {
+			continue; // Nothing changed since the last snapshot the peer acknowledged.
+		}
+
+		// Only what changed is kept, it's applied to the baseline when acknowledged.
+		ReplicationDelta &delta = rp.pending[snapshot_id];
+		delta.baseline = rp.acked;
+		for (uint32_t i = 0; i < sent.size(); i++) {
+			delta.nodes[sources[sent[i]].psc->id] = sources[sent[i]].values;
+		}
+		if (rp.pending.size() > REPLICATION_MAX_SNAPSHOTS) {
+			rp.pending.erase(rp.pending.front());
+		}
+
+#ifdef DEBUG_ENABLED
+		_profile_bandwidth_data("out", ofs);
+#endif
+
+		network_peer->set_target_peer(peer);
+		network_peer->put_packet(packet_cache.ptr(), ofs);
+
+		replication_stats.snapshots_sent++;
+		replication_stats.bytes_sent += ofs;
+	}
+
+	replication_stats.encode_usec += OS::get_singleton()->get_ticks_usec() - start;
+}
+
+void MultiplayerAPI::_send_replicate_ack(int p_to, uint32_t p_snapshot_id, const Vector<uint32_t> &p_reset) {
+	// Packet layout: command, snapshot id, then the path cache ids of the nodes
+	// which were skipped, for the sender to drop from its baseline.
+	MAKE_ROOM(5 + p_reset.size() * 5);
+	packet_cache.write[0] = NETWORK_COMMAND_REPLICATE_ACK;
+	encode_uint32(p_snapshot_id, &packet_cache.write[1]);
+	int ofs = 5;
+	for (int i = 0; i < p_reset.size(); i++) {
+		ofs += _encode_varint(p_reset[i], &packet_cache.write[ofs]);
+	}
+
+	network_peer->set_transfer_mode(NetworkedMultiplayerPeer::TRANSFER_MODE_UNRELIABLE);
+	network_peer->set_target_peer(p_to);
+	network_peer->put_packet(packet_cache.ptr(), ofs);
+}
+
+// Decodes the whole state of a node before anything is applied. Returns the
+// node, or null if the state can't be applied and the node must be reset.
+Node *MultiplayerAPI::_decode_replicated_node(int p_from, PathGetCache &r_cache, uint32_t p_id, const uint8_t *p_payload, int p_payload_len, const Vector<Variant> *p_base, Vector<Variant> &r_values) {
+	Map<int, PathGetCache::NodeInfo>::Element *F = r_cache.nodes.find(p_id);
+	ERR_FAIL_COND_V_MSG(!F, nullptr, "Invalid packet received. Unable to find requested cached node.");
+
+	PathGetCache::NodeInfo *ni = &F->get();
+	Node *node = Object::cast_to<Node>(ObjectDB::get_instance(ni->instance));
+	if (!node) {
+		node = root_node->get_node_or_null(ni->path);
+		ERR_FAIL_COND_V_MSG(!node, nullptr, "Failed to get cached path from replicated state: " + String(ni->path) + ".");
+		ni->instance = node->get_instance_id();
+	}
+	ERR_FAIL_COND_V_MSG(node->get_network_master() != p_from, nullptr, "Replicated state for node " + String(ni->path) + " is only accepted from its network master, not from: " + itos(p_from) + ".");
+
+	const ReplicatedNode *replicated = replicated_nodes.getptr(node->get_instance_id());
+	if (!replicated) {
+		return nullptr; // Not replicated on this side.
+	}
+	const Vector<ReplicatedField> &fields = replicated->fields;
+
+	uint64_t field_count;
+	int pofs = _decode_varint(p_payload, p_payload_len, field_count);
+	ERR_FAIL_COND_V_MSG(!pofs || field_count != (uint64_t)fields.size(), nullptr, "Replicated state for node " + String(ni->path) + " doesn't have the properties registered here.");
+	int mask_len = (fields.size() + 7) / 8;
+	ERR_FAIL_COND_V_MSG(pofs + mask_len > p_payload_len, nullptr, "Invalid packet received. Size too small.");
+	const uint8_t *mask = p_payload + pofs;
+	pofs += mask_len;
+
+	if (p_base && p_base->size() == fields.size()) {
+		r_values = *p_base;
+	} else {
+		// Nothing to apply a delta to, only full state can be used.
+		for (int i = 0; i < fields.size(); i++) {
+			if (!(mask[i / 8] & (1 << (i % 8)))) {
+				return nullptr;
+			}
+		}
+		r_values.resize(fields.size());
+	}
+
+	Variant *w = r_values.ptrw();
+	for (int i = 0; i < fields.size(); i++) {
+		if (!(mask[i / 8] & (1 << (i % 8)))) {
+			continue;
+		}
+		int vlen;
+		Error err = _decode_replicated_value(w[i], fields[i].quantization, p_payload + pofs, p_payload_len - pofs, &vlen);
+		ERR_FAIL_COND_V_MSG(err != OK, nullptr, "Invalid packet received. Unable to decode replicated value.");
+		pofs += vlen;
+	}
+
+	return node;
+}
+
+// Brings the receiving side's baseline to the snapshot the sender now makes deltas against,
+// merging the received deltas it acknowledged in between. Fails if one of them is gone.
+bool MultiplayerAPI::_advance_replication_baseline(ReplicationSource &r_source, uint32_t p_baseline_id) {
+	if (p_baseline_id == r_source.baseline_id) {
+		return true;
+	}
+	if (p_baseline_id == 0) {
+		// The sender started over with full state.
+		r_source.baseline_id = 0;
+		r_source.baseline.clear();
+		return true;
+	}
+
+	Map<uint32_t, ReplicationDelta>::Element *D = r_source.received.find(p_baseline_id);
+	if (!D || !_advance_replication_baseline(r_source, D->get().baseline)) {
+		return false;
+	}
+
+	const ReplicationSnapshot &nodes = D->get().nodes;
+	const uint32_t *K = nullptr;
+	while ((K = nodes.next(K))) {
+		r_source.baseline[*K] = nodes[*K];
+	}
+	for (int i = 0; i < D->get().reset.size(); i++) {
+		r_source.baseline.erase(D->get().reset[i]);
+	}
+	r_source.baseline_id = p_baseline_id;
+
+	// The sender only moves its baseline forward, so older deltas and ones against
+	// an older baseline are never used again.
+	Map<uint32_t, ReplicationDelta>::Element *E = r_source.received.front();
+	while (E) {
+		Map<uint32_t, ReplicationDelta>::Element *N = E->next();
+		if (E->key() <= p_baseline_id || E->get().baseline < p_baseline_id) {
+			r_source.received.erase(E);
+		}
+		E = N;
+	}
+	return true;
+}
+
+void MultiplayerAPI::_process_replicate_state(int p_from, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < 9, "Invalid packet received. Size too small.");
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	uint32_t snapshot_id = decode_uint32(p_packet + 1);
+	uint32_t baseline_id = decode_uint32(p_packet + 5);
+
+	ReplicationSource &source = replication_sources[p_from];
+	if (snapshot_id <= source.last_applied) {
+		return; // Late or duplicated, newer state was already applied.
+	}
+
+	if (!_advance_replication_baseline(source, baseline_id)) {
+		// We no longer have what this is a delta against, ask for everything again.
+		_send_replicate_ack(p_from, 0);
+		return;
+	}
+
+	ReplicationDelta delta;
+	delta.baseline = baseline_id;
+
+	Map<int, PathGetCache>::Element *C = path_get_cache.find(p_from);
+	ERR_FAIL_COND_MSG(!C, "Invalid packet received. Requests invalid peer cache.");
+
+	int ofs = 9;
+	while (ofs < p_packet_len) {
+		uint64_t id;
+		int used = _decode_varint(p_packet + ofs, p_packet_len - ofs, id);
+		ERR_FAIL_COND_MSG(!used || ofs + used + 2 > p_packet_len, "Invalid packet received. Size too small.");
+		ofs += used;
+		int payload_len = decode_uint16(p_packet + ofs);
+		ofs += 2;
+		ERR_FAIL_COND_MSG(ofs + payload_len > p_packet_len, "Invalid packet received. Size smaller than declared.");
+		const uint8_t *payload = p_packet + ofs;
+		ofs += payload_len;
+
+		Vector<Variant> values;
+		Node *node = _decode_replicated_node(p_from, C->get(), id, payload, payload_len, source.baseline.getptr(id), values);
+		if (!node) {
+			// Left out of the baseline on both sides, so the sender sends it in full next.
+			delta.reset.push_back(id);
+			continue;
+		}
+
+		// Copied, setters can run scripts that replicate more nodes and move the map's storage.
+		Vector<ReplicatedField> fields = replicated_nodes.getptr(node->get_instance_id())->fields;
+		for (int i = 0; i < fields.size(); i++) {
+			node->set(fields[i].property, values[i]);
+		}
+		delta.nodes[id] = values;
+	}
+
+	source.received[snapshot_id] = delta;
+	source.last_applied = snapshot_id;
+	while (source.received.size() > REPLICATION_MAX_SNAPSHOTS) {
+		source.received.erase(source.received.front());
+	}
+
+	_send_replicate_ack(p_from, snapshot_id, delta.reset);
+
+	replication_stats.snapshots_received++;
+	replication_stats.bytes_received += p_packet_len;
+	replication_stats.decode_usec += OS::get_singleton()->get_ticks_usec() - start;
+}
+
+void MultiplayerAPI::_process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < 5, "Invalid packet received. Size too small.");
+
+	Map<int, ReplicationPeer>::Element *E = replication_peers.find(p_from);
+	if (!E) {
+		return;
+	}
+	ReplicationPeer &rp = E->get();
+
+	uint32_t snapshot_id = decode_uint32(p_packet + 1);
+	if (snapshot_id == 0) {
+		// The peer lost our baseline, start over with full state.
+		rp.acked = 0;
+		rp.baseline.clear();
+		rp.pending.clear();
+		return;
+	}
+
+	Map<uint32_t, ReplicationDelta>::Element *S = rp.pending.find(snapshot_id);
+	if (snapshot_id <= rp.acked || !S) {
+		return; // Late, or for a snapshot we already gave up on.
+	}
+	if (S->get().baseline != rp.acked) {
+		// Relative to a baseline we already moved past, the peer still has
+		// the current one.
+		rp.pending.erase(S);
+		return;
+	}
+
+	const ReplicationSnapshot &nodes = S->get().nodes;
+	const uint32_t *K = nullptr;
+	while ((K = nodes.next(K))) {
+		rp.baseline[*K] = nodes[*K];
+	}
+
+	int ofs = 5;
+	while (ofs < p_packet_len) {
+		uint64_t id;
+		int used = _decode_varint(p_packet + ofs, p_packet_len - ofs, id);
+		ERR_BREAK_MSG(!used, "Invalid packet received. Size too small.");
+		ofs += used;
+		rp.baseline.erase(id);
+	}
+
+	rp.acked = snapshot_id;
+	while (rp.pending.front() && rp.pending.front()->key() <= snapshot_id) {
+		rp.pending.erase(rp.pending.front());
+	}
+}
+
+Dictionary MultiplayerAPI::get_replication_stats() const {
+	Dictionary stats;
+	stats["snapshots_sent"] = replication_stats.snapshots_sent;
+	stats["snapshots_received"] = replication_stats.snapshots_received;
+	stats["bytes_sent"] = replication_stats.bytes_sent;
+	stats["bytes_received"] = replication_stats.bytes_received;
+	stats["fields_sent"] = replication_stats.fields_sent;
+	stats["fields_unchanged"] = replication_stats.fields_unchanged;
+	stats["encode_usec"] = replication_stats.encode_usec;
+	stats["decode_usec"] = replication_stats.decode_usec;
+	return stats;
+}
+
 int MultiplayerAPI::get_network_unique_id() const {
 	ERR_FAIL_COND_V_MSG(!network_peer.is_valid(), 0, "No network peer is assigned. Unable to get unique network ID.");
 	return network_peer->get_unique_id();
@@ -1217,6 +1815,12 @@ void MultiplayerAPI::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_refusing_new_network_connections"), &MultiplayerAPI::is_refusing_new_network_connections);
 	ClassDB::bind_method(D_METHOD("set_allow_object_decoding", "enable"), &MultiplayerAPI::set_allow_object_decoding);
 	ClassDB::bind_method(D_METHOD("is_object_decoding_allowed"), &MultiplayerAPI::is_object_decoding_allowed);
+	ClassDB::bind_method(D_METHOD("replicate_node", "node", "properties"), &MultiplayerAPI::replicate_node);
+	ClassDB::bind_method(D_METHOD("stop_replicating_node", "node"), &MultiplayerAPI::stop_replicating_node);
+	ClassDB::bind_method(D_METHOD("is_node_replicated", "node"), &MultiplayerAPI::is_node_replicated);
+	ClassDB::bind_method(D_METHOD("set_replication_quantization", "node", "property", "step"), &MultiplayerAPI::set_replication_quantization);
+	ClassDB::bind_method(D_METHOD("send_replication_snapshot"), &MultiplayerAPI::send_replication_snapshot);
+	ClassDB::bind_method(D_METHOD("get_replication_stats"), &MultiplayerAPI::get_replication_stats);
 
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "allow_object_decoding"), "set_allow_object_decoding", "is_object_decoding_allowed");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "refuse_new_network_connections"), "set_refuse_new_network_connections", "is_refusing_new_network_connections");
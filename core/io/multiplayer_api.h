@@ -54,6 +54,54 @@ private:
 		Map<int, NodeInfo> nodes;
 	};
 
+	//state replication
+	struct ReplicatedField {
+		StringName property;
+		real_t quantization = 0; // Step floats and vectors are rounded to, or 0 to send them as is.
+	};
+
+	struct ReplicatedNode {
+		Vector<ReplicatedField> fields;
+	};
+
+	// Field values as the receiving side reconstructs them, by path cache id.
+	typedef HashMap<uint32_t, Vector<Variant>> ReplicationSnapshot;
+
+	// What a snapshot changed, against the baseline it was sent with.
+	struct ReplicationDelta {
+		uint32_t baseline = 0;
+		ReplicationSnapshot nodes;
+		Vector<uint32_t> reset; // Receiving side, nodes that couldn't be applied.
+	};
+
+	// Sending side, one per peer. Deltas are always against the newest
+	// snapshot the peer acknowledged, which it is guaranteed to still have.
+	struct ReplicationPeer {
+		uint32_t acked = 0;
+		ReplicationSnapshot baseline;
+		Map<uint32_t, ReplicationDelta> pending;
+	};
+
+	// Receiving side, one per peer sending us state. Mirrors the sender's
+	// baseline, which received deltas are merged into once the sender uses them.
+	struct ReplicationSource {
+		uint32_t last_applied = 0;
+		uint32_t baseline_id = 0;
+		ReplicationSnapshot baseline;
+		Map<uint32_t, ReplicationDelta> received;
+	};
+
+	struct ReplicationStats {
+		uint64_t snapshots_sent = 0;
+		uint64_t snapshots_received = 0;
+		uint64_t bytes_sent = 0;
+		uint64_t bytes_received = 0;
+		uint64_t fields_sent = 0;
+		uint64_t fields_unchanged = 0;
+		uint64_t encode_usec = 0;
+		uint64_t decode_usec = 0;
+	};
+
 	Ref<NetworkedMultiplayerPeer> network_peer;
 	int rpc_sender_id = 0;
 	Set<int> connected_peers;
@@ -64,6 +112,12 @@ private:
 	Node *root_node = nullptr;
 	bool allow_object_decoding = false;
 
+	HashMap<ObjectID, ReplicatedNode> replicated_nodes;
+	Map<int, ReplicationPeer> replication_peers;
+	Map<int, ReplicationSource> replication_sources;
+	uint32_t last_snapshot_id = 0;
+	ReplicationStats replication_stats;
+
 protected:
 	static void _bind_methods();
 
@@ -74,12 +128,19 @@ protected:
 	void _process_rpc(Node *p_node, const uint16_t p_rpc_method_id, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_rset(Node *p_node, const uint16_t p_rpc_property_id, int p_from, const uint8_t *p_packet, int p_packet_len, int p_offset);
 	void _process_raw(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate_state(int p_from, const uint8_t *p_packet, int p_packet_len);
+	void _process_replicate_ack(int p_from, const uint8_t *p_packet, int p_packet_len);
 
 	void _send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p_set, const StringName &p_name, const Variant **p_arg, int p_argcount);
 	bool _send_confirm_path(Node *p_node, NodePath p_path, PathSentCache *psc, int p_target);
 
 	Error _encode_and_compress_variant(const Variant &p_variant, uint8_t *p_buffer, int &r_len);
 	Error _decode_and_decompress_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len);
+	Error _encode_replicated_value(const Variant &p_variant, real_t p_quantization, uint8_t *r_buffer, int &r_len);
+	Error _decode_replicated_value(Variant &r_variant, real_t p_quantization, const uint8_t *p_buffer, int p_len, int *r_len);
+	Node *_decode_replicated_node(int p_from, PathGetCache &r_cache, uint32_t p_id, const uint8_t *p_payload, int p_payload_len, const Vector<Variant> *p_base, Vector<Variant> &r_values);
+	void _send_replicate_ack(int p_to, uint32_t p_snapshot_id, const Vector<uint32_t> &p_reset = Vector<uint32_t>());
+	bool _advance_replication_baseline(ReplicationSource &r_source, uint32_t p_baseline_id);
 
 public:
 	enum NetworkCommands {
@@ -88,6 +149,8 @@ public:
 		NETWORK_COMMAND_SIMPLIFY_PATH,
 		NETWORK_COMMAND_CONFIRM_PATH,
 		NETWORK_COMMAND_RAW,
+		NETWORK_COMMAND_REPLICATE_STATE,
+		NETWORK_COMMAND_REPLICATE_ACK,
 	};
 
 	enum NetworkNodeIdCompression {
@@ -141,6 +204,14 @@ public:
 	void set_allow_object_decoding(bool p_enable);
 	bool is_object_decoding_allowed() const;
 
+	// State replication, both sides must register the same properties for a node.
+	void replicate_node(Node *p_node, const PackedStringArray &p_properties);
+	void stop_replicating_node(Node *p_node);
+	bool is_node_replicated(Node *p_node) const;
+	void set_replication_quantization(Node *p_node, const StringName &p_property, real_t p_step);
+	void send_replication_snapshot();
+	Dictionary get_replication_stats() const;
+
 	MultiplayerAPI();
 	~MultiplayerAPI();
 };
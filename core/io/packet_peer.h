@@ -31,6 +31,7 @@
 #ifndef PACKET_PEER_H
 #define PACKET_PEER_H
 
+#include "core/io/marshalls.h"
 #include "core/io/stream_peer.h"
 #include "core/object.h"
 #include "core/ring_buffer.h"
@@ -49,7 +50,7 @@ class PacketPeer : public Reference {
 	mutable Error last_get_error = OK;
 
 	int encode_buffer_max_size = 8 * 1024 * 1024;
-	Vector<uint8_t> encode_buffer;
+	VariantEncoder encoder;
 
 public:
 	virtual int get_available_packet_count() const = 0;
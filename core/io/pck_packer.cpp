@@ -30,7 +30,7 @@
 
 #include "pck_packer.h"
 
-#include "core/io/file_access_pack.h" // PACK_HEADER_MAGIC, PACK_FORMAT_VERSION
+#include "core/io/file_access_pack.h" // PACK_HEADER_MAGIC, PACK_FORMAT_VERSION, PackedSourcePCK
 #include "core/os/file_access.h"
 #include "core/version.h"
 
@@ -56,6 +56,7 @@ static void _pad(FileAccess *p_file, int p_bytes) {
 void PCKPacker::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("pck_start", "pck_name", "alignment"), &PCKPacker::pck_start, DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("add_file", "pck_path", "source_path"), &PCKPacker::add_file);
+	ClassDB::bind_method(D_METHOD("set_zstd_dictionary", "dictionary"), &PCKPacker::set_zstd_dictionary);
 	ClassDB::bind_method(D_METHOD("flush", "verbose"), &PCKPacker::flush, DEFVAL(false));
 }
 
@@ -96,6 +97,8 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src) {
 	pf.src_path = p_src;
 	pf.size = f->get_len();
 	pf.offset_offset = 0;
+	pf.offset = 0;
+	pf.record = 0;
 
 	files.push_back(pf);
 
@@ -105,6 +108,10 @@ Error PCKPacker::add_file(const String &p_file, const String &p_src) {
 	return OK;
 }
 
+void PCKPacker::set_zstd_dictionary(const Vector<uint8_t> &p_dict) {
+	zstd_dictionary = p_dict;
+}
+
 Error PCKPacker::flush(bool p_verbose) {
 	ERR_FAIL_COND_V_MSG(!file, ERR_INVALID_PARAMETER, "File must be opened before use.");
 
@@ -113,6 +120,7 @@ Error PCKPacker::flush(bool p_verbose) {
 	file->store_32(files.size());
 
 	for (int i = 0; i < files.size(); i++) {
+		files.write[i].record = file->get_position();
 		file->store_pascal_string(files[i].path);
 		files.write[i].offset_offset = file->get_position();
 		file->store_64(0); // offset
@@ -147,6 +155,7 @@ Error PCKPacker::flush(bool p_verbose) {
 		file->seek(files[i].offset_offset); // go back to store the file's offset
 		file->store_64(ofs);
 		file->seek(pos);
+		files.write[i].offset = ofs;
 
 		ofs = _align(ofs + files[i].size, alignment);
 		_pad(file, ofs - pos);
@@ -166,6 +175,20 @@ Error PCKPacker::flush(bool p_verbose) {
 		printf("\n");
 	}
 
+	Vector<PackedSourcePCK::IndexEntry> index;
+	index.resize(files.size());
+	for (int i = 0; i < files.size(); i++) {
+		PackedSourcePCK::IndexEntry &e = index.write[i];
+		PackedSourcePCK::get_path_hash(files[i].path.md5_buffer(), e.hash_a, e.hash_b);
+		e.offset = files[i].offset;
+		e.size = files[i].size;
+		e.record = files[i].record;
+	}
+	PackedSourcePCK::store_index(file, 0, index);
+	if (zstd_dictionary.size()) {
+		PackedSourcePCK::store_dictionary(file, 0, zstd_dictionary);
+	}
+
 	file->close();
 	memdelete_arr(buf);
 
@@ -48,12 +48,16 @@ class PCKPacker : public Reference {
 		String src_path;
 		int size;
 		uint64_t offset_offset;
+		uint64_t offset;
+		uint64_t record;
 	};
 	Vector<File> files;
+	Vector<uint8_t> zstd_dictionary;
 
 public:
 	Error pck_start(const String &p_file, int p_alignment = 0);
 	Error add_file(const String &p_file, const String &p_src);
+	void set_zstd_dictionary(const Vector<uint8_t> &p_dict);
 	Error flush(bool p_verbose = false);
 
 	PCKPacker() {}
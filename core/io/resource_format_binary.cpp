@@ -106,14 +106,19 @@ StringName ResourceLoaderBinary::_get_string() {
 	uint32_t id = f->get_32();
 	if (id & 0x80000000) {
 		uint32_t len = id & 0x7FFFFFFF;
-		if ((int)len > str_buf.size()) {
-			str_buf.resize(len);
-		}
 		if (len == 0) {
 			return StringName();
 		}
-		f->get_buffer((uint8_t *)&str_buf[0], len);
 		String s;
+		const uint8_t *span = f->get_buffer_span(len);
+		if (span) {
+			s.parse_utf8((const char *)span, len);
+			return s;
+		}
+		if ((int)len > str_buf.size()) {
+			str_buf.resize(len);
+		}
+		f->get_buffer((uint8_t *)&str_buf[0], len);
 		s.parse_utf8(&str_buf[0]);
 		return s;
 	}
@@ -360,20 +365,11 @@ Error ResourceLoaderBinary::parse_variant(Variant &r_v) {
 						WARN_PRINT("Broken external resource! (index out of size)");
 						r_v = Variant();
 					} else {
-						if (external_resources[erindex].cache.is_null()) {
-							//cache not here yet, wait for it?
-							if (use_sub_threads) {
-								Error err;
-								external_resources.write[erindex].cache = ResourceLoader::load_threaded_get(external_resources[erindex].path, &err);
-
-								if (err != OK || external_resources[erindex].cache.is_null()) {
-									if (!ResourceLoader::get_abort_on_missing_resources()) {
-										ResourceLoader::notify_dependency_error(local_path, external_resources[erindex].path, external_resources[erindex].type);
-									} else {
-										error = ERR_FILE_MISSING_DEPENDENCIES;
-										ERR_FAIL_V_MSG(error, "Can't load dependency: " + external_resources[erindex].path + ".");
-									}
-								}
+						if (external_resources[erindex].requested) {
+							//cache not here yet, wait for it
+							Error err = _get_external_resource(erindex);
+							if (err != OK) {
+								return err;
 							}
 						}
 
@@ -613,6 +609,63 @@ Ref<Resource> ResourceLoaderBinary::get_resource() {
 	return resource;
 }
 
+void ResourceLoaderBinary::_request_external_resource(int p_index) {
+	ExtResource &er = external_resources.write[p_index];
+	if (ResourceCache::has(er.path)) {
+		er.cache = ResourceLoader::load(er.path, er.type); // Not worth a thread.
+		if (er.cache.is_valid()) {
+			return;
+		}
+	}
+
+	Error err;
+	if (use_sub_threads) {
+		err = ResourceLoader::load_threaded_request(er.path, er.type, true, local_path);
+	} else {
+		err = ResourceLoader::load_dependency_request(er.path, er.type, local_path);
+	}
+	// A cyclic dependency is left to load(), which returns it as is, like when not using threads.
+	er.requested = err == OK;
+	if (err != OK && err != ERR_CYCLIC_LINK && use_sub_threads) {
+		if (!ResourceLoader::get_abort_on_missing_resources()) {
+			ResourceLoader::notify_dependency_error(local_path, er.path, er.type);
+		} else {
+			error = ERR_FILE_MISSING_DEPENDENCIES;
+		}
+	}
+}
+
+Error ResourceLoaderBinary::_get_external_resource(int p_index) {
+	ExtResource &er = external_resources.write[p_index];
+	if (er.requested) {
+		er.requested = false;
+		er.cache = ResourceLoader::load_threaded_get(er.path);
+	} else if (!use_sub_threads && er.cache.is_null()) {
+		er.cache = ResourceLoader::load(er.path, er.type);
+	}
+
+	if (error == OK && er.cache.is_null()) {
+		if (!ResourceLoader::get_abort_on_missing_resources()) {
+			ResourceLoader::notify_dependency_error(local_path, er.path, er.type);
+		} else {
+			error = ERR_FILE_MISSING_DEPENDENCIES;
+		}
+	}
+	// Pending requests are released by the destructor.
+	ERR_FAIL_COND_V_MSG(error != OK, error, "Can't load dependency: " + er.path + ".");
+	return OK;
+}
+
+void ResourceLoaderBinary::_release_external_resources() {
+	// Every request must be matched by a get, or its task is never freed.
+	for (int i = 0; i < external_resources.size(); i++) {
+		if (external_resources[i].requested) {
+			external_resources.write[i].requested = false;
+			ResourceLoader::load_threaded_get(external_resources[i].path);
+		}
+	}
+}
+
 Error ResourceLoaderBinary::load() {
 	if (error != OK) {
 		return error;
@@ -633,28 +686,24 @@ Error ResourceLoaderBinary::load() {
 		}
 
 		external_resources.write[i].path = path; //remap happens here, not on load because on load it can actually be used for filesystem dock resource remap
+	}
 
-		if (!use_sub_threads) {
-			external_resources.write[i].cache = ResourceLoader::load(path, external_resources[i].type);
-
-			if (external_resources[i].cache.is_null()) {
-				if (!ResourceLoader::get_abort_on_missing_resources()) {
-					ResourceLoader::notify_dependency_error(local_path, path, external_resources[i].type);
-				} else {
-					error = ERR_FILE_MISSING_DEPENDENCIES;
-					ERR_FAIL_V_MSG(error, "Can't load dependency: " + path + ".");
-				}
-			}
+	// Without sub threads, dependencies may still load in parallel a few at a time, in the order they are needed.
+	int parallel = (use_sub_threads || use_nocache) ? 0 : ResourceLoader::get_parallel_dependency_loads(local_path);
+	int requested = 0;
 
+	for (int i = 0; i < external_resources.size(); i++) {
+		if (use_sub_threads) {
+			//fetched from the thread when first used
+			_request_external_resource(i);
+			ERR_FAIL_COND_V_MSG(error != OK, error, "Can't load dependency: " + external_resources[i].path + ".");
 		} else {
-			Error err = ResourceLoader::load_threaded_request(path, external_resources[i].type, use_sub_threads, local_path);
+			for (; requested < MIN(i + parallel, external_resources.size()); requested++) {
+				_request_external_resource(requested);
+			}
+			Error err = _get_external_resource(i);
 			if (err != OK) {
-				if (!ResourceLoader::get_abort_on_missing_resources()) {
-					ResourceLoader::notify_dependency_error(local_path, path, external_resources[i].type);
-				} else {
-					error = ERR_FILE_MISSING_DEPENDENCIES;
-					ERR_FAIL_V_MSG(error, "Can't load dependency: " + path + ".");
-				}
+				return err;
 			}
 		}
 
@@ -788,14 +837,19 @@ static String get_ustring(FileAccess *f) {
 
 String ResourceLoaderBinary::get_unicode_string() {
 	int len = f->get_32();
+	if (len <= 0) {
+		return String();
+	}
+	String s;
+	const uint8_t *span = f->get_buffer_span(len);
+	if (span) {
+		s.parse_utf8((const char *)span, len);
+		return s;
+	}
 	if (len > str_buf.size()) {
 		str_buf.resize(len);
 	}
-	if (len == 0) {
-		return String();
-	}
 	f->get_buffer((uint8_t *)&str_buf[0], len);
-	String s;
 	s.parse_utf8(&str_buf[0]);
 	return s;
 }
@@ -957,6 +1011,7 @@ String ResourceLoaderBinary::recognize(FileAccess *p_f) {
 }
 
 ResourceLoaderBinary::~ResourceLoaderBinary() {
+	_release_external_resources();
 	if (f) {
 		memdelete(f);
 	}
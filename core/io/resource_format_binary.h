@@ -58,6 +58,7 @@ class ResourceLoaderBinary {
 		String path;
 		String type;
 		RES cache;
+		bool requested = false; // Loading in a thread, waiting for load_threaded_get().
 	};
 
 	bool use_sub_threads = false;
@@ -83,6 +84,9 @@ class ResourceLoaderBinary {
 	friend class ResourceFormatLoaderBinary;
 
 	Error parse_variant(Variant &r_v);
+	void _request_external_resource(int p_index);
+	Error _get_external_resource(int p_index);
+	void _release_external_resources();
 
 	Map<String, RES> dependency_cache;
 
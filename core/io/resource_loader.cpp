@@ -35,6 +35,7 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 #include "core/translation.h"
 #include "core/variant_parser.h"
 
@@ -266,7 +267,22 @@ void ResourceLoader::_thread_load_function(void *p_userdata) {
 	thread_load_mutex->unlock();
 }
 
+void ResourceLoader::ThreadLoadWork::load(ThreadLoadTask *p_load_task) {
+	_thread_load_function(p_load_task);
+}
+
 Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, const String &p_source_resource) {
+	return _load_threaded_request(p_path, p_type_hint, p_use_sub_threads, p_source_resource, false);
+}
+
+Error ResourceLoader::load_dependency_request(const String &p_path, const String &p_type_hint, const String &p_source_resource) {
+	if (!ThreadWorkPool::get_singleton()) {
+		return ERR_UNAVAILABLE;
+	}
+	return _load_threaded_request(p_path, p_type_hint, false, p_source_resource, true);
+}
+
+Error ResourceLoader::_load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, const String &p_source_resource, bool p_use_work_pool) {
 	String local_path;
 	if (p_path.is_rel_path()) {
 		local_path = "res://" + p_path;
@@ -293,6 +309,11 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 			thread_load_mutex->unlock();
 			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Thread loading source resource '" + p_source_resource + "' already is loading '" + local_path + "'.");
 		}
+		//must not depend on the source, or both would wait for each other
+		if (local_path == p_source_resource || _depends_on(local_path, p_source_resource)) {
+			thread_load_mutex->unlock();
+			return ERR_CYCLIC_LINK;
+		}
 	}
 
 	if (thread_load_tasks.has(local_path)) {
@@ -321,26 +342,11 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 				thread_load_mutex->unlock();
 				ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Attempted to load a resource already being loaded from this thread, cyclic reference?");
 			}
-			//lock first if possible
-			if (ResourceCache::lock) {
-				ResourceCache::lock->read_lock();
-			}
-
-			//get ptr
-			Resource **rptr = ResourceCache::resources.getptr(local_path);
-
-			if (rptr) {
-				RES res(*rptr);
-				//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
-				if (res.is_valid()) {
-					//referencing is fine
-					load_task.resource = res;
-					load_task.status = THREAD_LOAD_LOADED;
-					load_task.progress = 1.0;
-				}
-			}
-			if (ResourceCache::lock) {
-				ResourceCache::lock->read_unlock();
+			RES res = ResourceCache::get_ref(local_path);
+			if (res.is_valid()) {
+				load_task.resource = res;
+				load_task.status = THREAD_LOAD_LOADED;
+				load_task.progress = 1.0;
 			}
 		}
 
@@ -353,7 +359,10 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
-	if (load_task.resource.is_null()) { //needs  to be loaded in thread
+	if (load_task.resource.is_null() && p_use_work_pool) {
+		// The pool bounds how many load at once, and waiting on it runs queued loads instead of blocking.
+		load_task.pool_task = ThreadWorkPool::get_singleton()->add_task(&thread_load_work, &ThreadLoadWork::load, &load_task);
+	} else if (load_task.resource.is_null()) { //needs  to be loaded in thread
 
 		load_task.semaphore = memnew(Semaphore);
 		if (thread_loading_count < thread_load_max) {
@@ -396,6 +405,32 @@ float ResourceLoader::_dependency_get_progress(const String &p_path) {
 	}
 }
 
+bool ResourceLoader::_depends_on(const String &p_path, const String &p_dependency) {
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_path);
+	if (!load_task) {
+		return false;
+	}
+	for (Set<String>::Element *E = load_task->sub_tasks.front(); E; E = E->next()) {
+		if (E->get() == p_dependency || _depends_on(E->get(), p_dependency)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int ResourceLoader::get_parallel_dependency_loads(const String &p_source) {
+	if (!parallel_dependency_loads || !ThreadWorkPool::get_singleton()) {
+		return 0;
+	}
+
+	thread_load_mutex->lock();
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(p_source);
+	bool loading = load_task && load_task->loader_id == Thread::get_caller_id();
+	thread_load_mutex->unlock();
+
+	return loading ? MAX(1u, ThreadWorkPool::get_singleton()->get_thread_count()) : 0;
+}
+
 ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
 	String local_path;
 	if (p_path.is_rel_path()) {
@@ -440,6 +475,14 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
+	if (load_task.pool_task != ThreadWorkPool::INVALID_TASK_ID) {
+		// Loading in the work pool, help with queued work until it's done.
+		ThreadWorkPool::TaskID pool_task = load_task.pool_task;
+		thread_load_mutex->unlock();
+		ThreadWorkPool::get_singleton()->wait_until_completed(pool_task);
+		thread_load_mutex->lock();
+	}
+
 	//semaphore still exists, meaning its still loading, request poll
 	Semaphore *semaphore = load_task.semaphore;
 	if (semaphore) {
@@ -495,6 +538,9 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 			Thread::wait_to_finish(load_task.thread);
 			memdelete(load_task.thread);
 		}
+		if (load_task.pool_task != ThreadWorkPool::INVALID_TASK_ID) {
+			ThreadWorkPool::get_singleton()->wait_for_task_completion(load_task.pool_task); // Completed, this releases it.
+		}
 		thread_load_tasks.erase(local_path);
 	}
 
@@ -534,32 +580,15 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, bool p
 		}
 
 		//Is it cached?
-		if (ResourceCache::lock) {
-			ResourceCache::lock->read_lock();
-		}
-
-		Resource **rptr = ResourceCache::resources.getptr(local_path);
-
-		if (rptr) {
-			RES res(*rptr);
-
-			//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
-			if (res.is_valid()) {
-				if (ResourceCache::lock) {
-					ResourceCache::lock->read_unlock();
-				}
-				thread_load_mutex->unlock();
-
-				if (r_error) {
-					*r_error = OK;
-				}
+		RES res = ResourceCache::get_ref(local_path);
+		if (res.is_valid()) {
+			thread_load_mutex->unlock();
 
-				return res; //use cached
+			if (r_error) {
+				*r_error = OK;
 			}
-		}
 
-		if (ResourceCache::lock) {
-			ResourceCache::lock->read_unlock();
+			return res; //use cached
 		}
 
 		//load using task (but this thread)
@@ -1130,6 +1159,8 @@ int ResourceLoader::thread_loading_count = 0;
 int ResourceLoader::thread_waiting_count = 0;
 int ResourceLoader::thread_suspended_count = 0;
 int ResourceLoader::thread_load_max = 0;
+bool ResourceLoader::parallel_dependency_loads = false;
+ResourceLoader::ThreadLoadWork ResourceLoader::thread_load_work;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
 HashMap<String, Vector<String>> ResourceLoader::translation_remaps;
@@ -107,6 +107,7 @@ private:
 
 	struct ThreadLoadTask {
 		Thread *thread = nullptr;
+		int64_t pool_task = -1; // ThreadWorkPool::TaskID, used instead of thread for dependency loads.
 		Thread::ID loader_id = 0;
 		Semaphore *semaphore = nullptr;
 		String local_path;
@@ -125,6 +126,14 @@ private:
 	};
 
 	static void _thread_load_function(void *p_userdata);
+	static Error _load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, const String &p_source_resource, bool p_use_work_pool);
+
+	// ThreadWorkPool runs methods, this runs _thread_load_function() for it.
+	struct ThreadLoadWork {
+		void load(ThreadLoadTask *p_load_task);
+	};
+	static ThreadLoadWork thread_load_work;
+
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
 	static Semaphore *thread_load_semaphore;
@@ -132,8 +141,10 @@ private:
 	static int thread_loading_count;
 	static int thread_suspended_count;
 	static int thread_load_max;
+	static bool parallel_dependency_loads;
 
 	static float _dependency_get_progress(const String &p_path);
+	static bool _depends_on(const String &p_path, const String &p_dependency);
 
 public:
 	static Error load_threaded_request(const String &p_path, const String &p_type_hint = "", bool p_use_sub_threads = false, const String &p_source_resource = String());
@@ -177,6 +188,14 @@ public:
 		dep_err_notify_ud = p_ud;
 	}
 
+	// Loaders can request the dependencies of a resource being loaded with load() in threads, as
+	// load_threaded_request() does with sub threads. Returns how many may be loading at once, or
+	// 0 if p_source isn't loaded by ResourceLoader on this thread.
+	static int get_parallel_dependency_loads(const String &p_source);
+	// Like load_threaded_request(), but loads in the ThreadWorkPool instead of a thread of its own.
+	static Error load_dependency_request(const String &p_path, const String &p_type_hint, const String &p_source_resource);
+	static void set_parallel_dependency_loads(bool p_enabled) { parallel_dependency_loads = p_enabled; }
+
 	static void set_abort_on_missing_resources(bool p_abort) { abort_on_missing_resource = p_abort; }
 	static bool get_abort_on_missing_resources() { return abort_on_missing_resource; }
 
@@ -31,6 +31,7 @@
 #include "message_queue.h"
 
 #include "core/core_string_names.h"
+#include "core/engine.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 
@@ -40,6 +41,64 @@ MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
+uint8_t *MessageQueue::_alloc_message(uint32_t p_room) {
+	Page *page = &pages[write_page];
+
+	if (page->end + p_room > page->size) {
+		// Move on to the next page, adding one if needed.
+		write_page++;
+		if (write_page == pages.size()) {
+			pages.push_back(Page());
+		}
+		page = &pages[write_page];
+
+		if (page->size < p_room) {
+			if (page->data) {
+				memdelete_arr(page->data);
+			}
+			page->size = MAX(page_size, p_room);
+			page->data = memnew_arr(uint8_t, page->size);
+		}
+	}
+
+	uint8_t *ptr = &page->data[page->end];
+	page->end += p_room;
+	return ptr;
+}
+
+uint32_t MessageQueue::_hash_message(const Callable &p_callable, int p_type, int p_extra, const Variant **p_args, int p_argcount) {
+	uint32_t hash = p_callable.hash();
+	hash = hash_djb2_one_32(p_type, hash);
+	hash = hash_djb2_one_32(p_extra, hash);
+	for (int i = 0; i < p_argcount; i++) {
+		hash = hash_djb2_one_32(p_args[i]->hash(), hash);
+	}
+	return hash;
+}
+
+bool MessageQueue::_is_pending(uint32_t p_hash, const Callable &p_callable, int p_type, int p_extra, const Variant **p_args, int p_argcount) {
+	Message **E = pending.getptr(p_hash);
+	if (!E) {
+		return false;
+	}
+
+	const Message *message = *E;
+	if (message->type != p_type || message->args != p_extra || message->callable != p_callable) {
+		return false;
+	}
+
+	if ((p_type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		const Variant *args = (const Variant *)(message + 1);
+		for (int i = 0; i < p_argcount; i++) {
+			if (!args[i].hash_compare(*p_args[i])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
 	return push_callable(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
 }
@@ -62,29 +121,33 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 	_THREAD_SAFE_METHOD_
 
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id)) {
-			type = ObjectDB::get_instance(p_id)->get_class();
+	Callable callable(p_id, p_prop);
+	uint32_t hash = 0;
+	if (coalesce) {
+		const Variant *argptr = &p_value;
+		hash = _hash_message(callable, TYPE_SET, 1, &argptr, 1);
+		if (_is_pending(hash, callable, TYPE_SET, 1, &argptr, 1)) {
+			frame_coalesced++;
+			return OK;
 		}
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant);
+	uint8_t *ptr = _alloc_message(room_needed);
+
+	Message *msg = memnew_placement(ptr, Message);
 	msg->args = 1;
-	msg->callable = Callable(p_id, p_prop);
+	msg->callable = callable;
 	msg->type = TYPE_SET;
+	msg->hash = hash;
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
+	Variant *v = memnew_placement(ptr + sizeof(Message), Variant);
 	*v = p_value;
 
+	if (coalesce) {
+		pending.set(hash, msg);
+	}
+
 	return OK;
 }
 
@@ -93,22 +156,27 @@ Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
-
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+	Callable callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
+	uint32_t hash = 0;
+	if (coalesce) {
+		hash = _hash_message(callable, TYPE_NOTIFICATION, p_notification, nullptr, 0);
+		if (_is_pending(hash, callable, TYPE_NOTIFICATION, p_notification, nullptr, 0)) {
+			frame_coalesced++;
+			return OK;
+		}
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(_alloc_message(sizeof(Message)), Message);
 
 	msg->type = TYPE_NOTIFICATION;
-	msg->callable = Callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
+	msg->callable = callable;
 	//msg->target;
 	msg->notification = p_notification;
+	msg->hash = hash;
 
-	buffer_end += sizeof(Message);
+	if (coalesce) {
+		pending.set(hash, msg);
+	}
 
 	return OK;
 }
@@ -128,30 +196,39 @@ Error MessageQueue::push_set(Object *p_object, const StringName &p_prop, const V
 Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error) {
 	_THREAD_SAFE_METHOD_
 
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	int16_t type = TYPE_CALL;
+	if (p_show_error) {
+		type |= FLAG_SHOW_ERROR;
+	}
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed method: " + p_callable);
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+	uint32_t hash = 0;
+	if (coalesce) {
+		hash = _hash_message(p_callable, type, p_argcount, p_args, p_argcount);
+		if (_is_pending(hash, p_callable, type, p_argcount, p_args, p_argcount)) {
+			frame_coalesced++;
+			return OK;
+		}
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	uint8_t *ptr = _alloc_message(room_needed);
+
+	Message *msg = memnew_placement(ptr, Message);
 	msg->args = p_argcount;
 	msg->callable = p_callable;
-	msg->type = TYPE_CALL;
-	if (p_show_error) {
-		msg->type |= FLAG_SHOW_ERROR;
-	}
-
-	buffer_end += sizeof(Message);
+	msg->type = type;
+	msg->hash = hash;
 
+	Variant *args = (Variant *)(ptr + sizeof(Message));
 	for (int i = 0; i < p_argcount; i++) {
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
+		Variant *v = memnew_placement(&args[i], Variant);
 		*v = *p_args[i];
 	}
 
+	if (coalesce) {
+		pending.set(hash, msg);
+	}
+
 	return OK;
 }
 
@@ -175,56 +252,62 @@ void MessageQueue::statistics() {
 	Map<int, int> notify_count;
 	Map<Callable, int> call_count;
 	int null_count = 0;
+	uint32_t total_bytes = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	for (uint32_t i = 0; i <= write_page; i++) {
+		const Page &page = pages[i];
+		total_bytes += page.end;
 
-		Object *target = message->callable.get_object();
+		uint32_t read_pos = 0;
+		while (read_pos < page.end) {
+			Message *message = (Message *)&page.data[read_pos];
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					if (!call_count.has(message->callable)) {
-						call_count[message->callable] = 0;
-					}
+			Object *target = message->callable.get_object();
 
-					call_count[message->callable]++;
+			if (target != nullptr) {
+				switch (message->type & FLAG_MASK) {
+					case TYPE_CALL: {
+						if (!call_count.has(message->callable)) {
+							call_count[message->callable] = 0;
+						}
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					if (!notify_count.has(message->notification)) {
-						notify_count[message->notification] = 0;
-					}
+						call_count[message->callable]++;
 
-					notify_count[message->notification]++;
+					} break;
+					case TYPE_NOTIFICATION: {
+						if (!notify_count.has(message->notification)) {
+							notify_count[message->notification] = 0;
+						}
 
-				} break;
-				case TYPE_SET: {
-					StringName t = message->callable.get_method();
-					if (!set_count.has(t)) {
-						set_count[t] = 0;
-					}
+						notify_count[message->notification]++;
 
-					set_count[t]++;
+					} break;
+					case TYPE_SET: {
+						StringName t = message->callable.get_method();
+						if (!set_count.has(t)) {
+							set_count[t] = 0;
+						}
 
-				} break;
-			}
+						set_count[t]++;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+					} break;
+				}
 
-			null_count++;
-		}
+			} else {
+				//object was deleted
+				print_line("Object was deleted while awaiting a callback");
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+				null_count++;
+			}
+
+			read_pos += sizeof(Message);
+			if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+				read_pos += sizeof(Variant) * message->args;
+			}
 		}
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	print_line("TOTAL BYTES: " + itos(total_bytes));
 	print_line("NULL count: " + itos(null_count));
 
 	for (Map<StringName, int>::Element *E = set_count.front(); E; E = E->next()) {
@@ -244,7 +327,15 @@ int MessageQueue::get_max_buffer_usage() const {
 	return buffer_max_used;
 }
 
-void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error) {
+int MessageQueue::get_frame_message_count() const {
+	return last_frame_messages;
+}
+
+int MessageQueue::get_frame_coalesced_count() const {
+	return last_frame_coalesced;
+}
+
+void MessageQueue::_call_function(const Callable &p_callable, Object *p_target, const Variant *p_args, int p_argcount, bool p_show_error) {
 	const Variant **argptrs = nullptr;
 	if (p_argcount) {
 		argptrs = (const Variant **)alloca(sizeof(Variant *) * p_argcount);
@@ -254,20 +345,30 @@ void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_a
 	}
 
 	Callable::CallError ce;
-	Variant ret;
-	p_callable.call(argptrs, p_argcount, ret, ce);
+	if (p_callable.is_standard()) {
+		// The target was just looked up, no need for Callable to do it again.
+		p_target->call(p_callable.get_method(), argptrs, p_argcount, ce);
+	} else {
+		Variant ret;
+		p_callable.call(argptrs, p_argcount, ret, ce);
+	}
 	if (p_show_error && ce.error != Callable::CallError::CALL_OK) {
 		ERR_PRINT("Error calling deferred method: " + Variant::get_callable_error_text(p_callable, argptrs, p_argcount, ce) + ".");
 	}
 }
 
-void MessageQueue::flush() {
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
+void MessageQueue::_destroy_message(Message *p_message) {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
 	}
 
-	uint32_t read_pos = 0;
+	p_message->~Message();
+}
 
+void MessageQueue::flush() {
 	//using reverse locking strategy
 	_THREAD_SAFE_LOCK_
 
@@ -277,10 +378,39 @@ void MessageQueue::flush() {
 	}
 	flushing = true;
 
-	while (read_pos < buffer_end) {
+	uint32_t used = 0;
+	for (uint32_t i = 0; i <= write_page; i++) {
+		used += pages[i].end;
+	}
+	if (used > buffer_max_used) {
+		buffer_max_used = used;
+	}
+
+	uint64_t frame = Engine::get_singleton()->get_idle_frames();
+	if (frame != stats_frame) {
+		last_frame_messages = frame_messages;
+		last_frame_coalesced = frame_coalesced;
+		frame_messages = 0;
+		frame_coalesced = 0;
+		stats_frame = frame;
+	}
+
+	uint32_t read_page = 0;
+	uint32_t read_pos = 0;
+
+	while (true) {
 		//lock on each iteration, so a call can re-add itself to the message queue
 
-		Message *message = (Message *)&buffer[read_pos];
+		if (read_pos >= pages[read_page].end) {
+			if (read_page == write_page) {
+				break;
+			}
+			read_page++;
+			read_pos = 0;
+			continue;
+		}
+
+		Message *message = (Message *)&pages[read_page].data[read_pos];
 
 		uint32_t advance = sizeof(Message);
 		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
@@ -290,6 +420,15 @@ void MessageQueue::flush() {
 		//pre-advance so this function is reentrant
 		read_pos += advance;
 
+		if (coalesce) {
+			// From now on, pushing the same message again must queue a new one.
+			Message **E = pending.getptr(message->hash);
+			if (E && *E == message) {
+				pending.erase(message->hash);
+			}
+		}
+		frame_messages++;
+
 		_THREAD_SAFE_UNLOCK_
 
 		Object *target = message->callable.get_object();
@@ -301,7 +440,7 @@ void MessageQueue::flush() {
 
 					// messages don't expect a return value
 
-					_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+					_call_function(message->callable, target, args, message->args, message->type & FLAG_SHOW_ERROR);
 
 				} break;
 				case TYPE_NOTIFICATION: {
@@ -318,19 +457,16 @@ void MessageQueue::flush() {
 			}
 		}
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
-			}
-		}
-
-		message->~Message();
+		_destroy_message(message);
 
 		_THREAD_SAFE_LOCK_
 	}
 
-	buffer_end = 0; // reset buffer
+	// reset buffer
+	for (uint32_t i = 0; i <= write_page; i++) {
+		pages[i].end = 0;
+	}
+	write_page = 0;
 	flushing = false;
 	_THREAD_SAFE_UNLOCK_
 }
@@ -343,32 +479,40 @@ MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
 	singleton = this;
 
-	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
+	page_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
-	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+	page_size *= 1024;
+
+	coalesce = GLOBAL_DEF_RST("memory/limits/message_queue/coalesce_identical_calls", false);
+
+	Page page;
+	page.size = page_size;
+	page.data = memnew_arr(uint8_t, page_size);
+	pages.push_back(page);
 }
 
 MessageQueue::~MessageQueue() {
-	uint32_t read_pos = 0;
+	for (uint32_t i = 0; i <= write_page; i++) {
+		const Page &page = pages[i];
+		uint32_t read_pos = 0;
 
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++) {
-				args[i].~Variant();
+		while (read_pos < page.end) {
+			Message *message = (Message *)&page.data[read_pos];
+
+			read_pos += sizeof(Message);
+			if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+				read_pos += sizeof(Variant) * message->args;
 			}
+
+			_destroy_message(message);
 		}
-		message->~Message();
+	}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+	for (uint32_t i = 0; i < pages.size(); i++) {
+		if (pages[i].data) {
+			memdelete_arr(pages[i].data);
 		}
 	}
 
 	singleton = nullptr;
-	memdelete_arr(buffer);
 }
@@ -31,6 +31,7 @@
 #ifndef MESSAGE_QUEUE_H
 #define MESSAGE_QUEUE_H
 
+#include "core/local_vector.h"
 #include "core/object.h"
 #include "core/os/thread_safe.h"
 
@@ -58,14 +59,37 @@ class MessageQueue {
 			int16_t notification;
 			int16_t args;
 		};
+		uint32_t hash; // Only used when coalescing.
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end = 0;
+	// The buffer grows in pages so messages never move, even if more are
+	// pushed while flushing.
+	struct Page {
+		uint8_t *data = nullptr;
+		uint32_t end = 0;
+		uint32_t size = 0;
+	};
+
+	LocalVector<Page> pages;
+	uint32_t write_page = 0;
+	uint32_t page_size;
 	uint32_t buffer_max_used = 0;
-	uint32_t buffer_size;
 
-	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
+	// Identical messages still waiting to be flushed, by hash.
+	bool coalesce = false;
+	FlatHashMap<uint32_t, Message *> pending;
+
+	uint64_t stats_frame = 0;
+	uint32_t frame_messages = 0;
+	uint32_t frame_coalesced = 0;
+	uint32_t last_frame_messages = 0;
+	uint32_t last_frame_coalesced = 0;
+
+	uint8_t *_alloc_message(uint32_t p_room);
+	static uint32_t _hash_message(const Callable &p_callable, int p_type, int p_extra, const Variant **p_args, int p_argcount);
+	bool _is_pending(uint32_t p_hash, const Callable &p_callable, int p_type, int p_extra, const Variant **p_args, int p_argcount);
+	void _destroy_message(Message *p_message);
+	void _call_function(const Callable &p_callable, Object *p_target, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
 
@@ -91,6 +115,9 @@ public:
 	bool is_flushing() const;
 
 	int get_max_buffer_usage() const;
+	// Messages flushed and coalesced during the last frame.
+	int get_frame_message_count() const;
+	int get_frame_coalesced_count() const;
 
 	MessageQueue();
 	~MessageQueue();
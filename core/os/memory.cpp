@@ -37,6 +37,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef SMALL_ALLOCATOR_ENABLED
+#include "core/os/small_allocator.h"
+
+#define _mem_alloc(m_size) SmallAllocator::alloc(m_size)
+#define _mem_realloc(m_mem, m_size) SmallAllocator::realloc(m_mem, m_size)
+#define _mem_free(m_mem) SmallAllocator::free(m_mem)
+#else
+#define _mem_alloc(m_size) malloc(m_size)
+#define _mem_realloc(m_mem, m_size) realloc(m_mem, m_size)
+#define _mem_free(m_mem) free(m_mem)
+#endif
+
 void *operator new(size_t p_size, const char *p_description) {
 	return Memory::alloc_static(p_size, false);
 }
@@ -73,7 +85,7 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
-	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+	void *mem = _mem_alloc(p_bytes + (prepad ? PAD_ALIGN : 0));
 
 	ERR_FAIL_COND_V(!mem, nullptr);
 
@@ -122,12 +134,12 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 #endif
 
 		if (p_bytes == 0) {
-			free(mem);
+			_mem_free(mem);
 			return nullptr;
 		} else {
 			*s = p_bytes;
 
-			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
+			mem = (uint8_t *)_mem_realloc(mem, p_bytes + PAD_ALIGN);
 			ERR_FAIL_COND_V(!mem, nullptr);
 
 			s = (uint64_t *)mem;
@@ -137,7 +149,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 			return mem + PAD_ALIGN;
 		}
 	} else {
-		mem = (uint8_t *)realloc(mem, p_bytes);
+		mem = (uint8_t *)_mem_realloc(mem, p_bytes);
 
 		ERR_FAIL_COND_V(mem == nullptr && p_bytes > 0, nullptr);
 
@@ -166,9 +178,9 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 		atomic_sub(&mem_usage, *s);
 #endif
 
-		free(mem);
+		_mem_free(mem);
 	} else {
-		free(mem);
+		_mem_free(mem);
 	}
 }
 
@@ -192,6 +204,19 @@ uint64_t Memory::get_mem_max_usage() {
 #endif
 }
 
+void Memory::get_small_alloc_stats(uint64_t *r_allocations, uint64_t *r_used, uint64_t *r_reserved) {
+#ifdef SMALL_ALLOCATOR_ENABLED
+	SmallAllocator::Stats stats = SmallAllocator::get_stats();
+	*r_allocations = stats.allocations;
+	*r_used = stats.used_bytes;
+	*r_reserved = stats.reserved_bytes;
+#else
+	*r_allocations = 0;
+	*r_used = 0;
+	*r_reserved = 0;
+#endif
+}
+
 _GlobalNil::_GlobalNil() {
 	left = this;
 	right = this;
@@ -57,6 +57,9 @@ public:
 	static uint64_t get_mem_available();
 	static uint64_t get_mem_usage();
 	static uint64_t get_mem_max_usage();
+
+	// Statistics of the small object allocator (all zero unless built with small_allocator=yes).
+	static void get_small_alloc_stats(uint64_t *r_allocations, uint64_t *r_used, uint64_t *r_reserved);
 };
 
 class DefaultAllocator {
@@ -0,0 +1,332 @@
+/*************************************************************************/
+/*  small_allocator.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "small_allocator.h"
+
+#include "core/spin_lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+// Nothing here may use the error macros or any other code that allocates,
+// and all state must be constant initialized, since memory is allocated
+// during static initialization too.
+
+namespace {
+
+enum {
+	CLASS_COUNT = 16,
+	ARENA_SPANS = 16, // Spans are reserved from malloc() this many at a time.
+	MAP_LEAF_BITS = 16,
+	MAP_LEAF_SIZE = 1 << MAP_LEAF_BITS,
+	MAP_ROOT_SIZE = 1 << 16,
+};
+
+const uint32_t class_sizes[CLASS_COUNT] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+
+// Size class for every multiple of 16 bytes, indexed by (size + 15) / 16.
+const uint8_t size_classes[SmallAllocator::MAX_SMALL_SIZE / 16 + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15
+};
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+struct CentralList {
+	SpinLock lock;
+	FreeBlock *free_list = nullptr;
+	uint8_t *carve_from = nullptr; // Part of the newest span not handed out yet.
+	uint8_t *carve_end = nullptr;
+};
+
+CentralList central[CLASS_COUNT];
+
+SpinLock arena_lock;
+uint8_t *arena_next_span = nullptr;
+uint32_t arena_spans_left = 0;
+bool arena_disabled = false;
+
+// Two level map from span index (address >> SPAN_SHIFT) to size class + 1.
+// Zero means the address was not allocated here (it came from malloc()).
+std::atomic<uint8_t *> span_map[MAP_ROOT_SIZE];
+
+std::atomic<uint64_t> stat_allocations = { 0 };
+std::atomic<int64_t> stat_used_bytes = { 0 };
+std::atomic<uint64_t> stat_reserved_bytes = { 0 };
+
+_FORCE_INLINE_ uint32_t get_batch_size(uint32_t p_class) {
+	return CLAMP(8192 / class_sizes[p_class], 8u, 128u);
+}
+
+_FORCE_INLINE_ int get_span_class(const void *p_memory) {
+	uintptr_t span = uintptr_t(p_memory) >> SmallAllocator::SPAN_SHIFT;
+	uintptr_t root = span >> MAP_LEAF_BITS;
+	if (root >= MAP_ROOT_SIZE) {
+		return -1;
+	}
+	const uint8_t *leaf = span_map[root].load(std::memory_order_acquire);
+	if (!leaf) {
+		return -1;
+	}
+	return int(leaf[span & (MAP_LEAF_SIZE - 1)]) - 1;
+}
+
+uint8_t *allocate_span(uint32_t p_class) {
+	arena_lock.lock();
+
+	if (arena_spans_left == 0) {
+		uint8_t *arena = arena_disabled ? nullptr : (uint8_t *)::malloc(SmallAllocator::SPAN_SIZE * (ARENA_SPANS + 1));
+		if (!arena) {
+			arena_lock.unlock();
+			return nullptr;
+		}
+		// Align to the span size, so the span of any block is found by masking its address.
+		uintptr_t aligned = (uintptr_t(arena) + SmallAllocator::SPAN_SIZE - 1) & ~uintptr_t(SmallAllocator::SPAN_SIZE - 1);
+		uintptr_t last = aligned + SmallAllocator::SPAN_SIZE * ARENA_SPANS - 1;
+		if (((last >> SmallAllocator::SPAN_SHIFT) >> MAP_LEAF_BITS) >= MAP_ROOT_SIZE) {
+			// Beyond the range covered by the span map, use malloc() from now on.
+			::free(arena);
+			arena_disabled = true;
+			arena_lock.unlock();
+			return nullptr;
+		}
+		arena_next_span = (uint8_t *)aligned;
+		arena_spans_left = ARENA_SPANS;
+	}
+
+	uint8_t *span = arena_next_span;
+	uintptr_t index = uintptr_t(span) >> SmallAllocator::SPAN_SHIFT;
+	uint8_t *leaf = span_map[index >> MAP_LEAF_BITS].load(std::memory_order_relaxed);
+	if (!leaf) {
+		leaf = (uint8_t *)::calloc(MAP_LEAF_SIZE, 1);
+		if (!leaf) {
+			arena_lock.unlock();
+			return nullptr;
+		}
+		span_map[index >> MAP_LEAF_BITS].store(leaf, std::memory_order_release);
+	}
+	leaf[index & (MAP_LEAF_SIZE - 1)] = p_class + 1;
+
+	arena_next_span += SmallAllocator::SPAN_SIZE;
+	arena_spans_left--;
+
+	arena_lock.unlock();
+
+	stat_reserved_bytes.fetch_add(SmallAllocator::SPAN_SIZE, std::memory_order_relaxed);
+	return span;
+}
+
+// Moves up to p_count blocks from the shared pool to r_list, returns how many.
+uint32_t fetch_blocks(uint32_t p_class, FreeBlock *&r_list, uint32_t p_count) {
+	CentralList &c = central[p_class];
+	uint32_t size = class_sizes[p_class];
+	uint32_t fetched = 0;
+
+	c.lock.lock();
+	while (fetched < p_count && c.free_list) {
+		FreeBlock *block = c.free_list;
+		c.free_list = block->next;
+		block->next = r_list;
+		r_list = block;
+		fetched++;
+	}
+	while (fetched < p_count) {
+		if (c.carve_from == c.carve_end) {
+			uint8_t *span = allocate_span(p_class);
+			if (!span) {
+				break;
+			}
+			c.carve_from = span;
+			c.carve_end = span + (SmallAllocator::SPAN_SIZE / size) * size;
+		}
+		FreeBlock *block = (FreeBlock *)c.carve_from;
+		c.carve_from += size;
+		block->next = r_list;
+		r_list = block;
+		fetched++;
+	}
+	c.lock.unlock();
+
+	return fetched;
+}
+
+// Gives the list of blocks from p_first to p_last back to the shared pool.
+void release_blocks(uint32_t p_class, FreeBlock *p_first, FreeBlock *p_last) {
+	CentralList &c = central[p_class];
+	c.lock.lock();
+	p_last->next = c.free_list;
+	c.free_list = p_first;
+	c.lock.unlock();
+}
+
+struct ThreadCache {
+	FreeBlock *lists[CLASS_COUNT] = {};
+	uint32_t counts[CLASS_COUNT] = {};
+	uint64_t allocations = 0;
+	int64_t used_bytes = 0;
+	bool dead = false; // Set once the thread is exiting, the shared pool is used directly then.
+
+	void flush_stats() {
+		stat_allocations.fetch_add(allocations, std::memory_order_relaxed);
+		stat_used_bytes.fetch_add(used_bytes, std::memory_order_relaxed);
+		allocations = 0;
+		used_bytes = 0;
+	}
+
+	~ThreadCache() {
+		for (uint32_t i = 0; i < CLASS_COUNT; i++) {
+			if (!lists[i]) {
+				continue;
+			}
+			FreeBlock *last = lists[i];
+			while (last->next) {
+				last = last->next;
+			}
+			release_blocks(i, lists[i], last);
+			lists[i] = nullptr;
+			counts[i] = 0;
+		}
+		flush_stats();
+		dead = true;
+	}
+};
+
+thread_local ThreadCache thread_cache;
+
+} // namespace
+
+void *SmallAllocator::alloc(size_t p_bytes) {
+	if (p_bytes > MAX_SMALL_SIZE) {
+		return ::malloc(p_bytes);
+	}
+
+	uint32_t size_class = size_classes[(p_bytes + 15) >> 4];
+	ThreadCache &cache = thread_cache;
+
+	if (unlikely(cache.dead)) {
+		FreeBlock *block = nullptr;
+		if (!fetch_blocks(size_class, block, 1)) {
+			return ::malloc(p_bytes);
+		}
+		stat_allocations.fetch_add(1, std::memory_order_relaxed);
+		stat_used_bytes.fetch_add(class_sizes[size_class], std::memory_order_relaxed);
+		return block;
+	}
+
+	FreeBlock *block = cache.lists[size_class];
+	if (unlikely(!block)) {
+		cache.counts[size_class] = fetch_blocks(size_class, cache.lists[size_class], get_batch_size(size_class));
+		cache.flush_stats();
+		block = cache.lists[size_class];
+		if (!block) {
+			return ::malloc(p_bytes); // Out of spans.
+		}
+	}
+
+	cache.lists[size_class] = block->next;
+	cache.counts[size_class]--;
+	cache.allocations++;
+	cache.used_bytes += class_sizes[size_class];
+
+	return block;
+}
+
+void *SmallAllocator::realloc(void *p_memory, size_t p_bytes) {
+	if (!p_memory) {
+		return alloc(p_bytes);
+	}
+
+	int size_class = get_span_class(p_memory);
+	if (size_class < 0) {
+		return ::realloc(p_memory, p_bytes);
+	}
+
+	uint32_t size = class_sizes[size_class];
+	if (p_bytes <= size && p_bytes >= size / 2) {
+		return p_memory; // Still fits without wasting too much.
+	}
+
+	void *new_memory = alloc(p_bytes);
+	if (!new_memory) {
+		return nullptr;
+	}
+	memcpy(new_memory, p_memory, MIN(size_t(size), p_bytes));
+	free(p_memory);
+
+	return new_memory;
+}
+
+void SmallAllocator::free(void *p_memory) {
+	int size_class = get_span_class(p_memory);
+	if (size_class < 0) {
+		::free(p_memory);
+		return;
+	}
+
+	FreeBlock *block = (FreeBlock *)p_memory;
+	ThreadCache &cache = thread_cache;
+
+	if (unlikely(cache.dead)) {
+		release_blocks(size_class, block, block);
+		stat_used_bytes.fetch_sub(class_sizes[size_class], std::memory_order_relaxed);
+		return;
+	}
+
+	block->next = cache.lists[size_class];
+	cache.lists[size_class] = block;
+	cache.counts[size_class]++;
+	cache.used_bytes -= class_sizes[size_class];
+
+	uint32_t batch = get_batch_size(size_class);
+	if (unlikely(cache.counts[size_class] > batch * 2)) {
+		// Too many cached blocks (likely freeing what another thread allocated), give a batch back.
+		FreeBlock *first = cache.lists[size_class];
+		FreeBlock *last = first;
+		for (uint32_t i = 1; i < batch; i++) {
+			last = last->next;
+		}
+		cache.lists[size_class] = last->next;
+		cache.counts[size_class] -= batch;
+		release_blocks(size_class, first, last);
+		cache.flush_stats();
+	}
+}
+
+SmallAllocator::Stats SmallAllocator::get_stats() {
+	Stats stats;
+	stats.allocations = stat_allocations.load(std::memory_order_relaxed);
+	stats.used_bytes = MAX(stat_used_bytes.load(std::memory_order_relaxed), int64_t(0));
+	stats.reserved_bytes = stat_reserved_bytes.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,72 @@
+/*************************************************************************/
+/*  small_allocator.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SMALL_ALLOCATOR_H
+#define SMALL_ALLOCATOR_H
+
+#include "core/typedefs.h"
+
+#include <stddef.h>
+
+// Size class allocator for small blocks, with per thread caches.
+//
+// Blocks up to MAX_SMALL_SIZE bytes are carved from 64 KiB spans, each span
+// holding blocks of a single size class. Every thread keeps a free list per
+// size class, so most allocations and frees never take a lock; lists are
+// refilled from (or returned to) the shared pool in batches. Larger blocks go
+// straight to malloc().
+//
+// Spans are never given back to the system, freed blocks are reused instead.
+//
+// Used by Memory when built with small_allocator=yes.
+
+class SmallAllocator {
+public:
+	enum {
+		SPAN_SHIFT = 16,
+		SPAN_SIZE = 1 << SPAN_SHIFT,
+		MAX_SMALL_SIZE = 512,
+	};
+
+	struct Stats {
+		uint64_t allocations = 0; // Total amount of small allocations done.
+		uint64_t used_bytes = 0; // Bytes in small blocks currently in use.
+		uint64_t reserved_bytes = 0; // Bytes reserved in spans.
+	};
+
+	static void *alloc(size_t p_bytes);
+	static void *realloc(void *p_memory, size_t p_bytes);
+	static void free(void *p_memory);
+
+	// Statistics are gathered in batches, so they lag slightly behind.
+	static Stats get_stats();
+};
+
+#endif // SMALL_ALLOCATOR_H
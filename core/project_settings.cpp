@@ -1177,6 +1177,12 @@ ProjectSettings::ProjectSettings() {
 
 	Compression::gzip_level = GLOBAL_DEF("compression/formats/gzip/compression_level", Z_DEFAULT_COMPRESSION);
 	custom_prop_info["compression/formats/gzip/compression_level"] = PropertyInfo(Variant::INT, "compression/formats/gzip/compression_level", PROPERTY_HINT_RANGE, "-1,9,1");
+
+	// Applied by Main::setup() once the project is loaded.
+	GLOBAL_DEF("compression/formats/compressed_files/block_size", 4096);
+	custom_prop_info["compression/formats/compressed_files/block_size"] = PropertyInfo(Variant::INT, "compression/formats/compressed_files/block_size", PROPERTY_HINT_RANGE, "1024,1048576,1024,or_greater");
+	GLOBAL_DEF("compression/formats/compressed_files/read_ahead_blocks", 4);
+	custom_prop_info["compression/formats/compressed_files/read_ahead_blocks"] = PropertyInfo(Variant::INT, "compression/formats/compressed_files/read_ahead_blocks", PROPERTY_HINT_RANGE, "0,64,1");
 }
 
 ProjectSettings::~ProjectSettings() {
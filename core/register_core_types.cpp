@@ -40,6 +40,7 @@
 #include "core/func_ref.h"
 #include "core/input/input.h"
 #include "core/input/input_map.h"
+#include "core/io/compression.h"
 #include "core/io/config_file.h"
 #include "core/io/dtls_server.h"
 #include "core/io/http_client.h"
@@ -67,6 +68,7 @@
 #include "core/os/main_loop.h"
 #include "core/packed_data_container.h"
 #include "core/project_settings.h"
+#include "core/thread_work_pool.h"
 #include "core/translation.h"
 #include "core/undo_redo.h"
 
@@ -105,6 +107,8 @@ void register_core_types() {
 	ObjectDB::setup();
 	ResourceCache::setup();
 
+	ThreadWorkPool::create_singleton();
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
@@ -309,6 +313,9 @@ void unregister_core_types() {
 
 	ResourceLoader::finalize();
 
+	ThreadWorkPool::free_singleton();
+	Compression::clear_zstd_dictionaries();
+
 	ClassDB::cleanup_defaults();
 	ObjectDB::cleanup();
 
@@ -52,40 +52,32 @@ void Resource::set_path(const String &p_path, bool p_take_over) {
 	}
 
 	if (path_cache != "") {
-		ResourceCache::lock->write_lock();
-		ResourceCache::resources.erase(path_cache);
-		ResourceCache::lock->write_unlock();
+		ResourceCache::_remove(path_cache, path_hash, this);
 	}
 
 	path_cache = "";
+	path_hash = 0;
 
-	ResourceCache::lock->read_lock();
-	bool has_path = ResourceCache::resources.has(p_path);
-	ResourceCache::lock->read_unlock();
+	if (p_path != "") {
+		ResourceCache::Path path(p_path, p_path.hash());
+		ResourceCache::Shard &shard = ResourceCache::_get_shard(path.hash);
 
-	if (has_path) {
-		if (p_take_over) {
-			ResourceCache::lock->write_lock();
-			Resource **res = ResourceCache::resources.getptr(p_path);
-			if (res) {
+		ResourceCache::_write_lock(shard);
+		Resource **res = shard.resources.getptr(path);
+		if (res) {
+			if (p_take_over) {
 				(*res)->set_name("");
+			} else {
+				shard.lock->write_unlock();
+				ERR_FAIL_MSG("Another resource is loaded from path '" + p_path + "' (possible cyclic resource inclusion).");
 			}
-			ResourceCache::lock->write_unlock();
-		} else {
-			ResourceCache::lock->read_lock();
-			bool exists = ResourceCache::resources.has(p_path);
-			ResourceCache::lock->read_unlock();
-
-			ERR_FAIL_COND_MSG(exists, "Another resource is loaded from path '" + p_path + "' (possible cyclic resource inclusion).");
 		}
-	}
-	path_cache = p_path;
+		shard.resources.set(path, this);
+		shard.lock->write_unlock();
 
-	if (path_cache != "") {
-		ResourceCache::lock->write_lock();
-		ResourceCache::resources[path_cache] = this;
-		ResourceCache::lock->write_unlock();
+		path_hash = path.hash;
 	}
+	path_cache = p_path;
 
 	_change_notify("resource_path");
 	_resource_path_changed();
@@ -404,16 +396,14 @@ Resource::Resource() :
 
 Resource::~Resource() {
 	if (path_cache != "") {
-		ResourceCache::lock->write_lock();
-		ResourceCache::resources.erase(path_cache);
-		ResourceCache::lock->write_unlock();
+		ResourceCache::_remove(path_cache, path_hash, this);
 	}
 	if (owners.size()) {
 		WARN_PRINT("Resource is still owned.");
 	}
 }
 
-HashMap<String, Resource *> ResourceCache::resources;
+ResourceCache::Shard ResourceCache::shards[SHARD_COUNT];
 #ifdef TOOLS_ENABLED
 HashMap<String, HashMap<String, int>> ResourceCache::resource_path_cache;
 #endif
@@ -423,7 +413,18 @@ RWLock *ResourceCache::lock = nullptr;
 RWLock *ResourceCache::path_cache_lock = nullptr;
 #endif
 
+std::atomic<uint64_t> ResourceCache::lookups = { 0 };
+std::atomic<uint64_t> ResourceCache::hits = { 0 };
+std::atomic<uint64_t> ResourceCache::lock_waits = { 0 };
+std::atomic<uint64_t> ResourceCache::lock_wait_usec = { 0 };
+
+static ResourceCache::Stats frame_begin_stats;
+static ResourceCache::Stats last_frame_stats;
+
 void ResourceCache::setup() {
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].lock = RWLock::create();
+	}
 	lock = RWLock::create();
 #ifdef TOOLS_ENABLED
 	path_cache_lock = RWLock::create();
@@ -431,71 +432,153 @@ void ResourceCache::setup() {
 }
 
 void ResourceCache::clear() {
-	if (resources.size()) {
+	int count = get_cached_resource_count();
+	if (count) {
 		ERR_PRINT("Resources still in use at exit (run with --verbose for details).");
 		if (OS::get_singleton()->is_stdout_verbose()) {
-			const String *K = nullptr;
-			while ((K = resources.next(K))) {
-				Resource *r = resources[*K];
-				print_line(vformat("Resource still in use: %s (%s)", *K, r->get_class()));
+			for (int i = 0; i < SHARD_COUNT; i++) {
+				const Path *K = nullptr;
+				while ((K = shards[i].resources.next(K))) {
+					Resource *r = shards[i].resources[*K];
+					print_line(vformat("Resource still in use: %s (%s)", K->path, r->get_class()));
+				}
 			}
 		}
 	}
 
-	resources.clear();
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].resources.clear();
+		memdelete(shards[i].lock);
+		shards[i].lock = nullptr;
+	}
 	memdelete(lock);
 #ifdef TOOLS_ENABLED
 	memdelete(path_cache_lock);
 #endif
 }
 
+void ResourceCache::_read_lock(Shard &p_shard) {
+	// Only waiting is timed, an uncontended lock costs no more than before.
+	if (p_shard.lock->read_try_lock() != OK) {
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		p_shard.lock->read_lock();
+		lock_wait_usec.fetch_add(OS::get_singleton()->get_ticks_usec() - begin, std::memory_order_relaxed);
+		lock_waits.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void ResourceCache::_write_lock(Shard &p_shard) {
+	if (p_shard.lock->write_try_lock() != OK) {
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		p_shard.lock->write_lock();
+		lock_wait_usec.fetch_add(OS::get_singleton()->get_ticks_usec() - begin, std::memory_order_relaxed);
+		lock_waits.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void ResourceCache::_remove(const String &p_path, uint32_t p_hash, Resource *p_resource) {
+	Shard &shard = _get_shard(p_hash);
+	if (!shard.lock) {
+		return; // Already cleared.
+	}
+
+	Path path(p_path, p_hash);
+	_write_lock(shard);
+	Resource **res = shard.resources.getptr(path);
+	// The path may have been taken over by another resource since.
+	if (res && *res == p_resource) {
+		shard.resources.erase(path);
+	}
+	shard.lock->write_unlock();
+}
+
 void ResourceCache::reload_externals() {
 }
 
 bool ResourceCache::has(const String &p_path) {
-	lock->read_lock();
-	bool b = resources.has(p_path);
-	lock->read_unlock();
-
-	return b;
+	return get(p_path) != nullptr;
 }
 
 Resource *ResourceCache::get(const String &p_path) {
-	lock->read_lock();
-
-	Resource **res = resources.getptr(p_path);
+	Path path(p_path, p_path.hash());
+	Shard &shard = _get_shard(path.hash);
 
-	lock->read_unlock();
+	_read_lock(shard);
+	Resource **res = shard.resources.getptr(path);
+	Resource *r = res ? *res : nullptr;
+	shard.lock->read_unlock();
 
-	if (!res) {
-		return nullptr;
+	lookups.fetch_add(1, std::memory_order_relaxed);
+	if (r) {
+		hits.fetch_add(1, std::memory_order_relaxed);
 	}
+	return r;
+}
 
-	return *res;
+Ref<Resource> ResourceCache::get_ref(const String &p_path) {
+	Path path(p_path, p_path.hash());
+	Shard &shard = _get_shard(path.hash);
+
+	_read_lock(shard);
+	Resource **res = shard.resources.getptr(path);
+	//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
+	Ref<Resource> r = res ? Ref<Resource>(*res) : Ref<Resource>();
+	shard.lock->read_unlock();
+
+	lookups.fetch_add(1, std::memory_order_relaxed);
+	if (r.is_valid()) {
+		hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	return r;
 }
 
 void ResourceCache::get_cached_resources(List<Ref<Resource>> *p_resources) {
-	lock->read_lock();
-	const String *K = nullptr;
-	while ((K = resources.next(K))) {
-		Resource *r = resources[*K];
-		p_resources->push_back(Ref<Resource>(r));
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].lock->read_lock();
+		const Path *K = nullptr;
+		while ((K = shards[i].resources.next(K))) {
+			Resource *r = shards[i].resources[*K];
+			p_resources->push_back(Ref<Resource>(r));
+		}
+		shards[i].lock->read_unlock();
 	}
-	lock->read_unlock();
 }
 
 int ResourceCache::get_cached_resource_count() {
-	lock->read_lock();
-	int rc = resources.size();
-	lock->read_unlock();
+	int rc = 0;
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].lock->read_lock();
+		rc += shards[i].resources.size();
+		shards[i].lock->read_unlock();
+	}
 
 	return rc;
 }
 
+ResourceCache::Stats ResourceCache::get_total_stats() {
+	Stats stats;
+	stats.lookups = lookups.load(std::memory_order_relaxed);
+	stats.hits = hits.load(std::memory_order_relaxed);
+	stats.lock_waits = lock_waits.load(std::memory_order_relaxed);
+	stats.lock_wait_usec = lock_wait_usec.load(std::memory_order_relaxed);
+	return stats;
+}
+
+ResourceCache::Stats ResourceCache::get_frame_stats() {
+	return last_frame_stats;
+}
+
+void ResourceCache::end_frame() {
+	Stats total = get_total_stats();
+	last_frame_stats.lookups = total.lookups - frame_begin_stats.lookups;
+	last_frame_stats.hits = total.hits - frame_begin_stats.hits;
+	last_frame_stats.lock_waits = total.lock_waits - frame_begin_stats.lock_waits;
+	last_frame_stats.lock_wait_usec = total.lock_wait_usec - frame_begin_stats.lock_wait_usec;
+	frame_begin_stats = total;
+}
+
 void ResourceCache::dump(const char *p_file, bool p_short) {
 #ifdef DEBUG_ENABLED
-	lock->read_lock();
-
 	Map<String, int> type_count;
 
 	FileAccess *f = nullptr;
@@ -504,21 +587,27 @@ void ResourceCache::dump(const char *p_file, bool p_short) {
 		ERR_FAIL_COND_MSG(!f, "Cannot create file at path '" + String(p_file) + "'.");
 	}
 
-	const String *K = nullptr;
-	while ((K = resources.next(K))) {
-		Resource *r = resources[*K];
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		shards[i].lock->read_lock();
 
-		if (!type_count.has(r->get_class())) {
-			type_count[r->get_class()] = 0;
-		}
+		const Path *K = nullptr;
+		while ((K = shards[i].resources.next(K))) {
+			Resource *r = shards[i].resources[*K];
+
+			if (!type_count.has(r->get_class())) {
+				type_count[r->get_class()] = 0;
+			}
 
-		type_count[r->get_class()]++;
+			type_count[r->get_class()]++;
 
-		if (!p_short) {
-			if (f) {
-				f->store_line(r->get_class() + ": " + r->get_path());
+			if (!p_short) {
+				if (f) {
+					f->store_line(r->get_class() + ": " + r->get_path());
+				}
 			}
 		}
+
+		shards[i].lock->read_unlock();
 	}
 
 	for (Map<String, int>::Element *E = type_count.front(); E; E = E->next()) {
@@ -530,7 +619,5 @@ void ResourceCache::dump(const char *p_file, bool p_short) {
 		f->close();
 		memdelete(f);
 	}
-
-	lock->read_unlock();
 #endif
 }
@@ -37,6 +37,8 @@
 #include "core/safe_refcount.h"
 #include "core/self_list.h"
 
+#include <atomic>
+
 #define RES_BASE_EXTENSION(m_ext)                                                                                   \
 public:                                                                                                             \
 	static void register_custom_data_to_otdb() { ClassDB::add_resource_base_extension(m_ext, get_class_static()); } \
@@ -56,6 +58,7 @@ class Resource : public Reference {
 
 	String name;
 	String path_cache;
+	uint32_t path_hash = 0; // Of path_cache, to find it in ResourceCache without hashing again.
 	int subindex = 0;
 
 	virtual bool _use_builtin_script() const { return true; }
@@ -146,24 +149,78 @@ typedef Ref<Resource> RES;
 class ResourceCache {
 	friend class Resource;
 	friend class ResourceLoader; //need the lock
-	static RWLock *lock;
-	static HashMap<String, Resource *> resources;
+
+	enum {
+		// Paths are spread across independently locked shards, so loader threads
+		// looking up unrelated paths do not serialize on a single lock.
+		SHARD_BITS = 4,
+		SHARD_COUNT = 1 << SHARD_BITS
+	};
+
+	// A path along with its hash, which is computed once and never again when rehashing.
+	struct Path {
+		String path;
+		uint32_t hash = 0;
+
+		bool operator==(const Path &p_path) const { return hash == p_path.hash && path == p_path.path; }
+
+		Path() {}
+		Path(const String &p_path, uint32_t p_hash) :
+				path(p_path),
+				hash(p_hash) {}
+	};
+
+	struct PathHasher {
+		static _FORCE_INLINE_ uint32_t hash(const Path &p_path) { return p_path.hash; }
+	};
+
+	struct alignas(64) Shard {
+		RWLock *lock = nullptr;
+		FlatHashMap<Path, Resource *, PathHasher> resources;
+	};
+
+	static Shard shards[SHARD_COUNT];
+	static RWLock *lock; // Guards ResourceLoader::remapped_list.
 #ifdef TOOLS_ENABLED
 	static HashMap<String, HashMap<String, int>> resource_path_cache; // each tscn has a set of resource paths and IDs
 	static RWLock *path_cache_lock;
 #endif // TOOLS_ENABLED
+
+	static std::atomic<uint64_t> lookups;
+	static std::atomic<uint64_t> hits;
+	static std::atomic<uint64_t> lock_waits;
+	static std::atomic<uint64_t> lock_wait_usec;
+
+	_FORCE_INLINE_ static Shard &_get_shard(uint32_t p_hash) { return shards[p_hash >> (32 - SHARD_BITS)]; }
+	static void _read_lock(Shard &p_shard);
+	static void _write_lock(Shard &p_shard);
+	static void _remove(const String &p_path, uint32_t p_hash, Resource *p_resource);
+
 	friend void unregister_core_types();
 	static void clear();
 	friend void register_core_types();
 	static void setup();
 
 public:
+	struct Stats {
+		uint64_t lookups = 0;
+		uint64_t hits = 0;
+		uint64_t lock_waits = 0; // Lock acquisitions that had to wait for another thread.
+		uint64_t lock_wait_usec = 0;
+	};
+
 	static void reload_externals();
 	static bool has(const String &p_path);
 	static Resource *get(const String &p_path);
+	// Unlike get(), returns a null reference if the resource is being freed by another thread.
+	static Ref<Resource> get_ref(const String &p_path);
 	static void dump(const char *p_file = nullptr, bool p_short = false);
 	static void get_cached_resources(List<Ref<Resource>> *p_resources);
 	static int get_cached_resource_count();
+
+	static Stats get_total_stats();
+	static Stats get_frame_stats(); // During the last frame.
+	static void end_frame();
 };
 
 #endif // RESOURCE_H
@@ -46,7 +46,7 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
+StringName::Shard StringName::shards[STRING_TABLE_SHARDS];
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
@@ -57,10 +57,10 @@ void StringName::setup() {
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
-
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+		MutexLock lock(_get_mutex(i));
+
 		while (_table[i]) {
 			_Data *d = _table[i];
 			lost_strings++;
@@ -85,7 +85,7 @@ void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
+		MutexLock lock(_get_mutex(_data->idx));
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
@@ -162,12 +162,12 @@ StringName::StringName(const char *p_name) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -206,12 +206,12 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_static_string.ptr);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -252,11 +252,11 @@ StringName::StringName(const String &p_name) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = p_name.hash();
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_data = _table[idx];
 
 	while (_data) {
@@ -295,11 +295,11 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -325,12 +325,12 @@ StringName StringName::search(const CharType *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = String::hash(p_name);
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -351,12 +351,12 @@ StringName StringName::search(const CharType *p_name) {
 StringName StringName::search(const String &p_name) {
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	MutexLock lock(mutex);
-
 	uint32_t hash = p_name.hash();
 
 	uint32_t idx = hash & STRING_TABLE_MASK;
 
+	MutexLock lock(_get_mutex(idx));
+
 	_Data *_data = _table[idx];
 
 	while (_data) {
@@ -45,7 +45,13 @@ class StringName {
 
 		STRING_TABLE_BITS = 12,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+
+		// Buckets are split across independently locked shards, so threads
+		// interning unrelated names do not contend on a single lock.
+		STRING_TABLE_SHARD_BITS = 6,
+		STRING_TABLE_SHARDS = 1 << STRING_TABLE_SHARD_BITS,
+		STRING_TABLE_SHARD_MASK = STRING_TABLE_SHARDS - 1
 	};
 
 	struct _Data {
@@ -74,7 +80,13 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex mutex;
+	struct alignas(64) Shard {
+		Mutex mutex;
+	};
+
+	static Shard shards[STRING_TABLE_SHARDS];
+	_FORCE_INLINE_ static const Mutex &_get_mutex(uint32_t p_idx) { return shards[p_idx & STRING_TABLE_SHARD_MASK].mutex; }
+
 	static void setup();
 	static void cleanup();
 	static bool configured;
@@ -32,48 +32,318 @@
 
 #include "core/os/os.h"
 
+thread_local ThreadWorkPool::ThreadData *ThreadWorkPool::current_thread = nullptr;
+ThreadWorkPool *ThreadWorkPool::singleton = nullptr;
+
+void ThreadWorkPool::TaskQueue::push_back(BaseTask *p_task, uint32_t p_times) {
+	lock.lock();
+	if (count + p_times > buffer.size()) {
+		// Grow to the next power of two, unwrapping the ring in the process.
+		LocalVector<BaseTask *> new_buffer;
+		new_buffer.resize(next_power_of_2(MAX(count + p_times, 16u)));
+		for (uint32_t i = 0; i < count; i++) {
+			new_buffer[i] = buffer[(head + i) & (buffer.size() - 1)];
+		}
+		buffer = new_buffer;
+		head = 0;
+	}
+	uint32_t mask = buffer.size() - 1;
+	for (uint32_t i = 0; i < p_times; i++) {
+		buffer[(head + count + i) & mask] = p_task;
+	}
+	count += p_times;
+	lock.unlock();
+}
+
+ThreadWorkPool::BaseTask *ThreadWorkPool::TaskQueue::pop_back() {
+	BaseTask *task = nullptr;
+	lock.lock();
+	if (count > 0) {
+		count--;
+		task = buffer[(head + count) & (buffer.size() - 1)];
+	}
+	lock.unlock();
+	return task;
+}
+
+ThreadWorkPool::BaseTask *ThreadWorkPool::TaskQueue::pop_front() {
+	BaseTask *task = nullptr;
+	lock.lock();
+	if (count > 0) {
+		task = buffer[head];
+		head = (head + 1) & (buffer.size() - 1);
+		count--;
+	}
+	lock.unlock();
+	return task;
+}
+
 void ThreadWorkPool::_thread_function(ThreadData *p_thread) {
+	current_thread = p_thread;
+	ThreadWorkPool *pool = p_thread->pool;
+
+	while (!pool->exit.load()) {
+		uint64_t epoch = pool->work_epoch.load();
+		BaseTask *task = pool->_pop_task(p_thread);
+		if (task) {
+			pool->_run_task(task);
+		} else {
+			pool->_sleep(epoch);
+		}
+	}
+
+	current_thread = nullptr;
+}
+
+ThreadWorkPool::ThreadData *ThreadWorkPool::_get_current_thread() const {
+	return (current_thread && current_thread->pool == this) ? current_thread : nullptr;
+}
+
+void ThreadWorkPool::_notify_work() {
+	work_epoch.fetch_add(1);
+	if (sleeping_threads.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		sleep_condition.notify_all();
+	}
+}
+
+void ThreadWorkPool::_sleep(uint64_t p_epoch) {
+	sleeping_threads.fetch_add(1);
+	{
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		while (work_epoch.load() == p_epoch && !exit.load()) {
+			sleep_condition.wait(lock);
+		}
+	}
+	sleeping_threads.fetch_sub(1);
+}
+
+ThreadWorkPool::BaseTask *ThreadWorkPool::_pop_task(ThreadData *p_thread) {
+	BaseTask *task = nullptr;
+
+	// Own work first (most recently pushed, likely still in cache).
+	if (p_thread) {
+		task = p_thread->queue.pop_back();
+		if (task) {
+			return task;
+		}
+	}
+
+	task = global_queue.pop_front();
+	if (task) {
+		return task;
+	}
+
+	// Steal the oldest work from other threads.
+	uint32_t from = p_thread ? p_thread->index + 1 : 0;
+	for (uint32_t i = 0; i < thread_count; i++) {
+		ThreadData *victim = &threads[(from + i) % thread_count];
+		if (victim == p_thread) {
+			continue;
+		}
+		task = victim->queue.pop_front();
+		if (task) {
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+void ThreadWorkPool::_run_task(BaseTask *p_task) {
+	p_task->work();
+
+	if (p_task->pending_tickets.fetch_sub(1) != 1) {
+		return;
+	}
+
+	// Last ticket done, the task is complete. It may be freed by a waiter as soon
+	// as it is flagged, so it must not be accessed afterwards.
+	LocalVector<BaseTask *> dependents;
+	{
+		std::lock_guard<std::mutex> lock(task_mutex);
+		dependents = p_task->dependents;
+		p_task->completed.store(true);
+	}
+
+	for (uint32_t i = 0; i < dependents.size(); i++) {
+		if (dependents[i]->pending_dependencies.fetch_sub(1) == 1) {
+			_enqueue_task(dependents[i]);
+		}
+	}
+
+	_notify_work();
+}
+
+void ThreadWorkPool::_enqueue_task(BaseTask *p_task) {
+	ThreadData *thread = _get_current_thread();
+	TaskQueue &queue = thread ? thread->queue : global_queue;
+	queue.push_back(p_task, p_task->tickets);
+	_notify_work();
+}
+
+ThreadWorkPool::TaskID ThreadWorkPool::_submit_task(BaseTask *p_task, const TaskID *p_dependencies, int p_dependency_count) {
+	p_task->pending_tickets.store(p_task->tickets);
+	p_task->pending_dependencies.store(1); // Keeps the task from being queued while dependencies are added.
+	p_task->completed.store(false);
+
+	TaskID id;
+	{
+		std::lock_guard<std::mutex> lock(task_mutex);
+		id = ++last_task_id;
+		p_task->id = id;
+		tasks.set(id, p_task);
+
+		for (int i = 0; i < p_dependency_count; i++) {
+			BaseTask **dependency = tasks.getptr(p_dependencies[i]);
+			if (!dependency) {
+				// Either invalid or already waited for (thus completed).
+				ERR_CONTINUE_MSG(p_dependencies[i] <= 0 || p_dependencies[i] >= id, "Invalid task dependency: " + itos(p_dependencies[i]) + ".");
+				continue;
+			}
+			if ((*dependency)->completed.load()) {
+				continue;
+			}
+			(*dependency)->dependents.push_back(p_task);
+			p_task->pending_dependencies.fetch_add(1);
+		}
+	}
+
+	if (p_task->pending_dependencies.fetch_sub(1) == 1) {
+		_enqueue_task(p_task);
+	}
+
+	return id;
+}
+
+bool ThreadWorkPool::is_task_completed(TaskID p_task) const {
+	std::lock_guard<std::mutex> lock(task_mutex);
+	BaseTask *const *task = tasks.getptr(p_task);
+	if (!task) {
+		ERR_FAIL_COND_V_MSG(p_task <= 0 || p_task > last_task_id, false, "Invalid task ID: " + itos(p_task) + ".");
+		return true; // Already waited for.
+	}
+	return (*task)->completed.load();
+}
+
+void ThreadWorkPool::wait_for_task_completion(TaskID p_task) {
+	BaseTask *task;
+	{
+		std::lock_guard<std::mutex> lock(task_mutex);
+		BaseTask **ptr = tasks.getptr(p_task);
+		ERR_FAIL_COND_MSG(!ptr, "Invalid task ID or task already waited for: " + itos(p_task) + ".");
+		task = *ptr;
+	}
+
+	// Help with the queued work instead of blocking, this is what allows tasks
+	// to wait for other tasks without running out of threads.
+	ThreadData *thread = _get_current_thread();
 	while (true) {
-		p_thread->start.wait();
-		if (p_thread->exit.load()) {
+		uint64_t epoch = work_epoch.load();
+		if (task->completed.load()) {
 			break;
 		}
-		p_thread->work->work();
-		p_thread->completed.post();
+		BaseTask *other = _pop_task(thread);
+		if (other) {
+			_run_task(other);
+		} else {
+			_sleep(epoch);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(task_mutex);
+		tasks.erase(p_task);
+	}
+	memdelete(task);
+}
+
+void ThreadWorkPool::wait_until_completed(TaskID p_task) {
+	ThreadData *thread = _get_current_thread();
+	while (true) {
+		uint64_t epoch = work_epoch.load();
+		if (is_task_completed(p_task)) {
+			break;
+		}
+		BaseTask *other = _pop_task(thread);
+		if (other) {
+			_run_task(other);
+		} else {
+			_sleep(epoch);
+		}
 	}
 }
 
 void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
+	ERR_FAIL_COND(initialized);
 	if (p_thread_count < 0) {
 		p_thread_count = OS::get_singleton()->get_processor_count();
 	}
 
+	exit.store(false);
 	thread_count = p_thread_count;
 	threads = memnew_arr(ThreadData, thread_count);
+	initialized = true;
 
 	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
+		threads[i].pool = this;
+		threads[i].index = i;
+	}
+	for (uint32_t i = 0; i < thread_count; i++) {
 		threads[i].thread = memnew(std::thread(ThreadWorkPool::_thread_function, &threads[i]));
 	}
 }
 
 void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
+	if (!initialized) {
 		return;
 	}
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
+	// Tasks nobody waited for would leak (and may still be running).
+	LocalVector<TaskID> leftover;
+	{
+		std::lock_guard<std::mutex> lock(task_mutex);
+		const TaskID *k = nullptr;
+		while ((k = tasks.next(k))) {
+			leftover.push_back(*k);
+		}
+	}
+	if (leftover.size()) {
+		WARN_PRINT(itos(leftover.size()) + " task(s) were never waited for.");
+		for (uint32_t i = 0; i < leftover.size(); i++) {
+			wait_for_task_completion(leftover[i]);
+		}
+	}
+
+	exit.store(true);
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		sleep_condition.notify_all();
 	}
 	for (uint32_t i = 0; i < thread_count; i++) {
 		threads[i].thread->join();
 		memdelete(threads[i].thread);
 	}
 
-	memdelete_arr(threads);
+	if (threads) {
+		memdelete_arr(threads);
+	}
 	threads = nullptr;
+	thread_count = 0;
+	initialized = false;
+}
+
+void ThreadWorkPool::create_singleton() {
+	ERR_FAIL_COND(singleton != nullptr);
+	singleton = memnew(ThreadWorkPool);
+	singleton->init();
+}
+
+void ThreadWorkPool::free_singleton() {
+	if (singleton) {
+		memdelete(singleton);
+		singleton = nullptr;
+	}
 }
 
 ThreadWorkPool::~ThreadWorkPool() {
@@ -31,30 +31,70 @@
 #ifndef THREAD_WORK_POOL_H
 #define THREAD_WORK_POOL_H
 
+#include "core/hash_map.h"
+#include "core/local_vector.h"
 #include "core/os/memory.h"
-#include "core/os/semaphore.h"
+#include "core/spin_lock.h"
+#include "core/vector.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
+// Task based work pool.
+//
+// Tasks are submitted with add_task() (runs once) or add_group_task() (runs
+// once per element, spread across threads) and may depend on previously
+// submitted tasks. Every task must be waited on exactly once with
+// wait_for_task_completion(), which also releases it.
+//
+// Each worker owns a queue it pushes to and pops from at the back, while idle
+// workers steal from the front of the other queues. Threads that wait for a
+// task keep running queued work until it completes, so tasks can safely
+// submit and wait for other tasks (nested parallel-for) from inside workers.
+
 class ThreadWorkPool {
-	std::atomic<uint32_t> index;
+public:
+	typedef int64_t TaskID;
+
+	enum {
+		INVALID_TASK_ID = -1
+	};
+
+private:
+	struct BaseTask {
+		TaskID id = INVALID_TASK_ID;
+		uint32_t tickets = 1; // Amount of times this task is queued.
+		std::atomic<uint32_t> pending_tickets;
+		std::atomic<uint32_t> pending_dependencies;
+		std::atomic<bool> completed;
+		LocalVector<BaseTask *> dependents; // Protected by task_mutex.
 
-	struct BaseWork {
-		std::atomic<uint32_t> *index;
-		uint32_t max_elements;
 		virtual void work() = 0;
-		virtual ~BaseWork() = default;
+		virtual ~BaseTask() = default;
+	};
+
+	template <class C, class M, class U>
+	struct Task : public BaseTask {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void work() {
+			(instance->*method)(userdata);
+		}
 	};
 
 	template <class C, class M, class U>
-	struct Work : public BaseWork {
+	struct GroupTask : public BaseTask {
+		std::atomic<uint32_t> index;
+		uint32_t max_elements;
 		C *instance;
 		M method;
 		U userdata;
 		virtual void work() {
 			while (true) {
-				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
+				uint32_t work_index = index.fetch_add(1, std::memory_order_relaxed);
 				if (work_index >= max_elements) {
 					break;
 				}
@@ -63,47 +103,106 @@ class ThreadWorkPool {
 		}
 	};
 
+	// Double ended ring buffer of queued tasks.
+	struct TaskQueue {
+		SpinLock lock;
+		LocalVector<BaseTask *> buffer;
+		uint32_t head = 0;
+		uint32_t count = 0;
+
+		void push_back(BaseTask *p_task, uint32_t p_times);
+		BaseTask *pop_back();
+		BaseTask *pop_front();
+	};
+
 	struct ThreadData {
-		std::thread *thread;
-		Semaphore start;
-		Semaphore completed;
-		std::atomic<bool> exit;
-		BaseWork *work;
+		ThreadWorkPool *pool = nullptr;
+		uint32_t index = 0;
+		std::thread *thread = nullptr;
+		TaskQueue queue;
 	};
 
 	ThreadData *threads = nullptr;
 	uint32_t thread_count = 0;
+	bool initialized = false;
+	std::atomic<bool> exit = { false };
+
+	TaskQueue global_queue; // Tasks submitted from threads outside the pool.
+
+	mutable std::mutex task_mutex;
+	HashMap<TaskID, BaseTask *> tasks;
+	TaskID last_task_id = 0;
+
+	// Sleeping threads wake up whenever work is queued or a task completes.
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_condition;
+	std::atomic<uint64_t> work_epoch = { 0 };
+	std::atomic<uint32_t> sleeping_threads = { 0 };
+
+	static thread_local ThreadData *current_thread;
+	static ThreadWorkPool *singleton;
 
 	static void _thread_function(ThreadData *p_thread);
 
+	ThreadData *_get_current_thread() const;
+	void _notify_work();
+	void _sleep(uint64_t p_epoch);
+	BaseTask *_pop_task(ThreadData *p_thread);
+	void _run_task(BaseTask *p_task);
+	void _enqueue_task(BaseTask *p_task);
+	TaskID _submit_task(BaseTask *p_task, const TaskID *p_dependencies, int p_dependency_count);
+
 public:
 	template <class C, class M, class U>
-	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		ERR_FAIL_COND(!threads); //never initialized
+	TaskID add_task(C *p_instance, M p_method, U p_userdata, const Vector<TaskID> &p_dependencies = Vector<TaskID>()) {
+		ERR_FAIL_COND_V(!initialized, INVALID_TASK_ID); //never initialized
 
-		index.store(0);
+		Task<C, M, U> *t = memnew((Task<C, M, U>));
+		t->instance = p_instance;
+		t->method = p_method;
+		t->userdata = p_userdata;
 
-		Work<C, M, U> *w = memnew((Work<C, M, U>));
-		w->instance = p_instance;
-		w->userdata = p_userdata;
-		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
+		return _submit_task(t, p_dependencies.ptr(), p_dependencies.size());
+	}
 
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
-		}
-		for (uint32_t i = 0; i < thread_count; i++) {
-			threads[i].completed.wait();
-			threads[i].work = nullptr;
-		}
+	template <class C, class M, class U>
+	TaskID add_group_task(uint32_t p_elements, C *p_instance, M p_method, U p_userdata, const Vector<TaskID> &p_dependencies = Vector<TaskID>()) {
+		ERR_FAIL_COND_V(!initialized, INVALID_TASK_ID); //never initialized
+
+		GroupTask<C, M, U> *t = memnew((GroupTask<C, M, U>));
+		t->index.store(0);
+		t->max_elements = p_elements;
+		t->instance = p_instance;
+		t->method = p_method;
+		t->userdata = p_userdata;
+		// No point in queuing more tickets than threads able to run them (workers plus the waiter).
+		t->tickets = MAX(1u, MIN(p_elements, thread_count + 1));
+
+		return _submit_task(t, p_dependencies.ptr(), p_dependencies.size());
+	}
+
+	bool is_task_completed(TaskID p_task) const;
+	void wait_for_task_completion(TaskID p_task);
+	// Like wait_for_task_completion(), but doesn't release the task, so any
+	// number of threads may wait for it.
+	void wait_until_completed(TaskID p_task);
 
-		memdelete(w);
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		ERR_FAIL_COND(!initialized); //never initialized
+
+		wait_for_task_completion(add_group_task(p_elements, p_instance, p_method, p_userdata));
 	}
 
+	uint32_t get_thread_count() const { return thread_count; }
+
 	void init(int p_thread_count = -1);
 	void finish();
+
+	static ThreadWorkPool *get_singleton() { return singleton; }
+	static void create_singleton();
+	static void free_singleton();
+
 	~ThreadWorkPool();
 };
 
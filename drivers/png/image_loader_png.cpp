@@ -38,6 +38,15 @@
 
 Error ImageLoaderPNG::load_image(Ref<Image> p_image, FileAccess *f, bool p_force_linear, float p_scale) {
 	const size_t buffer_size = f->get_len();
+
+	// Decode in place if the file is in memory already (e.g. in a mapped pack).
+	const uint8_t *span = f->get_buffer_span(buffer_size);
+	if (span) {
+		Error err = PNGDriverCommon::png_to_image(span, buffer_size, p_image);
+		f->close();
+		return err;
+	}
+
 	Vector<uint8_t> file_buffer;
 	Error err = file_buffer.resize(buffer_size);
 	if (err) {
@@ -41,6 +41,7 @@
 #include <errno.h>
 
 #if defined(UNIX_ENABLED)
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -72,7 +73,7 @@ void FileAccessUnix::check_errors() const {
 
 Error FileAccessUnix::_open(const String &p_path, int p_mode_flags) {
 	if (f) {
-		fclose(f);
+		close();
 	}
 	f = nullptr;
 
@@ -153,6 +154,14 @@ void FileAccessUnix::close() {
 		return;
 	}
 
+#if defined(UNIX_ENABLED)
+	if (mapped) {
+		munmap(mapped, mapped_len);
+		mapped = nullptr;
+		mapped_len = 0;
+	}
+#endif
+
 	fclose(f);
 	f = nullptr;
 
@@ -225,6 +234,32 @@ size_t FileAccessUnix::get_len() const {
 	return size;
 }
 
+const uint8_t *FileAccessUnix::map_contents() {
+#if defined(UNIX_ENABLED)
+	ERR_FAIL_COND_V_MSG(!f, nullptr, "File must be opened before use.");
+	if (mapped) {
+		return mapped;
+	}
+	if (flags != READ) {
+		return nullptr; // Writes go through stdio buffers, the mapping wouldn't see them.
+	}
+
+	size_t len = get_len();
+	if (len == 0) {
+		return nullptr;
+	}
+	void *ptr = mmap(nullptr, len, PROT_READ, MAP_SHARED, fileno(f), 0);
+	if (ptr == MAP_FAILED) {
+		return nullptr;
+	}
+	mapped = (uint8_t *)ptr;
+	mapped_len = len;
+	return mapped;
+#else
+	return nullptr;
+#endif
+}
+
 bool FileAccessUnix::eof_reached() const {
 	return last_error == ERR_FILE_EOF;
 }
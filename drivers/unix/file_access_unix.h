@@ -43,6 +43,8 @@ typedef void (*CloseNotificationFunc)(const String &p_file, int p_flags);
 class FileAccessUnix : public FileAccess {
 	FILE *f = nullptr;
 	int flags = 0;
+	uint8_t *mapped = nullptr;
+	size_t mapped_len = 0;
 	void check_errors() const;
 	mutable Error last_error = OK;
 	String save_path;
@@ -79,6 +81,8 @@ public:
 
 	virtual bool file_exists(const String &p_path); ///< return true if a file exists
 
+	virtual const uint8_t *map_contents();
+
 	virtual uint64_t _get_modified_time(const String &p_file);
 	virtual uint32_t _get_unix_permissions(const String &p_file);
 	virtual Error _set_unix_permissions(const String &p_file, uint32_t p_permissions);
@@ -967,10 +967,19 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 
 	int header_padding = _get_pad(PCK_PADDING, header_size);
 
+	Vector<PackedSourcePCK::IndexEntry> index;
+	index.resize(pd.file_ofs.size());
+
 	for (int i = 0; i < pd.file_ofs.size(); i++) {
 		int string_len = pd.file_ofs[i].path_utf8.length();
 		int pad = _get_pad(4, string_len);
 
+		PackedSourcePCK::IndexEntry &e = index.write[i];
+		PackedSourcePCK::get_path_hash(String::utf8(pd.file_ofs[i].path_utf8.get_data()).md5_buffer(), e.hash_a, e.hash_b);
+		e.offset = pd.file_ofs[i].ofs + header_padding + header_size;
+		e.size = pd.file_ofs[i].size;
+		e.record = f->get_position();
+
 		f->store_32(string_len + pad);
 		f->store_buffer((const uint8_t *)pd.file_ofs[i].path_utf8.get_data(), string_len);
 		for (int j = 0; j < pad; j++) {
@@ -1008,6 +1017,8 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, c
 
 	memdelete(ftmp);
 
+	PackedSourcePCK::store_index(f, pck_start_pos, index);
+
 	if (p_embed) {
 		// Ensure embedded data ends at a 64-bit multiple
 		int64_t embed_end = f->get_position() - embed_pos + 12;
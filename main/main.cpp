@@ -32,8 +32,10 @@
 
 #include "core/crypto/crypto.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/frame_arena.h"
 #include "core/input/input.h"
 #include "core/input/input_map.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_network.h"
 #include "core/io/file_access_pack.h"
 #include "core/io/file_access_zip.h"
@@ -933,8 +935,12 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	// Initialize user data dir.
 	OS::get_singleton()->ensure_user_data_dir();
 
+	FileAccessCompressed::set_default_block_size(GLOBAL_GET("compression/formats/compressed_files/block_size"));
+	FileAccessCompressed::set_read_ahead_blocks(GLOBAL_GET("compression/formats/compressed_files/read_ahead_blocks"));
+
 	GLOBAL_DEF("memory/limits/multithreaded_server/rid_pool_prealloc", 60);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/multithreaded_server/rid_pool_prealloc", PropertyInfo(Variant::INT, "memory/limits/multithreaded_server/rid_pool_prealloc", PROPERTY_HINT_RANGE, "0,500,1")); // No negative and limit to 500 due to crashes
+	GLOBAL_DEF("memory/limits/multithreaded_server/lock_free_command_queue", false);
 	GLOBAL_DEF("network/limits/debugger/max_chars_per_second", 32768);
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/debugger/max_chars_per_second", PropertyInfo(Variant::INT, "network/limits/debugger/max_chars_per_second", PROPERTY_HINT_RANGE, "0, 4096, 1, or_greater"));
 	GLOBAL_DEF("network/limits/debugger/max_queued_messages", 2048);
@@ -1494,6 +1500,8 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
 	ResourceLoader::load_translation_remaps(); //load remaps for resources
 
 	ResourceLoader::load_path_remaps();
+	// The editor loads resources that may be reimported meanwhile, keep it on a single thread.
+	ResourceLoader::set_parallel_dependency_loads(GLOBAL_DEF("application/run/load_dependencies_in_parallel", false) && !editor);
 
 	audio_server->load_default_bus_layout();
 
@@ -2250,6 +2258,13 @@ bool Main::iteration() {
 		frames = 0;
 	}
 
+	// Everything allocated from the frame arena this iteration is dead now, unless
+	// this is a nested iteration (e.g. a progress dialog) and the outer frame still uses it.
+	if (iterating == 1) {
+		FrameArena::get_current()->reset();
+	}
+	ResourceCache::end_frame();
+
 	iterating--;
 
 	if (fixed_fps != -1) {
@@ -2398,6 +2413,8 @@ void Main::cleanup() {
 		OS::get_singleton()->set_restart_on_exit(false, List<String>()); //clear list (uses memory)
 	}
 
+	FrameArena::free_current();
+
 	unregister_core_driver_types();
 	unregister_core_types();
 
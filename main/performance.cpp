@@ -34,6 +34,7 @@
 #include "core/os/os.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
+#include "scene/resources/packed_scene.h"
 #include "servers/audio_server.h"
 #include "servers/physics_server_2d.h"
 #include "servers/physics_server_3d.h"
@@ -71,6 +72,17 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(MEMORY_SMALL_ALLOCATIONS_PER_SECOND);
+	BIND_ENUM_CONSTANT(MEMORY_SMALL_USED);
+	BIND_ENUM_CONSTANT(MEMORY_SMALL_RESERVED);
+	BIND_ENUM_CONSTANT(OBJECT_MESSAGE_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(OBJECT_MESSAGE_QUEUE_COALESCED);
+	BIND_ENUM_CONSTANT(OBJECT_SCENE_POOL_PARKED);
+	BIND_ENUM_CONSTANT(OBJECT_SCENE_POOL_HITS);
+	BIND_ENUM_CONSTANT(OBJECT_SCENE_POOL_MISSES);
+	BIND_ENUM_CONSTANT(OBJECT_RESOURCE_CACHE_LOOKUPS);
+	BIND_ENUM_CONSTANT(OBJECT_RESOURCE_CACHE_HITS);
+	BIND_ENUM_CONSTANT(TIME_RESOURCE_CACHE_LOCK_WAIT);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -84,6 +96,22 @@ float Performance::_get_node_count() const {
 	return sml->get_node_count();
 }
 
+float Performance::_get_small_alloc_rate() const {
+	uint64_t allocations, used, reserved;
+	Memory::get_small_alloc_stats(&allocations, &used, &reserved);
+
+	// Averaged over at least a second, monitors may be polled more often than that.
+	uint64_t ticks = OS::get_singleton()->get_ticks_usec();
+	if (ticks - _small_alloc_last_ticks >= 1000000) {
+		if (_small_alloc_last_ticks) {
+			_small_alloc_rate = (allocations - _small_alloc_last_count) * 1000000.0 / (ticks - _small_alloc_last_ticks);
+		}
+		_small_alloc_last_count = allocations;
+		_small_alloc_last_ticks = ticks;
+	}
+	return _small_alloc_rate;
+}
+
 String Performance::get_monitor_name(Monitor p_monitor) const {
 	ERR_FAIL_INDEX_V(p_monitor, MONITOR_MAX, String());
 	static const char *names[MONITOR_MAX] = {
@@ -115,6 +143,17 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"memory/small_allocs_per_second",
+		"memory/small_used",
+		"memory/small_reserved",
+		"object/message_queue_depth",
+		"object/message_queue_coalesced",
+		"object/scene_pool_parked",
+		"object/scene_pool_hits",
+		"object/scene_pool_misses",
+		"object/resource_cache_lookups",
+		"object/resource_cache_hits",
+		"time/resource_cache_lock_wait",
 
 	};
 
@@ -177,6 +216,34 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case MEMORY_SMALL_ALLOCATIONS_PER_SECOND:
+			return _get_small_alloc_rate();
+		case MEMORY_SMALL_USED: {
+			uint64_t allocations, used, reserved;
+			Memory::get_small_alloc_stats(&allocations, &used, &reserved);
+			return used;
+		}
+		case MEMORY_SMALL_RESERVED: {
+			uint64_t allocations, used, reserved;
+			Memory::get_small_alloc_stats(&allocations, &used, &reserved);
+			return reserved;
+		}
+		case OBJECT_MESSAGE_QUEUE_DEPTH:
+			return MessageQueue::get_singleton()->get_frame_message_count();
+		case OBJECT_MESSAGE_QUEUE_COALESCED:
+			return MessageQueue::get_singleton()->get_frame_coalesced_count();
+		case OBJECT_SCENE_POOL_PARKED:
+			return PackedScene::get_pool_parked_count();
+		case OBJECT_SCENE_POOL_HITS:
+			return PackedScene::get_pool_hit_count();
+		case OBJECT_SCENE_POOL_MISSES:
+			return PackedScene::get_pool_miss_count();
+		case OBJECT_RESOURCE_CACHE_LOOKUPS:
+			return ResourceCache::get_frame_stats().lookups;
+		case OBJECT_RESOURCE_CACHE_HITS:
+			return ResourceCache::get_frame_stats().hits;
+		case TIME_RESOURCE_CACHE_LOCK_WAIT:
+			return USEC_TO_SEC(ResourceCache::get_frame_stats().lock_wait_usec);
 
 		default: {
 		}
@@ -217,6 +284,17 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_TIME,
 
 	};
 
@@ -47,6 +47,12 @@ class Performance : public Object {
 	float _process_time;
 	float _physics_process_time;
 
+	mutable uint64_t _small_alloc_last_count = 0;
+	mutable uint64_t _small_alloc_last_ticks = 0;
+	mutable float _small_alloc_rate = 0;
+
+	float _get_small_alloc_rate() const;
+
 public:
 	enum Monitor {
 
@@ -78,6 +84,17 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		MEMORY_SMALL_ALLOCATIONS_PER_SECOND,
+		MEMORY_SMALL_USED,
+		MEMORY_SMALL_RESERVED,
+		OBJECT_MESSAGE_QUEUE_DEPTH,
+		OBJECT_MESSAGE_QUEUE_COALESCED,
+		OBJECT_SCENE_POOL_PARKED,
+		OBJECT_SCENE_POOL_HITS,
+		OBJECT_SCENE_POOL_MISSES,
+		OBJECT_RESOURCE_CACHE_LOOKUPS,
+		OBJECT_RESOURCE_CACHE_HITS,
+		TIME_RESOURCE_CACHE_LOCK_WAIT,
 		MONITOR_MAX
 	};
 
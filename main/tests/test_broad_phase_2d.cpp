@@ -0,0 +1,241 @@
+/*************************************************************************/
+/*  test_broad_phase_2d.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_broad_phase_2d.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "servers/physics_2d/body_2d_sw.h"
+#include "servers/physics_2d/broad_phase_2d_hash_grid.h"
+
+namespace TestBroadPhase2D {
+
+// The userdata is the number of live pairs.
+static void *_pair_callback(CollisionObject2DSW *p_A, int p_subindex_A, CollisionObject2DSW *p_B, int p_subindex_B, void *p_userdata) {
+	(*(int *)p_userdata)++;
+	return p_userdata;
+}
+
+static void _unpair_callback(CollisionObject2DSW *p_A, int p_subindex_A, CollisionObject2DSW *p_B, int p_subindex_B, void *p_data, void *p_userdata) {
+	(*(int *)p_userdata)--;
+}
+
+static const int FRAMES = 10;
+static const int QUERIES = 2000;
+static const int LARGE_BODIES = 4;
+
+struct SweepEntry {
+	real_t x;
+	int index;
+
+	bool operator<(const SweepEntry &p_other) const { return x < p_other.x; }
+};
+
+// Counts the expected pairs with a sort and sweep over the final rects.
+static int _get_expected_pairs(const Vector<Rect2> &p_rects, const Vector<bool> &p_is_static) {
+	Vector<SweepEntry> entries;
+	entries.resize(p_rects.size());
+	for (int i = 0; i < p_rects.size(); i++) {
+		entries.write[i].x = p_rects[i].position.x;
+		entries.write[i].index = i;
+	}
+	entries.sort();
+
+	int pairs = 0;
+	for (int i = 0; i < entries.size(); i++) {
+		int a = entries[i].index;
+		real_t end = p_rects[a].position.x + p_rects[a].size.x;
+		for (int j = i + 1; j < entries.size() && entries[j].x < end; j++) {
+			int b = entries[j].index;
+			if ((!p_is_static[a] || !p_is_static[b]) && p_rects[a].intersects(p_rects[b])) {
+				pairs++;
+			}
+		}
+	}
+	return pairs;
+}
+
+static bool _benchmark(int p_count) {
+	OS::get_singleton()->print("\n\n%d bodies\n", p_count);
+
+	// Keep the density the same for every count.
+	real_t extent = Math::sqrt((real_t)p_count) * 40.0;
+
+	uint64_t seed = 1234;
+	Vector<Body2DSW *> bodies;
+	Vector<Rect2> rects;
+	Vector<bool> is_static;
+	bodies.resize(p_count);
+	rects.resize(p_count);
+	is_static.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		bodies.write[i] = memnew(Body2DSW);
+
+		Vector2 pos(Math::rand_from_seed(&seed) % 10000, Math::rand_from_seed(&seed) % 10000);
+		Vector2 size(8 + Math::rand_from_seed(&seed) % 32, 8 + Math::rand_from_seed(&seed) % 32);
+		if (i < LARGE_BODIES) {
+			// Large enough to be kept out of the grid.
+			size *= 400.0;
+		}
+		rects.write[i] = Rect2(pos * (extent / 10000.0), size);
+		// One in ten bodies never moves, like level geometry.
+		is_static.write[i] = i < LARGE_BODIES || (i % 10) == 0;
+	}
+
+	BroadPhase2DSW *broadphase = BroadPhase2DHashGrid::_create();
+	int pairs = 0;
+	broadphase->set_pair_callback(_pair_callback, &pairs);
+	broadphase->set_unpair_callback(_unpair_callback, &pairs);
+
+	Vector<BroadPhase2DSW::ID> ids;
+	ids.resize(p_count);
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		BroadPhase2DSW::ID id = broadphase->create(bodies[i], 0);
+		broadphase->set_static(id, is_static[i]);
+		broadphase->move(id, rects[i]);
+		ids.write[i] = id;
+	}
+	broadphase->update();
+	uint64_t create_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	seed = 5678;
+	int moves = 0;
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int f = 0; f < FRAMES; f++) {
+		for (int i = 0; i < p_count; i++) {
+			if (is_static[i]) {
+				continue;
+			}
+			Vector2 motion(int(Math::rand_from_seed(&seed) % 201) - 100, int(Math::rand_from_seed(&seed) % 201) - 100);
+			rects.write[i].position += motion * 0.04;
+			broadphase->move(ids[i], rects[i]);
+			moves++;
+		}
+		broadphase->update();
+	}
+	uint64_t move_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	const int max_results = 4096;
+	CollisionObject2DSW *results[max_results];
+	int subindices[max_results];
+	uint64_t query_results = 0;
+	uint64_t expected_query_results = 0;
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < QUERIES; i++) {
+		Vector2 pos = rects[(i * 7919) % p_count].position;
+		if (i % 2) {
+			query_results += broadphase->cull_aabb(Rect2(pos, Vector2(64, 64)), results, max_results, subindices);
+		} else {
+			query_results += broadphase->cull_segment(pos, pos + Vector2(300, 120), results, max_results, subindices);
+		}
+	}
+	uint64_t query_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	for (int i = 0; i < QUERIES; i++) {
+		Vector2 pos = rects[(i * 7919) % p_count].position;
+		for (int j = 0; j < p_count; j++) {
+			if (i % 2 ? rects[j].intersects(Rect2(pos, Vector2(64, 64))) : rects[j].intersects_segment(pos, pos + Vector2(300, 120))) {
+				expected_query_results++;
+			}
+		}
+	}
+
+	int expected_pairs = _get_expected_pairs(rects, is_static);
+	int final_pairs = pairs;
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		broadphase->remove(ids[i]);
+	}
+	uint64_t remove_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	memdelete(broadphase);
+	for (int i = 0; i < p_count; i++) {
+		memdelete(bodies[i]);
+	}
+
+	OS::get_singleton()->print("\tcreate %d usec, remove %d usec\n", int(create_usec), int(remove_usec));
+	OS::get_singleton()->print("\t%d moves in %d usec, %d ns per move\n", moves, int(move_usec), int(move_usec * 1000 / MAX(moves, 1)));
+	OS::get_singleton()->print("\t%d queries in %d usec, %d results\n", QUERIES, int(query_usec), int(query_results));
+	OS::get_singleton()->print("\t%d pairs (%d expected)\n", final_pairs, expected_pairs);
+
+	bool state = final_pairs == expected_pairs;
+	state = state && query_results == expected_query_results;
+	state = state && pairs == 0;
+	return state;
+}
+
+static bool test_1() {
+	return _benchmark(1000);
+}
+
+static bool test_2() {
+	return _benchmark(20000);
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestBroadPhase2D
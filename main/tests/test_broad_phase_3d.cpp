@@ -0,0 +1,276 @@
+/*************************************************************************/
+/*  test_broad_phase_3d.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_broad_phase_3d.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "servers/physics_3d/body_3d_sw.h"
+#include "servers/physics_3d/broad_phase_3d_aabb_tree.h"
+#include "servers/physics_3d/broad_phase_octree.h"
+
+namespace TestBroadPhase3D {
+
+// Tracks the live pairs of a broadphase, so two implementations can be
+// compared without storing every pair. Both run on the same bodies, so the
+// pointers identify the same pairs.
+struct PairTracker {
+	int pairs = 0;
+	uint64_t checksum = 0;
+	uint64_t pair_events = 0;
+};
+
+static uint64_t _pair_key(CollisionObject3DSW *p_A, int p_subindex_A, CollisionObject3DSW *p_B, int p_subindex_B) {
+	uint64_t a = (uint64_t)p_A * 64 + p_subindex_A;
+	uint64_t b = (uint64_t)p_B * 64 + p_subindex_B;
+	if (a > b) {
+		SWAP(a, b);
+	}
+	uint64_t h = a * 0x9E3779B97F4A7C15ULL ^ (b + 0x632BE59BD9B4E019ULL);
+	h ^= h >> 29;
+	return h * 0xBF58476D1CE4E5B9ULL;
+}
+
+static void *_pair_callback(CollisionObject3DSW *p_A, int p_subindex_A, CollisionObject3DSW *p_B, int p_subindex_B, void *p_userdata) {
+	PairTracker *tracker = (PairTracker *)p_userdata;
+	tracker->pairs++;
+	tracker->pair_events++;
+	tracker->checksum += _pair_key(p_A, p_subindex_A, p_B, p_subindex_B);
+	return tracker;
+}
+
+static void _unpair_callback(CollisionObject3DSW *p_A, int p_subindex_A, CollisionObject3DSW *p_B, int p_subindex_B, void *p_data, void *p_userdata) {
+	PairTracker *tracker = (PairTracker *)p_userdata;
+	tracker->pairs--;
+	tracker->pair_events++;
+	tracker->checksum -= _pair_key(p_A, p_subindex_A, p_B, p_subindex_B);
+}
+
+struct BenchmarkResult {
+	uint64_t create_usec = 0;
+	uint64_t move_usec = 0;
+	uint64_t query_usec = 0;
+	uint64_t remove_usec = 0;
+	int pairs = 0;
+	uint64_t checksum = 0;
+	uint64_t pair_events = 0;
+	uint64_t query_results = 0;
+	bool pairs_released = false;
+};
+
+struct Scene {
+	Vector<Body3DSW *> bodies;
+	Vector<AABB> aabbs;
+	Vector<bool> is_static;
+	real_t extent = 0;
+};
+
+static const int FRAMES = 10;
+static const int QUERIES = 2000;
+
+static void _make_scene(Scene &r_scene, int p_count) {
+	// Keep the density the same for every count, so the number of pairs
+	// grows linearly with the number of elements.
+	r_scene.extent = Math::pow((real_t)p_count, (real_t)(1.0 / 3.0)) * 4.0;
+
+	uint64_t seed = 1234;
+	r_scene.bodies.resize(p_count);
+	r_scene.aabbs.resize(p_count);
+	r_scene.is_static.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		Body3DSW *body = memnew(Body3DSW);
+		r_scene.bodies.write[i] = body;
+
+		Vector3 pos(Math::rand_from_seed(&seed) % 10000, Math::rand_from_seed(&seed) % 10000, Math::rand_from_seed(&seed) % 10000);
+		Vector3 size(Math::rand_from_seed(&seed) % 100, Math::rand_from_seed(&seed) % 100, Math::rand_from_seed(&seed) % 100);
+		r_scene.aabbs.write[i] = AABB(pos * (r_scene.extent / 10000.0), size * 0.02 + Vector3(0.5, 0.5, 0.5));
+		// A quarter of the elements never move, like level geometry.
+		r_scene.is_static.write[i] = (i % 4) == 0;
+	}
+}
+
+static void _free_scene(Scene &r_scene) {
+	for (int i = 0; i < r_scene.bodies.size(); i++) {
+		memdelete(r_scene.bodies[i]);
+	}
+	r_scene.bodies.clear();
+}
+
+static BenchmarkResult _run(BroadPhase3DSW *p_broadphase, const Scene &p_scene) {
+	BenchmarkResult result;
+	PairTracker tracker;
+	p_broadphase->set_pair_callback(_pair_callback, &tracker);
+	p_broadphase->set_unpair_callback(_unpair_callback, &tracker);
+
+	int count = p_scene.bodies.size();
+	Vector<BroadPhase3DSW::ID> ids;
+	ids.resize(count);
+	Vector<AABB> aabbs = p_scene.aabbs;
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		BroadPhase3DSW::ID id = p_broadphase->create(p_scene.bodies[i], 0);
+		p_broadphase->set_static(id, p_scene.is_static[i]);
+		p_broadphase->move(id, aabbs[i]);
+		ids.write[i] = id;
+	}
+	p_broadphase->update();
+	result.create_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	uint64_t seed = 5678;
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int f = 0; f < FRAMES; f++) {
+		for (int i = 0; i < count; i++) {
+			if (p_scene.is_static[i]) {
+				continue;
+			}
+			Vector3 motion(int(Math::rand_from_seed(&seed) % 201) - 100, int(Math::rand_from_seed(&seed) % 201) - 100, int(Math::rand_from_seed(&seed) % 201) - 100);
+			aabbs.write[i].position += motion * 0.002;
+			p_broadphase->move(ids[i], aabbs[i]);
+		}
+		p_broadphase->update();
+	}
+	result.move_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	const int max_results = 4096;
+	CollisionObject3DSW *results[max_results];
+	int subindices[max_results];
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < QUERIES; i++) {
+		Vector3 pos = aabbs[(i * 7919) % count].position;
+		switch (i % 3) {
+			case 0: {
+				result.query_results += p_broadphase->cull_aabb(AABB(pos, Vector3(2, 2, 2)), results, max_results, subindices);
+			} break;
+			case 1: {
+				result.query_results += p_broadphase->cull_point(pos + Vector3(0.25, 0.25, 0.25), results, max_results, subindices);
+			} break;
+			case 2: {
+				result.query_results += p_broadphase->cull_segment(pos, pos + Vector3(5, 1, 3), results, max_results, subindices);
+			} break;
+		}
+	}
+	result.query_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	result.pairs = tracker.pairs;
+	result.checksum = tracker.checksum;
+	result.pair_events = tracker.pair_events;
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		p_broadphase->remove(ids[i]);
+	}
+	result.remove_usec = OS::get_singleton()->get_ticks_usec() - start;
+	result.pairs_released = tracker.pairs == 0 && tracker.checksum == 0;
+
+	return result;
+}
+
+static void _print_result(const char *p_name, const BenchmarkResult &p_result) {
+	OS::get_singleton()->print("\t%-10s create %6d usec, %d frames of moves %8d usec, %d queries %6d usec, remove %6d usec\n", p_name, int(p_result.create_usec), FRAMES, int(p_result.move_usec), QUERIES, int(p_result.query_usec), int(p_result.remove_usec));
+	OS::get_singleton()->print("\t%-10s %d pairs, %d pair events, %d query results\n", "", p_result.pairs, int(p_result.pair_events), int(p_result.query_results));
+}
+
+static bool _benchmark(int p_count) {
+	OS::get_singleton()->print("\n\n%d elements\n", p_count);
+
+	Scene scene;
+	_make_scene(scene, p_count);
+
+	BroadPhase3DSW *octree = BroadPhaseOctree::_create();
+	BenchmarkResult octree_result = _run(octree, scene);
+	memdelete(octree);
+	_print_result("octree", octree_result);
+
+	BroadPhase3DSW *tree = BroadPhase3DAABBTree::_create();
+	BenchmarkResult tree_result = _run(tree, scene);
+	memdelete(tree);
+	_print_result("aabb tree", tree_result);
+
+	_free_scene(scene);
+
+	// Both must report the same pairs and find the same elements.
+	bool state = octree_result.pairs_released && tree_result.pairs_released;
+	state = state && octree_result.pairs == tree_result.pairs;
+	state = state && octree_result.checksum == tree_result.checksum;
+	state = state && octree_result.query_results == tree_result.query_results;
+	return state;
+}
+
+static bool test_1() {
+	return _benchmark(1000);
+}
+
+static bool test_2() {
+	return _benchmark(10000);
+}
+
+static bool test_3() {
+	return _benchmark(50000);
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestBroadPhase3D
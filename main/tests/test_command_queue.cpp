@@ -0,0 +1,221 @@
+/*************************************************************************/
+/*  test_command_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_command_queue.h"
+
+#include "core/command_queue_mt.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+
+namespace TestCommandQueue {
+
+enum {
+	MAX_PRODUCERS = 8
+};
+
+struct Receiver {
+	uint32_t last[MAX_PRODUCERS];
+	uint64_t received = 0;
+	bool in_order = true;
+	bool exit = false;
+
+	void receive(uint32_t p_producer, uint32_t p_value) {
+		if (p_value != last[p_producer] + 1) {
+			in_order = false;
+		}
+		last[p_producer] = p_value;
+		received++;
+	}
+
+	uint64_t get_received() {
+		return received;
+	}
+
+	void quit() {
+		exit = true;
+	}
+
+	Receiver() {
+		for (int i = 0; i < MAX_PRODUCERS; i++) {
+			last[i] = 0;
+		}
+	}
+};
+
+struct Context {
+	CommandQueueMT *queue = nullptr;
+	Receiver *receiver = nullptr;
+	uint32_t producer = 0;
+	uint32_t commands = 0;
+	uint32_t sync_every = 0;
+};
+
+static void consumer_thread(void *p_ud) {
+	Context *c = (Context *)p_ud;
+	while (!c->receiver->exit) {
+		c->queue->wait_and_flush_one();
+	}
+}
+
+static void producer_thread(void *p_ud) {
+	Context *c = (Context *)p_ud;
+	for (uint32_t i = 1; i <= c->commands; i++) {
+		c->queue->push(c->receiver, &Receiver::receive, c->producer, i);
+		if (c->sync_every && i % c->sync_every == 0) {
+			uint64_t received;
+			c->queue->push_and_ret(c->receiver, &Receiver::get_received, &received);
+		}
+	}
+}
+
+// Pushes from several threads at once to a queue flushed by its own thread.
+// Returns the time taken in microseconds, or 0 if commands went missing or
+// were run out of order.
+static uint64_t run(bool p_lock_free, uint32_t p_producers, uint32_t p_commands, uint32_t p_sync_every) {
+	CommandQueueMT queue(true, p_lock_free);
+	Receiver receiver;
+
+	Context consumer;
+	consumer.queue = &queue;
+	consumer.receiver = &receiver;
+	Thread *consumer_thread_ptr = Thread::create(consumer_thread, &consumer);
+
+	Context producers[MAX_PRODUCERS];
+	Thread *threads[MAX_PRODUCERS];
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < p_producers; i++) {
+		producers[i].queue = &queue;
+		producers[i].receiver = &receiver;
+		producers[i].producer = i;
+		producers[i].commands = p_commands / p_producers;
+		producers[i].sync_every = p_sync_every;
+		threads[i] = Thread::create(producer_thread, &producers[i]);
+	}
+	for (uint32_t i = 0; i < p_producers; i++) {
+		Thread::wait_to_finish(threads[i]);
+	}
+	queue.push_and_sync(&receiver, &Receiver::quit);
+	uint64_t time = OS::get_singleton()->get_ticks_usec() - from;
+
+	Thread::wait_to_finish(consumer_thread_ptr);
+
+	bool state = receiver.in_order && receiver.received == uint64_t(p_commands / p_producers) * p_producers;
+	return state ? MAX(time, 1) : 0;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: lock-free ordering and sync\n");
+
+	bool state = true;
+	for (uint32_t producers = 1; producers <= 4; producers++) {
+		state = state && run(true, producers, 100000, 1000) != 0;
+	}
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: throughput\n");
+
+	const uint32_t commands = 4000000;
+	bool state = true;
+	for (uint32_t producers = 1; producers <= MAX_PRODUCERS; producers *= 2) {
+		uint64_t ring = run(false, producers, commands, 0);
+		uint64_t lock_free = run(true, producers, commands, 0);
+		state = state && ring && lock_free;
+		OS::get_singleton()->print("\t%i producers, %i commands: ring buffer %.1f msec, lock-free %.1f msec\n", producers, commands, ring / 1000.0, lock_free / 1000.0);
+	}
+	return state;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: lock-free flush_all\n");
+
+	// Draining the queue puts the stub back behind the last command. Flushing
+	// again, before or after the next push, must not run any command twice.
+	CommandQueueMT queue(false, true);
+	Receiver receiver;
+	uint32_t pushed = 0;
+	for (uint32_t i = 0; i < 100; i++) {
+		for (uint32_t j = 0; j <= i % 3; j++) {
+			pushed++;
+			queue.push(&receiver, &Receiver::receive, 0, pushed);
+		}
+		queue.flush_all();
+		if (receiver.received != pushed) {
+			break;
+		}
+		queue.flush_all();
+		if (receiver.received != pushed) {
+			break;
+		}
+	}
+
+	OS::get_singleton()->print("\tPushed %i, received %i\n", pushed, (int)receiver.received);
+	return receiver.in_order && receiver.received == pushed;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestCommandQueue
@@ -0,0 +1,376 @@
+/*************************************************************************/
+/*  test_file_access_compressed.cpp                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_file_access_compressed.h"
+
+#include "core/io/file_access_compressed.h"
+#include "core/io/resource_saver.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+#include "scene/resources/curve.h"
+#include "scene/resources/gradient.h"
+#include "scene/resources/style_box.h"
+
+namespace TestFileAccessCompressed {
+
+static const int DATA_SIZE = 4 * 1024 * 1024 + 123; // Last block is a partial one.
+
+static Vector<uint8_t> make_data() {
+	Vector<uint8_t> data;
+	data.resize(DATA_SIZE);
+	uint32_t seed = 1234;
+	for (int i = 0; i < DATA_SIZE; i++) {
+		// Compressible, but not trivially.
+		seed = seed * 1103515245 + 12345;
+		data.write[i] = (i & 0xF0) ^ ((seed >> 16) & 0x7);
+	}
+	return data;
+}
+
+static String file_path(int p_block_size) {
+	return OS::get_singleton()->get_cache_path().plus_file("test_compressed_" + itos(p_block_size) + ".bin");
+}
+
+static bool write_file(const Vector<uint8_t> &p_data, int p_block_size) {
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("TEST", Compression::MODE_ZSTD, p_block_size);
+	if (fac->_open(file_path(p_block_size), FileAccess::WRITE) != OK) {
+		memdelete(fac);
+		return false;
+	}
+	fac->store_buffer(p_data.ptr(), p_data.size());
+	memdelete(fac); // Compresses and writes on close.
+	return true;
+}
+
+static FileAccessCompressed *open_file(int p_block_size) {
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("TEST");
+	if (fac->_open(file_path(p_block_size), FileAccess::READ) != OK) {
+		memdelete(fac);
+		return nullptr;
+	}
+	return fac;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: reads match what was written\n");
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(OS::get_singleton()->get_cache_path());
+	memdelete(da);
+
+	Vector<uint8_t> data = make_data();
+	const int block_sizes[] = { 4096, 65536, 1 << 20 };
+	bool state = true;
+
+	for (int b = 0; b < 3; b++) {
+		if (!write_file(data, block_sizes[b])) {
+			return false;
+		}
+
+		for (int read_ahead = 0; read_ahead <= 4; read_ahead += 4) {
+			FileAccessCompressed::set_read_ahead_blocks(read_ahead);
+			FileAccessCompressed *fac = open_file(block_sizes[b]);
+			if (!fac) {
+				return false;
+			}
+			state = state && fac->get_len() == (size_t)DATA_SIZE;
+
+			// Mixed sizes, crossing blocks and covering several of them.
+			Vector<uint8_t> read;
+			read.resize(DATA_SIZE);
+			int pos = 0;
+			int step = 0;
+			while (pos < DATA_SIZE) {
+				int len = MIN((step % 3 == 0) ? 1 + step * 7 : (step % 3 == 1 ? 300000 + step : 1), DATA_SIZE - pos);
+				if (len == 1) {
+					read.write[pos] = fac->get_8();
+				} else {
+					state = state && fac->get_buffer(read.ptrw() + pos, len) == len;
+				}
+				pos += len;
+				step++;
+			}
+			state = state && memcmp(read.ptr(), data.ptr(), DATA_SIZE) == 0;
+
+			// Past the end.
+			uint8_t extra[8];
+			state = state && fac->get_buffer(extra, 8) == 0 && fac->eof_reached();
+
+			// Seeking back and forth.
+			const int positions[] = { DATA_SIZE - 10, 5, DATA_SIZE / 2, 70000, 0 };
+			for (int i = 0; i < 5; i++) {
+				fac->seek(positions[i]);
+				uint8_t buf[10];
+				state = state && fac->get_buffer(buf, 10) == 10 && memcmp(buf, data.ptr() + positions[i], 10) == 0;
+			}
+			memdelete(fac);
+		}
+	}
+
+	FileAccessCompressed::set_read_ahead_blocks(4);
+	return state;
+}
+
+static uint64_t time_read(int p_block_size, int p_chunk) {
+	FileAccessCompressed *fac = open_file(p_block_size);
+	if (!fac) {
+		return 0;
+	}
+
+	Vector<uint8_t> read;
+	read.resize(DATA_SIZE);
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int pos = 0; pos < DATA_SIZE; pos += p_chunk) {
+		fac->get_buffer(read.ptrw() + pos, MIN(p_chunk, DATA_SIZE - pos));
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+	memdelete(fac);
+	return elapsed;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: read benchmark (%i threads)\n", ThreadWorkPool::get_singleton()->get_thread_count());
+
+	const int block_sizes[] = { 4096, 65536, 1 << 20 };
+	for (int b = 0; b < 3; b++) {
+		FileAccessCompressed::set_read_ahead_blocks(0);
+		uint64_t small = time_read(block_sizes[b], 1024);
+		FileAccessCompressed::set_read_ahead_blocks(4);
+		uint64_t ahead = time_read(block_sizes[b], 1024);
+		uint64_t bulk = time_read(block_sizes[b], DATA_SIZE);
+
+		OS::get_singleton()->print("\tblock %i: 1K reads %llu usec, with read ahead %llu usec, single read %llu usec\n", block_sizes[b], (unsigned long long)small, (unsigned long long)ahead, (unsigned long long)bulk);
+	}
+
+	return true;
+}
+
+// Small binary resources, which on their own compress poorly.
+static Vector<Vector<uint8_t>> make_resources(int p_count) {
+	Vector<Vector<uint8_t>> files;
+	String path = OS::get_singleton()->get_cache_path().plus_file("test_dict_resource.res");
+
+	for (int i = 0; i < p_count; i++) {
+		Ref<Resource> res;
+		switch (i % 3) {
+			case 0: {
+				Ref<StyleBoxFlat> style;
+				style.instance();
+				style->set_bg_color(Color(i % 7 / 7.0, i % 5 / 5.0, 0.5));
+				style->set_corner_radius_all(i % 12);
+				style->set_border_width_all(i % 4);
+				res = style;
+			} break;
+			case 1: {
+				Ref<Curve> curve;
+				curve.instance();
+				for (int j = 0; j < 4 + i % 5; j++) {
+					curve->add_point(Vector2(j / 8.0, (i * 31 + j * 17) % 100 / 100.0));
+				}
+				res = curve;
+			} break;
+			case 2: {
+				Ref<Gradient> gradient;
+				gradient.instance();
+				gradient->add_point(0.25 + i % 10 / 20.0, Color(0.1 * (i % 10), 0.2, 0.3));
+				res = gradient;
+			} break;
+		}
+
+		if (ResourceSaver::save(path, res) != OK) {
+			return Vector<Vector<uint8_t>>();
+		}
+		files.push_back(FileAccess::get_file_as_array(path));
+	}
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(path);
+	memdelete(da);
+	return files;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: files compressed with a dictionary\n");
+
+	Vector<Vector<uint8_t>> samples;
+	Vector<uint8_t> data = make_data();
+	for (int i = 0; i < 64; i++) {
+		samples.push_back(data.subarray(i * 4096, i * 4096 + 1023));
+	}
+	uint32_t id = Compression::add_zstd_dictionary(Compression::train_zstd_dictionary(samples, 4096));
+	if (!id) {
+		return false;
+	}
+
+	bool state = true;
+	String path = file_path(0);
+	for (int embed = 0; embed < 2; embed++) {
+		FileAccessCompressed *fac = memnew(FileAccessCompressed);
+		fac->configure("TEST", Compression::MODE_ZSTD_DICT, 4096);
+		fac->set_zstd_dictionary(id, embed);
+		if (fac->_open(path, FileAccess::WRITE) != OK) {
+			memdelete(fac);
+			return false;
+		}
+		fac->store_buffer(data.ptr(), 100000);
+		memdelete(fac);
+
+		fac = memnew(FileAccessCompressed);
+		fac->configure("TEST");
+		if (fac->_open(path, FileAccess::READ) != OK) {
+			memdelete(fac);
+			return false;
+		}
+		Vector<uint8_t> read;
+		read.resize(100000);
+		state = state && fac->get_len() == 100000 && fac->get_buffer(read.ptrw(), 100000) == 100000;
+		state = state && memcmp(read.ptr(), data.ptr(), 100000) == 0;
+		memdelete(fac);
+	}
+
+	// A dictionary size past the end of the file is refused (prints an error).
+	OS::get_singleton()->print("\tExpecting an error:\n");
+	FileAccess *f = FileAccess::open(path, FileAccess::WRITE);
+	if (!f) {
+		return false;
+	}
+	f->store_buffer((const uint8_t *)"TEST", 4);
+	f->store_32(Compression::MODE_ZSTD_DICT);
+	f->store_32(4096);
+	f->store_32(100000);
+	f->store_32(0x7FFFFFFF);
+	memdelete(f);
+
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("TEST");
+	state = state && fac->_open(path, FileAccess::READ) != OK;
+	memdelete(fac);
+
+	return state;
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: dictionary benchmark on binary resources\n");
+
+	Vector<Vector<uint8_t>> files = make_resources(600);
+	if (files.size() == 0) {
+		return false;
+	}
+
+	// Trained on one half, measured on the other.
+	Vector<Vector<uint8_t>> samples;
+	for (int i = 0; i < files.size(); i += 2) {
+		samples.push_back(files[i]);
+	}
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	Vector<uint8_t> dict = Compression::train_zstd_dictionary(samples, 16384);
+	uint64_t train_time = OS::get_singleton()->get_ticks_usec() - begin;
+	uint32_t id = Compression::add_zstd_dictionary(dict);
+	if (!id) {
+		return false;
+	}
+	OS::get_singleton()->print("\t%i byte dictionary trained in %llu usec\n", dict.size(), (unsigned long long)train_time);
+
+	bool state = true;
+	uint64_t sizes[2] = { 0, 0 };
+	uint64_t compressed[2] = { 0, 0 };
+	uint64_t compress_time[2] = { 0, 0 };
+	uint64_t decompress_time[2] = { 0, 0 };
+	const Compression::Mode modes[2] = { Compression::MODE_ZSTD, Compression::MODE_ZSTD_DICT };
+	Vector<uint8_t> comp;
+	Vector<uint8_t> decomp;
+
+	for (int m = 0; m < 2; m++) {
+		for (int i = 1; i < files.size(); i += 2) {
+			const Vector<uint8_t> &file = files[i];
+			comp.resize(Compression::get_max_compressed_buffer_size(file.size(), modes[m]));
+			decomp.resize(file.size());
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			int size = Compression::compress(comp.ptrw(), file.ptr(), file.size(), modes[m], id);
+			compress_time[m] += OS::get_singleton()->get_ticks_usec() - begin;
+
+			begin = OS::get_singleton()->get_ticks_usec();
+			int ret = Compression::decompress(decomp.ptrw(), file.size(), comp.ptr(), size, modes[m], id);
+			decompress_time[m] += OS::get_singleton()->get_ticks_usec() - begin;
+
+			state = state && ret == file.size() && memcmp(decomp.ptr(), file.ptr(), file.size()) == 0;
+			sizes[m] += file.size();
+			compressed[m] += size;
+		}
+
+		OS::get_singleton()->print("\t%s: ratio %.2f, compress %.1f MB/s, decompress %.1f MB/s\n", m ? "zstd with dictionary" : "zstd", double(sizes[m]) / compressed[m],
+				sizes[m] / double(MAX(compress_time[m], 1ull)), sizes[m] / double(MAX(decompress_time[m], 1ull)));
+	}
+
+	return state && compressed[1] < compressed[0];
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestFileAccessCompressed
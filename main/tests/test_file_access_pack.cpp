@@ -0,0 +1,286 @@
+/*************************************************************************/
+/*  test_file_access_pack.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_file_access_pack.h"
+
+#include "core/io/file_access_pack.h"
+#include "core/io/pck_packer.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+
+namespace TestFileAccessPack {
+
+static const int FILE_COUNT = 4000;
+static const int SOURCE_COUNT = 8;
+
+static String source_path(int p_index) {
+	return OS::get_singleton()->get_cache_path().plus_file("test_pack_src_" + itos(p_index) + ".bin");
+}
+
+static Vector<uint8_t> source_data(int p_index) {
+	Vector<uint8_t> data;
+	data.resize(64 << p_index);
+	for (int i = 0; i < data.size(); i++) {
+		data.write[i] = (i * 31 + p_index) & 0xFF;
+	}
+	return data;
+}
+
+static String packed_path(const String &p_dir, int p_index) {
+	return "res://" + p_dir + "/" + itos(p_index / 100) + "/file_" + itos(p_index) + ".bin";
+}
+
+static bool make_pack(const String &p_pack, const String &p_dir) {
+	Ref<PCKPacker> packer;
+	packer.instance();
+	if (packer->pck_start(p_pack) != OK) {
+		return false;
+	}
+	for (int i = 0; i < FILE_COUNT; i++) {
+		packer->add_file(packed_path(p_dir, i), source_path(i % SOURCE_COUNT));
+	}
+	return packer->flush() == OK;
+}
+
+// Opens and reads every file in the pack, returns false if any differs.
+static bool read_all(const String &p_dir, uint64_t &r_usec) {
+	Vector<uint8_t> sources[SOURCE_COUNT];
+	for (int i = 0; i < SOURCE_COUNT; i++) {
+		sources[i] = source_data(i);
+	}
+
+	Vector<uint8_t> buffer;
+	buffer.resize(64 << (SOURCE_COUNT - 1));
+	bool state = true;
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < FILE_COUNT; i++) {
+		FileAccess *f = FileAccess::open(packed_path(p_dir, i), FileAccess::READ);
+		if (!f) {
+			return false;
+		}
+		const Vector<uint8_t> &src = sources[i % SOURCE_COUNT];
+		int len = f->get_len();
+		int read = f->get_buffer(buffer.ptrw(), len);
+		state = state && len == src.size() && read == len && memcmp(buffer.ptr(), src.ptr(), len) == 0;
+		memdelete(f);
+	}
+	r_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+	return state;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: read %i files from a pack, with and without mmap\n", FILE_COUNT);
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(OS::get_singleton()->get_cache_path());
+	memdelete(da);
+	for (int i = 0; i < SOURCE_COUNT; i++) {
+		FileAccess *f = FileAccess::open(source_path(i), FileAccess::WRITE);
+		if (!f) {
+			return false;
+		}
+		Vector<uint8_t> data = source_data(i);
+		f->store_buffer(data.ptr(), data.size());
+		memdelete(f);
+	}
+
+	// Packs can't be removed once added, so each mode gets its own.
+	String pack_copy = OS::get_singleton()->get_cache_path().plus_file("test_pack_copy.pck");
+	String pack_mmap = OS::get_singleton()->get_cache_path().plus_file("test_pack_mmap.pck");
+	if (!make_pack(pack_copy, "test_pack_copy") || !make_pack(pack_mmap, "test_pack_mmap")) {
+		return false;
+	}
+
+	PackedData *packed_data = PackedData::get_singleton();
+	bool was_using_mmap = packed_data->is_using_mmap();
+	bool was_disabled = packed_data->is_disabled();
+	packed_data->set_disabled(false);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	packed_data->set_use_mmap(false);
+	bool state = packed_data->add_pack(pack_copy, false) == OK;
+	uint64_t add_copy = OS::get_singleton()->get_ticks_usec() - begin;
+
+	begin = OS::get_singleton()->get_ticks_usec();
+	packed_data->set_use_mmap(true);
+	state = state && packed_data->add_pack(pack_mmap, false) == OK;
+	uint64_t add_mmap = OS::get_singleton()->get_ticks_usec() - begin;
+	packed_data->set_use_mmap(was_using_mmap);
+
+	uint64_t read_copy = 0;
+	uint64_t read_mmap = 0;
+	state = state && read_all("test_pack_copy", read_copy);
+	state = state && read_all("test_pack_mmap", read_mmap);
+
+	OS::get_singleton()->print("\tadd_pack, copy: %llu usec, mmap: %llu usec\n", (unsigned long long)add_copy, (unsigned long long)add_mmap);
+	OS::get_singleton()->print("\topen and read all, copy: %llu usec, mmap: %llu usec\n", (unsigned long long)read_copy, (unsigned long long)read_mmap);
+
+	// Spans are only available on mapped packs.
+	FileAccess *f = FileAccess::open(packed_path("test_pack_mmap", 3), FileAccess::READ);
+	if (f) {
+		Vector<uint8_t> src = source_data(3);
+		f->seek(16);
+		const uint8_t *span = f->get_buffer_span(src.size() - 16);
+		bool supported = span != nullptr;
+		OS::get_singleton()->print("\tspan available: %s\n", supported ? "yes" : "no");
+		if (supported) {
+			state = state && memcmp(span, src.ptr() + 16, src.size() - 16) == 0 && f->get_position() == (size_t)src.size();
+			state = state && f->get_buffer_span(1) == nullptr; // Past the end.
+		}
+		memdelete(f);
+	} else {
+		state = false;
+	}
+
+	packed_data->set_disabled(was_disabled);
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: lookups and directories of indexed packs\n");
+
+	PackedData *packed_data = PackedData::get_singleton();
+	bool state = packed_data->has_path(packed_path("test_pack_mmap", FILE_COUNT - 1));
+	state = state && !packed_data->has_path(packed_path("test_pack_mmap", FILE_COUNT));
+
+	const int lookups = FILE_COUNT * 2 * 12;
+	int found = 0;
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < lookups; i++) {
+		found += packed_data->has_path(packed_path("test_pack_copy", i % (FILE_COUNT * 2))) ? 1 : 0;
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+	OS::get_singleton()->print("\t%i lookups: %llu usec\n", lookups, (unsigned long long)elapsed);
+	state = state && found == lookups / 2;
+
+	// The directory tree of indexed packs is only built here.
+	DirAccessPack *da = memnew(DirAccessPack);
+	int files = 0;
+	if (da->change_dir("res://test_pack_mmap/3") == OK) {
+		da->list_dir_begin();
+		for (String f = da->get_next(); f != String(); f = da->get_next()) {
+			files += da->current_is_dir() ? 0 : 1;
+		}
+		da->list_dir_end();
+	}
+	state = state && files == 100 && da->file_exists("file_300.bin") && !da->file_exists("file_400.bin");
+	memdelete(da);
+
+	return state;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: mapped pack with an index pointing outside of it\n");
+
+	String pack = OS::get_singleton()->get_cache_path().plus_file("test_pack_bad.pck");
+	if (!make_pack(pack, "test_pack_bad")) {
+		return false;
+	}
+
+	// Moves the first file in the index past the end of the pack.
+	FileAccess *f = FileAccess::open(pack, FileAccess::READ_WRITE);
+	if (!f) {
+		return false;
+	}
+	f->seek(PACK_INDEX_OFFSET_POS);
+	uint64_t index_ofs = f->get_64();
+	f->seek(index_ofs + 8 + 16);
+	f->store_64(f->get_len() + 1024);
+	memdelete(f);
+
+	PackedData *packed_data = PackedData::get_singleton();
+	bool was_using_mmap = packed_data->is_using_mmap();
+	bool was_disabled = packed_data->is_disabled();
+	packed_data->set_disabled(false);
+	packed_data->set_use_mmap(true);
+	OS::get_singleton()->print("\tExpecting a warning:\n");
+	bool state = packed_data->add_pack(pack, false) == OK;
+	packed_data->set_use_mmap(was_using_mmap);
+
+	// Read without the mapping, only the moved file comes back short.
+	Vector<uint8_t> buffer;
+	buffer.resize(64 << (SOURCE_COUNT - 1));
+	int matching = 0;
+	for (int i = 0; i < FILE_COUNT && state; i++) {
+		f = FileAccess::open(packed_path("test_pack_bad", i), FileAccess::READ);
+		if (!f) {
+			state = false;
+			break;
+		}
+		Vector<uint8_t> src = source_data(i % SOURCE_COUNT);
+		int read = f->get_buffer(buffer.ptrw(), f->get_len());
+		matching += read == src.size() && memcmp(buffer.ptr(), src.ptr(), read) == 0 ? 1 : 0;
+		memdelete(f);
+	}
+	state = state && matching == FILE_COUNT - 1;
+
+	packed_data->set_disabled(was_disabled);
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestFileAccessPack
@@ -0,0 +1,276 @@
+/*************************************************************************/
+/*  test_flat_hash_map.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_flat_hash_map.h"
+
+#include "core/flat_hash_map.h"
+#include "core/hash_map.h"
+#include "core/oa_hash_map.h"
+#include "core/os/os.h"
+#include "core/string_name.h"
+
+namespace TestFlatHashMap {
+
+// Thin adapters so the same benchmark code runs on every map.
+
+template <class K>
+struct BenchHashMap {
+	static const char *get_name() { return "HashMap"; }
+	HashMap<K, int> map;
+	void insert(const K &p_key, int p_value) { map.set(p_key, p_value); }
+	int *lookup(const K &p_key) { return map.getptr(p_key); }
+	void erase(const K &p_key) { map.erase(p_key); }
+	int iterate() {
+		int sum = 0;
+		const K *k = nullptr;
+		while ((k = map.next(k))) {
+			sum += *map.getptr(*k);
+		}
+		return sum;
+	}
+};
+
+template <class K>
+struct BenchOAHashMap {
+	static const char *get_name() { return "OAHashMap"; }
+	OAHashMap<K, int> map;
+	void insert(const K &p_key, int p_value) { map.set(p_key, p_value); }
+	int *lookup(const K &p_key) { return map.lookup_ptr(p_key); }
+	void erase(const K &p_key) { map.remove(p_key); }
+	int iterate() {
+		int sum = 0;
+		for (typename OAHashMap<K, int>::Iterator it = map.iter(); it.valid; it = map.next_iter(it)) {
+			sum += *it.value;
+		}
+		return sum;
+	}
+};
+
+template <class K>
+struct BenchFlatHashMap {
+	static const char *get_name() { return "FlatHashMap"; }
+	FlatHashMap<K, int> map;
+	void insert(const K &p_key, int p_value) { map.set(p_key, p_value); }
+	int *lookup(const K &p_key) { return map.getptr(p_key); }
+	void erase(const K &p_key) { map.erase(p_key); }
+	int iterate() {
+		int sum = 0;
+		const K *k = nullptr;
+		while ((k = map.next(k))) {
+			sum += *map.getptr(*k);
+		}
+		return sum;
+	}
+};
+
+template <class M, class K>
+static void benchmark(const char *p_key_type, const Vector<K> &p_keys, const Vector<K> &p_missing) {
+	M m;
+	int count = p_keys.size();
+	int found = 0;
+
+	uint64_t t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		m.insert(p_keys[i], i);
+	}
+	uint64_t insert_time = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int pass = 0; pass < 4; pass++) {
+		for (int i = 0; i < count; i++) {
+			found += m.lookup(p_keys[i]) != nullptr;
+			found += m.lookup(p_missing[i]) != nullptr;
+		}
+	}
+	uint64_t lookup_time = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	int sum = 0;
+	for (int pass = 0; pass < 4; pass++) {
+		sum += m.iterate();
+	}
+	uint64_t iterate_time = OS::get_singleton()->get_ticks_usec() - t;
+
+	t = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		m.erase(p_keys[i]);
+	}
+	uint64_t erase_time = OS::get_singleton()->get_ticks_usec() - t;
+
+	OS::get_singleton()->print("\t%-12s %-10s insert %6.2f ms, lookup %6.2f ms, iterate %6.2f ms, erase %6.2f ms (%d, %d)\n",
+			M::get_name(), p_key_type, insert_time / 1000.0, lookup_time / 1000.0, iterate_time / 1000.0, erase_time / 1000.0, found, sum);
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: set, get and overwrite\n");
+
+	FlatHashMap<int, int> map;
+	map.set(42, 1337);
+	map.set(1337, 21);
+	map.set(42, 11880);
+	map[7] = 3;
+
+	OS::get_singleton()->print("\tsize %d, map[42] = %d\n", map.size(), map[42]);
+	return map.size() == 3 && map[42] == 11880 && map[1337] == 21 && map[7] == 3 && !map.has(8);
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: rehashing and deletion\n");
+
+	FlatHashMap<int, int> map;
+	for (int i = 0; i < 5000; i++) {
+		map.set(i, i * 2);
+	}
+	for (int i = 0; i < 5000; i += 2) {
+		map.erase(i);
+	}
+
+	int num_elems = 0;
+	bool state = true;
+	for (int i = 0; i < 5000; i++) {
+		const int *v = map.getptr(i);
+		if (v) {
+			num_elems++;
+			state = state && *v == i * 2;
+		}
+		state = state && (v != nullptr) == (i % 2 == 1);
+	}
+
+	OS::get_singleton()->print("\telements %d == %d\n", map.size(), num_elems);
+	return state && map.size() == (uint32_t)num_elems && num_elems == 2500;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: churn (tombstone reuse)\n");
+
+	FlatHashMap<int, int> map;
+	bool state = true;
+	for (int i = 0; i < 100000; i++) {
+		map.set(i, i);
+		if (i >= 10) {
+			state = state && map.erase(i - 10);
+		}
+	}
+
+	OS::get_singleton()->print("\telements %d\n", map.size());
+	return state && map.size() == 10 && map.has(99999) && !map.has(99989);
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: iteration and copy\n");
+
+	FlatHashMap<String, int> map;
+	map.set("Hello", 1);
+	map.set("World", 2);
+	map.set("Godot rocks", 42);
+
+	FlatHashMap<String, int> copy = map;
+	map.erase("World");
+
+	int sum = 0;
+	const String *k = nullptr;
+	while ((k = copy.next(k))) {
+		OS::get_singleton()->print("\t%s => %d\n", k->utf8().get_data(), copy[*k]);
+		sum += copy[*k];
+	}
+
+	// Erasing everything while restarting iteration (as Object does with its signals).
+	while ((k = copy.next(nullptr))) {
+		copy.erase(*k);
+	}
+
+	return sum == 45 && map.size() == 2 && copy.empty();
+}
+
+static bool test_5() {
+	OS::get_singleton()->print("\n\nTest 5: benchmark\n");
+
+	const int count = 100000;
+
+	Vector<int> int_keys;
+	Vector<int> int_missing;
+	Vector<StringName> name_keys;
+	Vector<StringName> name_missing;
+	for (int i = 0; i < count; i++) {
+		int_keys.push_back(i * 7919);
+		int_missing.push_back(i * 7919 + 1);
+		name_keys.push_back(StringName("key_" + itos(i)));
+		name_missing.push_back(StringName("missing_" + itos(i)));
+	}
+
+	benchmark<BenchHashMap<int>>("int", int_keys, int_missing);
+	benchmark<BenchOAHashMap<int>>("int", int_keys, int_missing);
+	benchmark<BenchFlatHashMap<int>>("int", int_keys, int_missing);
+	benchmark<BenchHashMap<StringName>>("StringName", name_keys, name_missing);
+	benchmark<BenchOAHashMap<StringName>>("StringName", name_keys, name_missing);
+	benchmark<BenchFlatHashMap<StringName>>("StringName", name_keys, name_missing);
+
+	return true;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	test_5,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestFlatHashMap
@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  test_frame_arena.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_frame_arena.h"
+
+#include "core/frame_arena.h"
+#include "core/map.h"
+#include "core/os/os.h"
+
+namespace TestFrameArena {
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: alignment\n");
+
+	FrameArena arena(256);
+	bool state = true;
+	for (int i = 0; i < 100; i++) {
+		size_t align = size_t(1) << (i % 7);
+		uint8_t *ptr = (uint8_t *)arena.alloc(i % 13 + 1, align);
+		if (uintptr_t(ptr) % align != 0) {
+			state = false;
+		}
+		memset(ptr, 0xAB, i % 13 + 1);
+	}
+
+	OS::get_singleton()->print("\tUsed: %i, capacity: %i\n", (int)arena.get_used(), (int)arena.get_capacity());
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: steady state\n");
+
+	FrameArena arena(1024);
+	for (int i = 0; i < 64; i++) {
+		arena.alloc(200);
+	}
+	arena.reset();
+	size_t capacity = arena.get_capacity();
+
+	// The same frame again must fit in the merged chunk.
+	for (int i = 0; i < 64; i++) {
+		arena.alloc(200);
+	}
+	bool state = arena.get_capacity() == capacity;
+	arena.reset();
+	state = state && arena.get_capacity() == capacity && arena.get_used() == 0;
+
+	OS::get_singleton()->print("\tCapacity: %i, max used: %i\n", (int)capacity, (int)arena.get_max_used());
+	return state;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: containers\n");
+
+	bool state = true;
+	{
+		FrameVector<int> vec;
+		for (int i = 0; i < 1000; i++) {
+			vec.push_back(i);
+		}
+		for (int i = 0; i < 1000; i++) {
+			if (vec[i] != i) {
+				state = false;
+			}
+		}
+
+		// Growing must copy construct elements that aren't trivially copyable.
+		FrameVector<String> strings;
+		for (int i = 0; i < 100; i++) {
+			strings.push_back(itos(i));
+		}
+		for (int i = 0; i < 100; i++) {
+			if (strings[i] != itos(i)) {
+				state = false;
+			}
+		}
+
+		Map<int, FrameVector<int>, Comparator<int>, FrameAllocator> map;
+		for (int i = 0; i < 100; i++) {
+			map[i % 10].push_back(i);
+		}
+		for (Map<int, FrameVector<int>, Comparator<int>, FrameAllocator>::Element *E = map.front(); E; E = E->next()) {
+			if (E->get().size() != 10 || E->get()[0] != E->key()) {
+				state = false;
+			}
+		}
+	}
+
+	OS::get_singleton()->print("\tUsed: %i\n", (int)FrameArena::get_current()->get_used());
+	FrameArena::get_current()->reset();
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestFrameArena
@@ -41,6 +41,7 @@
 #include "modules/gdscript/gdscript_compiler.h"
 #include "modules/gdscript/gdscript_parser.h"
 #include "modules/gdscript/gdscript_tokenizer.h"
+#include "scene/main/node.h"
 
 namespace TestGDScript {
 
@@ -530,9 +531,30 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 			String txt = itos(ip) + " ";
 
 			switch (code[ip]) {
+				case GDScriptFunction::OPCODE_OPERATOR_ADD_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_SUB_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_DIV_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_MOD_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_COMPARE_INT_INT:
+				case GDScriptFunction::OPCODE_OPERATOR_ADD_FLOAT_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_SUB_FLOAT_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_FLOAT_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_DIV_FLOAT_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_COMPARE_FLOAT_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_ADD_VECTOR2_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_SUB_VECTOR2_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR2_VECTOR2:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR2_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_DIV_VECTOR2_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_ADD_VECTOR3_VECTOR3:
+				case GDScriptFunction::OPCODE_OPERATOR_SUB_VECTOR3_VECTOR3:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR3_VECTOR3:
+				case GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR3_FLOAT:
+				case GDScriptFunction::OPCODE_OPERATOR_DIV_VECTOR3_FLOAT:
 				case GDScriptFunction::OPCODE_OPERATOR: {
 					int op = code[ip + 1];
-					txt += " op ";
+					txt += code[ip] == GDScriptFunction::OPCODE_OPERATOR ? " op " : " typed op ";
 
 					String opname = Variant::get_operator_name(Variant::Operator(op));
 
@@ -731,7 +753,7 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 
 					int argc = code[ip + 1];
 					if (ret) {
-						txt += DADDR(4 + argc) + "=";
+						txt += DADDR(5 + argc) + "=";
 					}
 
 					txt += DADDR(2) + ".";
@@ -742,11 +764,11 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 						if (i > 0) {
 							txt += ", ";
 						}
-						txt += DADDR(4 + i);
+						txt += DADDR(5 + i);
 					}
-					txt += ")";
+					txt += ") cache " + itos(code[ip + 4]);
 
-					incr = 5 + argc;
+					incr = 6 + argc;
 
 				} break;
 				case GDScriptFunction::OPCODE_CALL_BUILT_IN: {
@@ -883,9 +905,325 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Representative workloads for the opcode dispatch benchmark. Every
+// `bench_*` function is called with the iteration count as its only argument.
+static const char *_benchmark_script = R"(
+static func bench_untyped_arithmetic(n):
+	var x = 0
+	for i in range(n):
+		x = x + i * 2 - 1
+	return x
+
+static func bench_typed_arithmetic(n: int) -> int:
+	var x: int = 0
+	var i: int = 0
+	while i < n:
+		x += i * 2 - 1
+		i += 1
+	return x
+
+static func bench_typed_vectors(n: int) -> Vector3:
+	var p := Vector3()
+	var v := Vector3(1, 2, 3)
+	var i := 0
+	while i < n:
+		p += v * 0.016
+		i += 1
+	return p
+
+static func _add(a, b):
+	return a + b
+
+static func bench_calls(n):
+	var x = 0
+	for i in range(n):
+		x = _add(x, i)
+	return x
+
+static func bench_ai_tick(n):
+	var state = { "hp": 100, "target": Vector2(10, 10) }
+	var pos = Vector2()
+	var counters = [0, 0, 0, 0]
+	for i in range(n):
+		if state.hp > 50:
+			pos += (state.target - pos) * 0.1
+		else:
+			pos -= Vector2(1, 0)
+		counters[i % 4] += 1
+		if i % 100 == 0:
+			state.hp = 150 - state.hp
+	return pos
+)";
+
+static void _benchmark(const String &p_code) {
+	GDScriptParser parser;
+	Error err = parser.parse(p_code);
+	if (err) {
+		print_line("Parse Error:\n" + itos(parser.get_error_line()) + ":" + itos(parser.get_error_column()) + ":" + parser.get_error());
+		return;
+	}
+
+	Ref<GDScript> gds;
+	gds.instance();
+
+	GDScriptCompiler gdc;
+	err = gdc.compile(&parser, gds.ptr());
+	if (err) {
+		print_line("Compile Error:\n" + itos(gdc.get_error_line()) + ":" + itos(gdc.get_error_column()) + ":" + gdc.get_error());
+		return;
+	}
+
+	const int iterations = 1000000;
+	const Map<StringName, GDScriptFunction *> &mf = gds->debug_get_member_functions();
+
+	// Profiling must be enabled for the VM to count dispatched opcodes.
+	GDScriptLanguage::get_singleton()->profiling_start();
+
+	for (const Map<StringName, GDScriptFunction *>::Element *E = mf.front(); E; E = E->next()) {
+		GDScriptFunction *func = E->get();
+		if (!String(func->get_name()).begins_with("bench_") || !func->is_static() || func->get_argument_count() != 1) {
+			continue;
+		}
+
+		Variant arg = iterations;
+		const Variant *args[1] = { &arg };
+		Callable::CallError ce;
+
+		uint64_t start = OS::get_singleton()->get_ticks_usec();
+		Variant ret = func->call(nullptr, args, 1, ce);
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+		if (ce.error != Callable::CallError::CALL_OK) {
+			print_line(String(func->get_name()) + ": call failed.");
+			continue;
+		}
+
+		// Calls into other script functions are profiled separately, count them too.
+		uint64_t opcodes = 0;
+		for (const Map<StringName, GDScriptFunction *>::Element *F = mf.front(); F; F = F->next()) {
+			opcodes += F->get()->get_profile_opcode_count();
+		}
+
+		double ns_per_opcode = opcodes ? double(usec) * 1000.0 / double(opcodes) : 0.0;
+		print_line(String(func->get_name()) + ": " + itos(usec / 1000) + " msec, " + itos(opcodes) + " opcodes, " + rtos(ns_per_opcode) + " ns/opcode (result: " + String(ret) + ")");
+
+		// Reset the counters so the next benchmark only sees its own opcodes.
+		GDScriptLanguage::get_singleton()->profiling_start();
+	}
+
+	GDScriptLanguage::get_singleton()->profiling_stop();
+}
+
+static Ref<GDScript> _compile(const String &p_code) {
+	GDScriptParser parser;
+	Error err = parser.parse(p_code);
+	if (err) {
+		print_line("Parse Error:\n" + itos(parser.get_error_line()) + ":" + itos(parser.get_error_column()) + ":" + parser.get_error());
+		return Ref<GDScript>();
+	}
+
+	Ref<GDScript> gds;
+	gds.instance();
+
+	GDScriptCompiler gdc;
+	err = gdc.compile(&parser, gds.ptr());
+	if (err) {
+		print_line("Compile Error:\n" + itos(gdc.get_error_line()) + ":" + itos(gdc.get_error_column()) + ":" + gdc.get_error());
+		return Ref<GDScript>();
+	}
+	return gds;
+}
+
+static String _class_of(GDScriptFunction *p_func, const Variant &p_object) {
+	const Variant *args[1] = { &p_object };
+	Callable::CallError ce;
+	Variant ret = p_func->call(nullptr, args, 1, ce);
+	return ce.error == Callable::CallError::CALL_OK ? String(ret) : String();
+}
+
+// A single call site sees native objects of one class, then another, then a
+// scripted object of the cached class, then too many classes to cache.
+static void _test_call_cache() {
+	Ref<GDScript> site = _compile("static func class_of(o):\n\treturn o.get_class()\n");
+	Ref<GDScript> scripted = _compile("extends Reference\n\nfunc get_class() -> String:\n\treturn \"Scripted\"\n");
+	if (site.is_null() || scripted.is_null() || !site->debug_get_member_functions().has("class_of")) {
+		print_line("\tFAILED");
+		return;
+	}
+	GDScriptFunction *func = site->debug_get_member_functions()["class_of"];
+
+	// First call misses, the rest hit.
+	Node *node = memnew(Node);
+	bool state = true;
+	for (int i = 0; i < 3; i++) {
+		state = state && _class_of(func, node) == "Node";
+	}
+	state = state && func->get_call_cache_misses() == 1;
+	print_line("\tone class: " + String(state ? "PASS" : "FAILED"));
+
+	Ref<Reference> reference;
+	reference.instance();
+	state = state && _class_of(func, reference) == "Reference";
+	state = state && _class_of(func, reference) == "Reference";
+	state = state && func->get_call_cache_misses() == 2;
+	print_line("\tclass change: " + String(state ? "PASS" : "FAILED"));
+
+	// Must reach the script's method, although its class is the cached one.
+	Ref<Reference> with_script;
+	with_script.instance();
+	with_script->set_script(scripted);
+	state = state && _class_of(func, with_script) == "Scripted";
+	state = state && _class_of(func, reference) == "Reference";
+	state = state && func->get_call_cache_misses() == 2;
+	print_line("\tscripted object: " + String(state ? "PASS" : "FAILED"));
+
+	// Gives up after four classes, calls still go through Object::call.
+	const char *classes[] = { "Object", "Timer", "Node2D", "Control", "Node" };
+	for (int i = 0; i < 5; i++) {
+		Object *obj = ClassDB::instance(classes[i]);
+		state = state && _class_of(func, obj) == classes[i];
+		memdelete(obj);
+	}
+	state = state && func->get_call_cache_misses() == 4;
+	state = state && _class_of(func, reference) == "Reference" && _class_of(func, node) == "Node";
+	state = state && func->get_call_cache_misses() == 4;
+	print_line("\ttoo many classes: " + String(state ? "PASS" : "FAILED"));
+
+	memdelete(node);
+}
+
+static bool _same_result(const Variant &p_a, const Variant &p_b) {
+	if (p_a.get_type() != p_b.get_type()) {
+		return false;
+	}
+	if (p_a.get_type() == Variant::FLOAT && Math::is_nan(double(p_a))) {
+		return Math::is_nan(double(p_b)); // 0.0 / 0.0 is only valid in release builds.
+	}
+	return p_a == p_b;
+}
+
+// Every operator on each operand type pair the compiler specializes must give
+// the same value and type as Variant::evaluate, whether or not it is typed.
+static void _test_typed_operators() {
+	const Variant::Operator ops[] = { Variant::OP_ADD, Variant::OP_SUBTRACT, Variant::OP_MULTIPLY, Variant::OP_DIVIDE, Variant::OP_MODULE,
+		Variant::OP_EQUAL, Variant::OP_NOT_EQUAL, Variant::OP_LESS, Variant::OP_LESS_EQUAL, Variant::OP_GREATER, Variant::OP_GREATER_EQUAL };
+	const char *op_names[] = { "+", "-", "*", "/", "%", "==", "!=", "<", "<=", ">", ">=" };
+	const int op_count = sizeof(ops) / sizeof(ops[0]);
+
+	// Bit i set means ops[i] is expected to get a typed opcode.
+	struct OperandPair {
+		Variant::Type a;
+		Variant::Type b;
+		uint32_t typed_ops;
+	};
+	const OperandPair pairs[] = {
+		{ Variant::INT, Variant::INT, 0x7FF },
+		{ Variant::INT, Variant::FLOAT, 0x7EF },
+		{ Variant::FLOAT, Variant::INT, 0x7EF },
+		{ Variant::FLOAT, Variant::FLOAT, 0x7EF },
+		{ Variant::VECTOR2, Variant::VECTOR2, 0x7 },
+		{ Variant::VECTOR2, Variant::INT, 0xC },
+		{ Variant::VECTOR2, Variant::FLOAT, 0xC },
+		{ Variant::VECTOR3, Variant::VECTOR3, 0x7 },
+		{ Variant::VECTOR3, Variant::INT, 0xC },
+		{ Variant::VECTOR3, Variant::FLOAT, 0xC },
+	};
+
+	// The first value of each type is non zero, it decides whether the operator is supported.
+	Map<Variant::Type, Vector<Variant>> values;
+	values[Variant::INT].push_back(7);
+	values[Variant::INT].push_back(-3);
+	values[Variant::INT].push_back(0);
+	values[Variant::INT].push_back(12);
+	values[Variant::FLOAT].push_back(2.5);
+	values[Variant::FLOAT].push_back(-0.75);
+	values[Variant::FLOAT].push_back(0.0);
+	values[Variant::FLOAT].push_back(12.0);
+	values[Variant::VECTOR2].push_back(Vector2(1.5, -2));
+	values[Variant::VECTOR2].push_back(Vector2(3, 0.25));
+	values[Variant::VECTOR3].push_back(Vector3(1.5, -2, 4));
+	values[Variant::VECTOR3].push_back(Vector3(3, 0.25, -1));
+
+	for (int i = 0; i < (int)(sizeof(pairs) / sizeof(pairs[0])); i++) {
+		const OperandPair &pair = pairs[i];
+		const Vector<Variant> &values_a = values[pair.a];
+		const Vector<Variant> &values_b = values[pair.b];
+		bool state = true;
+
+		for (int j = 0; j < op_count; j++) {
+			bool valid;
+			Variant result;
+			Variant::evaluate(ops[j], values_a[0], values_b[0], result, valid);
+			if (!valid) {
+				continue; // Not an operator of these types.
+			}
+
+			String code = "static func op(a: " + Variant::get_type_name(pair.a) + ", b: " + Variant::get_type_name(pair.b) + "):\n\treturn a " + op_names[j] + " b\n";
+			Ref<GDScript> script = _compile(code);
+			if (script.is_null() || !script->debug_get_member_functions().has("op")) {
+				state = false;
+				continue;
+			}
+			GDScriptFunction *func = script->debug_get_member_functions()["op"];
+
+			// Find the operator whose result is returned, operators take 5 words.
+			int operator_opcode = -1;
+			const int *opcodes = func->get_code();
+			for (int ip = 5; ip < func->get_code_size() - 1; ip++) {
+				if (opcodes[ip] == GDScriptFunction::OPCODE_RETURN && opcodes[ip - 4] == ops[j] && opcodes[ip - 1] == opcodes[ip + 1]) {
+					operator_opcode = opcodes[ip - 5];
+					break;
+				}
+			}
+			bool typed = operator_opcode >= GDScriptFunction::OPCODE_OPERATOR_ADD_INT_INT && operator_opcode <= GDScriptFunction::OPCODE_OPERATOR_DIV_VECTOR3_FLOAT;
+			if (operator_opcode < 0 || typed != bool(pair.typed_ops & (1 << j))) {
+				print_line("\t" + code.get_slice("\n", 1).strip_edges() + ": " + (operator_opcode < 0 ? "operator not found" : (typed ? "unexpected typed opcode" : "missing typed opcode")));
+				state = false;
+			}
+
+			for (int k = 0; k < values_a.size(); k++) {
+				for (int l = 0; l < values_b.size(); l++) {
+					if ((ops[j] == Variant::OP_DIVIDE || ops[j] == Variant::OP_MODULE) && values_b[l].get_type() == Variant::INT && int64_t(values_b[l]) == 0) {
+						continue; // Traps in release builds, with or without typed opcodes.
+					}
+					Variant::evaluate(ops[j], values_a[k], values_b[l], result, valid);
+					if (!valid) {
+						continue; // Errors go through the generic opcode.
+					}
+
+					const Variant *args[2] = { &values_a[k], &values_b[l] };
+					Callable::CallError ce;
+					Variant ret = func->call(nullptr, args, 2, ce);
+					if (ce.error != Callable::CallError::CALL_OK || !_same_result(ret, result)) {
+						print_line("\t" + values_a[k].get_construct_string() + " " + op_names[j] + " " + values_b[l].get_construct_string() + ": got " + ret.get_construct_string() + ", expected " + result.get_construct_string());
+						state = false;
+					}
+				}
+			}
+		}
+
+		print_line("\t" + Variant::get_type_name(pair.a) + ", " + Variant::get_type_name(pair.b) + ": " + String(state ? "PASS" : "FAILED"));
+	}
+}
+
 MainLoop *test(TestType p_type) {
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
+	if (p_type == TEST_CALL_CACHE) {
+		_test_call_cache();
+		return nullptr;
+	}
+
+	if (p_type == TEST_TYPED_OPERATORS) {
+		_test_typed_operators();
+		return nullptr;
+	}
+
+	if (p_type == TEST_BENCHMARK && (cmdlargs.empty() || !cmdlargs.back()->get().ends_with(".gd"))) {
+		_benchmark(_benchmark_script);
+		return nullptr;
+	}
+
 	if (cmdlargs.empty()) {
 		return nullptr;
 	}
@@ -1006,6 +1344,8 @@ MainLoop *test(TestType p_type) {
 			current = current->get_base();
 		}
 
+	} else if (p_type == TEST_BENCHMARK) {
+		_benchmark(code);
 	} else if (p_type == TEST_BYTECODE) {
 		Vector<uint8_t> buf2 = GDScriptTokenizerBuffer::parse_code_string(code);
 		String dst = test.get_basename() + ".gdc";
@@ -40,6 +40,9 @@ enum TestType {
 	TEST_PARSER,
 	TEST_COMPILER,
 	TEST_BYTECODE,
+	TEST_BENCHMARK,
+	TEST_CALL_CACHE,
+	TEST_TYPED_OPERATORS,
 };
 
 MainLoop *test(TestType p_type);
@@ -0,0 +1,280 @@
+/*************************************************************************/
+/*  test_height_map_shape_3d.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_height_map_shape_3d.h"
+
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "servers/physics_3d/shape_3d_sw.h"
+
+namespace TestHeightMapShape3D {
+
+// The same terrain as a height map and as a trimesh, so every query can be
+// checked against the trimesh implementation.
+struct Terrain {
+	int width = 0;
+	int depth = 0;
+	Vector<real_t> heights;
+	HeightMapShape3DSW height_map;
+	ConcavePolygonShape3DSW trimesh;
+};
+
+static void _make_terrain(Terrain &r_terrain, int p_size) {
+	r_terrain.width = p_size;
+	r_terrain.depth = p_size;
+	r_terrain.heights.resize(p_size * p_size);
+
+	uint64_t seed = 1234;
+	for (int z = 0; z < p_size; z++) {
+		for (int x = 0; x < p_size; x++) {
+			real_t noise = (Math::rand_from_seed(&seed) % 1000) / 1000.0;
+			r_terrain.heights.write[z * p_size + x] = Math::sin(x * 0.1) * 8.0 + Math::cos(z * 0.07) * 5.0 + noise;
+		}
+	}
+
+	Dictionary d;
+	d["width"] = p_size;
+	d["depth"] = p_size;
+	d["heights"] = r_terrain.heights;
+	r_terrain.height_map.set_data(d);
+
+	// HeightMapShape3D samples are one unit apart, centered on the origin.
+	Vector<Vector3> faces;
+	real_t offset = (p_size - 1) * 0.5;
+	for (int z = 0; z < p_size - 1; z++) {
+		for (int x = 0; x < p_size - 1; x++) {
+			Vector3 p00(x - offset, r_terrain.heights[z * p_size + x], z - offset);
+			Vector3 p10(x + 1 - offset, r_terrain.heights[z * p_size + x + 1], z - offset);
+			Vector3 p01(x - offset, r_terrain.heights[(z + 1) * p_size + x], z + 1 - offset);
+			Vector3 p11(x + 1 - offset, r_terrain.heights[(z + 1) * p_size + x + 1], z + 1 - offset);
+
+			faces.push_back(p00);
+			faces.push_back(p11);
+			faces.push_back(p01);
+
+			faces.push_back(p00);
+			faces.push_back(p10);
+			faces.push_back(p11);
+		}
+	}
+	r_terrain.trimesh.set_data(faces);
+}
+
+static Vector3 _random_point(uint64_t *r_seed, real_t p_extent) {
+	return Vector3(
+			((Math::rand_from_seed(r_seed) % 10000) / 10000.0 - 0.5) * p_extent * 1.2,
+			((Math::rand_from_seed(r_seed) % 10000) / 10000.0 - 0.5) * 40.0,
+			((Math::rand_from_seed(r_seed) % 10000) / 10000.0 - 0.5) * p_extent * 1.2);
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: memory\n");
+
+	Terrain terrain;
+	_make_terrain(terrain, 513);
+
+	const HeightMapShape3DSW &height_map = terrain.height_map;
+	const ConcavePolygonShape3DSW &trimesh = terrain.trimesh;
+
+	int height_map_bytes = height_map.heights.size() * sizeof(real_t) + height_map.mip_ranges.size() * sizeof(HeightMapShape3DSW::MinMax);
+	int trimesh_bytes = trimesh.faces.size() * sizeof(ConcavePolygonShape3DSW::Face) + trimesh.vertices.size() * sizeof(Vector3) + trimesh.bvh.size() * sizeof(ConcavePolygonShape3DSW::BVH);
+
+	OS::get_singleton()->print("\theight map %d KiB, trimesh %d KiB\n", height_map_bytes / 1024, trimesh_bytes / 1024);
+
+	return height_map.get_aabb().is_equal_approx(trimesh.get_aabb()) && height_map_bytes * 4 < trimesh_bytes;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: segments\n");
+
+	Terrain terrain;
+	_make_terrain(terrain, 257);
+
+	const int count = 20000;
+	Vector<Vector3> from;
+	Vector<Vector3> to;
+	uint64_t seed = 42;
+	for (int i = 0; i < count; i++) {
+		Vector3 begin = _random_point(&seed, 256);
+		// Mix long rays across the map with short downward ones, like ground checks.
+		Vector3 end = (i % 2) ? _random_point(&seed, 256) : begin + Vector3(0, -30, 0);
+		from.push_back(begin);
+		to.push_back(end);
+	}
+
+	int height_map_hits = 0;
+	int mismatches = 0;
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	Vector<Vector3> points;
+	points.resize(count);
+	for (int i = 0; i < count; i++) {
+		Vector3 normal;
+		if (terrain.height_map.intersect_segment(from[i], to[i], points.write[i], normal)) {
+			height_map_hits++;
+		} else {
+			points.write[i] = Vector3(1e20, 1e20, 1e20);
+		}
+	}
+	uint64_t height_map_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		Vector3 point;
+		Vector3 normal;
+		if (terrain.trimesh.intersect_segment(from[i], to[i], point, normal)) {
+			if (point.distance_to(points[i]) > 0.001) {
+				mismatches++;
+			}
+		} else if (points[i].x < 1e19) {
+			mismatches++;
+		}
+	}
+	uint64_t trimesh_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	OS::get_singleton()->print("\t%d segments, %d hits, height map %d usec, trimesh %d usec\n", count, height_map_hits, int(height_map_usec), int(trimesh_usec));
+
+	return mismatches == 0 && height_map_hits > 0;
+}
+
+static void _count_face(void *p_userdata, Shape3DSW *p_convex) {
+	(*(int *)p_userdata)++;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: cull\n");
+
+	Terrain terrain;
+	_make_terrain(terrain, 257);
+
+	const int count = 20000;
+	Vector<AABB> aabbs;
+	uint64_t seed = 43;
+	for (int i = 0; i < count; i++) {
+		Vector3 size(1 + (Math::rand_from_seed(&seed) % 400) / 100.0, 1 + (Math::rand_from_seed(&seed) % 400) / 100.0, 1 + (Math::rand_from_seed(&seed) % 400) / 100.0);
+		// Keep the corners off the sample grid, where touching counts as overlapping.
+		aabbs.push_back(AABB(_random_point(&seed, 256) + Vector3(0.0001234, 0.0001234, 0.0001234), size));
+	}
+
+	int height_map_faces = 0;
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		terrain.height_map.cull(aabbs[i], _count_face, &height_map_faces);
+	}
+	uint64_t height_map_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	int trimesh_faces = 0;
+	start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		terrain.trimesh.cull(aabbs[i], _count_face, &trimesh_faces);
+	}
+	uint64_t trimesh_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+	OS::get_singleton()->print("\t%d queries, %d faces, height map %d usec, trimesh %d usec\n", count, height_map_faces, int(height_map_usec), int(trimesh_usec));
+
+	return height_map_faces == trimesh_faces && height_map_faces > 0;
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: points\n");
+
+	Terrain terrain;
+	_make_terrain(terrain, 65);
+
+	const Vector<Vector3> faces = terrain.trimesh.get_faces();
+	AABB aabb = terrain.height_map.get_aabb();
+
+	bool state = true;
+	uint64_t seed = 44;
+	for (int i = 0; i < 2000; i++) {
+		Vector3 point = _random_point(&seed, 64);
+
+		// Inside means under the surface, which a ray going up finds.
+		Vector3 hit;
+		Vector3 normal;
+		bool under = point.x > aabb.position.x && point.x < aabb.position.x + aabb.size.x && point.z > aabb.position.z && point.z < aabb.position.z + aabb.size.z && point.y > aabb.position.y;
+		under = under && terrain.trimesh.intersect_segment(point, point + Vector3(0, 100, 0), hit, normal);
+		bool inside = terrain.height_map.intersect_point(point);
+		state = state && inside == under;
+
+		Vector3 closest = terrain.height_map.get_closest_point_to(point);
+		if (inside) {
+			state = state && closest == point;
+			continue;
+		}
+
+		real_t min_distance = 1e20;
+		for (int j = 0; j < faces.size(); j += 3) {
+			Vector3 face_point = Face3(faces[j], faces[j + 1], faces[j + 2]).get_closest_point_to(point);
+			min_distance = MIN(min_distance, face_point.distance_to(point));
+		}
+		state = state && Math::abs(min_distance - closest.distance_to(point)) < 0.001;
+	}
+
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestHeightMapShape3D
@@ -36,17 +36,32 @@
 
 #include "test_astar.h"
 #include "test_basis.h"
+#include "test_broad_phase_2d.h"
+#include "test_broad_phase_3d.h"
 #include "test_class_db.h"
+#include "test_command_queue.h"
+#include "test_file_access_compressed.h"
+#include "test_file_access_pack.h"
+#include "test_flat_hash_map.h"
+#include "test_frame_arena.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
+#include "test_height_map_shape_3d.h"
+#include "test_marshalls.h"
 #include "test_math.h"
+#include "test_multiplayer.h"
 #include "test_oa_hash_map.h"
 #include "test_ordered_hash_map.h"
+#include "test_packed_scene.h"
 #include "test_physics_2d.h"
 #include "test_physics_3d.h"
 #include "test_render.h"
+#include "test_resource_cache.h"
+#include "test_resource_loader.h"
 #include "test_shader_lang.h"
+#include "test_small_allocator.h"
 #include "test_string.h"
+#include "test_thread_work_pool.h"
 
 const char **tests_get_names() {
 	static const char *test_names[] = {
@@ -54,18 +69,38 @@ const char **tests_get_names() {
 		"math",
 		"basis",
 		"physics_2d",
+		"physics_2d_benchmark",
 		"physics_3d",
+		"physics_3d_benchmark",
+		"broad_phase_2d",
+		"broad_phase_3d",
+		"height_map_shape_3d",
 		"render",
 		"oa_hash_map",
+		"flat_hash_map",
+		"frame_arena",
+		"small_allocator",
 		"class_db",
+		"command_queue",
+		"packed_scene",
+		"file_access_pack",
+		"file_access_compressed",
+		"resource_cache",
+		"resource_loader",
+		"marshalls",
+		"multiplayer",
 		"gui",
 		"shaderlang",
 		"gd_tokenizer",
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_benchmark",
+		"gd_call_cache",
+		"gd_typed_operators",
 		"ordered_hash_map",
 		"astar",
+		"thread_work_pool",
 		nullptr
 	};
 
@@ -89,10 +124,30 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_benchmark") {
+		return TestPhysics2D::benchmark();
+	}
+
 	if (p_test == "physics_3d") {
 		return TestPhysics3D::test();
 	}
 
+	if (p_test == "physics_3d_benchmark") {
+		return TestPhysics3D::benchmark();
+	}
+
+	if (p_test == "broad_phase_2d") {
+		return TestBroadPhase2D::test();
+	}
+
+	if (p_test == "broad_phase_3d") {
+		return TestBroadPhase3D::test();
+	}
+
+	if (p_test == "height_map_shape_3d") {
+		return TestHeightMapShape3D::test();
+	}
+
 	if (p_test == "render") {
 		return TestRender::test();
 	}
@@ -101,10 +156,54 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestOAHashMap::test();
 	}
 
+	if (p_test == "flat_hash_map") {
+		return TestFlatHashMap::test();
+	}
+
+	if (p_test == "frame_arena") {
+		return TestFrameArena::test();
+	}
+
+	if (p_test == "small_allocator") {
+		return TestSmallAllocator::test();
+	}
+
 	if (p_test == "class_db") {
 		return TestClassDB::test();
 	}
 
+	if (p_test == "command_queue") {
+		return TestCommandQueue::test();
+	}
+
+	if (p_test == "packed_scene") {
+		return TestPackedScene::test();
+	}
+
+	if (p_test == "file_access_pack") {
+		return TestFileAccessPack::test();
+	}
+
+	if (p_test == "file_access_compressed") {
+		return TestFileAccessCompressed::test();
+	}
+
+	if (p_test == "resource_cache") {
+		return TestResourceCache::test();
+	}
+
+	if (p_test == "resource_loader") {
+		return TestResourceLoader::test();
+	}
+
+	if (p_test == "marshalls") {
+		return TestMarshalls::test();
+	}
+
+	if (p_test == "multiplayer") {
+		return TestMultiplayer::test();
+	}
+
 #ifndef _3D_DISABLED
 	if (p_test == "gui") {
 		return TestGUI::test();
@@ -131,6 +230,18 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_benchmark") {
+		return TestGDScript::test(TestGDScript::TEST_BENCHMARK);
+	}
+
+	if (p_test == "gd_call_cache") {
+		return TestGDScript::test(TestGDScript::TEST_CALL_CACHE);
+	}
+
+	if (p_test == "gd_typed_operators") {
+		return TestGDScript::test(TestGDScript::TEST_TYPED_OPERATORS);
+	}
+
 	if (p_test == "ordered_hash_map") {
 		return TestOrderedHashMap::test();
 	}
@@ -139,6 +250,10 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "thread_work_pool") {
+		return TestThreadWorkPool::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return nullptr;
 }
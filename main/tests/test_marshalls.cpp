@@ -0,0 +1,268 @@
+/*************************************************************************/
+/*  test_marshalls.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_marshalls.h"
+
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+
+namespace TestMarshalls {
+
+static Vector<uint8_t> _encode_two_pass(const Variant &p_variant) {
+	int len;
+	Vector<uint8_t> data;
+	if (encode_variant(p_variant, nullptr, len) != OK) {
+		return data;
+	}
+	data.resize(len);
+	encode_variant(p_variant, data.ptrw(), len);
+	return data;
+}
+
+static Vector<uint8_t> _encode_single_pass(const Variant &p_variant) {
+	VariantEncoder encoder;
+	encoder.encode(p_variant);
+	return encoder.get_data();
+}
+
+static bool _same_bytes(const Vector<uint8_t> &p_a, const Vector<uint8_t> &p_b) {
+	return p_a.size() == p_b.size() && memcmp(p_a.ptr(), p_b.ptr(), p_a.size()) == 0;
+}
+
+static Dictionary _make_record(int p_index, int p_samples) {
+	Dictionary record;
+	record["name"] = "record_" + itos(p_index);
+	record["id"] = p_index;
+	record["big_id"] = int64_t(p_index) << 40;
+	record["weight"] = p_index * 0.25;
+	record["position"] = Vector3(p_index, p_index * 2, p_index * 3);
+	record["transform"] = Transform(Basis(Vector3(0, 1, 0), p_index * 0.01), Vector3(p_index, 0, 0));
+	record["tags"] = varray("a", StringName("b"), NodePath("c/d:e"), Color(1, 0.5, 0.25));
+
+	PackedFloat32Array samples;
+	samples.resize(p_samples);
+	for (int i = 0; i < p_samples; i++) {
+		samples.write[i] = Math::sin(p_index + i * 0.1);
+	}
+	record["samples"] = samples;
+
+	return record;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: single pass encoding matches encode_variant\n");
+
+	PackedByteArray bytes;
+	PackedInt32Array ints;
+	PackedInt64Array longs;
+	PackedFloat64Array doubles;
+	PackedStringArray strings;
+	PackedVector2Array vec2s;
+	PackedVector3Array vec3s;
+	PackedColorArray colors;
+	for (int i = 0; i < 7; i++) {
+		bytes.push_back(i);
+		ints.push_back(-i * 1000);
+		longs.push_back(int64_t(i) << 33);
+		doubles.push_back(i / 3.0);
+		strings.push_back(String("s") + itos(i));
+		vec2s.push_back(Vector2(i, -i));
+		vec3s.push_back(Vector3(i, -i, i * 0.5));
+		colors.push_back(Color(i, i * 0.1, i * 0.2, 1));
+	}
+
+	Dictionary nested;
+	nested["record"] = _make_record(1, 5);
+	nested[Vector2i(1, 2)] = Rect2(1, 2, 3, 4);
+	nested[7] = Array();
+	nested["empty"] = PackedInt64Array();
+
+	Array values;
+	values.push_back(Variant());
+	values.push_back(true);
+	values.push_back(123);
+	values.push_back(int64_t(1) << 40);
+	values.push_back(0.5);
+	values.push_back(1.0 / 3.0);
+	values.push_back("héllo");
+	values.push_back(StringName("name"));
+	values.push_back(NodePath("/root/Node:position:x"));
+	values.push_back(Plane(1, 0, 0, 2));
+	values.push_back(Quat(0, 0, 0, 1));
+	values.push_back(AABB(Vector3(1, 2, 3), Vector3(4, 5, 6)));
+	values.push_back(Transform2D(0.5, Vector2(1, 2)));
+	values.push_back(Vector3i(1, -2, 3));
+	values.push_back(Rect2i(1, 2, 3, 4));
+	values.push_back(bytes);
+	values.push_back(ints);
+	values.push_back(longs);
+	values.push_back(doubles);
+	values.push_back(strings);
+	values.push_back(vec2s);
+	values.push_back(vec3s);
+	values.push_back(colors);
+	values.push_back(nested);
+
+	bool state = true;
+	for (int i = 0; i < values.size(); i++) {
+		if (!_same_bytes(_encode_two_pass(values[i]), _encode_single_pass(values[i]))) {
+			OS::get_singleton()->print("\tmismatch encoding %s\n", Variant::get_type_name(values[i].get_type()).utf8().get_data());
+			state = false;
+		}
+	}
+
+	Vector<uint8_t> encoded = _encode_single_pass(values);
+	state = state && _same_bytes(encoded, _encode_two_pass(values));
+
+	// Decoding and encoding again must give back the same bytes.
+	Variant decoded;
+	int used = 0;
+	state = state && decode_variant(decoded, encoded.ptr(), encoded.size(), &used) == OK;
+	state = state && used == encoded.size();
+	state = state && _same_bytes(encoded, _encode_single_pass(decoded));
+
+	Array decoded_values = decoded;
+	state = state && decoded_values[values.size() - 7] == Variant(longs);
+	state = state && decoded_values[values.size() - 3] == Variant(vec3s);
+
+	// clear() starts over but keeps the buffer.
+	VariantEncoder encoder;
+	encoder.encode(123);
+	state = state && encoder.size() == 8;
+	encoder.clear();
+	state = state && encoder.size() == 0;
+
+	// Past the maximum size, encoding stops and the buffer is left unchanged.
+	encoder.set_max_size(128);
+	encoder.encode(123);
+	state = state && encoder.encode(doubles) == OK && encoder.encode(_make_record(0, 64)) == ERR_OUT_OF_MEMORY;
+	state = state && encoder.size() == 8 + 8 + 7 * 8;
+
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: encode and decode speed\n");
+
+	const int iterations = 20;
+
+	Array records;
+	for (int i = 0; i < 2000; i++) {
+		records.push_back(_make_record(i, 256));
+	}
+	Dictionary scene;
+	scene["records"] = records;
+	scene["nested"] = _make_record(0, 16);
+
+	PackedFloat32Array floats;
+	floats.resize(4 * 1024 * 1024);
+	for (int i = 0; i < floats.size(); i++) {
+		floats.write[i] = i * 0.5;
+	}
+
+	Variant cases[] = { scene, floats };
+	const char *names[] = { "nested dictionaries", "PackedFloat32Array" };
+
+	bool state = true;
+	for (int c = 0; c < 2; c++) {
+		const Variant &v = cases[c];
+
+		uint64_t start = OS::get_singleton()->get_ticks_usec();
+		Vector<uint8_t> two_pass;
+		for (int i = 0; i < iterations; i++) {
+			two_pass = _encode_two_pass(v);
+		}
+		uint64_t two_pass_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+		// Reusing the encoder, as peers do, so only the first iteration allocates.
+		VariantEncoder encoder;
+		start = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < iterations; i++) {
+			encoder.clear();
+			encoder.encode(v);
+		}
+		uint64_t single_pass_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+		start = OS::get_singleton()->get_ticks_usec();
+		Variant decoded;
+		for (int i = 0; i < iterations; i++) {
+			decode_variant(decoded, encoder.ptr(), encoder.size());
+		}
+		uint64_t decode_usec = OS::get_singleton()->get_ticks_usec() - start;
+
+		double mb = double(encoder.size()) * iterations / (1024 * 1024);
+		OS::get_singleton()->print("\t%s, %d KiB:\n", names[c], encoder.size() / 1024);
+		OS::get_singleton()->print("\t\ttwo pass encode %d msec (%.1f MiB/s)\n", int(two_pass_usec / 1000), mb * 1000000 / MAX(two_pass_usec, (uint64_t)1));
+		OS::get_singleton()->print("\t\tsingle pass encode %d msec (%.1f MiB/s)\n", int(single_pass_usec / 1000), mb * 1000000 / MAX(single_pass_usec, (uint64_t)1));
+		OS::get_singleton()->print("\t\tdecode %d msec (%.1f MiB/s)\n", int(decode_usec / 1000), mb * 1000000 / MAX(decode_usec, (uint64_t)1));
+
+		state = state && _same_bytes(two_pass, encoder.get_data());
+		state = state && _same_bytes(two_pass, _encode_single_pass(decoded));
+	}
+
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestMarshalls
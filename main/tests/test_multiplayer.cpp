@@ -0,0 +1,309 @@
+/*************************************************************************/
+/*  test_multiplayer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_multiplayer.h"
+
+#include "core/io/marshalls.h"
+#include "core/io/multiplayer_api.h"
+#include "core/os/os.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/window.h"
+
+namespace TestMultiplayer {
+
+// Delivers packets straight to the other end of the pair, optionally dropping
+// some of the unreliable ones.
+class LoopbackPeer : public NetworkedMultiplayerPeer {
+	GDCLASS(LoopbackPeer, NetworkedMultiplayerPeer);
+
+	struct Packet {
+		int from = 0;
+		Vector<uint8_t> data;
+	};
+
+	List<Packet> incoming;
+	Packet current;
+	int target = 0;
+	TransferMode transfer_mode = TRANSFER_MODE_RELIABLE;
+	int unreliable_sent = 0;
+
+public:
+	LoopbackPeer *remote = nullptr;
+	int unique_id = 0;
+	int drop_every = 0;
+
+	virtual int get_available_packet_count() const { return incoming.size(); }
+	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
+		ERR_FAIL_COND_V(incoming.empty(), ERR_UNAVAILABLE);
+		current = incoming.front()->get();
+		incoming.pop_front();
+		*r_buffer = current.data.ptr();
+		r_buffer_size = current.data.size();
+		return OK;
+	}
+	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size) {
+		ERR_FAIL_COND_V(!remote, ERR_UNCONFIGURED);
+		if ((target > 0 && target != remote->unique_id) || target == -remote->unique_id) {
+			return OK;
+		}
+		if (transfer_mode == TRANSFER_MODE_UNRELIABLE && drop_every && ++unreliable_sent % drop_every == 0) {
+			return OK;
+		}
+		Packet packet;
+		packet.from = unique_id;
+		packet.data.resize(p_buffer_size);
+		copymem(packet.data.ptrw(), p_buffer, p_buffer_size);
+		remote->incoming.push_back(packet);
+		return OK;
+	}
+	virtual int get_max_packet_size() const { return 1 << 24; }
+
+	virtual void set_transfer_mode(TransferMode p_mode) { transfer_mode = p_mode; }
+	virtual TransferMode get_transfer_mode() const { return transfer_mode; }
+	virtual void set_target_peer(int p_peer_id) { target = p_peer_id; }
+	virtual int get_packet_peer() const { return incoming.empty() ? 0 : incoming.front()->get().from; }
+	virtual bool is_server() const { return unique_id == 1; }
+	virtual void poll() {}
+	virtual int get_unique_id() const { return unique_id; }
+	virtual void set_refuse_new_connections(bool p_enable) {}
+	virtual bool is_refusing_new_connections() const { return false; }
+	virtual ConnectionStatus get_connection_status() const { return CONNECTION_CONNECTED; }
+};
+
+class TestMainLoop : public SceneTree {
+	struct Side {
+		Ref<MultiplayerAPI> multiplayer;
+		Ref<LoopbackPeer> peer;
+		Node *root = nullptr;
+		Vector<Node2D *> entities;
+	};
+
+	Side server;
+	Side client;
+
+	void _create_side(Side &r_side, const String &p_name, int p_unique_id, int p_entities, real_t p_step) {
+		r_side.root = memnew(Node);
+		r_side.root->set_name(p_name);
+		get_root()->add_child(r_side.root);
+
+		r_side.multiplayer.instance();
+		r_side.multiplayer->set_root_node(r_side.root);
+
+		r_side.peer.instance();
+		r_side.peer->unique_id = p_unique_id;
+
+		PackedStringArray properties;
+		properties.push_back("position");
+		properties.push_back("rotation");
+		properties.push_back("z_index");
+
+		for (int i = 0; i < p_entities; i++) {
+			Node2D *entity = memnew(Node2D);
+			entity->set_name("Entity" + itos(i));
+			r_side.root->add_child(entity);
+			r_side.multiplayer->replicate_node(entity, properties);
+			r_side.multiplayer->set_replication_quantization(entity, "position", p_step);
+			r_side.entities.push_back(entity);
+		}
+	}
+
+	void _create(int p_entities, real_t p_step) {
+		_create_side(server, "Server", 1, p_entities, p_step);
+		_create_side(client, "Client", 2, p_entities, p_step);
+
+		server.peer->remote = client.peer.ptr();
+		client.peer->remote = server.peer.ptr();
+		server.multiplayer->set_network_peer(server.peer);
+		client.multiplayer->set_network_peer(client.peer);
+		server.peer->emit_signal("peer_connected", 2);
+		client.peer->emit_signal("peer_connected", 1);
+	}
+
+	void _destroy() {
+		Side *sides[] = { &server, &client };
+		for (int i = 0; i < 2; i++) {
+			sides[i]->multiplayer->set_network_peer(Ref<NetworkedMultiplayerPeer>());
+			sides[i]->root->queue_delete();
+			*sides[i] = Side();
+		}
+	}
+
+	// One network tick: the server sends, the client applies and acknowledges.
+	void _tick() {
+		server.multiplayer->send_replication_snapshot();
+		client.multiplayer->poll();
+		server.multiplayer->poll();
+	}
+
+	void _move(int p_tick, int p_every) {
+		for (int i = p_tick % p_every; i < server.entities.size(); i += p_every) {
+			Node2D *entity = server.entities[i];
+			entity->set_position(entity->get_position() + Vector2(Math::sin(p_tick * 0.1 + i), Math::cos(p_tick * 0.1 + i)) * 3.7);
+			entity->set_rotation(entity->get_rotation() + 0.05);
+			if (i % 16 == 0) {
+				entity->set_z_index(p_tick % 100);
+			}
+		}
+	}
+
+	bool _in_sync(real_t p_step) {
+		for (int i = 0; i < server.entities.size(); i++) {
+			Node2D *a = server.entities[i];
+			Node2D *b = client.entities[i];
+			if (ABS(a->get_position().x - b->get_position().x) > p_step / 2 + CMP_EPSILON || ABS(a->get_position().y - b->get_position().y) > p_step / 2 + CMP_EPSILON) {
+				return false;
+			}
+			if (a->get_rotation() != b->get_rotation() || a->get_z_index() != b->get_z_index()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool test_1() {
+		OS::get_singleton()->print("\n\nTest 1: state converges with packet loss\n");
+
+		const real_t step = 0.01;
+		_create(200, step);
+		// Drops every third unreliable packet, snapshots and acknowledgements alike.
+		server.peer->drop_every = 3;
+		client.peer->drop_every = 3;
+
+		for (int tick = 0; tick < 60; tick++) {
+			_move(tick, 4);
+			_tick();
+		}
+		server.peer->drop_every = 0;
+		client.peer->drop_every = 0;
+		for (int tick = 0; tick < 3; tick++) {
+			_tick();
+		}
+
+		bool state = _in_sync(step);
+		Dictionary stats = server.multiplayer->get_replication_stats();
+		OS::get_singleton()->print("\t%d snapshots sent, %d received\n", int(stats["snapshots_sent"]), int(client.multiplayer->get_replication_stats()["snapshots_received"]));
+
+		// Once everything is acknowledged, nothing changed means nothing to send.
+		int sent = stats["snapshots_sent"];
+		_tick();
+		state = state && int(server.multiplayer->get_replication_stats()["snapshots_sent"]) == sent;
+
+		// A node only accepts state from its master.
+		client.entities[0]->set_network_master(2);
+		Vector2 position = client.entities[0]->get_position();
+		server.entities[0]->set_position(position + Vector2(10, 10));
+		_tick();
+		state = state && client.entities[0]->get_position() == position;
+
+		// The skipped node was dropped from the baseline, so it's sent in full
+		// again even though nothing changed since.
+		client.entities[0]->set_network_master(1);
+		_tick();
+		_tick();
+		state = state && _in_sync(step);
+
+		_destroy();
+		return state;
+	}
+
+	bool test_2() {
+		OS::get_singleton()->print("\n\nTest 2: bandwidth and time for 500 entities at 30 Hz\n");
+
+		const int ticks = 300;
+		_create(500, 0.01);
+
+		for (int tick = 0; tick < ticks; tick++) {
+			// A tenth of the entities move each tick.
+			_move(tick, 10);
+			_tick();
+		}
+
+		// What sending every property with rset every tick would take.
+		int rset_bytes = 0;
+		for (int i = 0; i < server.entities.size(); i++) {
+			Variant values[] = { server.entities[i]->get_position(), server.entities[i]->get_rotation(), server.entities[i]->get_z_index() };
+			for (int j = 0; j < 3; j++) {
+				int len;
+				encode_variant(values[j], nullptr, len);
+				rset_bytes += 1 + 1 + 1 + len; // Meta, node and property ids.
+			}
+		}
+
+		Dictionary sent = server.multiplayer->get_replication_stats();
+		Dictionary received = client.multiplayer->get_replication_stats();
+		uint64_t snapshots = sent["snapshots_sent"];
+		uint64_t bytes = sent["bytes_sent"];
+		uint64_t fields = sent["fields_sent"];
+		uint64_t unchanged = sent["fields_unchanged"];
+
+		OS::get_singleton()->print("\t%d bytes per snapshot, %d per tick with rset\n", int(bytes / MAX(snapshots, (uint64_t)1)), rset_bytes);
+		OS::get_singleton()->print("\t%.1f%% of fields sent\n", fields * 100.0 / MAX(fields + unchanged, (uint64_t)1));
+		OS::get_singleton()->print("\t%d usec to encode, %d usec to decode per snapshot\n", int(uint64_t(sent["encode_usec"]) / MAX(snapshots, (uint64_t)1)), int(uint64_t(received["decode_usec"]) / MAX(snapshots, (uint64_t)1)));
+
+		bool state = _in_sync(0.01);
+		state = state && int(received["snapshots_received"]) == ticks - 1; // The first tick only sends paths.
+		state = state && bytes < uint64_t(rset_bytes) * snapshots / 4;
+
+		_destroy();
+		return state;
+	}
+
+public:
+	virtual void init() {
+		SceneTree::init();
+
+		int count = 0;
+		int passed = 0;
+		bool (TestMainLoop::*tests[])() = { &TestMainLoop::test_1, &TestMainLoop::test_2 };
+		for (int i = 0; i < 2; i++) {
+			bool pass = (this->*tests[i])();
+			if (pass) {
+				passed++;
+			}
+			OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+			count++;
+		}
+
+		OS::get_singleton()->print("\n\n\n");
+		OS::get_singleton()->print("*************\n");
+		OS::get_singleton()->print("***TOTALS!***\n");
+		OS::get_singleton()->print("*************\n");
+
+		OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+		quit();
+	}
+};
+
+MainLoop *test() {
+	return memnew(TestMainLoop);
+}
+
+} // namespace TestMultiplayer
@@ -0,0 +1,270 @@
+/*************************************************************************/
+/*  test_packed_scene.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_packed_scene.h"
+
+#include "core/os/os.h"
+#include "scene/2d/sprite_2d.h"
+#include "scene/main/timer.h"
+#include "scene/resources/packed_scene.h"
+
+namespace TestPackedScene {
+
+static Ref<PackedScene> make_scene() {
+	Node2D *root = memnew(Node2D);
+	root->set_name("Root");
+	root->set_position(Vector2(10, 20));
+	root->set_z_index(3);
+
+	for (int i = 0; i < 8; i++) {
+		Sprite2D *sprite = memnew(Sprite2D);
+		sprite->set_name("Sprite" + itos(i));
+		sprite->set_position(Vector2(i * 16, i * 8));
+		sprite->set_rotation(i * 0.25);
+		sprite->set_scale(Vector2(2, 2));
+		sprite->set_modulate(Color(1, 0.5, 0.25, 1));
+		sprite->set_offset(Vector2(4, 4));
+		sprite->set_centered(false);
+		sprite->set_hframes(4);
+		root->add_child(sprite);
+		sprite->set_owner(root);
+
+		Node2D *pivot = memnew(Node2D);
+		pivot->set_name("Pivot");
+		pivot->set_position(Vector2(1, 2));
+		pivot->set_visible(false);
+		sprite->add_child(pivot);
+		pivot->set_owner(root);
+	}
+
+	Timer *timer = memnew(Timer);
+	timer->set_name("Timer");
+	timer->set_wait_time(2.5);
+	timer->set_one_shot(true);
+	timer->set_autostart(true);
+	root->add_child(timer);
+	timer->set_owner(root);
+
+	Ref<PackedScene> scene;
+	scene.instance();
+	scene->pack(root);
+	memdelete(root);
+	return scene;
+}
+
+static bool compare(Node *p_a, Node *p_b) {
+	if (p_a->get_class() != p_b->get_class() || p_a->get_name() != p_b->get_name() || p_a->get_child_count() != p_b->get_child_count()) {
+		return false;
+	}
+
+	List<PropertyInfo> props;
+	p_a->get_property_list(&props);
+	for (List<PropertyInfo>::Element *E = props.front(); E; E = E->next()) {
+		if (!(E->get().usage & PROPERTY_USAGE_STORAGE)) {
+			continue;
+		}
+		if (p_a->get(E->get().name) != p_b->get(E->get().name)) {
+			OS::get_singleton()->print("\tMismatch in %s.%s\n", String(p_a->get_name()).utf8().get_data(), String(E->get().name).utf8().get_data());
+			return false;
+		}
+	}
+
+	for (int i = 0; i < p_a->get_child_count(); i++) {
+		if (!compare(p_a->get_child(i), p_b->get_child(i))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: planned instance matches the generic path\n");
+
+	Ref<PackedScene> scene = make_scene();
+
+	SceneState::set_use_instance_plans(false);
+	Node *plain = scene->instance();
+	SceneState::set_use_instance_plans(true);
+	Node *planned = scene->instance();
+
+	bool state = plain && planned && compare(plain, planned);
+	state = state && Object::cast_to<Timer>(planned->get_node(NodePath("Timer")))->get_wait_time() == 2.5;
+
+	if (plain) {
+		memdelete(plain);
+	}
+	if (planned) {
+		memdelete(planned);
+	}
+	return state;
+}
+
+static uint64_t instance_many(const Ref<PackedScene> &p_scene, int p_count) {
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		Node *n = p_scene->instance();
+		memdelete(n);
+	}
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: instance benchmark\n");
+
+	const int count = 2000;
+	Ref<PackedScene> scene = make_scene();
+
+	SceneState::set_use_instance_plans(false);
+	uint64_t plain = instance_many(scene, count);
+	SceneState::set_use_instance_plans(true);
+	uint64_t planned = instance_many(scene, count);
+
+	OS::get_singleton()->print("\t%i instances, generic: %llu usec, planned: %llu usec\n", count, (unsigned long long)plain, (unsigned long long)planned);
+	return true;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: pooled instances are reset\n");
+
+	Ref<PackedScene> scene = make_scene();
+	scene->warm_up_pool(2);
+	bool state = scene->get_pooled_count() == 2;
+
+	uint64_t hits = PackedScene::get_pool_hit_count();
+	Node *node = scene->instance_pooled();
+	state = state && PackedScene::get_pool_hit_count() == hits + 1;
+
+	Object::cast_to<Node2D>(node)->set_position(Vector2(-5, -5));
+	Object::cast_to<Sprite2D>(node->get_child(2))->set_modulate(Color(0, 0, 1, 1));
+	Object::cast_to<Timer>(node->get_node(NodePath("Timer")))->set_one_shot(false);
+	scene->release_pooled(node);
+	state = state && scene->get_pooled_count() == 2;
+
+	Node *fresh = scene->instance();
+	node = scene->instance_pooled();
+	state = state && compare(fresh, node);
+	memdelete(fresh);
+
+	// Changed structure, must not come back.
+	node->add_child(memnew(Node));
+	scene->release_pooled(node);
+	state = state && scene->get_pooled_count() == 1;
+
+	// Issued before the pool was cleared, freed instead of parked.
+	node = scene->instance_pooled();
+	scene->clear_pool();
+	state = state && scene->get_pooled_count() == 0;
+	scene->release_pooled(node);
+	state = state && scene->get_pooled_count() == 0;
+
+	// Not from the pool, refused (prints an error) and left to the caller.
+	OS::get_singleton()->print("\tExpecting an error:\n");
+	fresh = scene->instance();
+	scene->release_pooled(fresh);
+	state = state && scene->get_pooled_count() == 0;
+	memdelete(fresh);
+	return state;
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: pooled instance benchmark\n");
+
+	const int count = 2000;
+	Ref<PackedScene> scene = make_scene();
+	Node *nodes[16];
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i += 16) {
+		for (int j = 0; j < 16; j++) {
+			nodes[j] = scene->instance();
+			Object::cast_to<Node2D>(nodes[j])->set_position(Vector2(i, j));
+		}
+		for (int j = 0; j < 16; j++) {
+			memdelete(nodes[j]);
+		}
+	}
+	uint64_t plain = OS::get_singleton()->get_ticks_usec() - begin;
+
+	scene->warm_up_pool(16);
+	uint64_t misses = PackedScene::get_pool_miss_count();
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i += 16) {
+		for (int j = 0; j < 16; j++) {
+			nodes[j] = scene->instance_pooled();
+			Object::cast_to<Node2D>(nodes[j])->set_position(Vector2(i, j));
+		}
+		for (int j = 0; j < 16; j++) {
+			scene->release_pooled(nodes[j]);
+		}
+	}
+	uint64_t pooled = OS::get_singleton()->get_ticks_usec() - begin;
+
+	OS::get_singleton()->print("\t%i spawns, instance: %llu usec, pooled: %llu usec\n", count, (unsigned long long)plain, (unsigned long long)pooled);
+	return PackedScene::get_pool_miss_count() == misses;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestPackedScene
@@ -36,6 +36,7 @@
 #include "core/print_string.h"
 #include "scene/resources/texture.h"
 #include "servers/display_server.h"
+#include "servers/physics_2d/physics_server_2d_sw.h"
 #include "servers/physics_server_2d.h"
 #include "servers/rendering_server.h"
 
@@ -398,10 +399,219 @@ public:
 	TestPhysics2DMainLoop() {}
 };
 
+// Runs the same scenes with the serial and the multithreaded solver of the
+// Godot physics engine, without rendering anything.
+class TestPhysics2DBenchmarkMainLoop : public MainLoop {
+	GDCLASS(TestPhysics2DBenchmarkMainLoop, MainLoop);
+
+	RID rectangle_shape;
+	RID circle_shape;
+	RID floor_shape;
+	RID platform_shape;
+
+	RID space;
+	Vector<RID> bodies;
+
+	void _create_space() {
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		space = ps->space_create();
+		ps->area_set_param(space, PhysicsServer2D::AREA_PARAM_GRAVITY, 98);
+		ps->area_set_param(space, PhysicsServer2D::AREA_PARAM_GRAVITY_VECTOR, Vector2(0, 1));
+		ps->space_set_active(space, true);
+
+		RID floor = ps->body_create();
+		ps->body_set_mode(floor, PhysicsServer2D::BODY_MODE_STATIC);
+		ps->body_set_space(floor, space);
+		ps->body_add_shape(floor, floor_shape);
+		bodies.push_back(floor);
+	}
+
+	RID _create_body(RID p_shape, const Transform2D &p_xform) {
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		RID body = ps->body_create();
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, p_shape);
+		ps->body_set_state(body, PhysicsServer2D::BODY_STATE_TRANSFORM, p_xform);
+		bodies.push_back(body);
+		return body;
+	}
+
+	void _free_space() {
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		ps->space_set_active(space, false);
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		bodies.clear();
+		ps->free(space);
+	}
+
+	uint64_t _simulate(int p_steps) {
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		uint64_t usec = 0;
+		for (int i = 0; i < p_steps; i++) {
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			ps->step(1.0 / 60.0);
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+			ps->flush_queries();
+		}
+		return usec;
+	}
+
+	Vector<Transform2D> _get_transforms() {
+		Vector<Transform2D> result;
+		for (int i = 0; i < bodies.size(); i++) {
+			result.push_back(PhysicsServer2D::get_singleton()->body_get_state(bodies[i], PhysicsServer2D::BODY_STATE_TRANSFORM));
+		}
+		return result;
+	}
+
+	void _compare(const Vector<Transform2D> &p_serial, const Vector<Transform2D> &p_threaded) {
+		int mismatches = 0;
+		for (int i = 0; i < p_serial.size(); i++) {
+			if (p_serial[i] != p_threaded[i]) {
+				mismatches++;
+			}
+		}
+		OS::get_singleton()->print("\t%s, %d of %d transforms differ\n", mismatches ? "FAILED" : "PASS", mismatches, p_serial.size());
+	}
+
+	// Bodies far enough apart to only ever touch the floor, so each one is its
+	// own island.
+	Vector<Transform2D> _run_scattered(bool p_threads) {
+		PhysicsServer2DSW::singletonsw->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		for (int i = 0; i < 1000; i++) {
+			Transform2D xform(i * 0.37, Vector2(i * 64.0, -20.0 - (i % 5) * 12.0));
+			RID body = _create_body(i % 3 ? rectangle_shape : circle_shape, xform);
+			PhysicsServer2D::get_singleton()->body_set_state(body, PhysicsServer2D::BODY_STATE_ANGULAR_VELOCITY, (i % 7) * 0.5 - 1.5);
+		}
+
+		_simulate(180);
+
+		Vector<Transform2D> result = _get_transforms();
+		_free_space();
+		return result;
+	}
+
+	// Piles of boxes, each one an island of many bodies. Every pile shares the
+	// static floor with the others, and the two middle piles of each group of
+	// four stand on a shared kinematic platform. Constraints are solved in
+	// creation order, so the scene must be built in the same order for both runs.
+	Vector<Transform2D> _run_stacked(bool p_threads) {
+		PhysicsServer2DSW::singletonsw->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		for (int i = 0; i < 16; i++) {
+			Vector2 base(i * 100.0, 0);
+			if (i % 4 == 1 || i % 4 == 2) {
+				base.y = -32.0; // On the platform.
+			}
+			if (i % 4 == 1) {
+				RID platform = ps->body_create();
+				ps->body_set_mode(platform, PhysicsServer2D::BODY_MODE_KINEMATIC);
+				ps->body_set_space(platform, space);
+				ps->body_add_shape(platform, platform_shape);
+				ps->body_set_state(platform, PhysicsServer2D::BODY_STATE_TRANSFORM, Transform2D(0, base + Vector2(50, 16)));
+				bodies.push_back(platform);
+			}
+			for (int j = 0; j < 6; j++) {
+				Transform2D xform(j * 0.1, base + Vector2(3.0 * (j % 3), -16.0 - j * 34.0));
+				_create_body(rectangle_shape, xform);
+			}
+		}
+
+		_simulate(240);
+
+		Vector<Transform2D> result = _get_transforms();
+		_free_space();
+		return result;
+	}
+
+	// Piles of boxes collapsing on the floor, each pile being an island.
+	void _run_piles(int p_piles, int p_height, bool p_threads) {
+		PhysicsServer2DSW::singletonsw->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		for (int i = 0; i < p_piles; i++) {
+			for (int j = 0; j < p_height; j++) {
+				Transform2D xform(j * 0.1, Vector2(i * 100.0 + 3.0 * (j % 3), -16.0 - j * 34.0));
+				_create_body(rectangle_shape, xform);
+			}
+		}
+
+		const int steps = 240;
+		uint64_t usec = _simulate(steps);
+		OS::get_singleton()->print("\t%s: %.3f msec per step, %d islands at the end\n", p_threads ? "multithreaded" : "serial", usec / 1000.0 / steps, PhysicsServer2D::get_singleton()->get_process_info(PhysicsServer2D::INFO_ISLAND_COUNT));
+
+		_free_space();
+	}
+
+public:
+	virtual void init() {
+		if (!PhysicsServer2DSW::singletonsw) {
+			OS::get_singleton()->print("The benchmark needs the GodotPhysics2D engine (physics/2d/physics_engine).\n");
+			return;
+		}
+
+		PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+		ps->set_active(true);
+		rectangle_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(rectangle_shape, Vector2(16, 16));
+		circle_shape = ps->circle_shape_create();
+		ps->shape_set_data(circle_shape, 16);
+		floor_shape = ps->line_shape_create();
+		Array floor_data;
+		floor_data.push_back(Vector2(0, -1));
+		floor_data.push_back(0);
+		ps->shape_set_data(floor_shape, floor_data);
+		platform_shape = ps->rectangle_shape_create();
+		ps->shape_set_data(platform_shape, Vector2(80, 16));
+
+		bool was_multithreaded = PhysicsServer2DSW::singletonsw->is_multithreaded_solver();
+
+		OS::get_singleton()->print("Determinism, 1000 separate bodies for 180 steps:\n");
+		_compare(_run_scattered(false), _run_scattered(true));
+
+		OS::get_singleton()->print("Determinism, 16 piles of 6 boxes on a shared floor and platforms for 240 steps:\n");
+		_compare(_run_stacked(false), _run_stacked(true));
+
+		const int piles[] = { 100, 400, 1600 };
+		for (int i = 0; i < 3; i++) {
+			OS::get_singleton()->print("%d piles of 8 boxes, %d bodies:\n", piles[i], piles[i] * 8);
+			_run_piles(piles[i], 8, false);
+			_run_piles(piles[i], 8, true);
+		}
+
+		PhysicsServer2DSW::singletonsw->set_multithreaded_solver(was_multithreaded);
+		ps->free(rectangle_shape);
+		ps->free(circle_shape);
+		ps->free(floor_shape);
+		ps->free(platform_shape);
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
 namespace TestPhysics2D {
 
 MainLoop *test() {
 	return memnew(TestPhysics2DMainLoop);
 }
 
+MainLoop *benchmark() {
+	return memnew(TestPhysics2DBenchmarkMainLoop);
+}
+
 } // namespace TestPhysics2D
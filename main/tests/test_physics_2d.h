@@ -36,6 +36,7 @@
 namespace TestPhysics2D {
 
 MainLoop *test();
+MainLoop *benchmark();
 }
 
 #endif // TEST_PHYSICS_2D_H
@@ -37,6 +37,7 @@
 #include "core/os/os.h"
 #include "core/print_string.h"
 #include "servers/display_server.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
 #include "servers/physics_server_3d.h"
 #include "servers/rendering_server.h"
 
@@ -404,10 +405,257 @@ public:
 	}
 };
 
+// Runs the same scenes with the serial and the multithreaded solver of the
+// Godot physics engine, without rendering anything.
+class TestPhysics3DBenchmarkMainLoop : public MainLoop {
+	GDCLASS(TestPhysics3DBenchmarkMainLoop, MainLoop);
+
+	RID box_shape;
+	RID sphere_shape;
+	RID plane_shape;
+	RID platform_shape;
+
+	RID space;
+	Vector<RID> bodies;
+
+	void _create_space() {
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		space = ps->space_create();
+		ps->area_set_param(space, PhysicsServer3D::AREA_PARAM_GRAVITY, 9.8);
+		ps->area_set_param(space, PhysicsServer3D::AREA_PARAM_GRAVITY_VECTOR, Vector3(0, -1, 0));
+		ps->space_set_active(space, true);
+
+		RID floor = ps->body_create(PhysicsServer3D::BODY_MODE_STATIC);
+		ps->body_set_space(floor, space);
+		ps->body_add_shape(floor, plane_shape);
+		bodies.push_back(floor);
+	}
+
+	RID _create_body(RID p_shape, const Transform &p_xform) {
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		RID body = ps->body_create(PhysicsServer3D::BODY_MODE_RIGID);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, p_shape);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, p_xform);
+		bodies.push_back(body);
+		return body;
+	}
+
+	void _free_space() {
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		ps->space_set_active(space, false);
+		for (int i = 0; i < bodies.size(); i++) {
+			ps->free(bodies[i]);
+		}
+		bodies.clear();
+		ps->free(space);
+	}
+
+	uint64_t _simulate(int p_steps) {
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		uint64_t usec = 0;
+		for (int i = 0; i < p_steps; i++) {
+			uint64_t begin = OS::get_singleton()->get_ticks_usec();
+			ps->step(1.0 / 60.0);
+			usec += OS::get_singleton()->get_ticks_usec() - begin;
+			ps->flush_queries();
+		}
+		return usec;
+	}
+
+	Vector<Transform> _get_transforms() {
+		Vector<Transform> result;
+		for (int i = 0; i < bodies.size(); i++) {
+			result.push_back(PhysicsServer3D::get_singleton()->body_get_state(bodies[i], PhysicsServer3D::BODY_STATE_TRANSFORM));
+		}
+		return result;
+	}
+
+	void _compare(const Vector<Transform> &p_serial, const Vector<Transform> &p_threaded) {
+		int mismatches = 0;
+		for (int i = 0; i < p_serial.size(); i++) {
+			if (p_serial[i] != p_threaded[i]) {
+				mismatches++;
+			}
+		}
+		OS::get_singleton()->print("\t%s, %d of %d transforms differ\n", mismatches ? "FAILED" : "PASS", mismatches, p_serial.size());
+	}
+
+	// Bodies far enough apart to only ever touch the floor, so each one is its
+	// own island.
+	Vector<Transform> _run_scattered(bool p_threads) {
+		PhysicsServer3DSW::singleton->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		for (int i = 0; i < 1000; i++) {
+			Transform xform;
+			xform.basis.rotate(Vector3(1, 0.5 * (i % 7), 0.3).normalized(), i * 0.37);
+			xform.origin = Vector3((i % 32) * 4.0, 1.0 + (i % 5) * 0.8, (i / 32) * 4.0);
+			RID body = _create_body(i % 3 ? box_shape : sphere_shape, xform);
+			PhysicsServer3D::get_singleton()->body_set_state(body, PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY, Vector3(i % 3, 1, i % 5) * 0.5);
+		}
+
+		_simulate(180);
+
+		Vector<Transform> result = _get_transforms();
+		_free_space();
+		return result;
+	}
+
+	// Piles of boxes, each one an island of many bodies. Every pile shares the
+	// static floor with the others, and the two middle piles of each row stand
+	// on a shared kinematic platform. Constraints are solved in creation order, so the scene
+	// must be built in the same order for both runs.
+	Vector<Transform> _run_stacked(bool p_threads) {
+		PhysicsServer3DSW::singleton->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		for (int i = 0; i < 16; i++) {
+			Vector3 base((i % 4) * 6.0, 0, (i / 4) * 6.0);
+			if (i % 4 == 1 || i % 4 == 2) {
+				base.y = 1.0; // On the platform.
+			}
+			if (i % 4 == 1) {
+				RID platform = ps->body_create(PhysicsServer3D::BODY_MODE_KINEMATIC);
+				ps->body_set_space(platform, space);
+				ps->body_add_shape(platform, platform_shape);
+				ps->body_set_state(platform, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform(Basis(), base + Vector3(3, -0.5, 0)));
+				bodies.push_back(platform);
+			}
+			for (int j = 0; j < 6; j++) {
+				Transform xform;
+				xform.basis.rotate(Vector3(0, 1, 0), j * 0.3);
+				xform.origin = base + Vector3(0.15 * (j % 3), 0.5 + j * 1.1, 0.1 * (j % 2));
+				_create_body(box_shape, xform);
+			}
+		}
+
+		_simulate(240);
+
+		Vector<Transform> result = _get_transforms();
+		_free_space();
+		return result;
+	}
+
+	// A pile of boxes falling on a kinematic platform. Contacts only push
+	// dynamic bodies, so the platform must not pick up any velocity or move.
+	void _run_kinematic_contact(bool p_threads) {
+		PhysicsServer3DSW::singleton->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		Transform platform_xform(Basis(Vector3(0, 0, 1), 0.2), Vector3(0, 2, 0));
+		RID platform = ps->body_create(PhysicsServer3D::BODY_MODE_KINEMATIC);
+		ps->body_set_space(platform, space);
+		ps->body_add_shape(platform, platform_shape);
+		ps->body_set_state(platform, PhysicsServer3D::BODY_STATE_TRANSFORM, platform_xform);
+		bodies.push_back(platform);
+
+		for (int j = 0; j < 6; j++) {
+			Transform xform;
+			xform.basis.rotate(Vector3(0, 1, 0), j * 0.3);
+			xform.origin = Vector3(0.15 * (j % 3) - 2.0, 3.5 + j * 1.1, 0.1 * (j % 2));
+			_create_body(box_shape, xform);
+		}
+
+		_simulate(120);
+
+		Vector3 linear = ps->body_get_state(platform, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY);
+		Vector3 angular = ps->body_get_state(platform, PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY);
+		Transform xform = ps->body_get_state(platform, PhysicsServer3D::BODY_STATE_TRANSFORM);
+		bool pass = linear == Vector3() && angular == Vector3() && xform == platform_xform;
+		OS::get_singleton()->print("\t%s: %s, platform angular velocity %s\n", p_threads ? "multithreaded" : "serial", pass ? "PASS" : "FAILED", String(angular).utf8().get_data());
+
+		_free_space();
+	}
+
+	// Piles of boxes collapsing on the floor, each pile being an island.
+	void _run_piles(int p_piles, int p_height, bool p_threads) {
+		PhysicsServer3DSW::singleton->set_multithreaded_solver(p_threads);
+		_create_space();
+
+		int side = Math::ceil(Math::sqrt((double)p_piles));
+		for (int i = 0; i < p_piles; i++) {
+			Vector3 base((i % side) * 6.0, 0, (i / side) * 6.0);
+			for (int j = 0; j < p_height; j++) {
+				Transform xform;
+				xform.basis.rotate(Vector3(0, 1, 0), j * 0.3);
+				xform.origin = base + Vector3(0.15 * (j % 3), 0.5 + j * 1.1, 0.1 * (j % 2));
+				_create_body(box_shape, xform);
+			}
+		}
+
+		const int steps = 240;
+		uint64_t usec = _simulate(steps);
+		OS::get_singleton()->print("\t%s: %.3f msec per step, %d islands at the end\n", p_threads ? "multithreaded" : "serial", usec / 1000.0 / steps, PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT));
+
+		_free_space();
+	}
+
+public:
+	virtual void init() {
+		if (!PhysicsServer3DSW::singleton) {
+			OS::get_singleton()->print("The benchmark needs the GodotPhysics3D engine (physics/3d/physics_engine).\n");
+			return;
+		}
+
+		PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+		box_shape = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+		ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+		sphere_shape = ps->shape_create(PhysicsServer3D::SHAPE_SPHERE);
+		ps->shape_set_data(sphere_shape, 0.5);
+		plane_shape = ps->shape_create(PhysicsServer3D::SHAPE_PLANE);
+		ps->shape_set_data(plane_shape, Plane(Vector3(0, 1, 0), 0));
+		platform_shape = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+		ps->shape_set_data(platform_shape, Vector3(5, 0.5, 1.5));
+
+		bool was_multithreaded = PhysicsServer3DSW::singleton->is_multithreaded_solver();
+
+		OS::get_singleton()->print("Determinism, 1000 separate bodies for 180 steps:\n");
+		_compare(_run_scattered(false), _run_scattered(true));
+
+		OS::get_singleton()->print("Determinism, 16 piles of 6 boxes on a shared floor and platforms for 240 steps:\n");
+		_compare(_run_stacked(false), _run_stacked(true));
+
+		OS::get_singleton()->print("Kinematic platform under a pile of 6 boxes for 120 steps:\n");
+		_run_kinematic_contact(false);
+		_run_kinematic_contact(true);
+
+		const int piles[] = { 50, 200, 800 };
+		for (int i = 0; i < 3; i++) {
+			OS::get_singleton()->print("%d piles of 8 boxes, %d bodies:\n", piles[i], piles[i] * 8);
+			_run_piles(piles[i], 8, false);
+			_run_piles(piles[i], 8, true);
+		}
+
+		PhysicsServer3DSW::singleton->set_multithreaded_solver(was_multithreaded);
+		ps->free(box_shape);
+		ps->free(sphere_shape);
+		ps->free(plane_shape);
+		ps->free(platform_shape);
+	}
+
+	virtual bool iteration(float p_time) {
+		return true;
+	}
+
+	virtual bool idle(float p_time) {
+		return true;
+	}
+
+	virtual void finish() {
+	}
+};
+
 namespace TestPhysics3D {
 
 MainLoop *test() {
 	return memnew(TestPhysics3DMainLoop);
 }
 
+MainLoop *benchmark() {
+	return memnew(TestPhysics3DBenchmarkMainLoop);
+}
+
 } // namespace TestPhysics3D
@@ -36,6 +36,7 @@
 namespace TestPhysics3D {
 
 MainLoop *test();
+MainLoop *benchmark();
 }
 
 #endif
@@ -0,0 +1,176 @@
+/*************************************************************************/
+/*  test_resource_cache.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_resource_cache.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/resource.h"
+
+namespace TestResourceCache {
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: paths are cached and released\n");
+
+	bool state = true;
+	int count = ResourceCache::get_cached_resource_count();
+	{
+		Ref<Resource> a;
+		a.instance();
+		a->set_path("res://test_cache_a.tres");
+		state = state && ResourceCache::get("res://test_cache_a.tres") == a.ptr();
+		state = state && ResourceCache::get_cached_resource_count() == count + 1;
+
+		// Renaming frees the old path.
+		a->set_path("res://test_cache_b.tres");
+		state = state && !ResourceCache::has("res://test_cache_a.tres");
+		state = state && ResourceCache::get_ref("res://test_cache_b.tres") == a;
+
+		// Taking over a path keeps it when the previous owner is freed.
+		Ref<Resource> b;
+		b.instance();
+		b->set_path("res://test_cache_b.tres", true);
+		state = state && ResourceCache::get("res://test_cache_b.tres") == b.ptr();
+		a.unref();
+		state = state && ResourceCache::get("res://test_cache_b.tres") == b.ptr();
+	}
+	state = state && !ResourceCache::has("res://test_cache_b.tres");
+	state = state && ResourceCache::get_cached_resource_count() == count;
+
+	return state;
+}
+
+struct LookupData {
+	Vector<String> paths;
+	int iterations = 0;
+	int found = 0;
+};
+
+static void _lookup_thread(void *p_userdata) {
+	LookupData *data = (LookupData *)p_userdata;
+	for (int i = 0; i < data->iterations; i++) {
+		// One in four paths isn't cached.
+		if (ResourceCache::get_ref(data->paths[i % data->paths.size()]).is_valid()) {
+			data->found++;
+		}
+	}
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: multithreaded lookups\n");
+
+	const int thread_count = MAX(2, OS::get_singleton()->get_processor_count());
+	const int iterations = 200000;
+
+	Vector<Ref<Resource>> resources;
+	Vector<String> paths;
+	for (int i = 0; i < 1024; i++) {
+		String path = "res://test_cache_" + itos(i) + ".tres";
+		if (i % 4) {
+			Ref<Resource> res;
+			res.instance();
+			res->set_path(path);
+			resources.push_back(res);
+		}
+		paths.push_back(path);
+	}
+
+	Vector<LookupData> data;
+	data.resize(thread_count);
+	for (int i = 0; i < thread_count; i++) {
+		data.write[i].paths = paths;
+		data.write[i].iterations = iterations;
+	}
+
+	ResourceCache::Stats before = ResourceCache::get_total_stats();
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+
+	Vector<Thread *> threads;
+	for (int i = 0; i < thread_count; i++) {
+		threads.push_back(Thread::create(_lookup_thread, &data.write[i]));
+	}
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+	ResourceCache::Stats after = ResourceCache::get_total_stats();
+	uint64_t lookups = after.lookups - before.lookups;
+	uint64_t hits = after.hits - before.hits;
+
+	OS::get_singleton()->print("\t%d threads, %d msec, %d ns per lookup\n", thread_count, int(usec / 1000), int(usec * 1000 / MAX(lookups, (uint64_t)1)));
+	OS::get_singleton()->print("\thit rate %.1f%%, %d contended locks, %d usec waiting\n", hits * 100.0 / MAX(lookups, (uint64_t)1), int(after.lock_waits - before.lock_waits), int(after.lock_wait_usec - before.lock_wait_usec));
+
+	bool state = lookups == uint64_t(thread_count) * iterations;
+	state = state && hits == uint64_t(thread_count) * iterations * 3 / 4;
+	for (int i = 0; i < thread_count; i++) {
+		state = state && data[i].found == iterations * 3 / 4;
+	}
+
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestResourceCache
@@ -0,0 +1,221 @@
+/*************************************************************************/
+/*  test_resource_loader.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_resource_loader.h"
+
+#include "core/io/resource_loader.h"
+#include "core/io/resource_saver.h"
+#include "core/os/dir_access.h"
+#include "core/os/os.h"
+
+namespace TestResourceLoader {
+
+static String res_path(const String &p_name) {
+	return OS::get_singleton()->get_cache_path().plus_file("test_loader_" + p_name + ".res");
+}
+
+// Saves a binary resource named p_name, with external references to the comma
+// separated resources in p_deps as metadata under their names.
+static bool save(const String &p_name, const String &p_deps) {
+	Ref<Resource> res;
+	res.instance();
+	res->set_meta("name", p_name);
+
+	Vector<String> deps = p_deps.split(",", false);
+	for (int i = 0; i < deps.size(); i++) {
+		Ref<Resource> dep;
+		dep.instance();
+		dep->set_path(res_path(deps[i]));
+		res->set_meta(deps[i], dep);
+	}
+	return ResourceSaver::save(res_path(p_name), res) == OK;
+}
+
+static Ref<Resource> get_dep(const Ref<Resource> &p_res, const String &p_name) {
+	if (p_res.is_null() || !p_res->has_meta(p_name)) {
+		return Ref<Resource>();
+	}
+	return p_res->get_meta(p_name);
+}
+
+static bool is_named(const Ref<Resource> &p_res, const String &p_name) {
+	return p_res.is_valid() && p_res->has_meta("name") && String(p_res->get_meta("name")) == p_name;
+}
+
+// Nothing requested must be left behind once a load returns.
+static bool no_task_left(const String &p_name) {
+	return ResourceLoader::load_threaded_get_status(res_path(p_name)) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: dependencies load in parallel\n");
+
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->make_dir_recursive(OS::get_singleton()->get_cache_path());
+	memdelete(da);
+
+	String deps;
+	for (int i = 0; i < 16; i++) {
+		if (!save("leaf" + itos(i), "")) {
+			return false;
+		}
+		deps += (i ? "," : "") + String("leaf") + itos(i);
+	}
+	if (!save("wide", deps)) {
+		return false;
+	}
+
+	bool state = true;
+	for (int parallel = 0; parallel < 2; parallel++) {
+		ResourceLoader::set_parallel_dependency_loads(parallel);
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		Ref<Resource> wide = ResourceLoader::load(res_path("wide"));
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - begin;
+		OS::get_singleton()->print("\t%s: %llu usec\n", parallel ? "parallel" : "serial", (unsigned long long)usec);
+
+		state = state && is_named(wide, "wide");
+		for (int i = 0; i < 16; i++) {
+			state = state && is_named(get_dep(wide, "leaf" + itos(i)), "leaf" + itos(i));
+			state = state && no_task_left("leaf" + itos(i));
+		}
+	}
+	ResourceLoader::set_parallel_dependency_loads(false);
+
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: a shared dependency is loaded once\n");
+
+	if (!save("shared", "") || !save("left", "shared") || !save("right", "shared") || !save("top", "left,right")) {
+		return false;
+	}
+
+	ResourceLoader::set_parallel_dependency_loads(true);
+	Ref<Resource> top = ResourceLoader::load(res_path("top"));
+	ResourceLoader::set_parallel_dependency_loads(false);
+
+	Ref<Resource> shared = get_dep(get_dep(top, "left"), "shared");
+	bool state = is_named(shared, "shared");
+	state = state && get_dep(get_dep(top, "right"), "shared") == shared;
+	state = state && ResourceLoader::load(res_path("shared")) == shared; // Cached.
+	state = state && no_task_left("shared") && no_task_left("left") && no_task_left("right");
+
+	return state;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: cyclic dependencies don't wait for each other\n");
+
+	if (!save("cycle_a", "cycle_b") || !save("cycle_b", "cycle_a")) {
+		return false;
+	}
+
+	// The reference back to the resource being loaded can't be resolved, with or without threads.
+	bool abort = ResourceLoader::get_abort_on_missing_resources();
+	ResourceLoader::set_abort_on_missing_resources(false);
+
+	bool state = true;
+	for (int parallel = 0; parallel < 2; parallel++) {
+		ResourceLoader::set_parallel_dependency_loads(parallel);
+		Ref<Resource> a = ResourceLoader::load(res_path("cycle_a"));
+		Ref<Resource> b = get_dep(a, "cycle_b");
+		state = state && is_named(a, "cycle_a") && is_named(b, "cycle_b");
+		state = state && get_dep(b, "cycle_a").is_null();
+		state = state && no_task_left("cycle_a") && no_task_left("cycle_b");
+	}
+	ResourceLoader::set_parallel_dependency_loads(false);
+	ResourceLoader::set_abort_on_missing_resources(abort);
+
+	return state;
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: dependencies requested by a failed load are released\n");
+
+	if (!save("broken", "missing,leaf0,leaf1,leaf2")) {
+		return false;
+	}
+	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	da->remove(res_path("missing"));
+	memdelete(da);
+
+	OS::get_singleton()->print("\tExpecting errors:\n");
+	ResourceLoader::set_parallel_dependency_loads(true);
+	Ref<Resource> broken = ResourceLoader::load(res_path("broken"));
+	ResourceLoader::set_parallel_dependency_loads(false);
+
+	bool state = broken.is_null();
+	for (int i = 0; i < 3; i++) {
+		state = state && no_task_left("leaf" + itos(i));
+	}
+	state = state && is_named(ResourceLoader::load(res_path("leaf2")), "leaf2");
+
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestResourceLoader
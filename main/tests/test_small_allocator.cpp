@@ -0,0 +1,231 @@
+/*************************************************************************/
+/*  test_small_allocator.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_small_allocator.h"
+
+#include "core/os/os.h"
+#include "core/os/small_allocator.h"
+
+namespace TestSmallAllocator {
+
+static const uint32_t class_sizes[] = { 16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512 };
+static const int class_count = sizeof(class_sizes) / sizeof(class_sizes[0]);
+
+// Returns whether the block at p_memory has room for p_bytes, using that
+// realloc() keeps blocks in place when they still fit their size class.
+// The block may move, r_memory is updated with where it ends up.
+static bool _fits_class(void *&r_memory, uint32_t p_bytes) {
+	void *memory = SmallAllocator::realloc(r_memory, p_bytes);
+	bool fits = memory == r_memory;
+	r_memory = memory;
+	return fits;
+}
+
+static bool test_1() {
+	OS::get_singleton()->print("\n\nTest 1: reuse\n");
+
+	bool state = true;
+
+	// The thread cache hands out the block freed last first.
+	for (int i = 0; i < class_count; i++) {
+		void *a = SmallAllocator::alloc(class_sizes[i]);
+		SmallAllocator::free(a);
+		void *b = SmallAllocator::alloc(class_sizes[i]);
+		if (a != b) {
+			OS::get_singleton()->print("\tBlock of %i bytes not reused.\n", class_sizes[i]);
+			state = false;
+		}
+		SmallAllocator::free(b);
+	}
+
+	// Freed blocks are reused, so a steady alloc/free pattern reserves no more spans.
+	void *blocks[256];
+	for (int i = 0; i < 256; i++) {
+		blocks[i] = SmallAllocator::alloc(i % 256 + 1);
+	}
+	for (int i = 0; i < 256; i++) {
+		SmallAllocator::free(blocks[i]);
+	}
+	uint64_t reserved = SmallAllocator::get_stats().reserved_bytes;
+	for (int j = 0; j < 1000; j++) {
+		for (int i = 0; i < 256; i++) {
+			blocks[i] = SmallAllocator::alloc(i % 256 + 1);
+		}
+		for (int i = 0; i < 256; i++) {
+			SmallAllocator::free(blocks[i]);
+		}
+	}
+	uint64_t reserved_after = SmallAllocator::get_stats().reserved_bytes;
+	if (reserved_after != reserved) {
+		state = false;
+	}
+
+	OS::get_singleton()->print("\tReserved before: %i, after: %i\n", (int)reserved, (int)reserved_after);
+	return state;
+}
+
+static bool test_2() {
+	OS::get_singleton()->print("\n\nTest 2: alignment\n");
+
+	bool state = true;
+	void *blocks[SmallAllocator::MAX_SMALL_SIZE + 1];
+	for (int i = 0; i <= SmallAllocator::MAX_SMALL_SIZE; i++) {
+		blocks[i] = SmallAllocator::alloc(i);
+		if (uintptr_t(blocks[i]) % 16 != 0) {
+			OS::get_singleton()->print("\tBlock of %i bytes not aligned to 16 bytes.\n", i);
+			state = false;
+		}
+		memset(blocks[i], 0xAB, i);
+	}
+	for (int i = 0; i <= SmallAllocator::MAX_SMALL_SIZE; i++) {
+		SmallAllocator::free(blocks[i]);
+	}
+
+	return state;
+}
+
+static bool test_3() {
+	OS::get_singleton()->print("\n\nTest 3: size class boundaries\n");
+
+	bool state = true;
+	uint32_t prev_size = 0;
+	for (int i = 0; i < class_count; i++) {
+		uint32_t size = class_sizes[i];
+
+		// The smallest and largest request of each class must land in it.
+		uint32_t requests[2] = { prev_size + 1, size };
+		for (int j = 0; j < 2; j++) {
+			void *memory = SmallAllocator::alloc(requests[j]);
+			memset(memory, 0xCD, requests[j]);
+			if (!_fits_class(memory, size)) {
+				OS::get_singleton()->print("\tRequest of %i bytes not in the %i byte class.\n", requests[j], size);
+				state = false;
+			}
+			if (size < SmallAllocator::MAX_SMALL_SIZE && _fits_class(memory, size + 1)) {
+				OS::get_singleton()->print("\tRequest of %i bytes fits past its %i byte class.\n", requests[j], size);
+				state = false;
+			}
+			SmallAllocator::free(memory);
+		}
+
+		prev_size = size;
+	}
+
+	// Growing out of a class must keep the contents.
+	uint8_t *memory = (uint8_t *)SmallAllocator::alloc(48);
+	for (int i = 0; i < 48; i++) {
+		memory[i] = i;
+	}
+	memory = (uint8_t *)SmallAllocator::realloc(memory, 200);
+	for (int i = 0; i < 48; i++) {
+		if (memory[i] != i) {
+			state = false;
+		}
+	}
+	SmallAllocator::free(memory);
+
+	return state;
+}
+
+static bool test_4() {
+	OS::get_singleton()->print("\n\nTest 4: large blocks\n");
+
+	bool state = true;
+
+	// Blocks past MAX_SMALL_SIZE come from malloc(), so they reserve no spans.
+	// Nothing may be printed while measuring, since printing can allocate.
+	void *blocks[64];
+	uint64_t reserved = SmallAllocator::get_stats().reserved_bytes;
+	for (int i = 0; i < 64; i++) {
+		uint32_t size = SmallAllocator::MAX_SMALL_SIZE + 1 + i * 1024;
+		blocks[i] = SmallAllocator::alloc(size);
+		memset(blocks[i], 0xEF, size);
+	}
+	uint64_t reserved_after = SmallAllocator::get_stats().reserved_bytes;
+	if (reserved_after != reserved) {
+		state = false;
+	}
+
+	// Large blocks stay with malloc() through realloc(), even when shrunk.
+	for (int i = 0; i < 64; i++) {
+		blocks[i] = SmallAllocator::realloc(blocks[i], i % 2 ? 16 : 100000);
+		if (((uint8_t *)blocks[i])[0] != 0xEF) {
+			state = false;
+		}
+	}
+	for (int i = 0; i < 64; i++) {
+		SmallAllocator::free(blocks[i]);
+	}
+	if (SmallAllocator::get_stats().reserved_bytes != reserved) {
+		state = false;
+	}
+
+	OS::get_singleton()->print("\tReserved before: %i, after: %i\n", (int)reserved, (int)reserved_after);
+	return state;
+}
+
+typedef bool (*TestFunc)();
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count]();
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestSmallAllocator
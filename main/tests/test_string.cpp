@@ -32,6 +32,8 @@
 
 #include "core/io/ip_address.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_name.h"
 #include "core/ustring.h"
 
 #include "modules/modules_enabled.gen.h"
@@ -1127,6 +1129,72 @@ bool test_35() {
 	return state;
 }
 
+struct StringNameStressData {
+	int thread_index = 0;
+	int iterations = 0;
+	Vector<String> shared_names;
+	StringName first_shared;
+};
+
+static void _string_name_stress_thread(void *p_userdata) {
+	StringNameStressData *data = (StringNameStressData *)p_userdata;
+	String prefix = "thread_" + itos(data->thread_index) + "_";
+
+	for (int i = 0; i < data->iterations; i++) {
+		// Mix names shared between all threads with names only this thread uses.
+		StringName shared = data->shared_names[i % data->shared_names.size()];
+		StringName local = prefix + itos(i % 1024);
+		StringName copy = shared;
+		if (i == 0) {
+			data->first_shared = shared;
+		}
+	}
+}
+
+bool test_36() {
+	OS::get_singleton()->print("\n\nTest 36: StringName multithreaded interning\n");
+
+	const int thread_count = MAX(2, OS::get_singleton()->get_processor_count());
+	const int iterations = 200000;
+
+	Vector<String> shared_names;
+	for (int i = 0; i < 256; i++) {
+		shared_names.push_back("shared_name_" + itos(i));
+	}
+
+	Vector<StringNameStressData> data;
+	data.resize(thread_count);
+	for (int i = 0; i < thread_count; i++) {
+		data.write[i].thread_index = i;
+		data.write[i].iterations = iterations;
+		data.write[i].shared_names = shared_names;
+	}
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+
+	Vector<Thread *> threads;
+	for (int i = 0; i < thread_count; i++) {
+		threads.push_back(Thread::create(_string_name_stress_thread, &data.write[i]));
+	}
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+	uint64_t operations = uint64_t(thread_count) * iterations * 3;
+	OS::get_singleton()->print("\t%d threads, %d msec, %d ns per construction\n", thread_count, int(usec / 1000), int(usec * 1000 / operations));
+
+	// The same string must intern to the same name in every thread.
+	bool state = true;
+	for (int i = 0; i < thread_count; i++) {
+		state = state && data[i].first_shared == data[0].first_shared;
+	}
+	state = state && data[0].first_shared == StringName(shared_names[0]);
+
+	return state;
+}
+
 typedef bool (*TestFunc)();
 
 TestFunc test_funcs[] = {
@@ -1166,6 +1234,7 @@ TestFunc test_funcs[] = {
 	test_33,
 	test_34,
 	test_35,
+	test_36,
 	nullptr
 
 };
@@ -0,0 +1,180 @@
+/*************************************************************************/
+/*  test_thread_work_pool.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_thread_work_pool.h"
+
+#include "core/os/os.h"
+#include "core/thread_work_pool.h"
+
+namespace TestThreadWorkPool {
+
+struct Worker {
+	ThreadWorkPool *pool = nullptr;
+	std::atomic<uint64_t> sum = { 0 };
+	std::atomic<uint32_t> sequence = { 0 };
+	uint32_t first_at = 0;
+	uint32_t second_at = 0;
+	uint32_t third_at = 0;
+
+	void add(uint32_t p_index, uint32_t p_unused) {
+		sum.fetch_add(p_index);
+	}
+
+	void nested(uint32_t p_index, uint32_t p_elements) {
+		// Waits from inside a worker, must not deadlock.
+		pool->do_work(p_elements, this, &Worker::add, 0u);
+	}
+
+	void first(uint32_t p_delay) {
+		OS::get_singleton()->delay_usec(p_delay);
+		first_at = sequence.fetch_add(1);
+	}
+
+	void second(uint32_t p_unused) {
+		second_at = sequence.fetch_add(1);
+	}
+
+	void third(uint32_t p_unused) {
+		third_at = sequence.fetch_add(1);
+	}
+};
+
+static bool test_1(ThreadWorkPool *p_pool) {
+	OS::get_singleton()->print("\n\nTest 1: parallel for\n");
+
+	Worker w;
+	w.pool = p_pool;
+	p_pool->do_work(10000, &w, &Worker::add, 0u);
+
+	OS::get_singleton()->print("\tSum: %llu\n", (unsigned long long)w.sum.load());
+	return w.sum.load() == 10000ull * 9999 / 2;
+}
+
+static bool test_2(ThreadWorkPool *p_pool) {
+	OS::get_singleton()->print("\n\nTest 2: nested parallel for\n");
+
+	Worker w;
+	w.pool = p_pool;
+	// More outer elements than threads, so every worker ends up waiting.
+	uint32_t outer = p_pool->get_thread_count() * 4 + 1;
+	p_pool->do_work(outer, &w, &Worker::nested, 100u);
+
+	OS::get_singleton()->print("\tSum: %llu\n", (unsigned long long)w.sum.load());
+	return w.sum.load() == uint64_t(outer) * 4950;
+}
+
+static bool test_3(ThreadWorkPool *p_pool) {
+	OS::get_singleton()->print("\n\nTest 3: dependencies\n");
+
+	bool state = true;
+	for (int i = 0; i < 10; i++) {
+		Worker w;
+		w.pool = p_pool;
+
+		ThreadWorkPool::TaskID first = p_pool->add_task(&w, &Worker::first, 5000u);
+		Vector<ThreadWorkPool::TaskID> first_deps;
+		first_deps.push_back(first);
+		ThreadWorkPool::TaskID second = p_pool->add_task(&w, &Worker::second, 0u, first_deps);
+		Vector<ThreadWorkPool::TaskID> second_deps;
+		second_deps.push_back(first);
+		second_deps.push_back(second);
+		ThreadWorkPool::TaskID third = p_pool->add_task(&w, &Worker::third, 0u, second_deps);
+		ThreadWorkPool::TaskID group = p_pool->add_group_task(100, &w, &Worker::add, 0u, second_deps);
+
+		p_pool->wait_for_task_completion(third);
+		p_pool->wait_for_task_completion(group);
+		p_pool->wait_for_task_completion(second);
+		state = state && p_pool->is_task_completed(first);
+		p_pool->wait_for_task_completion(first);
+
+		state = state && w.first_at < w.second_at && w.second_at < w.third_at && w.sum.load() == 4950;
+	}
+
+	OS::get_singleton()->print("\tOrder respected: %s\n", state ? "yes" : "no");
+	return state;
+}
+
+static bool test_4(ThreadWorkPool *p_pool) {
+	OS::get_singleton()->print("\n\nTest 4: no worker threads\n");
+
+	ThreadWorkPool pool;
+	pool.init(0);
+
+	// The waiting thread runs everything by itself.
+	Worker w;
+	w.pool = &pool;
+	pool.do_work(10, &w, &Worker::nested, 100u);
+	pool.finish();
+
+	OS::get_singleton()->print("\tSum: %llu\n", (unsigned long long)w.sum.load());
+	return w.sum.load() == 10 * 4950;
+}
+
+typedef bool (*TestFunc)(ThreadWorkPool *);
+
+TestFunc test_funcs[] = {
+	test_1,
+	test_2,
+	test_3,
+	test_4,
+	nullptr
+};
+
+MainLoop *test() {
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	ERR_FAIL_COND_V(!pool, nullptr);
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count]) {
+			break;
+		}
+		bool pass = test_funcs[count](pool);
+		if (pass) {
+			passed++;
+		}
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return nullptr;
+}
+
+} // namespace TestThreadWorkPool
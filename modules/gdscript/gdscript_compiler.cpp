@@ -106,13 +106,111 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 		return false;
 	}
 
-	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
+	codegen.opcodes.push_back(_get_operator_opcode(op, on->arguments[0]->get_datatype(), on->arguments[1]->get_datatype())); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
 }
 
+GDScriptFunction::Opcode GDScriptCompiler::_get_operator_opcode(Variant::Operator p_op, const GDScriptParser::DataType &p_a, const GDScriptParser::DataType &p_b) const {
+	// Only builtin types known at compile time can be specialized. The typed
+	// opcodes still check the operands at runtime and fall back to OPCODE_OPERATOR.
+	if (!p_a.has_type || !p_b.has_type || p_a.kind != GDScriptParser::DataType::BUILTIN || p_b.kind != GDScriptParser::DataType::BUILTIN) {
+		return GDScriptFunction::OPCODE_OPERATOR;
+	}
+
+	Variant::Type a = p_a.builtin_type;
+	Variant::Type b = p_b.builtin_type;
+	bool is_compare = p_op == Variant::OP_EQUAL || p_op == Variant::OP_NOT_EQUAL || p_op == Variant::OP_LESS || p_op == Variant::OP_LESS_EQUAL || p_op == Variant::OP_GREATER || p_op == Variant::OP_GREATER_EQUAL;
+
+	if (a == Variant::INT && b == Variant::INT) {
+		switch (p_op) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_OPERATOR_ADD_INT_INT;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_OPERATOR_SUB_INT_INT;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_INT_INT;
+			case Variant::OP_DIVIDE:
+				return GDScriptFunction::OPCODE_OPERATOR_DIV_INT_INT;
+			case Variant::OP_MODULE:
+				return GDScriptFunction::OPCODE_OPERATOR_MOD_INT_INT;
+			default:
+				return is_compare ? GDScriptFunction::OPCODE_OPERATOR_COMPARE_INT_INT : GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	bool a_num = a == Variant::INT || a == Variant::FLOAT;
+	bool b_num = b == Variant::INT || b == Variant::FLOAT;
+
+	if (a_num && b_num) {
+		// At least one of them is a float here, so the result is a float.
+		switch (p_op) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_OPERATOR_ADD_FLOAT_FLOAT;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_OPERATOR_SUB_FLOAT_FLOAT;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_FLOAT_FLOAT;
+			case Variant::OP_DIVIDE:
+				return GDScriptFunction::OPCODE_OPERATOR_DIV_FLOAT_FLOAT;
+			default:
+				return is_compare ? GDScriptFunction::OPCODE_OPERATOR_COMPARE_FLOAT_FLOAT : GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	if (a == Variant::VECTOR2 && b == Variant::VECTOR2) {
+		switch (p_op) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_OPERATOR_ADD_VECTOR2_VECTOR2;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_OPERATOR_SUB_VECTOR2_VECTOR2;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR2_VECTOR2;
+			default:
+				return GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	if (a == Variant::VECTOR2 && b_num) {
+		switch (p_op) {
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR2_FLOAT;
+			case Variant::OP_DIVIDE:
+				return GDScriptFunction::OPCODE_OPERATOR_DIV_VECTOR2_FLOAT;
+			default:
+				return GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	if (a == Variant::VECTOR3 && b == Variant::VECTOR3) {
+		switch (p_op) {
+			case Variant::OP_ADD:
+				return GDScriptFunction::OPCODE_OPERATOR_ADD_VECTOR3_VECTOR3;
+			case Variant::OP_SUBTRACT:
+				return GDScriptFunction::OPCODE_OPERATOR_SUB_VECTOR3_VECTOR3;
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR3_VECTOR3;
+			default:
+				return GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	if (a == Variant::VECTOR3 && b_num) {
+		switch (p_op) {
+			case Variant::OP_MULTIPLY:
+				return GDScriptFunction::OPCODE_OPERATOR_MUL_VECTOR3_FLOAT;
+			case Variant::OP_DIVIDE:
+				return GDScriptFunction::OPCODE_OPERATOR_DIV_VECTOR3_FLOAT;
+			default:
+				return GDScriptFunction::OPCODE_OPERATOR;
+		}
+	}
+
+	return GDScriptFunction::OPCODE_OPERATOR;
+}
+
 GDScriptDataType GDScriptCompiler::_gdtype_from_datatype(const GDScriptParser::DataType &p_datatype) const {
 	if (!p_datatype.has_type) {
 		return GDScriptDataType();
@@ -664,6 +762,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						codegen.alloc_call(on->arguments.size() - 2);
 						for (int i = 0; i < arguments.size(); i++) {
 							codegen.opcodes.push_back(arguments[i]);
+							if (i == 1) {
+								codegen.opcodes.push_back(codegen.call_cache_count++); // call site cache, after the method name
+							}
 						}
 					}
 				} break;
@@ -1618,6 +1719,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.stack_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
+	codegen.call_cache_count = 0;
 	codegen.debug_stack = EngineDebugger::is_active();
 	Vector<StringName> argnames;
 
@@ -1796,6 +1898,10 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
+	gdfunc->_call_cache_count = codegen.call_cache_count;
+	if (codegen.call_cache_count) {
+		gdfunc->_call_caches = memnew_arr(GDScriptFunction::CallCache, codegen.call_cache_count);
+	}
 	gdfunc->name = func_name;
 #ifdef DEBUG_ENABLED
 	if (EngineDebugger::is_active()) {
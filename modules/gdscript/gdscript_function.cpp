@@ -30,7 +30,9 @@
 
 #include "gdscript_function.h"
 
+#include "core/core_string_names.h"
 #include "core/os/os.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
 
@@ -126,6 +128,54 @@ Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_insta
 	return nullptr;
 }
 
+MethodBind *GDScriptFunction::_get_cached_method(int p_cache, Object *p_object, const StringName &p_method) {
+	CallCache &cache = _call_caches[p_cache];
+	const CallCacheEntry *entry = cache.entry.load(std::memory_order_acquire);
+	if (likely(entry && entry->class_name == p_object->get_class_name())) {
+		return entry->method;
+	}
+
+	return _update_call_cache(cache, p_object->get_class_name(), p_method);
+}
+
+MethodBind *GDScriptFunction::_update_call_cache(CallCache &p_cache, const StringName &p_class, const StringName &p_method) {
+	if (p_cache.misses.load(std::memory_order_relaxed) >= CALL_CACHE_MAX_MISSES) {
+		return nullptr; // Gave up on this call site, Object::call does the lookup.
+	}
+	if (p_method == CoreStringNames::get_singleton()->_free) {
+		return nullptr; // Handled by Object::call itself.
+	}
+
+	MethodBind *method = ClassDB::get_method(p_class, p_method);
+	if (!method) {
+		return nullptr;
+	}
+
+	MutexLock lock(call_cache_mutex);
+
+	if (p_cache.misses.load(std::memory_order_relaxed) < CALL_CACHE_MAX_MISSES) {
+		p_cache.misses.fetch_add(1, std::memory_order_relaxed);
+
+		CallCacheEntry entry;
+		entry.class_name = p_class;
+		entry.method = method;
+		call_cache_entries.push_back(entry);
+		p_cache.entry.store(&call_cache_entries.back()->get(), std::memory_order_release);
+	}
+
+	return method;
+}
+
+#ifdef DEBUG_ENABLED
+uint32_t GDScriptFunction::get_call_cache_misses() const {
+	uint32_t misses = 0;
+	for (int i = 0; i < _call_cache_count; i++) {
+		misses += _call_caches[i].misses.load(std::memory_order_relaxed);
+	}
+	return misses;
+}
+#endif
+
 #ifdef DEBUG_ENABLED
 static String _get_var_type(const Variant *p_var) {
 	String basestr;
@@ -184,49 +234,97 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 	return err_text;
 }
 
-#if defined(__GNUC__)
-#define OPCODES_TABLE                         \
-	static const void *switch_table_ops[] = { \
-		&&OPCODE_OPERATOR,                    \
-		&&OPCODE_EXTENDS_TEST,                \
-		&&OPCODE_IS_BUILTIN,                  \
-		&&OPCODE_SET,                         \
-		&&OPCODE_GET,                         \
-		&&OPCODE_SET_NAMED,                   \
-		&&OPCODE_GET_NAMED,                   \
-		&&OPCODE_SET_MEMBER,                  \
-		&&OPCODE_GET_MEMBER,                  \
-		&&OPCODE_ASSIGN,                      \
-		&&OPCODE_ASSIGN_TRUE,                 \
-		&&OPCODE_ASSIGN_FALSE,                \
-		&&OPCODE_ASSIGN_TYPED_BUILTIN,        \
-		&&OPCODE_ASSIGN_TYPED_NATIVE,         \
-		&&OPCODE_ASSIGN_TYPED_SCRIPT,         \
-		&&OPCODE_CAST_TO_BUILTIN,             \
-		&&OPCODE_CAST_TO_NATIVE,              \
-		&&OPCODE_CAST_TO_SCRIPT,              \
-		&&OPCODE_CONSTRUCT,                   \
-		&&OPCODE_CONSTRUCT_ARRAY,             \
-		&&OPCODE_CONSTRUCT_DICTIONARY,        \
-		&&OPCODE_CALL,                        \
-		&&OPCODE_CALL_RETURN,                 \
-		&&OPCODE_CALL_BUILT_IN,               \
-		&&OPCODE_CALL_SELF,                   \
-		&&OPCODE_CALL_SELF_BASE,              \
-		&&OPCODE_YIELD,                       \
-		&&OPCODE_YIELD_SIGNAL,                \
-		&&OPCODE_YIELD_RESUME,                \
-		&&OPCODE_JUMP,                        \
-		&&OPCODE_JUMP_IF,                     \
-		&&OPCODE_JUMP_IF_NOT,                 \
-		&&OPCODE_JUMP_TO_DEF_ARGUMENT,        \
-		&&OPCODE_RETURN,                      \
-		&&OPCODE_ITERATE_BEGIN,               \
-		&&OPCODE_ITERATE,                     \
-		&&OPCODE_ASSERT,                      \
-		&&OPCODE_BREAKPOINT,                  \
-		&&OPCODE_LINE,                        \
-		&&OPCODE_END                          \
+template <class T>
+static _FORCE_INLINE_ bool _compare_values(Variant::Operator p_op, T p_a, T p_b) {
+	switch (p_op) {
+		case Variant::OP_EQUAL:
+			return p_a == p_b;
+		case Variant::OP_NOT_EQUAL:
+			return p_a != p_b;
+		case Variant::OP_LESS:
+			return p_a < p_b;
+		case Variant::OP_LESS_EQUAL:
+			return p_a <= p_b;
+		case Variant::OP_GREATER:
+			return p_a > p_b;
+		case Variant::OP_GREATER_EQUAL:
+			return p_a >= p_b;
+		default:
+			return false;
+	}
+}
+
+#ifdef DEBUG_ENABLED
+#define COUNT_OPCODE opcode_count++
+#else
+#define COUNT_OPCODE
+#endif
+
+// Define GDSCRIPT_DISABLE_COMPUTED_GOTO to benchmark the switch based dispatch on GCC/Clang.
+#if defined(__GNUC__) && !defined(GDSCRIPT_DISABLE_COMPUTED_GOTO)
+#define OPCODES_TABLE                          \
+	static const void *switch_table_ops[] = {  \
+		&&OPCODE_OPERATOR,                     \
+		&&OPCODE_OPERATOR_ADD_INT_INT,         \
+		&&OPCODE_OPERATOR_SUB_INT_INT,         \
+		&&OPCODE_OPERATOR_MUL_INT_INT,         \
+		&&OPCODE_OPERATOR_DIV_INT_INT,         \
+		&&OPCODE_OPERATOR_MOD_INT_INT,         \
+		&&OPCODE_OPERATOR_COMPARE_INT_INT,     \
+		&&OPCODE_OPERATOR_ADD_FLOAT_FLOAT,     \
+		&&OPCODE_OPERATOR_SUB_FLOAT_FLOAT,     \
+		&&OPCODE_OPERATOR_MUL_FLOAT_FLOAT,     \
+		&&OPCODE_OPERATOR_DIV_FLOAT_FLOAT,     \
+		&&OPCODE_OPERATOR_COMPARE_FLOAT_FLOAT, \
+		&&OPCODE_OPERATOR_ADD_VECTOR2_VECTOR2, \
+		&&OPCODE_OPERATOR_SUB_VECTOR2_VECTOR2, \
+		&&OPCODE_OPERATOR_MUL_VECTOR2_VECTOR2, \
+		&&OPCODE_OPERATOR_MUL_VECTOR2_FLOAT,   \
+		&&OPCODE_OPERATOR_DIV_VECTOR2_FLOAT,   \
+		&&OPCODE_OPERATOR_ADD_VECTOR3_VECTOR3, \
+		&&OPCODE_OPERATOR_SUB_VECTOR3_VECTOR3, \
+		&&OPCODE_OPERATOR_MUL_VECTOR3_VECTOR3, \
+		&&OPCODE_OPERATOR_MUL_VECTOR3_FLOAT,   \
+		&&OPCODE_OPERATOR_DIV_VECTOR3_FLOAT,   \
+		&&OPCODE_EXTENDS_TEST,                 \
+		&&OPCODE_IS_BUILTIN,                   \
+		&&OPCODE_SET,                          \
+		&&OPCODE_GET,                          \
+		&&OPCODE_SET_NAMED,                    \
+		&&OPCODE_GET_NAMED,                    \
+		&&OPCODE_SET_MEMBER,                   \
+		&&OPCODE_GET_MEMBER,                   \
+		&&OPCODE_ASSIGN,                       \
+		&&OPCODE_ASSIGN_TRUE,                  \
+		&&OPCODE_ASSIGN_FALSE,                 \
+		&&OPCODE_ASSIGN_TYPED_BUILTIN,         \
+		&&OPCODE_ASSIGN_TYPED_NATIVE,          \
+		&&OPCODE_ASSIGN_TYPED_SCRIPT,          \
+		&&OPCODE_CAST_TO_BUILTIN,              \
+		&&OPCODE_CAST_TO_NATIVE,               \
+		&&OPCODE_CAST_TO_SCRIPT,               \
+		&&OPCODE_CONSTRUCT,                    \
+		&&OPCODE_CONSTRUCT_ARRAY,              \
+		&&OPCODE_CONSTRUCT_DICTIONARY,         \
+		&&OPCODE_CALL,                         \
+		&&OPCODE_CALL_RETURN,                  \
+		&&OPCODE_CALL_BUILT_IN,                \
+		&&OPCODE_CALL_SELF,                    \
+		&&OPCODE_CALL_SELF_BASE,               \
+		&&OPCODE_YIELD,                        \
+		&&OPCODE_YIELD_SIGNAL,                 \
+		&&OPCODE_YIELD_RESUME,                 \
+		&&OPCODE_JUMP,                         \
+		&&OPCODE_JUMP_IF,                      \
+		&&OPCODE_JUMP_IF_NOT,                  \
+		&&OPCODE_JUMP_TO_DEF_ARGUMENT,         \
+		&&OPCODE_RETURN,                       \
+		&&OPCODE_ITERATE_BEGIN,                \
+		&&OPCODE_ITERATE,                      \
+		&&OPCODE_ASSERT,                       \
+		&&OPCODE_BREAKPOINT,                   \
+		&&OPCODE_LINE,                         \
+		&&OPCODE_END                           \
 	};
 
 #define OPCODE(m_op) \
@@ -236,7 +334,9 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 	OPSEXIT:
 #define OPCODES_OUT \
 	OPSOUT:
-#define DISPATCH_OPCODE goto *switch_table_ops[_code_ptr[ip]]
+#define DISPATCH_OPCODE \
+	COUNT_OPCODE;       \
+	goto *switch_table_ops[_code_ptr[ip]]
 #define OPCODE_SWITCH(m_test) DISPATCH_OPCODE;
 #define OPCODE_BREAK goto OPSEXIT
 #define OPCODE_OUT goto OPSOUT
@@ -247,7 +347,9 @@ String GDScriptFunction::_get_call_error(const Callable::CallError &p_err, const
 #define OPCODES_END
 #define OPCODES_OUT
 #define DISPATCH_OPCODE continue
-#define OPCODE_SWITCH(m_test) switch (m_test)
+#define OPCODE_SWITCH(m_test) \
+	COUNT_OPCODE;             \
+	switch (m_test)
 #define OPCODE_BREAK break
 #define OPCODE_OUT break
 #endif
@@ -399,6 +501,26 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 
+// Typed operators share the OPCODE_OPERATOR layout, so when the operands turn
+// out not to match the types inferred at compile time they jump to the
+// generic handler, which evaluates through Variant and reports errors.
+#define OPCODE_OPERATOR_TYPED(m_opcode, m_valid, m_eval) \
+	OPCODE(m_opcode) {                                   \
+		CHECK_SPACE(5);                                  \
+		GET_VARIANT_PTR(a, 2);                           \
+		GET_VARIANT_PTR(b, 3);                           \
+		GET_VARIANT_PTR(dst, 4);                         \
+		if (unlikely(!(m_valid))) {                      \
+			goto operator_generic;                       \
+		}                                                \
+		m_eval;                                          \
+		ip += 5;                                         \
+	}                                                    \
+	DISPATCH_OPCODE
+
+#define IS_FLOAT_PAIR(m_a, m_b) \
+	(((m_a)->get_type() == Variant::FLOAT && (m_b)->is_num()) || ((m_a)->get_type() == Variant::INT && (m_b)->get_type() == Variant::FLOAT))
+
 #ifdef DEBUG_ENABLED
 
 	uint64_t function_start_time = 0;
@@ -410,6 +532,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		profile.call_count++;
 		profile.frame_call_count++;
 	}
+	uint64_t opcode_count = 0;
 	bool exit_ok = false;
 	bool yielded = false;
 #endif
@@ -423,6 +546,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 		OPCODE_SWITCH(_code_ptr[ip]) {
 			OPCODE(OPCODE_OPERATOR) {
+			operator_generic:
 				CHECK_SPACE(5);
 
 				bool valid;
@@ -457,6 +581,54 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_ADD_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT,
+					VariantInternal::set_int(dst, *VariantInternal::get_int(a) + *VariantInternal::get_int(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_SUB_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT,
+					VariantInternal::set_int(dst, *VariantInternal::get_int(a) - *VariantInternal::get_int(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT,
+					VariantInternal::set_int(dst, *VariantInternal::get_int(a) * *VariantInternal::get_int(b)));
+			// Division by zero goes through the generic path so it reports the error.
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_DIV_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT && *VariantInternal::get_int(b) != 0,
+					VariantInternal::set_int(dst, *VariantInternal::get_int(a) / *VariantInternal::get_int(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MOD_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT && *VariantInternal::get_int(b) != 0,
+					VariantInternal::set_int(dst, *VariantInternal::get_int(a) % *VariantInternal::get_int(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_COMPARE_INT_INT, a->get_type() == Variant::INT && b->get_type() == Variant::INT,
+					VariantInternal::set_bool(dst, _compare_values((Variant::Operator)_code_ptr[ip + 1], *VariantInternal::get_int(a), *VariantInternal::get_int(b))));
+
+			// Mixed int/float operands are promoted to float, as long as one of them is a float.
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_ADD_FLOAT_FLOAT, IS_FLOAT_PAIR(a, b),
+					VariantInternal::set_float(dst, VariantInternal::get_number(a) + VariantInternal::get_number(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_SUB_FLOAT_FLOAT, IS_FLOAT_PAIR(a, b),
+					VariantInternal::set_float(dst, VariantInternal::get_number(a) - VariantInternal::get_number(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_FLOAT_FLOAT, IS_FLOAT_PAIR(a, b),
+					VariantInternal::set_float(dst, VariantInternal::get_number(a) * VariantInternal::get_number(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_DIV_FLOAT_FLOAT, IS_FLOAT_PAIR(a, b) && VariantInternal::get_number(b) != 0,
+					VariantInternal::set_float(dst, VariantInternal::get_number(a) / VariantInternal::get_number(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_COMPARE_FLOAT_FLOAT, IS_FLOAT_PAIR(a, b),
+					VariantInternal::set_bool(dst, _compare_values((Variant::Operator)_code_ptr[ip + 1], VariantInternal::get_number(a), VariantInternal::get_number(b))));
+
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_ADD_VECTOR2_VECTOR2, a->get_type() == Variant::VECTOR2 && b->get_type() == Variant::VECTOR2,
+					VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) + *VariantInternal::get_vector2(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_SUB_VECTOR2_VECTOR2, a->get_type() == Variant::VECTOR2 && b->get_type() == Variant::VECTOR2,
+					VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) - *VariantInternal::get_vector2(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_VECTOR2_VECTOR2, a->get_type() == Variant::VECTOR2 && b->get_type() == Variant::VECTOR2,
+					VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) * *VariantInternal::get_vector2(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_VECTOR2_FLOAT, a->get_type() == Variant::VECTOR2 && b->is_num(),
+					VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) * real_t(VariantInternal::get_number(b))));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_DIV_VECTOR2_FLOAT, a->get_type() == Variant::VECTOR2 && b->is_num(),
+					VariantInternal::set_vector2(dst, *VariantInternal::get_vector2(a) / real_t(VariantInternal::get_number(b))));
+
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_ADD_VECTOR3_VECTOR3, a->get_type() == Variant::VECTOR3 && b->get_type() == Variant::VECTOR3,
+					VariantInternal::set_vector3(dst, *VariantInternal::get_vector3(a) + *VariantInternal::get_vector3(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_SUB_VECTOR3_VECTOR3, a->get_type() == Variant::VECTOR3 && b->get_type() == Variant::VECTOR3,
+					VariantInternal::set_vector3(dst, *VariantInternal::get_vector3(a) - *VariantInternal::get_vector3(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_VECTOR3_VECTOR3, a->get_type() == Variant::VECTOR3 && b->get_type() == Variant::VECTOR3,
+					VariantInternal::set_vector3(dst, *VariantInternal::get_vector3(a) * *VariantInternal::get_vector3(b)));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_MUL_VECTOR3_FLOAT, a->get_type() == Variant::VECTOR3 && b->is_num(),
+					VariantInternal::set_vector3(dst, *VariantInternal::get_vector3(a) * real_t(VariantInternal::get_number(b))));
+			OPCODE_OPERATOR_TYPED(OPCODE_OPERATOR_DIV_VECTOR3_FLOAT, a->get_type() == Variant::VECTOR3 && b->is_num(),
+					VariantInternal::set_vector3(dst, *VariantInternal::get_vector3(a) / real_t(VariantInternal::get_number(b))));
+
 			OPCODE(OPCODE_EXTENDS_TEST) {
 				CHECK_SPACE(4);
 
@@ -1008,18 +1180,21 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 				bool call_ret = _code_ptr[ip] == OPCODE_CALL_RETURN;
 
 				int argc = _code_ptr[ip + 1];
 				GET_VARIANT_PTR(base, 2);
 				int nameg = _code_ptr[ip + 3];
+				int call_cache = _code_ptr[ip + 4];
 
 				GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
+				GD_ERR_BREAK(call_cache < 0 || call_cache >= _call_cache_count);
+
 				GD_ERR_BREAK(argc < 0);
-				ip += 4;
+				ip += 5;
 				CHECK_SPACE(argc + 1);
 				Variant **argptrs = call_args;
 
@@ -1036,8 +1211,30 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 
 #endif
+				// Native methods of objects without a script can skip the
+				// ClassDB lookup done by Object::call, using the call site cache.
+				Object *obj = nullptr;
+				if (base->get_type() == Variant::OBJECT) {
+#ifdef DEBUG_ENABLED
+					obj = EngineDebugger::is_active() ? base->get_validated_object() : base->operator Object *();
+#else
+					obj = base->operator Object *();
+#endif
+				}
+				MethodBind *method = (obj && !obj->get_script_instance()) ? _get_cached_method(call_cache, obj, *methodname) : nullptr;
+
 				Callable::CallError err;
-				if (call_ret) {
+				if (method) {
+#ifdef DEBUG_ENABLED
+					_ObjectDebugLock debug_lock(obj);
+#endif
+					if (call_ret) {
+						GET_VARIANT_PTR(ret, argc);
+						*ret = method->call(obj, (const Variant **)argptrs, argc, err);
+					} else {
+						method->call(obj, (const Variant **)argptrs, argc, err);
+					}
+				} else if (call_ret) {
 					GET_VARIANT_PTR(ret, argc);
 					base->call_ptr(*methodname, (const Variant **)argptrs, argc, ret, err);
 				} else {
@@ -1553,6 +1750,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 		profile.self_time += time_taken - function_call_time;
 		profile.frame_total_time += time_taken;
 		profile.frame_self_time += time_taken - function_call_time;
+		profile.opcode_count += opcode_count;
 		GDScriptLanguage::get_singleton()->script_frame_time += time_taken - function_call_time;
 	}
 
@@ -1711,11 +1909,16 @@ GDScriptFunction::GDScriptFunction() :
 	profile.last_frame_call_count = 0;
 	profile.last_frame_self_time = 0;
 	profile.last_frame_total_time = 0;
+	profile.opcode_count = 0;
 
 #endif
 }
 
 GDScriptFunction::~GDScriptFunction() {
+	if (_call_caches) {
+		memdelete_arr(_call_caches);
+	}
+
 #ifdef DEBUG_ENABLED
 
 	MutexLock lock(GDScriptLanguage::get_singleton()->lock);
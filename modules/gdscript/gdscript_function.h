@@ -31,6 +31,7 @@
 #ifndef GDSCRIPT_FUNCTION_H
 #define GDSCRIPT_FUNCTION_H
 
+#include "core/os/mutex.h"
 #include "core/os/thread.h"
 #include "core/pair.h"
 #include "core/reference.h"
@@ -39,6 +40,8 @@
 #include "core/string_name.h"
 #include "core/variant.h"
 
+#include <atomic>
+
 class GDScriptInstance;
 class GDScript;
 
@@ -158,6 +161,29 @@ class GDScriptFunction {
 public:
 	enum Opcode {
 		OPCODE_OPERATOR,
+		// Type-specialized operators, emitted when both operand types are known.
+		// Same layout as OPCODE_OPERATOR, which is used as fallback on type mismatch.
+		OPCODE_OPERATOR_ADD_INT_INT,
+		OPCODE_OPERATOR_SUB_INT_INT,
+		OPCODE_OPERATOR_MUL_INT_INT,
+		OPCODE_OPERATOR_DIV_INT_INT,
+		OPCODE_OPERATOR_MOD_INT_INT,
+		OPCODE_OPERATOR_COMPARE_INT_INT,
+		OPCODE_OPERATOR_ADD_FLOAT_FLOAT,
+		OPCODE_OPERATOR_SUB_FLOAT_FLOAT,
+		OPCODE_OPERATOR_MUL_FLOAT_FLOAT,
+		OPCODE_OPERATOR_DIV_FLOAT_FLOAT,
+		OPCODE_OPERATOR_COMPARE_FLOAT_FLOAT,
+		OPCODE_OPERATOR_ADD_VECTOR2_VECTOR2,
+		OPCODE_OPERATOR_SUB_VECTOR2_VECTOR2,
+		OPCODE_OPERATOR_MUL_VECTOR2_VECTOR2,
+		OPCODE_OPERATOR_MUL_VECTOR2_FLOAT,
+		OPCODE_OPERATOR_DIV_VECTOR2_FLOAT,
+		OPCODE_OPERATOR_ADD_VECTOR3_VECTOR3,
+		OPCODE_OPERATOR_SUB_VECTOR3_VECTOR3,
+		OPCODE_OPERATOR_MUL_VECTOR3_VECTOR3,
+		OPCODE_OPERATOR_MUL_VECTOR3_FLOAT,
+		OPCODE_OPERATOR_DIV_VECTOR3_FLOAT,
 		OPCODE_EXTENDS_TEST,
 		OPCODE_IS_BUILTIN,
 		OPCODE_SET,
@@ -266,6 +292,30 @@ private:
 
 	List<StackDebug> stack_debug;
 
+	// Inline cache for OPCODE_CALL/OPCODE_CALL_RETURN, one per call site.
+	// Entries are immutable once published, so they can be read without locking.
+	struct CallCacheEntry {
+		StringName class_name;
+		MethodBind *method = nullptr;
+	};
+
+	struct CallCache {
+		std::atomic<CallCacheEntry *> entry = { nullptr };
+		std::atomic<uint32_t> misses = { 0 };
+	};
+
+	enum {
+		CALL_CACHE_MAX_MISSES = 4, // Give up on call sites that see too many classes.
+	};
+
+	CallCache *_call_caches = nullptr;
+	int _call_cache_count = 0;
+	List<CallCacheEntry> call_cache_entries;
+	Mutex call_cache_mutex;
+
+	_FORCE_INLINE_ MethodBind *_get_cached_method(int p_cache, Object *p_object, const StringName &p_method);
+	MethodBind *_update_call_cache(CallCache &p_cache, const StringName &p_class, const StringName &p_method);
+
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant &static_ref, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Callable::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
@@ -287,6 +337,7 @@ private:
 		uint64_t last_frame_call_count;
 		uint64_t last_frame_self_time;
 		uint64_t last_frame_total_time;
+		uint64_t opcode_count;
 	} profile;
 
 #endif
@@ -325,6 +376,12 @@ public:
 	StringName get_source() const { return source; }
 
 	void debug_get_stack_member_state(int p_line, List<Pair<StringName, int>> *r_stackvars) const;
+#ifdef DEBUG_ENABLED
+	// Number of opcodes dispatched while profiling was enabled.
+	uint64_t get_profile_opcode_count() const { return profile.opcode_count; }
+	// Times call sites in this function had to look up a method, summed.
+	uint32_t get_call_cache_misses() const;
+#endif
 
 	_FORCE_INLINE_ bool is_empty() const { return _code_size == 0; }
 
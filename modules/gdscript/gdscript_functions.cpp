@@ -827,9 +827,8 @@ void GDScriptFunctions::call(Function p_func, const Variant **p_args, int p_arg_
 				full_objects = *p_args[1];
 			}
 
-			PackedByteArray barr;
-			int len;
-			Error err = encode_variant(*p_args[0], nullptr, len, full_objects);
+			VariantEncoder encoder;
+			Error err = encoder.encode(*p_args[0], full_objects);
 			if (err) {
 				r_error.error = Callable::CallError::CALL_ERROR_INVALID_ARGUMENT;
 				r_error.argument = 0;
@@ -838,12 +837,7 @@ void GDScriptFunctions::call(Function p_func, const Variant **p_args, int p_arg_
 				return;
 			}
 
-			barr.resize(len);
-			{
-				uint8_t *w = barr.ptrw();
-				encode_variant(*p_args[0], w, len, full_objects);
-			}
-			r_ret = barr;
+			r_ret = encoder.get_data();
 		} break;
 		case BYTES_TO_VAR: {
 			bool allow_objects = false;
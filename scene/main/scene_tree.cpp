@@ -31,6 +31,7 @@
 #include "scene_tree.h"
 
 #include "core/debugger/engine_debugger.h"
+#include "core/frame_arena.h"
 #include "core/input/input.h"
 #include "core/io/marshalls.h"
 #include "core/io/resource_loader.h"
@@ -798,12 +799,11 @@ void SceneTree::_notify_group_pause(const StringName &p_group, int p_notificatio
 
 	_update_group_order(g, p_notification == Node::NOTIFICATION_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PROCESS || p_notification == Node::NOTIFICATION_PHYSICS_PROCESS || p_notification == Node::NOTIFICATION_INTERNAL_PHYSICS_PROCESS);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
-
-	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	//copy, in case something is added/removed from process while being called.
+	//the copy lives in the frame arena, so this doesn't touch the heap every frame.
+	int node_count = g.nodes.size();
+	Node **nodes = FrameArena::get_current()->alloc_array<Node *>(node_count);
+	copymem(nodes, g.nodes.ptr(), node_count * sizeof(Node *));
 
 	call_lock++;
 
@@ -854,12 +854,11 @@ void SceneTree::_call_input_pause(const StringName &p_group, const StringName &p
 
 	_update_group_order(g);
 
-	//copy, so copy on write happens in case something is removed from process while being called
-	//performance is not lost because only if something is added/removed the vector is copied.
-	Vector<Node *> nodes_copy = g.nodes;
-
-	int node_count = nodes_copy.size();
-	Node **nodes = nodes_copy.ptrw();
+	//copy, in case something is added/removed from process while being called.
+	//the copy lives in the frame arena, so this doesn't touch the heap every frame.
+	int node_count = g.nodes.size();
+	Node **nodes = FrameArena::get_current()->alloc_array<Node *>(node_count);
+	copymem(nodes, g.nodes.ptr(), node_count * sizeof(Node *));
 
 	Variant arg = p_input;
 	const Variant *v[1] = { &arg };
@@ -32,6 +32,7 @@
 
 #include "core/core_string_names.h"
 #include "core/debugger/engine_debugger.h"
+#include "core/frame_arena.h"
 #include "core/input/input.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
@@ -714,7 +715,7 @@ void Viewport::_notification(int p_what) {
 						}
 
 						if (is_mouse) {
-							List<Map<ObjectID, uint64_t>::Element *> to_erase;
+							FrameVector<Map<ObjectID, uint64_t>::Element *> to_erase;
 
 							for (Map<ObjectID, uint64_t>::Element *E = physics_2d_mouseover.front(); E; E = E->next()) {
 								if (E->get() != frame) {
@@ -729,9 +730,8 @@ void Viewport::_notification(int p_what) {
 								}
 							}
 
-							while (to_erase.size()) {
-								physics_2d_mouseover.erase(to_erase.front()->get());
-								to_erase.pop_front();
+							for (uint32_t i = 0; i < to_erase.size(); i++) {
+								physics_2d_mouseover.erase(to_erase[i]);
 							}
 						}
 					}
@@ -757,6 +757,8 @@ void register_scene_types() {
 
 	ClassDB::register_virtual_class<SceneState>();
 	ClassDB::register_class<PackedScene>();
+	PackedScene::set_pool_max_size(GLOBAL_DEF("memory/limits/scene_pool/max_size", 64));
+	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/scene_pool/max_size", PropertyInfo(Variant::INT, "memory/limits/scene_pool/max_size", PROPERTY_HINT_RANGE, "0,4096,1,or_greater"));
 
 	ClassDB::register_class<SceneTree>();
 	ClassDB::register_virtual_class<SceneTreeTimer>(); //sorry, you can't create it
@@ -38,6 +38,7 @@
 #include "scene/3d/node_3d.h"
 #include "scene/gui/control.h"
 #include "scene/main/instance_placeholder.h"
+#include "scene/scene_string_names.h"
 
 #define PACKED_SCENE_VERSION 2
 
@@ -82,6 +83,11 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 
 	bool gen_node_path_cache = p_edit_state != GEN_EDIT_STATE_DISABLED && node_path_cache.empty();
 
+	const InstancePlan *plan = nullptr;
+	if (use_instance_plans && p_edit_state == GEN_EDIT_STATE_DISABLED && !Engine::get_singleton()->is_editor_hint()) {
+		plan = _get_instance_plan();
+	}
+
 	Map<Ref<Resource>, Ref<Resource>> resources_local_to_scene;
 
 	for (int i = 0; i < nc; i++) {
@@ -147,6 +153,10 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 				}
 #endif
 			}
+		} else if (plan && plan->nodes[i].creation_func) {
+			//node belongs to this scene, its class was already checked when making the plan
+			node = static_cast<Node *>(plan->nodes[i].creation_func());
+
 		} else if (ClassDB::is_class_enabled(snames[n.type])) {
 			//node belongs to this scene and must be created
 			Object *obj = ClassDB::instance(snames[n.type]);
@@ -187,6 +197,12 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 			if (nprop_count) {
 				const NodeData::Property *nprops = &n.properties[0];
 
+				// Only valid if the node was created from the plan too.
+				const InstancePlan::PropertyPlan *pplans = nullptr;
+				if (plan && plan->nodes[i].creation_func) {
+					pplans = &plan->nodes[i].properties[0];
+				}
+
 				for (int j = 0; j < nprop_count; j++) {
 					bool valid;
 					ERR_FAIL_INDEX_V(nprops[j].name, sname_count, nullptr);
@@ -243,7 +259,24 @@ Node *SceneState::instance(GenEditState p_edit_state) const {
 						} else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
 							value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
 						}
-						node->set(snames[nprops[j].name], value, &valid);
+
+						if (pplans && pplans[j].setter) {
+							// Same as Object::set(), minus looking up the setter.
+							ScriptInstance *si = node->get_script_instance();
+							if (!si || !si->set(snames[nprops[j].name], value)) {
+								Callable::CallError ce;
+								if (pplans[j].index >= 0) {
+									Variant index = pplans[j].index;
+									const Variant *args[2] = { &index, &value };
+									pplans[j].setter->call(node, args, 2, ce);
+								} else {
+									const Variant *args[1] = { &value };
+									pplans[j].setter->call(node, args, 1, ce);
+								}
+							}
+						} else {
+							node->set(snames[nprops[j].name], value, &valid);
+						}
 					}
 				}
 			}
@@ -365,6 +398,57 @@ static int _vm_get_variant(const Variant &p_variant, HashMap<Variant, int, Varia
 	return idx;
 }
 
+const SceneState::InstancePlan *SceneState::_get_instance_plan() const {
+	MutexLock lock(instance_plan_mutex);
+	if (instance_plan) {
+		return instance_plan;
+	}
+
+	InstancePlan *plan = memnew(InstancePlan);
+	plan->nodes.resize(nodes.size());
+
+	for (int i = 0; i < nodes.size(); i++) {
+		const NodeData &n = nodes[i];
+		InstancePlan::NodePlan &np = plan->nodes[i];
+
+		if ((i == 0 && base_scene_idx >= 0) || n.instance >= 0 || n.type == TYPE_INSTANCED) {
+			// Comes from another scene, its class isn't known until then.
+			continue;
+		}
+		ERR_CONTINUE(n.type < 0 || n.type >= names.size());
+
+		const StringName &type = names[n.type];
+		if (!ClassDB::is_parent_class(type, "Node")) {
+			continue; // Missing or not a node, leave it to the fallback path.
+		}
+		np.creation_func = ClassDB::get_creation_func(type);
+		if (!np.creation_func) {
+			continue;
+		}
+
+		np.properties.resize(n.properties.size());
+		for (int j = 0; j < n.properties.size(); j++) {
+			ERR_CONTINUE(n.properties[j].name < 0 || n.properties[j].name >= names.size());
+			const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(type, names[n.properties[j].name]);
+			if (psg && psg->_setptr) {
+				np.properties[j].setter = psg->_setptr;
+				np.properties[j].index = psg->index;
+			}
+		}
+	}
+
+	instance_plan = plan;
+	return plan;
+}
+
+void SceneState::_clear_instance_plan() {
+	MutexLock lock(instance_plan_mutex);
+	if (instance_plan) {
+		memdelete(instance_plan);
+		instance_plan = nullptr;
+	}
+}
+
 Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map) {
 	// this function handles all the work related to properly packing scenes, be it
 	// instanced or inherited.
@@ -900,6 +984,7 @@ String SceneState::get_path() const {
 }
 
 void SceneState::clear() {
+	_clear_instance_plan();
 	names.clear();
 	variants.clear();
 	nodes.clear();
@@ -1014,6 +1099,12 @@ void SceneState::set_disable_placeholders(bool p_disable) {
 	disable_placeholders = p_disable;
 }
 
+bool SceneState::use_instance_plans = true;
+
+void SceneState::set_use_instance_plans(bool p_enable) {
+	use_instance_plans = p_enable;
+}
+
 bool SceneState::is_connection(int p_node, const StringName &p_signal, int p_to_node, const StringName &p_to_method) const {
 	ERR_FAIL_COND_V(p_node < 0, false);
 	ERR_FAIL_COND_V(p_to_node < 0, false);
@@ -1056,6 +1147,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 	ERR_FAIL_COND(!p_dictionary.has("conns"));
 	//ERR_FAIL_COND( !p_dictionary.has("path"));
 
+	_clear_instance_plan();
+
 	int version = 1;
 	if (p_dictionary.has("version")) {
 		version = p_dictionary["version"];
@@ -1502,6 +1595,7 @@ int SceneState::add_node_path(const NodePath &p_path) {
 }
 
 int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int p_instance, int p_index) {
+	_clear_instance_plan();
 	NodeData nd;
 	nd.parent = p_parent;
 	nd.owner = p_owner;
@@ -1519,6 +1613,7 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 	ERR_FAIL_INDEX(p_node, nodes.size());
 	ERR_FAIL_INDEX(p_name, names.size());
 	ERR_FAIL_INDEX(p_value, variants.size());
+	_clear_instance_plan();
 
 	NodeData::Property prop;
 	prop.name = p_name;
@@ -1603,9 +1698,14 @@ SceneState::SceneState() {
 	last_modified_time = 0;
 }
 
+SceneState::~SceneState() {
+	_clear_instance_plan();
+}
+
 ////////////////
 
 void PackedScene::_set_bundled_scene(const Dictionary &p_scene) {
+	clear_pool();
 	state->set_bundled_scene(p_scene);
 }
 
@@ -1614,10 +1714,12 @@ Dictionary PackedScene::_get_bundled_scene() const {
 }
 
 Error PackedScene::pack(Node *p_scene) {
+	clear_pool();
 	return state->pack(p_scene);
 }
 
 void PackedScene::clear() {
+	clear_pool();
 	state->clear();
 }
 
@@ -1649,6 +1751,7 @@ Node *PackedScene::instance(GenEditState p_edit_state) const {
 }
 
 void PackedScene::replace_state(Ref<SceneState> p_by) {
+	clear_pool();
 	state = p_by;
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1657,6 +1760,7 @@ void PackedScene::replace_state(Ref<SceneState> p_by) {
 }
 
 void PackedScene::recreate_state() {
+	clear_pool();
 	state = Ref<SceneState>(memnew(SceneState));
 	state->set_path(get_path());
 #ifdef TOOLS_ENABLED
@@ -1673,6 +1777,315 @@ void PackedScene::set_path(const String &p_path, bool p_take_over) {
 	Resource::set_path(p_path, p_take_over);
 }
 
+int PackedScene::pool_max_size = 64;
+std::atomic<uint32_t> PackedScene::pool_parked = { 0 };
+std::atomic<uint64_t> PackedScene::pool_hits = { 0 };
+std::atomic<uint64_t> PackedScene::pool_misses = { 0 };
+
+void PackedScene::set_pool_max_size(int p_size) {
+	pool_max_size = MAX(p_size, 0);
+}
+
+// Path of a node relative to the scene root, "" for the root itself.
+static String _pool_path_key(const String &p_base, const NodePath &p_path) {
+	String key = p_base;
+	for (int i = 0; i < p_path.get_name_count(); i++) {
+		String name = p_path.get_name(i);
+		if (name == ".") {
+			continue;
+		}
+		key = key.empty() ? name : key + "/" + name;
+	}
+	return key;
+}
+
+static bool _pool_is_local_resource(const Variant &p_value) {
+	if (p_value.get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Ref<Resource> res = p_value;
+	return res.is_valid() && res->is_local_to_scene();
+}
+
+void PackedScene::_pool_collect_state(const Ref<SceneState> &p_state, const String &p_base, PoolStateProperties &r_properties) {
+	for (int i = 0; i < p_state->get_node_count(); i++) {
+		String path = _pool_path_key(p_base, p_state->get_node_path(i));
+
+		// Instanced and inherited scenes set their values first, this state overrides them.
+		Ref<PackedScene> instance = p_state->get_node_instance(i);
+		if (instance.is_valid() && instance->get_state().is_valid()) {
+			_pool_collect_state(instance->get_state(), path, r_properties);
+		}
+
+		LocalVector<Pair<StringName, Variant>> &properties = r_properties[path];
+		for (int j = 0; j < p_state->get_node_property_count(i); j++) {
+			StringName name = p_state->get_node_property_name(i, j);
+			Variant value = p_state->get_node_property_value(i, j);
+			bool found = false;
+			for (uint32_t k = 0; k < properties.size(); k++) {
+				if (properties[k].first == name) {
+					properties[k].second = value;
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				properties.push_back(Pair<StringName, Variant>(name, value));
+			}
+		}
+	}
+}
+
+void PackedScene::_pool_make_template(Node *p_node, const String &p_path, const PoolStateProperties &p_properties, Vector<PoolNode> &r_template) {
+	PoolNode pn;
+	pn.type = p_node->get_class_name();
+	pn.child_count = p_node->get_child_count();
+
+	const LocalVector<Pair<StringName, Variant>> *properties = p_properties.getptr(p_path);
+	if (properties) {
+		for (uint32_t i = 0; i < properties->size(); i++) {
+			if (!_pool_is_local_resource((*properties)[i].second)) { // Each instance keeps its own copy.
+				pn.properties.push_back((*properties)[i]);
+			}
+		}
+	}
+
+	// Script variables aren't all stored in the state, take them as the script initialized them.
+	ScriptInstance *si = p_node->get_script_instance();
+	if (si) {
+		pn.has_ready = si->has_method(SceneStringNames::get_singleton()->_ready);
+
+		List<PropertyInfo> plist;
+		si->get_property_list(&plist);
+		for (List<PropertyInfo>::Element *E = plist.front(); E; E = E->next()) {
+			if (!(E->get().usage & PROPERTY_USAGE_SCRIPT_VARIABLE)) {
+				continue;
+			}
+			bool in_state = false;
+			for (uint32_t i = 0; i < pn.properties.size(); i++) {
+				if (pn.properties[i].first == E->get().name) {
+					in_state = true;
+					break;
+				}
+			}
+			Variant value;
+			if (in_state || !si->get(E->get().name, value) || _pool_is_local_resource(value)) {
+				continue;
+			}
+			if (value.get_type() == Variant::OBJECT && !Object::cast_to<Resource>(value)) {
+				continue; // Owned by the fresh instance, can't be shared.
+			}
+			pn.script_variables.push_back(Pair<StringName, Variant>(E->get().name, value));
+		}
+	}
+
+	r_template.push_back(pn);
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		Node *child = p_node->get_child(i);
+		_pool_make_template(child, p_path.empty() ? String(child->get_name()) : p_path + "/" + child->get_name(), p_properties, r_template);
+	}
+}
+
+bool PackedScene::_pool_reset(Node *p_node, const Vector<PoolNode> &p_template, int &r_index) {
+	if (r_index >= p_template.size()) {
+		return false;
+	}
+	const PoolNode &pn = p_template[r_index++];
+	if (p_node->get_class_name() != pn.type || p_node->get_child_count() != pn.child_count) {
+		return false; // Nodes were added or removed, can't be reused.
+	}
+
+	// Only set what changed, most properties of a reused instance don't.
+	for (uint32_t i = 0; i < pn.properties.size(); i++) {
+		const Pair<StringName, Variant> &prop = pn.properties[i];
+		if (p_node->get(prop.first) != prop.second) {
+			p_node->set(prop.first, prop.second);
+		}
+	}
+
+	if (pn.script_variables.size()) {
+		ScriptInstance *si = p_node->get_script_instance();
+		if (!si) {
+			return false;
+		}
+		for (uint32_t i = 0; i < pn.script_variables.size(); i++) {
+			const Pair<StringName, Variant> &var = pn.script_variables[i];
+			Variant value;
+			if (si->get(var.first, value) && value != var.second) {
+				// Containers would otherwise be shared by every reused instance.
+				bool container = var.second.get_type() == Variant::ARRAY || var.second.get_type() == Variant::DICTIONARY;
+				si->set(var.first, container ? var.second.duplicate(true) : var.second);
+			}
+		}
+	}
+
+	if (pn.has_ready) {
+		p_node->request_ready();
+	}
+
+	for (int i = 0; i < p_node->get_child_count(); i++) {
+		if (!_pool_reset(p_node->get_child(i), p_template, r_index)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void PackedScene::_pool_set_template(Node *p_fresh, uint32_t p_generation) {
+	{
+		MutexLock lock(pool_mutex);
+		if (p_generation != pool_generation || !pool_template.empty()) {
+			return;
+		}
+	}
+
+	PoolStateProperties properties;
+	_pool_collect_state(state, String(), properties);
+	Vector<PoolNode> tmpl;
+	_pool_make_template(p_fresh, String(), properties, tmpl);
+
+	MutexLock lock(pool_mutex);
+	if (p_generation == pool_generation && pool_template.empty()) {
+		pool_template = tmpl;
+	}
+}
+
+void PackedScene::_pool_issue(Node *p_node, uint32_t p_generation) {
+	MutexLock lock(pool_mutex);
+
+	// Instances freed without being released leave their entry behind, drop
+	// those every time the map doubles.
+	if (pool_issued.size() >= pool_issued_prune_size) {
+		List<ObjectID> stale;
+		const ObjectID *k = nullptr;
+		while ((k = pool_issued.next(k))) {
+			if (!ObjectDB::get_instance(*k)) {
+				stale.push_back(*k);
+			}
+		}
+		for (List<ObjectID>::Element *E = stale.front(); E; E = E->next()) {
+			pool_issued.erase(E->get());
+		}
+		pool_issued_prune_size = MAX(pool_issued.size() * 2, 64u);
+	}
+
+	pool_issued[p_node->get_instance_id()] = p_generation;
+}
+
+void PackedScene::_pool_park(Node *p_node, uint32_t p_generation) {
+	Vector<PoolNode> tmpl;
+	{
+		MutexLock lock(pool_mutex);
+		if (p_generation != pool_generation || (int)pool.size() >= pool_max_size) {
+			memdelete(p_node);
+			return;
+		}
+		tmpl = pool_template;
+	}
+
+	if (tmpl.empty()) {
+		memdelete(p_node); // Nothing to reset it to.
+		return;
+	}
+
+	// Setters can run scripts, so reset without holding the lock.
+	int index = 0;
+	bool reusable = _pool_reset(p_node, tmpl, index) && index == tmpl.size();
+
+	if (reusable) {
+		MutexLock lock(pool_mutex);
+		if (p_generation == pool_generation && (int)pool.size() < pool_max_size) {
+			pool.push_back(p_node);
+			pool_parked.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	memdelete(p_node);
+}
+
+Node *PackedScene::instance_pooled() {
+	uint32_t generation;
+	{
+		MutexLock lock(pool_mutex);
+		generation = pool_generation;
+		if (pool.size()) {
+			Node *node = pool[pool.size() - 1];
+			pool.resize(pool.size() - 1);
+			pool_parked.fetch_sub(1, std::memory_order_relaxed);
+			pool_hits.fetch_add(1, std::memory_order_relaxed);
+			pool_issued[node->get_instance_id()] = generation;
+			return node;
+		}
+	}
+
+	pool_misses.fetch_add(1, std::memory_order_relaxed);
+	Node *node = instance();
+	if (node) {
+		// Still untouched, so this is what parked instances are reset to.
+		_pool_set_template(node, generation);
+		_pool_issue(node, generation);
+	}
+	return node;
+}
+
+void PackedScene::release_pooled(Node *p_node) {
+	ERR_FAIL_NULL(p_node);
+
+	uint32_t generation;
+	{
+		MutexLock lock(pool_mutex);
+		const uint32_t *issued = pool_issued.getptr(p_node->get_instance_id());
+		ERR_FAIL_COND_MSG(!issued, "Node was not returned by instance_pooled() of this scene, or was already released.");
+		generation = *issued;
+		pool_issued.erase(p_node->get_instance_id());
+	}
+
+	if (p_node->get_parent()) {
+		p_node->get_parent()->remove_child(p_node);
+	}
+	_pool_park(p_node, generation);
+}
+
+void PackedScene::warm_up_pool(int p_count) {
+	ERR_FAIL_COND(p_count < 0);
+
+	for (int i = get_pooled_count(); i < p_count && i < pool_max_size; i++) {
+		uint32_t generation;
+		{
+			MutexLock lock(pool_mutex);
+			generation = pool_generation;
+		}
+		Node *node = instance();
+		ERR_FAIL_NULL(node);
+		_pool_set_template(node, generation);
+		_pool_park(node, generation);
+	}
+}
+
+void PackedScene::clear_pool() {
+	LocalVector<Node *> parked;
+	{
+		MutexLock lock(pool_mutex);
+		parked = pool;
+		pool_parked.fetch_sub(pool.size(), std::memory_order_relaxed);
+		pool.clear();
+		pool_template.clear();
+		// Instances still out belong to the old state, they are freed when released.
+		pool_generation++;
+	}
+
+	for (uint32_t i = 0; i < parked.size(); i++) {
+		memdelete(parked[i]);
+	}
+}
+
+int PackedScene::get_pooled_count() const {
+	MutexLock lock(pool_mutex);
+	return pool.size();
+}
+
 void PackedScene::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("pack", "path"), &PackedScene::pack);
 	ClassDB::bind_method(D_METHOD("instance", "edit_state"), &PackedScene::instance, DEFVAL(GEN_EDIT_STATE_DISABLED));
@@ -1680,6 +2093,11 @@ void PackedScene::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("_set_bundled_scene"), &PackedScene::_set_bundled_scene);
 	ClassDB::bind_method(D_METHOD("_get_bundled_scene"), &PackedScene::_get_bundled_scene);
 	ClassDB::bind_method(D_METHOD("get_state"), &PackedScene::get_state);
+	ClassDB::bind_method(D_METHOD("instance_pooled"), &PackedScene::instance_pooled);
+	ClassDB::bind_method(D_METHOD("release_pooled", "node"), &PackedScene::release_pooled);
+	ClassDB::bind_method(D_METHOD("warm_up_pool", "count"), &PackedScene::warm_up_pool);
+	ClassDB::bind_method(D_METHOD("clear_pool"), &PackedScene::clear_pool);
+	ClassDB::bind_method(D_METHOD("get_pooled_count"), &PackedScene::get_pooled_count);
 
 	ADD_PROPERTY(PropertyInfo(Variant::DICTIONARY, "_bundled"), "_set_bundled_scene", "_get_bundled_scene");
 
@@ -1691,3 +2109,7 @@ void PackedScene::_bind_methods() {
 PackedScene::PackedScene() {
 	state = Ref<SceneState>(memnew(SceneState));
 }
+
+PackedScene::~PackedScene() {
+	clear_pool();
+}
@@ -31,6 +31,8 @@
 #ifndef PACKED_SCENE_H
 #define PACKED_SCENE_H
 
+#include "core/hash_map.h"
+#include "core/local_vector.h"
 #include "core/resource.h"
 #include "scene/main/node.h"
 
@@ -88,6 +90,28 @@ class SceneState : public Reference {
 
 	Vector<ConnectionData> connections;
 
+	// Creation functions and property setters resolved once, so instancing
+	// at runtime doesn't look them up by name for every node every time.
+	struct InstancePlan {
+		struct PropertyPlan {
+			MethodBind *setter = nullptr;
+			int index = -1;
+		};
+
+		struct NodePlan {
+			Object *(*creation_func)() = nullptr;
+			LocalVector<PropertyPlan> properties;
+		};
+
+		LocalVector<NodePlan> nodes;
+	};
+
+	mutable InstancePlan *instance_plan = nullptr;
+	mutable Mutex instance_plan_mutex;
+
+	const InstancePlan *_get_instance_plan() const;
+	void _clear_instance_plan();
+
 	Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 	Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, VariantHasher, VariantComparator> &variant_map, Map<Node *, int> &node_map, Map<Node *, int> &nodepath_map);
 
@@ -98,6 +122,7 @@ class SceneState : public Reference {
 	_FORCE_INLINE_ Ref<SceneState> _get_base_scene_state() const;
 
 	static bool disable_placeholders;
+	static bool use_instance_plans;
 
 	Vector<String> _get_node_groups(int p_idx) const;
 
@@ -121,6 +146,7 @@ public:
 	};
 
 	static void set_disable_placeholders(bool p_disable);
+	static void set_use_instance_plans(bool p_enable);
 
 	int find_node_by_path(const NodePath &p_node) const;
 	Variant get_property_value(int p_node, const StringName &p_property, bool &found) const;
@@ -186,6 +212,7 @@ public:
 	uint64_t get_last_modified_time() const { return last_modified_time; }
 
 	SceneState();
+	~SceneState();
 };
 
 VARIANT_ENUM_CAST(SceneState::GenEditState)
@@ -196,6 +223,37 @@ class PackedScene : public Resource {
 
 	Ref<SceneState> state;
 
+	// Parked instances, reset to how a fresh instance looks and ready to be reused.
+	struct PoolNode {
+		StringName type;
+		int child_count = 0;
+		bool has_ready = false; // Only scripts with _ready() need it called again.
+		LocalVector<Pair<StringName, Variant>> properties; // As stored in the scene state.
+		LocalVector<Pair<StringName, Variant>> script_variables; // As in a fresh instance.
+	};
+	typedef HashMap<String, LocalVector<Pair<StringName, Variant>>> PoolStateProperties;
+
+	LocalVector<Node *> pool;
+	Vector<PoolNode> pool_template; // Depth first, as _pool_reset() visits nodes. Shared while resetting.
+	// Bumped whenever the state changes, so instances of the old state are never parked.
+	uint32_t pool_generation = 0;
+	// Generation of every instance handed out by instance_pooled() and not released yet.
+	HashMap<ObjectID, uint32_t> pool_issued;
+	uint32_t pool_issued_prune_size = 64;
+	mutable Mutex pool_mutex;
+
+	static int pool_max_size;
+	static std::atomic<uint32_t> pool_parked;
+	static std::atomic<uint64_t> pool_hits;
+	static std::atomic<uint64_t> pool_misses;
+
+	static void _pool_collect_state(const Ref<SceneState> &p_state, const String &p_base, PoolStateProperties &r_properties);
+	static void _pool_make_template(Node *p_node, const String &p_path, const PoolStateProperties &p_properties, Vector<PoolNode> &r_template);
+	static bool _pool_reset(Node *p_node, const Vector<PoolNode> &p_template, int &r_index);
+	void _pool_set_template(Node *p_fresh, uint32_t p_generation);
+	void _pool_issue(Node *p_node, uint32_t p_generation);
+	void _pool_park(Node *p_node, uint32_t p_generation);
+
 	void _set_bundled_scene(const Dictionary &p_scene);
 	Dictionary _get_bundled_scene() const;
 
@@ -227,7 +285,19 @@ public:
 #endif
 	Ref<SceneState> get_state();
 
+	Node *instance_pooled();
+	void release_pooled(Node *p_node);
+	void warm_up_pool(int p_count);
+	void clear_pool();
+	int get_pooled_count() const;
+
+	static void set_pool_max_size(int p_size);
+	static uint32_t get_pool_parked_count() { return pool_parked.load(std::memory_order_relaxed); }
+	static uint64_t get_pool_hit_count() { return pool_hits.load(std::memory_order_relaxed); }
+	static uint64_t get_pool_miss_count() { return pool_misses.load(std::memory_order_relaxed); }
+
 	PackedScene();
+	~PackedScene();
 };
 
 VARIANT_ENUM_CAST(PackedScene::GenEditState)
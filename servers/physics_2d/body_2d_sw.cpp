@@ -30,9 +30,16 @@
 
 #include "body_2d_sw.h"
 #include "area_2d_sw.h"
+#include "constraint_2d_sw.h"
 #include "physics_server_2d_sw.h"
 #include "space_2d_sw.h"
 
+uint64_t Constraint2DSW::creation_counter = 0;
+
+bool Body2DSW::ConstraintComparator::operator()(const Constraint2DSW *p_a, const Constraint2DSW *p_b) const {
+	return p_a->get_creation_index() < p_b->get_creation_index();
+}
+
 void Body2DSW::_update_inertia() {
 	if (!user_inertia && get_space() && !inertia_update_list.in_list()) {
 		get_space()->body_add_to_inertia_update_list(&inertia_update_list);
@@ -399,6 +406,8 @@ void Body2DSW::_compute_area_gravity_and_dampenings(const Area2DSW *p_area) {
 }
 
 void Body2DSW::integrate_forces(real_t p_step) {
+	motion_pending = false;
+
 	if (mode == PhysicsServer2D::BODY_MODE_STATIC) {
 		return;
 	}
@@ -518,30 +527,30 @@ void Body2DSW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = 0;
 	biased_linear_velocity = Vector2();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	//shapes temporarily extend for raycast, done in post_integrate_forces()
+	motion_pending = do_motion;
+	pending_motion = motion;
 
 	// damp_area=nullptr; // clear the area, so it is set in the next frame
 	def_area = nullptr; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void Body2DSW::post_integrate_forces() {
+	if (motion_pending) {
+		_update_shapes_with_motion(pending_motion);
+		motion_pending = false;
+	}
+}
+
 void Body2DSW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer2D::BODY_MODE_STATIC) {
 		return;
 	}
 
-	if (fi_callback) {
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-	}
-
 	if (mode == PhysicsServer2D::BODY_MODE_KINEMATIC) {
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
-		if (contacts.size() == 0 && linear_velocity == Vector2() && angular_velocity == 0) {
-			set_active(false); //stopped moving, deactivate
-		}
 		return;
 	}
 
@@ -551,7 +560,7 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	real_t angle = get_transform().get_rotation() + total_angular_velocity * p_step;
 	Vector2 pos = get_transform().get_origin() + total_linear_velocity * p_step;
 
-	_set_transform(Transform2D(angle, pos), continuous_cd_mode == PhysicsServer2D::CCD_MODE_DISABLED);
+	_set_transform(Transform2D(angle, pos), false); //shapes are updated in post_integrate_velocities()
 	_set_inv_transform(get_transform().inverse());
 
 	if (continuous_cd_mode != PhysicsServer2D::CCD_MODE_DISABLED) {
@@ -561,8 +570,29 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	//_update_inertia_tensor();
 }
 
+void Body2DSW::post_integrate_velocities() {
+	if (mode == PhysicsServer2D::BODY_MODE_STATIC) {
+		return;
+	}
+
+	if (fi_callback) {
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	}
+
+	if (mode == PhysicsServer2D::BODY_MODE_KINEMATIC) {
+		if (contacts.size() == 0 && linear_velocity == Vector2() && angular_velocity == 0) {
+			set_active(false); //stopped moving, deactivate
+		}
+		return;
+	}
+
+	if (continuous_cd_mode == PhysicsServer2D::CCD_MODE_DISABLED) {
+		_update_shapes();
+	}
+}
+
 void Body2DSW::wakeup_neighbours() {
-	for (Map<Constraint2DSW *, int>::Element *E = constraint_map.front(); E; E = E->next()) {
+	for (ConstraintMap::Element *E = constraint_map.front(); E; E = E->next()) {
 		const Constraint2DSW *c = E->key();
 		Body2DSW **n = c->get_body_ptr();
 		int bc = c->get_body_count();
@@ -83,7 +83,19 @@ class Body2DSW : public CollisionObject2DSW {
 	virtual void _shapes_changed();
 	Transform2D new_transform;
 
-	Map<Constraint2DSW *, int> constraint_map;
+	Vector2 pending_motion;
+	bool motion_pending = false;
+
+public:
+	// Constraints are visited in creation order rather than by address, so
+	// islands come out the same whenever a scene is built the same way.
+	struct ConstraintComparator {
+		bool operator()(const Constraint2DSW *p_a, const Constraint2DSW *p_b) const;
+	};
+	typedef Map<Constraint2DSW *, int, ConstraintComparator> ConstraintMap;
+
+private:
+	ConstraintMap constraint_map;
 
 	struct AreaCMP {
 		Area2DSW *area;
@@ -181,7 +193,7 @@ public:
 
 	_FORCE_INLINE_ void add_constraint(Constraint2DSW *p_constraint, int p_pos) { constraint_map[p_constraint] = p_pos; }
 	_FORCE_INLINE_ void remove_constraint(Constraint2DSW *p_constraint) { constraint_map.erase(p_constraint); }
-	const Map<Constraint2DSW *, int> &get_constraint_map() const { return constraint_map; }
+	const ConstraintMap &get_constraint_map() const { return constraint_map; }
 	_FORCE_INLINE_ void clear_constraint_map() { constraint_map.clear(); }
 
 	_FORCE_INLINE_ void set_omit_force_integration(bool p_omit_force_integration) { omit_force_integration = p_omit_force_integration; }
@@ -270,8 +282,12 @@ public:
 	_FORCE_INLINE_ real_t get_linear_damp() const { return linear_damp; }
 	_FORCE_INLINE_ real_t get_angular_damp() const { return angular_damp; }
 
+	// Integration runs in parallel for all active bodies, the post_* functions apply
+	// what it can't (broadphase and space list updates) one body at a time.
 	void integrate_forces(real_t p_step);
+	void post_integrate_forces();
 	void integrate_velocities(real_t p_step);
+	void post_integrate_velocities();
 
 	_FORCE_INLINE_ Vector2 get_motion() const {
 		if (mode > PhysicsServer2D::BODY_MODE_KINEMATIC) {
@@ -220,6 +220,9 @@ real_t combine_friction(Body2DSW *A, Body2DSW *B) {
 }
 
 bool BodyPair2DSW::setup(real_t p_step) {
+	dynamic_A = (A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+	dynamic_B = (B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer2D::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
@@ -236,7 +239,6 @@ bool BodyPair2DSW::setup(real_t p_step) {
 
 	_validate_contacts();
 
-	Vector2 offset_A = A->get_transform().get_origin();
 	Transform2D xform_Au = A->get_transform().untranslated();
 	Transform2D xform_A = xform_Au * A->get_shape_transform(shape_A);
 
@@ -282,6 +284,7 @@ bool BodyPair2DSW::setup(real_t p_step) {
 	}
 
 	if (oneway_disabled) {
+		collided = false;
 		return false;
 	}
 
@@ -337,6 +340,23 @@ bool BodyPair2DSW::setup(real_t p_step) {
 		}
 	}
 
+	return true;
+}
+
+bool BodyPair2DSW::pre_solve(real_t p_step) {
+	if (!collided) {
+		return false;
+	}
+
+	Vector2 offset_A = A->get_transform().get_origin();
+	Transform2D xform_Au = A->get_transform().untranslated();
+
+	Transform2D xform_Bu = B->get_transform();
+	xform_Bu.elements[2] -= A->get_transform().get_origin();
+
+	Shape2DSW *shape_A_ptr = A->get_shape(shape_A);
+	Shape2DSW *shape_B_ptr = B->get_shape(shape_B);
+
 	real_t max_penetration = space->get_contact_max_allowed_penetration();
 
 	real_t bias = 0.3;
@@ -427,8 +447,12 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			// Apply normal + friction impulse
 			Vector2 P = c.acc_normal_impulse * c.normal + c.acc_tangent_impulse * tangent;
 
-			A->apply_impulse(c.rA, -P);
-			B->apply_impulse(c.rB, P);
+			if (dynamic_A) {
+				A->apply_impulse(c.rA, -P);
+			}
+			if (dynamic_B) {
+				B->apply_impulse(c.rB, P);
+			}
 		}
 
 #endif
@@ -481,8 +505,12 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-		A->apply_bias_impulse(c.rA, -jb);
-		B->apply_bias_impulse(c.rB, jb);
+		if (dynamic_A) {
+			A->apply_bias_impulse(c.rA, -jb);
+		}
+		if (dynamic_B) {
+			B->apply_bias_impulse(c.rB, jb);
+		}
 
 		real_t jn = -(c.bounce + vn) * c.mass_normal;
 		real_t jnOld = c.acc_normal_impulse;
@@ -497,8 +525,12 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 j = c.normal * (c.acc_normal_impulse - jnOld) + tangent * (c.acc_tangent_impulse - jtOld);
 
-		A->apply_impulse(c.rA, -j);
-		B->apply_impulse(c.rB, j);
+		if (dynamic_A) {
+			A->apply_impulse(c.rA, -j);
+		}
+		if (dynamic_B) {
+			B->apply_impulse(c.rB, j);
+		}
 	}
 }
 
@@ -514,6 +546,8 @@ BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_sh
 	contact_count = 0;
 	collided = false;
 	oneway_disabled = false;
+	dynamic_A = false;
+	dynamic_B = false;
 }
 
 BodyPair2DSW::~BodyPair2DSW() {
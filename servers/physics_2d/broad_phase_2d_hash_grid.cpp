@@ -33,360 +33,452 @@
 
 #define LARGE_ELEMENT_FI 1.01239812
 
-void BroadPhase2DHashGrid::_pair_attempt(Element *p_elem, Element *p_with) {
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+BroadPhase2DHashGrid::Element *BroadPhase2DHashGrid::_get_element(ID p_id) {
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size(), nullptr);
+	Element *e = &elements[p_id - 1];
+	ERR_FAIL_COND_V(!e->owner, nullptr);
+	return e;
+}
+
+const BroadPhase2DHashGrid::Element *BroadPhase2DHashGrid::_get_element(ID p_id) const {
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size(), nullptr);
+	const Element *e = &elements[p_id - 1];
+	ERR_FAIL_COND_V(!e->owner, nullptr);
+	return e;
+}
+
+bool BroadPhase2DHashGrid::_is_large(const Rect2 &p_rect) const {
+	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
+	return sz.width * sz.height > large_object_min_surface;
+}
+
+BroadPhase2DHashGrid::CellRange BroadPhase2DHashGrid::_get_cell_range(const Rect2 &p_rect) const {
+	CellRange range;
+	range.from = (p_rect.position / cell_size).floor();
+	range.to = ((p_rect.position + p_rect.size) / cell_size).floor();
+	return range;
+}
+
+bool BroadPhase2DHashGrid::_can_pair(const Element &p_elem, const Element &p_with) const {
+	return p_elem.owner != p_with.owner && !(p_elem._static && p_with._static);
+}
+
+void BroadPhase2DHashGrid::_pair_attempt(uint32_t p_elem, uint32_t p_with) {
+	ERR_FAIL_COND(elements[p_elem]._static && elements[p_with]._static);
 
-	ERR_FAIL_COND(p_elem->_static && p_with->_static);
+	uint64_t key = p_elem < p_with ? (uint64_t(p_elem) << 32) | p_with : (uint64_t(p_with) << 32) | p_elem;
+	uint32_t *existing = pair_map.getptr(key);
+	if (existing) {
+		pairs[*existing].rc++;
+		return;
+	}
 
-	if (!E) {
-		PairData *pd = memnew(PairData);
-		p_elem->paired[p_with] = pd;
-		p_with->paired[p_elem] = pd;
+	uint32_t index;
+	if (free_pair != INVALID_INDEX) {
+		index = free_pair;
+		free_pair = pairs[index].a;
 	} else {
-		E->get()->rc++;
+		index = pairs.size();
+		pairs.push_back(Pair());
 	}
+
+	Element &a = elements[p_elem];
+	Element &b = elements[p_with];
+
+	Pair &pair = pairs[index];
+	pair.a = p_elem;
+	pair.b = p_with;
+	pair.index_in_a = a.pairs.size();
+	pair.index_in_b = b.pairs.size();
+	pair.rc = 1;
+	pair.colliding = false;
+	pair.ud = nullptr;
+
+	a.pairs.push_back(index);
+	b.pairs.push_back(index);
+	pair_map.set(key, index);
 }
 
-void BroadPhase2DHashGrid::_unpair_attempt(Element *p_elem, Element *p_with) {
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+void BroadPhase2DHashGrid::_remove_element_pair(uint32_t p_elem, uint32_t p_index) {
+	Element &e = elements[p_elem];
+	uint32_t last = e.pairs[e.pairs.size() - 1];
+	e.pairs[p_index] = last;
 
-	ERR_FAIL_COND(!E); //this should really be paired..
+	Pair &moved = pairs[last];
+	if (moved.a == p_elem) {
+		moved.index_in_a = p_index;
+	} else {
+		moved.index_in_b = p_index;
+	}
 
-	E->get()->rc--;
+	e.pairs.resize(e.pairs.size() - 1);
+}
 
-	if (E->get()->rc == 0) {
-		if (E->get()->colliding) {
-			//uncollide
-			if (unpair_callback) {
-				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, E->get()->ud, unpair_userdata);
-			}
-		}
+void BroadPhase2DHashGrid::_unpair_attempt(uint32_t p_elem, uint32_t p_with) {
+	uint64_t key = p_elem < p_with ? (uint64_t(p_elem) << 32) | p_with : (uint64_t(p_with) << 32) | p_elem;
+	uint32_t *existing = pair_map.getptr(key);
+
+	ERR_FAIL_COND(!existing); //this should really be paired..
 
-		memdelete(E->get());
-		p_elem->paired.erase(E);
-		p_with->paired.erase(p_elem);
+	uint32_t index = *existing;
+	Pair &pair = pairs[index];
+
+	pair.rc--;
+	if (pair.rc > 0) {
+		return;
+	}
+
+	if (pair.colliding) {
+		//uncollide
+		if (unpair_callback) {
+			const Element &e = elements[p_elem];
+			const Element &with = elements[p_with];
+			unpair_callback(e.owner, e.subindex, with.owner, with.subindex, pair.ud, unpair_userdata);
+		}
 	}
+
+	_remove_element_pair(pair.a, pair.index_in_a);
+	_remove_element_pair(pair.b, pair.index_in_b);
+	pair_map.erase(key);
+
+	pair.a = free_pair;
+	free_pair = index;
 }
 
-void BroadPhase2DHashGrid::_check_motion(Element *p_elem) {
-	for (Map<Element *, PairData *>::Element *E = p_elem->paired.front(); E; E = E->next()) {
-		bool pairing = p_elem->aabb.intersects(E->key()->aabb);
+void BroadPhase2DHashGrid::_check_motion(uint32_t p_elem) {
+	const Element &e = elements[p_elem];
+
+	for (uint32_t i = 0; i < e.pairs.size(); i++) {
+		Pair &pair = pairs[e.pairs[i]];
+		const Element &with = elements[pair.a == p_elem ? pair.b : pair.a];
+
+		bool pairing = e.aabb.intersects(with.aabb);
 
-		if (pairing != E->get()->colliding) {
+		if (pairing != pair.colliding) {
 			if (pairing) {
 				if (pair_callback) {
-					E->get()->ud = pair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, pair_userdata);
+					pair.ud = pair_callback(e.owner, e.subindex, with.owner, with.subindex, pair_userdata);
 				}
 			} else {
 				if (unpair_callback) {
-					unpair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, E->get()->ud, unpair_userdata);
+					unpair_callback(e.owner, e.subindex, with.owner, with.subindex, pair.ud, unpair_userdata);
 				}
 			}
 
-			E->get()->colliding = pairing;
+			pair.colliding = pairing;
 		}
 	}
 }
 
-void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
-	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
-	if (sz.width * sz.height > large_object_min_surface) {
-		//large object, do not use grid, must check against all elements
-		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
-			if (E->key() == p_elem->self) {
-				continue; // do not pair against itself
-			}
-			if (E->get().owner == p_elem->owner) {
-				continue;
-			}
-			if (E->get()._static && p_static) {
-				continue;
-			}
+uint32_t BroadPhase2DHashGrid::_alloc_cell_block() {
+	uint32_t block;
+	if (free_cell_block != INVALID_INDEX) {
+		block = free_cell_block;
+		free_cell_block = cell_blocks[block].next;
+	} else {
+		block = cell_blocks.size();
+		cell_blocks.push_back(CellBlock());
+	}
 
-			_pair_attempt(p_elem, &E->get());
-		}
+	cell_blocks[block].count = 0;
+	cell_blocks[block].next = INVALID_INDEX;
+	return block;
+}
 
-		large_elements[p_elem].inc();
-		return;
+void BroadPhase2DHashGrid::_cell_add(const PosKey &p_key, uint32_t p_elem) {
+	uint32_t *head = cells.getptr(p_key);
+	uint32_t block;
+
+	if (!head) {
+		//does not exist, create!
+		block = _alloc_cell_block();
+		cells.set(p_key, block);
+	} else if (cell_blocks[*head].count == CELL_BLOCK_SIZE) {
+		uint32_t next = *head;
+		block = _alloc_cell_block();
+		cell_blocks[block].next = next;
+		*head = block;
+	} else {
+		block = *head;
 	}
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+	const Element &e = elements[p_elem];
 
-	for (int i = from.x; i <= to.x; i++) {
-		for (int j = from.y; j <= to.y; j++) {
-			PosKey pk;
-			pk.x = i;
-			pk.y = j;
+	for (uint32_t b = block; b != INVALID_INDEX; b = cell_blocks[b].next) {
+		const CellBlock &cb = cell_blocks[b];
+		for (uint32_t i = 0; i < cb.count; i++) {
+			if (_can_pair(e, elements[cb.elements[i]])) {
+				_pair_attempt(p_elem, cb.elements[i]);
+			}
+		}
+	}
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
+	CellBlock &cb = cell_blocks[block];
+	cb.elements[cb.count++] = p_elem;
+}
 
-			while (pb) {
-				if (pb->key == pk) {
-					break;
-				}
+void BroadPhase2DHashGrid::_cell_remove(const PosKey &p_key, uint32_t p_elem) {
+	uint32_t *head = cells.getptr(p_key);
 
-				pb = pb->next;
-			}
+	ERR_FAIL_COND(!head); //should exist!!
 
-			bool entered = false;
+	// Fill the hole with the last element of the first block.
+	uint32_t first = *head;
+	CellBlock &first_block = cell_blocks[first];
+	bool found = false;
 
-			if (!pb) {
-				//does not exist, create!
-				pb = memnew(PosBin);
-				pb->key = pk;
-				pb->next = hash_table[idx];
-				hash_table[idx] = pb;
+	for (uint32_t b = first; b != INVALID_INDEX && !found; b = cell_blocks[b].next) {
+		CellBlock &cb = cell_blocks[b];
+		for (uint32_t i = 0; i < cb.count; i++) {
+			if (cb.elements[i] == p_elem) {
+				cb.elements[i] = first_block.elements[first_block.count - 1];
+				found = true;
+				break;
 			}
+		}
+	}
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].inc() == 1) {
-					entered = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].inc() == 1) {
-					entered = true;
-				}
-			}
+	ERR_FAIL_COND(!found);
 
-			if (entered) {
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
-					if (E->key()->owner == p_elem->owner) {
-						continue;
-					}
-					_pair_attempt(p_elem, E->key());
-				}
+	first_block.count--;
+	if (first_block.count == 0) {
+		uint32_t next = first_block.next;
+		first_block.next = free_cell_block;
+		free_cell_block = first;
 
-				if (!p_static) {
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
-						if (E->key()->owner == p_elem->owner) {
-							continue;
-						}
-						_pair_attempt(p_elem, E->key());
-					}
-				}
-			}
+		if (next == INVALID_INDEX) {
+			cells.erase(p_key);
+			return;
 		}
+		*head = next;
 	}
 
-	//pair separatedly with large elements
+	const Element &e = elements[p_elem];
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
-		if (E->key() == p_elem) {
-			continue; // do not pair against itself
-		}
-		if (E->key()->owner == p_elem->owner) {
-			continue;
-		}
-		if (E->key()->_static && p_static) {
-			continue;
+	for (uint32_t b = *head; b != INVALID_INDEX; b = cell_blocks[b].next) {
+		const CellBlock &cb = cell_blocks[b];
+		for (uint32_t i = 0; i < cb.count; i++) {
+			if (_can_pair(e, elements[cb.elements[i]])) {
+				_unpair_attempt(p_elem, cb.elements[i]);
+			}
 		}
-
-		_pair_attempt(E->key(), p_elem);
 	}
 }
 
-void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static) {
-	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI);
-	if (sz.width * sz.height > large_object_min_surface) {
-		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
-		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
-		while (E) {
-			Map<Element *, PairData *>::Element *next = E->next();
-			_unpair_attempt(p_elem, E->key());
-			E = next;
-		}
+void BroadPhase2DHashGrid::_enter_grid(uint32_t p_elem, const Rect2 &p_rect, const CellRange *p_skip) {
+	Element &e = elements[p_elem];
 
-		if (large_elements[p_elem].dec() == 0) {
-			large_elements.erase(p_elem);
+	if (_is_large(p_rect)) {
+		//large object, do not use grid, must check against all elements
+		for (uint32_t i = 0; i < elements.size(); i++) {
+			if (i == p_elem) {
+				continue; // do not pair against itself
+			}
+			const Element &with = elements[i];
+			if (!with.owner || with.aabb == Rect2()) {
+				continue; // not in the grid
+			}
+			if (_can_pair(e, with)) {
+				_pair_attempt(p_elem, i);
+			}
 		}
+
+		e.large_index = large_elements.size();
+		large_elements.push_back(p_elem);
 		return;
 	}
 
-	Point2i from = (p_rect.position / cell_size).floor();
-	Point2i to = ((p_rect.position + p_rect.size) / cell_size).floor();
+	CellRange range = _get_cell_range(p_rect);
+
+	for (int i = range.from.x; i <= range.to.x; i++) {
+		for (int j = range.from.y; j <= range.to.y; j++) {
+			if (p_skip && p_skip->has_cell(i, j)) {
+				continue; // already there
+			}
 
-	for (int i = from.x; i <= to.x; i++) {
-		for (int j = from.y; j <= to.y; j++) {
 			PosKey pk;
 			pk.x = i;
 			pk.y = j;
+			_cell_add(pk, p_elem);
+		}
+	}
 
-			uint32_t idx = pk.hash() % hash_table_size;
-			PosBin *pb = hash_table[idx];
+	//pair separatedly with large elements
 
-			while (pb) {
-				if (pb->key == pk) {
-					break;
-				}
+	for (uint32_t i = 0; i < large_elements.size(); i++) {
+		uint32_t large = large_elements[i];
+		if (large != p_elem && _can_pair(e, elements[large])) {
+			_pair_attempt(large, p_elem);
+		}
+	}
+}
 
-				pb = pb->next;
-			}
+void BroadPhase2DHashGrid::_exit_grid(uint32_t p_elem, const Rect2 &p_rect, const CellRange *p_skip) {
+	Element &e = elements[p_elem];
 
-			ERR_CONTINUE(!pb); //should exist!!
+	if (_is_large(p_rect)) {
+		ERR_FAIL_COND(e.large_index == INVALID_INDEX);
 
-			bool exited = false;
+		uint32_t last = large_elements[large_elements.size() - 1];
+		large_elements[e.large_index] = last;
+		elements[last].large_index = e.large_index;
+		large_elements.resize(large_elements.size() - 1);
+		e.large_index = INVALID_INDEX;
 
-			if (p_static) {
-				if (pb->static_object_set[p_elem].dec() == 0) {
-					pb->static_object_set.erase(p_elem);
-					exited = true;
-				}
-			} else {
-				if (pb->object_set[p_elem].dec() == 0) {
-					pb->object_set.erase(p_elem);
-					exited = true;
-				}
+		for (uint32_t i = 0; i < elements.size(); i++) {
+			if (i == p_elem) {
+				continue;
 			}
-
-			if (exited) {
-				for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
-					if (E->key()->owner == p_elem->owner) {
-						continue;
-					}
-					_unpair_attempt(p_elem, E->key());
-				}
-
-				if (!p_static) {
-					for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
-						if (E->key()->owner == p_elem->owner) {
-							continue;
-						}
-						_unpair_attempt(p_elem, E->key());
-					}
-				}
+			const Element &with = elements[i];
+			if (!with.owner || with.aabb == Rect2()) {
+				continue;
 			}
+			if (_can_pair(e, with)) {
+				_unpair_attempt(p_elem, i);
+			}
+		}
+		return;
+	}
 
-			if (pb->object_set.empty() && pb->static_object_set.empty()) {
-				if (hash_table[idx] == pb) {
-					hash_table[idx] = pb->next;
-				} else {
-					PosBin *px = hash_table[idx];
-
-					while (px) {
-						if (px->next == pb) {
-							px->next = pb->next;
-							break;
-						}
-
-						px = px->next;
-					}
-
-					ERR_CONTINUE(!px);
-				}
+	CellRange range = _get_cell_range(p_rect);
 
-				memdelete(pb);
+	for (int i = range.from.x; i <= range.to.x; i++) {
+		for (int j = range.from.y; j <= range.to.y; j++) {
+			if (p_skip && p_skip->has_cell(i, j)) {
+				continue; // still there
 			}
+
+			PosKey pk;
+			pk.x = i;
+			pk.y = j;
+			_cell_remove(pk, p_elem);
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
-		if (E->key() == p_elem) {
-			continue; // do not pair against itself
-		}
-		if (E->key()->owner == p_elem->owner) {
-			continue;
-		}
-		if (E->key()->_static && p_static) {
-			continue;
+	for (uint32_t i = 0; i < large_elements.size(); i++) {
+		uint32_t large = large_elements[i];
+		if (large != p_elem && _can_pair(e, elements[large])) {
+			//unpair from large elements
+			_unpair_attempt(p_elem, large);
 		}
-
-		//unpair from large elements
-		_unpair_attempt(p_elem, E->key());
 	}
 }
 
 BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_object, int p_subindex) {
-	current++;
+	ERR_FAIL_COND_V(!p_object, 0);
 
-	Element e;
+	uint32_t index;
+	if (free_elements.size()) {
+		index = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		index = elements.size();
+		elements.push_back(Element());
+	}
+
+	Element &e = elements[index];
 	e.owner = p_object;
 	e._static = false;
+	e.aabb = Rect2();
 	e.subindex = p_subindex;
-	e.self = current;
 	e.pass = 0;
+	e.large_index = INVALID_INDEX;
 
-	element_map[current] = e;
-	return current;
+	return index + 1;
 }
 
 void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	if (p_aabb == e.aabb) {
+	if (p_aabb == e->aabb) {
 		return;
 	}
 
-	if (p_aabb != Rect2()) {
-		_enter_grid(&e, p_aabb, e._static);
-	}
+	uint32_t index = p_id - 1;
+	bool was_in_grid = e->aabb != Rect2();
+	bool in_grid = p_aabb != Rect2();
+	bool was_large = was_in_grid && _is_large(e->aabb);
+	bool large = in_grid && _is_large(p_aabb);
 
-	if (e.aabb != Rect2()) {
-		_exit_grid(&e, e.aabb, e._static);
-	}
+	if (!was_large || !large) {
+		// Only the cells that change are entered or exited. The new ones are
+		// entered first, so pairs that keep a shared cell are never dropped.
+		bool grid_motion = was_in_grid && in_grid && !was_large && !large;
+		CellRange from_range;
+		CellRange to_range;
+		if (grid_motion) {
+			from_range = _get_cell_range(e->aabb);
+			to_range = _get_cell_range(p_aabb);
+		}
 
-	e.aabb = p_aabb;
+		if (in_grid) {
+			_enter_grid(index, p_aabb, grid_motion ? &from_range : nullptr);
+		}
 
-	_check_motion(&e);
+		if (was_in_grid) {
+			_exit_grid(index, e->aabb, grid_motion ? &to_range : nullptr);
+		}
+	}
 
-	e.aabb = p_aabb;
+	e->aabb = p_aabb;
+
+	_check_motion(index);
 }
 
 void BroadPhase2DHashGrid::set_static(ID p_id, bool p_static) {
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
-
-	Element &e = E->get();
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	if (e._static == p_static) {
+	if (e->_static == p_static) {
 		return;
 	}
 
-	if (e.aabb != Rect2()) {
-		_exit_grid(&e, e.aabb, e._static);
+	uint32_t index = p_id - 1;
+
+	if (e->aabb != Rect2()) {
+		_exit_grid(index, e->aabb, nullptr);
 	}
 
-	e._static = p_static;
+	e->_static = p_static;
 
-	if (e.aabb != Rect2()) {
-		_enter_grid(&e, e.aabb, e._static);
-		_check_motion(&e);
+	if (e->aabb != Rect2()) {
+		_enter_grid(index, e->aabb, nullptr);
+		_check_motion(index);
 	}
 }
 
 void BroadPhase2DHashGrid::remove(ID p_id) {
-	Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND(!E);
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
 
-	Element &e = E->get();
-
-	if (e.aabb != Rect2()) {
-		_exit_grid(&e, e.aabb, e._static);
+	if (e->aabb != Rect2()) {
+		_exit_grid(p_id - 1, e->aabb, nullptr);
 	}
 
-	element_map.erase(p_id);
+	ERR_FAIL_COND(e->pairs.size());
+
+	e->owner = nullptr;
+	e->aabb = Rect2();
+	free_elements.push_back(p_id - 1);
 }
 
 CollisionObject2DSW *BroadPhase2DHashGrid::get_object(ID p_id) const {
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, nullptr);
-	return E->get().owner;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, nullptr);
+	return e->owner;
 }
 
 bool BroadPhase2DHashGrid::is_static(ID p_id) const {
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, false);
-	return E->get()._static;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, false);
+	return e->_static;
 }
 
 int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
-	ERR_FAIL_COND_V(!E, -1);
-	return E->get().subindex;
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, -1);
+	return e->subindex;
 }
 
 template <bool use_aabb, bool use_segment>
@@ -395,64 +487,37 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
 	pk.x = p_cell.x;
 	pk.y = p_cell.y;
 
-	uint32_t idx = pk.hash() % hash_table_size;
-	PosBin *pb = hash_table[idx];
-
-	while (pb) {
-		if (pb->key == pk) {
-			break;
-		}
-
-		pb = pb->next;
-	}
-
-	if (!pb) {
+	const uint32_t *head = cells.getptr(pk);
+	if (!head) {
 		return;
 	}
 
-	for (Map<Element *, RC>::Element *E = pb->object_set.front(); E; E = E->next()) {
-		if (index >= p_max_results) {
-			break;
-		}
-		if (E->key()->pass == pass) {
-			continue;
-		}
-
-		E->key()->pass = pass;
-
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb)) {
-			continue;
-		}
+	for (uint32_t b = *head; b != INVALID_INDEX; b = cell_blocks[b].next) {
+		const CellBlock &cb = cell_blocks[b];
+		for (uint32_t i = 0; i < cb.count; i++) {
+			if (index >= p_max_results) {
+				return;
+			}
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to)) {
-			continue;
-		}
+			Element &e = elements[cb.elements[i]];
+			if (e.pass == pass) {
+				continue;
+			}
 
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
-		index++;
-	}
+			e.pass = pass;
 
-	for (Map<Element *, RC>::Element *E = pb->static_object_set.front(); E; E = E->next()) {
-		if (index >= p_max_results) {
-			break;
-		}
-		if (E->key()->pass == pass) {
-			continue;
-		}
+			if (use_aabb && !p_aabb.intersects(e.aabb)) {
+				continue;
+			}
 
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb)) {
-			continue;
-		}
+			if (use_segment && !e.aabb.intersects_segment(p_from, p_to)) {
+				continue;
+			}
 
-		if (use_segment && !E->key()->aabb.intersects_segment(p_from, p_to)) {
-			continue;
+			p_results[index] = e.owner;
+			p_result_indices[index] = e.subindex;
+			index++;
 		}
-
-		E->key()->pass = pass;
-		p_results[index] = E->key()->owner;
-		p_result_indices[index] = E->key()->subindex;
-		index++;
 	}
 }
 
@@ -533,27 +598,24 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (uint32_t i = 0; i < large_elements.size(); i++) {
 		if (cullcount >= p_max_results) {
 			break;
 		}
-		if (E->key()->pass == pass) {
+
+		Element &e = elements[large_elements[i]];
+		if (e.pass == pass) {
 			continue;
 		}
 
-		E->key()->pass = pass;
+		e.pass = pass;
 
-		/*
-		if (use_aabb && !p_aabb.intersects(E->key()->aabb))
-			continue;
-		*/
-
-		if (!E->key()->aabb.intersects_segment(p_from, p_to)) {
+		if (!e.aabb.intersects_segment(p_from, p_to)) {
 			continue;
 		}
 
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e.owner;
+		p_result_indices[cullcount] = e.subindex;
 		cullcount++;
 	}
 
@@ -573,27 +635,24 @@ int BroadPhase2DHashGrid::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p
 		}
 	}
 
-	for (Map<Element *, RC>::Element *E = large_elements.front(); E; E = E->next()) {
+	for (uint32_t i = 0; i < large_elements.size(); i++) {
 		if (cullcount >= p_max_results) {
 			break;
 		}
-		if (E->key()->pass == pass) {
+
+		Element &e = elements[large_elements[i]];
+		if (e.pass == pass) {
 			continue;
 		}
 
-		E->key()->pass = pass;
+		e.pass = pass;
 
-		if (!p_aabb.intersects(E->key()->aabb)) {
+		if (!p_aabb.intersects(e.aabb)) {
 			continue;
 		}
 
-		/*
-		if (!E->key()->aabb.intersects_segment(p_from,p_to))
-			continue;
-		*/
-
-		p_results[cullcount] = E->key()->owner;
-		p_result_indices[cullcount] = E->key()->subindex;
+		p_results[cullcount] = e.owner;
+		p_result_indices[cullcount] = e.subindex;
 		cullcount++;
 	}
 	return cullcount;
@@ -617,10 +676,10 @@ BroadPhase2DSW *BroadPhase2DHashGrid::_create() {
 }
 
 BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
-	hash_table_size = GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
+	// The cell table grows as needed, this only sets how many cells fit before the first rehash.
+	int hash_table_size = GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/bp_hash_table_size", PropertyInfo(Variant::INT, "physics/2d/bp_hash_table_size", PROPERTY_HINT_RANGE, "0,8192,1,or_greater"));
-	hash_table_size = Math::larger_prime(hash_table_size);
-	hash_table = memnew_arr(PosBin *, hash_table_size);
+	cells.reserve(MAX(hash_table_size, 0));
 
 	cell_size = GLOBAL_DEF("physics/2d/cell_size", 128);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/cell_size", PropertyInfo(Variant::INT, "physics/2d/cell_size", PROPERTY_HINT_RANGE, "0,512,1,or_greater"));
@@ -628,24 +687,18 @@ BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 	large_object_min_surface = GLOBAL_DEF("physics/2d/large_object_surface_threshold_in_cells", 512);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/2d/large_object_surface_threshold_in_cells", PropertyInfo(Variant::INT, "physics/2d/large_object_surface_threshold_in_cells", PROPERTY_HINT_RANGE, "0,1024,1,or_greater"));
 
-	for (uint32_t i = 0; i < hash_table_size; i++) {
-		hash_table[i] = nullptr;
-	}
 	pass = 1;
 
-	current = 0;
+	free_pair = INVALID_INDEX;
+	free_cell_block = INVALID_INDEX;
+
+	pair_callback = nullptr;
+	pair_userdata = nullptr;
+	unpair_callback = nullptr;
+	unpair_userdata = nullptr;
 }
 
 BroadPhase2DHashGrid::~BroadPhase2DHashGrid() {
-	for (uint32_t i = 0; i < hash_table_size; i++) {
-		while (hash_table[i]) {
-			PosBin *pb = hash_table[i];
-			hash_table[i] = pb->next;
-			memdelete(pb);
-		}
-	}
-
-	memdelete_arr(hash_table);
 }
 
 /* 3D version of voxel traversal:
@@ -32,80 +32,48 @@
 #define BROAD_PHASE_2D_HASH_GRID_H
 
 #include "broad_phase_2d_sw.h"
-#include "core/map.h"
+#include "core/flat_hash_map.h"
+#include "core/local_vector.h"
 
 class BroadPhase2DHashGrid : public BroadPhase2DSW {
-	struct PairData {
-		bool colliding;
+	enum {
+		INVALID_INDEX = 0xFFFFFFFF,
+		CELL_BLOCK_SIZE = 6, // Keeps a block at 32 bytes.
+	};
+
+	// Two elements become a pair as soon as they share a cell (or one of them
+	// is large), and the pair is reported once their rects intersect.
+	// rc counts the shared cells, plus one if either element is large.
+	struct Pair {
+		uint32_t a; // Next free pair, when unused.
+		uint32_t b;
+		uint32_t index_in_a; // Position in the pairs of each element.
+		uint32_t index_in_b;
 		int rc;
+		bool colliding;
 		void *ud;
-		PairData() {
-			colliding = false;
-			rc = 1;
-			ud = nullptr;
-		}
 	};
 
 	struct Element {
-		ID self;
-		CollisionObject2DSW *owner;
-		bool _static;
+		CollisionObject2DSW *owner = nullptr;
+		bool _static = false;
 		Rect2 aabb;
-		int subindex;
-		uint64_t pass;
-		Map<Element *, PairData *> paired;
-	};
-
-	struct RC {
-		int ref;
-
-		_FORCE_INLINE_ int inc() {
-			ref++;
-			return ref;
-		}
-		_FORCE_INLINE_ int dec() {
-			ref--;
-			return ref;
-		}
-
-		_FORCE_INLINE_ RC() {
-			ref = 0;
-		}
+		int subindex = 0;
+		uint64_t pass = 0;
+		uint32_t large_index = INVALID_INDEX;
+		LocalVector<uint32_t> pairs;
 	};
 
-	Map<ID, Element> element_map;
-	Map<Element *, RC> large_elements;
-
-	ID current;
+	// Elements are indexed by ID - 1, and freed IDs are reused.
+	LocalVector<Element> elements;
+	LocalVector<uint32_t> free_elements;
+	LocalVector<uint32_t> large_elements;
 
 	uint64_t pass;
 
-	struct PairKey {
-		union {
-			struct {
-				ID a;
-				ID b;
-			};
-			uint64_t key;
-		};
-
-		_FORCE_INLINE_ bool operator<(const PairKey &p_key) const {
-			return key < p_key.key;
-		}
-
-		PairKey() { key = 0; }
-		PairKey(ID p_a, ID p_b) {
-			if (p_a > p_b) {
-				a = p_b;
-				b = p_a;
-			} else {
-				a = p_a;
-				b = p_b;
-			}
-		}
-	};
-
-	Map<PairKey, PairData> pair_map;
+	LocalVector<Pair> pairs;
+	uint32_t free_pair;
+	FlatHashMap<uint64_t, uint32_t> pair_map; // Both element indices, smallest first.
 
 	int cell_size;
 	int large_object_min_surface;
@@ -115,11 +83,6 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 	UnpairCallback unpair_callback;
 	void *unpair_userdata;
 
-	void _enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
-	void _exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static);
-	template <bool use_aabb, bool use_segment>
-	_FORCE_INLINE_ void _cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index);
-
 	struct PosKey {
 		union {
 			struct {
@@ -146,19 +109,51 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		}
 	};
 
-	struct PosBin {
-		PosKey key;
-		Map<Element *, RC> object_set;
-		Map<Element *, RC> static_object_set;
-		PosBin *next;
+	struct PosKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PosKey &p_key) { return p_key.hash(); }
+	};
+
+	// The elements of a cell are stored in a chain of fixed size blocks. Only
+	// the first block of the chain can be partially filled.
+	struct CellBlock {
+		uint32_t elements[CELL_BLOCK_SIZE];
+		uint32_t count;
+		uint32_t next; // Next free block, when unused.
 	};
 
-	uint32_t hash_table_size;
-	PosBin **hash_table;
+	struct CellRange {
+		Point2i from;
+		Point2i to;
+
+		_FORCE_INLINE_ bool has_cell(int p_x, int p_y) const {
+			return p_x >= from.x && p_x <= to.x && p_y >= from.y && p_y <= to.y;
+		}
+	};
+
+	LocalVector<CellBlock> cell_blocks;
+	uint32_t free_cell_block;
+	FlatHashMap<PosKey, uint32_t, PosKeyHasher> cells; // First block of each cell.
+
+	_FORCE_INLINE_ Element *_get_element(ID p_id);
+	_FORCE_INLINE_ const Element *_get_element(ID p_id) const;
+
+	_FORCE_INLINE_ bool _is_large(const Rect2 &p_rect) const;
+	_FORCE_INLINE_ CellRange _get_cell_range(const Rect2 &p_rect) const;
+
+	uint32_t _alloc_cell_block();
+	void _cell_add(const PosKey &p_key, uint32_t p_elem);
+	void _cell_remove(const PosKey &p_key, uint32_t p_elem);
+
+	void _enter_grid(uint32_t p_elem, const Rect2 &p_rect, const CellRange *p_skip);
+	void _exit_grid(uint32_t p_elem, const Rect2 &p_rect, const CellRange *p_skip);
+	template <bool use_aabb, bool use_segment>
+	_FORCE_INLINE_ void _cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index);
 
-	void _pair_attempt(Element *p_elem, Element *p_with);
-	void _unpair_attempt(Element *p_elem, Element *p_with);
-	void _check_motion(Element *p_elem);
+	_FORCE_INLINE_ bool _can_pair(const Element &p_elem, const Element &p_with) const;
+	void _pair_attempt(uint32_t p_elem, uint32_t p_with);
+	void _remove_element_pair(uint32_t p_elem, uint32_t p_index);
+	void _unpair_attempt(uint32_t p_elem, uint32_t p_with);
+	void _check_motion(uint32_t p_elem);
 
 public:
 	virtual ID create(CollisionObject2DSW *p_object, int p_subindex = 0);
@@ -32,22 +32,27 @@
 #define CONSTRAINT_2D_SW_H
 
 #include "body_2d_sw.h"
+#include "core/safe_refcount.h"
 
 class Constraint2DSW {
 	Body2DSW **_body_ptr;
 	int _body_count;
 	uint64_t island_step;
+	uint64_t creation_index;
 	Constraint2DSW *island_next;
 	Constraint2DSW *island_list_next;
 	bool disabled_collisions_between_bodies;
 
 	RID self;
 
+	static uint64_t creation_counter;
+
 protected:
 	Constraint2DSW(Body2DSW **p_body_ptr = nullptr, int p_body_count = 0) {
 		_body_ptr = p_body_ptr;
 		_body_count = p_body_count;
 		island_step = 0;
+		creation_index = atomic_increment(&creation_counter);
 		disabled_collisions_between_bodies = true;
 	}
 
@@ -58,6 +63,9 @@ public:
 	_FORCE_INLINE_ uint64_t get_island_step() const { return island_step; }
 	_FORCE_INLINE_ void set_island_step(uint64_t p_step) { island_step = p_step; }
 
+	// Grows with every constraint created, unlike the address it doesn't depend on the allocator.
+	_FORCE_INLINE_ uint64_t get_creation_index() const { return creation_index; }
+
 	_FORCE_INLINE_ Constraint2DSW *get_island_next() const { return island_next; }
 	_FORCE_INLINE_ void set_island_next(Constraint2DSW *p_next) { island_next = p_next; }
 
@@ -70,7 +78,12 @@ public:
 	_FORCE_INLINE_ void disable_collisions_between_bodies(const bool p_disabled) { disabled_collisions_between_bodies = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled_collisions_between_bodies() const { return disabled_collisions_between_bodies; }
 
+	// Called for all constraints in parallel, must only modify the constraint itself. Returns false if there is nothing to solve.
 	virtual bool setup(real_t p_step) = 0;
+	// Called after setup() one constraint at a time, in island order, whatever setup() returned. Anything touching bodies or areas shared between islands goes here.
+	// Returns false if there is nothing to solve, the constraint is only solved if both return true.
+	virtual bool pre_solve(real_t p_step) { return true; }
+	// Called for each island in parallel with the others, must only modify the constraint and its dynamic bodies.
 	virtual void solve(real_t p_step) = 0;
 
 	virtual ~Constraint2DSW() {}
@@ -89,6 +89,9 @@ normal_relative_velocity(Body2DSW *a, Body2DSW *b, Vector2 rA, Vector2 rB, Vecto
 }
 
 bool PinJoint2DSW::setup(real_t p_step) {
+	dynamic_A = (A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+	dynamic_B = (B && B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+
 	Space2DSW *space = A->get_space();
 	ERR_FAIL_COND_V(!space, false);
 	rA = A->get_transform().basis_xform(anchor_A);
@@ -135,9 +138,15 @@ bool PinJoint2DSW::setup(real_t p_step) {
 
 	bias = delta * -(get_bias() == 0 ? space->get_constraint_bias() : get_bias()) * (1.0 / p_step);
 
+	return true;
+}
+
+bool PinJoint2DSW::pre_solve(real_t p_step) {
 	// apply accumulated impulse
-	A->apply_impulse(rA, -P);
-	if (B) {
+	if (dynamic_A) {
+		A->apply_impulse(rA, -P);
+	}
+	if (dynamic_B) {
 		B->apply_impulse(rB, P);
 	}
 
@@ -161,8 +170,10 @@ void PinJoint2DSW::solve(real_t p_step) {
 
 	Vector2 impulse = M.basis_xform(bias - rel_vel - Vector2(softness, softness) * P);
 
-	A->apply_impulse(rA, -impulse);
-	if (B) {
+	if (dynamic_A) {
+		A->apply_impulse(rA, -impulse);
+	}
+	if (dynamic_B) {
 		B->apply_impulse(rB, impulse);
 	}
 
@@ -258,6 +269,9 @@ mult_k(const Vector2 &vr, const Vector2 &k1, const Vector2 &k2) {
 }
 
 bool GrooveJoint2DSW::setup(real_t p_step) {
+	dynamic_A = (A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+	dynamic_B = (B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+
 	// calculate endpoints in worldspace
 	Vector2 ta = A->get_transform().xform(A_groove_1);
 	Vector2 tb = A->get_transform().xform(A_groove_2);
@@ -300,11 +314,19 @@ bool GrooveJoint2DSW::setup(real_t p_step) {
 	real_t _b = get_bias();
 	gbias = (delta * -(_b == 0 ? space->get_constraint_bias() : _b) * (1.0 / p_step)).clamped(get_max_bias());
 
+	correct = true;
+	return true;
+}
+
+bool GrooveJoint2DSW::pre_solve(real_t p_step) {
 	// apply accumulated impulse
-	A->apply_impulse(rA, -jn_acc);
-	B->apply_impulse(rB, jn_acc);
+	if (dynamic_A) {
+		A->apply_impulse(rA, -jn_acc);
+	}
+	if (dynamic_B) {
+		B->apply_impulse(rB, jn_acc);
+	}
 
-	correct = true;
 	return true;
 }
 
@@ -320,8 +342,12 @@ void GrooveJoint2DSW::solve(real_t p_step) {
 
 	j = jn_acc - jOld;
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+	if (dynamic_A) {
+		A->apply_impulse(rA, -j);
+	}
+	if (dynamic_B) {
+		B->apply_impulse(rB, j);
+	}
 }
 
 GrooveJoint2DSW::GrooveJoint2DSW(const Vector2 &p_a_groove1, const Vector2 &p_a_groove2, const Vector2 &p_b_anchor, Body2DSW *p_body_a, Body2DSW *p_body_b) :
@@ -348,6 +374,9 @@ GrooveJoint2DSW::~GrooveJoint2DSW() {
 //////////////////////////////////////////////
 
 bool DampedSpringJoint2DSW::setup(real_t p_step) {
+	dynamic_A = (A->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+	dynamic_B = (B->get_mode() > PhysicsServer2D::BODY_MODE_KINEMATIC);
+
 	rA = A->get_transform().basis_xform(anchor_A);
 	rB = B->get_transform().basis_xform(anchor_B);
 
@@ -366,12 +395,21 @@ bool DampedSpringJoint2DSW::setup(real_t p_step) {
 	target_vrn = 0.0f;
 	v_coef = 1.0f - Math::exp(-damping * (p_step)*k);
 
-	// apply spring force
+	// spring force, applied in pre_solve()
 	real_t f_spring = (rest_length - dist) * stiffness;
-	Vector2 j = n * f_spring * (p_step);
+	spring_impulse = n * f_spring * (p_step);
+
+	return true;
+}
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+bool DampedSpringJoint2DSW::pre_solve(real_t p_step) {
+	// apply spring force
+	if (dynamic_A) {
+		A->apply_impulse(rA, -spring_impulse);
+	}
+	if (dynamic_B) {
+		B->apply_impulse(rB, spring_impulse);
+	}
 
 	return true;
 }
@@ -386,8 +424,12 @@ void DampedSpringJoint2DSW::solve(real_t p_step) {
 	target_vrn = vrn + v_damp;
 	Vector2 j = n * v_damp * n_mass;
 
-	A->apply_impulse(rA, -j);
-	B->apply_impulse(rB, j);
+	if (dynamic_A) {
+		A->apply_impulse(rA, -j);
+	}
+	if (dynamic_B) {
+		B->apply_impulse(rB, j);
+	}
 }
 
 void DampedSpringJoint2DSW::set_param(PhysicsServer2D::DampedSpringParam p_param, real_t p_value) {
@@ -1219,6 +1219,7 @@ void PhysicsServer2DSW::init() {
 	last_step = 0.001;
 	iterations = 8; // 8?
 	stepper = memnew(Step2DSW);
+	stepper->set_use_threads(GLOBAL_DEF("physics/2d/multithreaded_solver", true));
 	direct_state = memnew(PhysicsDirectBodyState2DSW);
 };
 
@@ -1330,6 +1331,14 @@ int PhysicsServer2DSW::get_process_info(ProcessInfo p_info) {
 	return 0;
 }
 
+void PhysicsServer2DSW::set_multithreaded_solver(bool p_enable) {
+	stepper->set_use_threads(p_enable);
+}
+
+bool PhysicsServer2DSW::is_multithreaded_solver() const {
+	return stepper->is_using_threads();
+}
+
 PhysicsServer2DSW *PhysicsServer2DSW::singletonsw = nullptr;
 
 PhysicsServer2DSW::PhysicsServer2DSW() {
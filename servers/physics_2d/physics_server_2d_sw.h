@@ -67,8 +67,6 @@ class PhysicsServer2DSW : public PhysicsServer2D {
 	mutable RID_PtrOwner<Body2DSW> body_owner;
 	mutable RID_PtrOwner<Joint2DSW> joint_owner;
 
-	static PhysicsServer2DSW *singletonsw;
-
 	//void _clear_query(Query2DSW *p_query);
 	friend class CollisionObject2DSW;
 	SelfList<CollisionObject2DSW>::List pending_shape_update_list;
@@ -77,6 +75,8 @@ class PhysicsServer2DSW : public PhysicsServer2D {
 	RID _shape_create(ShapeType p_shape);
 
 public:
+	static PhysicsServer2DSW *singletonsw;
+
 	struct CollCbkData {
 		Vector2 valid_dir;
 		real_t valid_depth;
@@ -287,6 +287,10 @@ public:
 
 	int get_process_info(ProcessInfo p_info);
 
+	// Set from the physics/2d/multithreaded_solver project setting, results don't depend on it.
+	void set_multithreaded_solver(bool p_enable);
+	bool is_multithreaded_solver() const;
+
 	PhysicsServer2DSW();
 	~PhysicsServer2DSW() {}
 };
@@ -132,7 +132,7 @@ void PhysicsServer2DWrapMT::finish() {
 }
 
 PhysicsServer2DWrapMT::PhysicsServer2DWrapMT(PhysicsServer2D *p_contained, bool p_create_thread) :
-		command_queue(p_create_thread) {
+		command_queue(p_create_thread, GLOBAL_GET("memory/limits/multithreaded_server/lock_free_command_queue")) {
 	physics_2d_server = p_contained;
 	create_thread = p_create_thread;
 	thread = nullptr;
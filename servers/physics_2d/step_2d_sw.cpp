@@ -30,13 +30,14 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/thread_work_pool.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 	p_body->set_island_step(_step);
 	p_body->set_island_next(*p_island);
 	*p_island = p_body;
 
-	for (Map<Constraint2DSW *, int>::Element *E = p_body->get_constraint_map().front(); E; E = E->next()) {
+	for (Body2DSW::ConstraintMap::Element *E = p_body->get_constraint_map().front(); E; E = E->next()) {
 		Constraint2DSW *c = (Constraint2DSW *)E->key();
 		if (c->get_island_step() == _step) {
 			continue; //already processed
@@ -58,35 +59,25 @@ void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constrain
 	}
 }
 
-bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
-	Constraint2DSW *ci = p_island;
-	Constraint2DSW *prev_ci = nullptr;
-	bool removed_root = false;
-	while (ci) {
-		bool process = ci->setup(p_delta);
-
-		if (!process) {
-			//remove from island if process fails
-			if (prev_ci) {
-				prev_ci->set_island_next(ci->get_island_next());
-			} else {
-				removed_root = true;
-				prev_ci = ci;
-			}
-		} else {
-			prev_ci = ci;
-		}
-		ci = ci->get_island_next();
-	}
+void Step2DSW::_integrate_forces(uint32_t p_body_index, void *p_userdata) {
+	bodies[p_body_index]->integrate_forces(delta);
+}
 
-	return removed_root;
+void Step2DSW::_integrate_velocities(uint32_t p_body_index, void *p_userdata) {
+	bodies[p_body_index]->integrate_velocities(delta);
 }
 
-void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta) {
-	for (int i = 0; i < p_iterations; i++) {
-		Constraint2DSW *ci = p_island;
+void Step2DSW::_setup_constraint(uint32_t p_constraint_index, void *p_userdata) {
+	constraint_setup_results[p_constraint_index] = constraints[p_constraint_index]->setup(delta);
+}
+
+void Step2DSW::_solve_island(uint32_t p_island_index, void *p_userdata) {
+	Constraint2DSW *island = constraint_islands[p_island_index];
+
+	for (int i = 0; i < iterations; i++) {
+		Constraint2DSW *ci = island;
 		while (ci) {
-			ci->solve(p_delta);
+			ci->solve(delta);
 			ci = ci->get_island_next();
 		}
 	}
@@ -128,11 +119,27 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 	}
 }
 
+// Every element only touches data no other element does, so the result is the same whether it runs on one thread or many.
+template <class M>
+void Step2DSW::_run(uint32_t p_elements, M p_method) {
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (use_threads && pool && p_elements > 1) {
+		pool->do_work(p_elements, this, p_method, (void *)nullptr);
+	} else {
+		for (uint32_t i = 0; i < p_elements; i++) {
+			(this->*p_method)(i, nullptr);
+		}
+	}
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<Body2DSW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -140,16 +147,20 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
-
+	bodies.clear();
 	const SelfList<Body2DSW> *b = body_list->first();
 	while (b) {
-		b->self()->integrate_forces(p_delta);
+		bodies.push_back(b->self());
 		b = b->next();
-		active_count++;
 	}
 
-	p_space->set_active_objects(active_count);
+	_run(bodies.size(), &Step2DSW::_integrate_forces);
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		bodies[i]->post_integrate_forces();
+	}
+
+	p_space->set_active_objects(bodies.size());
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -203,6 +214,15 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 		p_space->area_remove_from_moved_list((SelfList<Area2DSW> *)aml.first()); //faster to remove here
 	}
 
+	constraint_islands.clear();
+	constraints.clear();
+	for (Constraint2DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+		constraint_islands.push_back(ci);
+		for (Constraint2DSW *c = ci; c; c = c->get_island_next()) {
+			constraints.push_back(c);
+		}
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space2DSW::ELAPSED_TIME_GENERATE_ISLANDS, profile_endtime - profile_begtime);
@@ -211,39 +231,40 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		Constraint2DSW *prev_ci = nullptr;
-		while (ci) {
-			if (_setup_island(ci, p_delta)) {
-				//removed the root from the island graph because it is not to be processed
+	constraint_setup_results.resize(constraints.size());
+	_run(constraints.size(), &Step2DSW::_setup_constraint);
 
+	// Applies what setup can't do in parallel (contact reports, area queries, warm starting),
+	// in the same order the constraints were set up in when this ran on a single thread.
+	// Constraints with nothing to solve are removed from their island, and empty islands are dropped.
+	{
+		uint32_t constraint_index = 0;
+		uint32_t island_index = 0;
+		for (uint32_t i = 0; i < constraint_islands.size(); i++) {
+			Constraint2DSW *island = nullptr;
+			Constraint2DSW *last = nullptr;
+			Constraint2DSW *ci = constraint_islands[i];
+			while (ci) {
 				Constraint2DSW *next = ci->get_island_next();
-
-				if (next) {
-					//root from list being deleted no longer exists, replace by next
-					next->set_island_list_next(ci->get_island_list_next());
-					if (prev_ci) {
-						prev_ci->set_island_list_next(next);
+				bool process = ci->pre_solve(p_delta);
+				if (process && constraint_setup_results[constraint_index]) {
+					if (last) {
+						last->set_island_next(ci);
 					} else {
-						constraint_island_list = next;
-					}
-					prev_ci = next;
-				} else {
-					//list is empty, just skip
-					if (prev_ci) {
-						prev_ci->set_island_list_next(ci->get_island_list_next());
-
-					} else {
-						constraint_island_list = ci->get_island_list_next();
+						island = ci;
 					}
+					last = ci;
 				}
-			} else {
-				prev_ci = ci;
+				constraint_index++;
+				ci = next;
 			}
 
-			ci = ci->get_island_list_next();
+			if (last) {
+				last->set_island_next(nullptr);
+				constraint_islands[island_index++] = island;
+			}
 		}
+		constraint_islands.resize(island_index);
 	}
 
 	{ //profile
@@ -254,14 +275,8 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint2DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	// Islands share no dynamic bodies, so they can be solved at the same time.
+	_run(constraint_islands.size(), &Step2DSW::_solve_island);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -271,11 +286,17 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
+	bodies.clear();
 	b = body_list->first();
 	while (b) {
-		const SelfList<Body2DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n; // in case it shuts itself down
+		bodies.push_back(b->self());
+		b = b->next();
+	}
+
+	_run(bodies.size(), &Step2DSW::_integrate_velocities);
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		bodies[i]->post_integrate_velocities(); //may deactivate the body
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
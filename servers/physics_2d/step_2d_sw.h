@@ -31,17 +31,36 @@
 #ifndef STEP_2D_SW_H
 #define STEP_2D_SW_H
 
+#include "core/local_vector.h"
 #include "space_2d_sw.h"
 
 class Step2DSW {
 	uint64_t _step;
+	bool use_threads = true;
+
+	real_t delta = 0.0;
+	int iterations = 0;
+
+	// Flattened for the work pool, in the order the serial solver visited them.
+	LocalVector<Body2DSW *> bodies;
+	LocalVector<Constraint2DSW *> constraints;
+	LocalVector<bool> constraint_setup_results;
+	LocalVector<Constraint2DSW *> constraint_islands;
 
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
-	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
-	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
+	void _integrate_forces(uint32_t p_body_index, void *p_userdata);
+	void _integrate_velocities(uint32_t p_body_index, void *p_userdata);
+	void _setup_constraint(uint32_t p_constraint_index, void *p_userdata);
+	void _solve_island(uint32_t p_island_index, void *p_userdata);
 	void _check_suspend(Body2DSW *p_island, real_t p_delta);
 
+	template <class M>
+	void _run(uint32_t p_elements, M p_method);
+
 public:
+	void set_use_threads(bool p_enable) { use_threads = p_enable; }
+	bool is_using_threads() const { return use_threads; }
+
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
 	Step2DSW();
 };
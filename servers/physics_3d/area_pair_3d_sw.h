@@ -41,9 +41,11 @@ class AreaPair3DSW : public Constraint3DSW {
 	int body_shape;
 	int area_shape;
 	bool colliding;
+	bool process_collision; // The overlap changed in setup(), pre_solve() updates the areas.
 
 public:
 	bool setup(real_t p_step);
+	void pre_solve(real_t p_step);
 	void solve(real_t p_step);
 
 	AreaPair3DSW(Body3DSW *p_body, int p_body_shape, Area3DSW *p_area, int p_area_shape);
@@ -56,9 +58,11 @@ class Area2Pair3DSW : public Constraint3DSW {
 	int shape_a;
 	int shape_b;
 	bool colliding;
+	bool process_collision; // The overlap changed in setup(), pre_solve() updates the areas.
 
 public:
 	bool setup(real_t p_step);
+	void pre_solve(real_t p_step);
 	void solve(real_t p_step);
 
 	Area2Pair3DSW(Area3DSW *p_area_a, int p_shape_a, Area3DSW *p_area_b, int p_shape_b);
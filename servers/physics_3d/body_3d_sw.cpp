@@ -30,8 +30,15 @@
 
 #include "body_3d_sw.h"
 #include "area_3d_sw.h"
+#include "constraint_3d_sw.h"
 #include "space_3d_sw.h"
 
+uint64_t Constraint3DSW::creation_counter = 0;
+
+bool Body3DSW::ConstraintComparator::operator()(const Constraint3DSW *p_a, const Constraint3DSW *p_b) const {
+	return p_a->get_creation_index() < p_b->get_creation_index();
+}
+
 void Body3DSW::_update_inertia() {
 	if (get_space() && !inertia_update_list.in_list()) {
 		get_space()->body_add_to_inertia_update_list(&inertia_update_list);
@@ -425,6 +432,8 @@ bool Body3DSW::is_axis_locked(PhysicsServer3D::BodyAxis p_axis) const {
 }
 
 void Body3DSW::integrate_forces(real_t p_step) {
+	motion_pending = false;
+
 	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
 		return;
 	}
@@ -549,23 +558,26 @@ void Body3DSW::integrate_forces(real_t p_step) {
 	biased_angular_velocity = Vector3();
 	biased_linear_velocity = Vector3();
 
-	if (do_motion) { //shapes temporarily extend for raycast
-		_update_shapes_with_motion(motion);
-	}
+	//shapes temporarily extend for raycast, done in post_integrate_forces()
+	motion_pending = do_motion;
+	pending_motion = motion;
 
 	def_area = nullptr; // clear the area, so it is set in the next frame
 	contact_count = 0;
 }
 
+void Body3DSW::post_integrate_forces() {
+	if (motion_pending) {
+		_update_shapes_with_motion(pending_motion);
+		motion_pending = false;
+	}
+}
+
 void Body3DSW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
 		return;
 	}
 
-	if (fi_callback) {
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-	}
-
 	//apply axis lock linear
 	for (int i = 0; i < 3; i++) {
 		if (is_axis_locked((PhysicsServer3D::BodyAxis)(1 << i))) {
@@ -585,10 +597,6 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_KINEMATIC) {
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
-		if (contacts.size() == 0 && linear_velocity == Vector3() && angular_velocity == Vector3()) {
-			set_active(false); //stopped moving, deactivate
-		}
-
 		return;
 	}
 
@@ -615,7 +623,7 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 
 	transform.origin += total_linear_velocity * p_step;
 
-	_set_transform(transform);
+	_set_transform(transform, false); //shapes are updated in post_integrate_velocities()
 	_set_inv_transform(get_transform().inverse());
 
 	_update_transform_dependant();
@@ -626,6 +634,26 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 	*/
 }
 
+void Body3DSW::post_integrate_velocities() {
+	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
+		return;
+	}
+
+	if (fi_callback) {
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+	}
+
+	if (mode == PhysicsServer3D::BODY_MODE_KINEMATIC) {
+		if (contacts.size() == 0 && linear_velocity == Vector3() && angular_velocity == Vector3()) {
+			set_active(false); //stopped moving, deactivate
+		}
+
+		return;
+	}
+
+	_update_shapes();
+}
+
 /*
 void BodySW::simulate_motion(const Transform& p_xform,real_t p_step) {
 
@@ -662,7 +690,7 @@ void BodySW::simulate_motion(const Transform& p_xform,real_t p_step) {
 */
 
 void Body3DSW::wakeup_neighbours() {
-	for (Map<Constraint3DSW *, int>::Element *E = constraint_map.front(); E; E = E->next()) {
+	for (ConstraintMap::Element *E = constraint_map.front(); E; E = E->next()) {
 		const Constraint3DSW *c = E->key();
 		Body3DSW **n = c->get_body_ptr();
 		int bc = c->get_body_count();
@@ -95,7 +95,19 @@ class Body3DSW : public CollisionObject3DSW {
 	virtual void _shapes_changed();
 	Transform new_transform;
 
-	Map<Constraint3DSW *, int> constraint_map;
+	Vector3 pending_motion;
+	bool motion_pending = false;
+
+public:
+	// Constraints are visited in creation order rather than by address, so
+	// islands come out the same whenever a scene is built the same way.
+	struct ConstraintComparator {
+		bool operator()(const Constraint3DSW *p_a, const Constraint3DSW *p_b) const;
+	};
+	typedef Map<Constraint3DSW *, int, ConstraintComparator> ConstraintMap;
+
+private:
+	ConstraintMap constraint_map;
 
 	struct AreaCMP {
 		Area3DSW *area;
@@ -197,7 +209,7 @@ public:
 
 	_FORCE_INLINE_ void add_constraint(Constraint3DSW *p_constraint, int p_pos) { constraint_map[p_constraint] = p_pos; }
 	_FORCE_INLINE_ void remove_constraint(Constraint3DSW *p_constraint) { constraint_map.erase(p_constraint); }
-	const Map<Constraint3DSW *, int> &get_constraint_map() const { return constraint_map; }
+	const ConstraintMap &get_constraint_map() const { return constraint_map; }
 	_FORCE_INLINE_ void clear_constraint_map() { constraint_map.clear(); }
 
 	_FORCE_INLINE_ void set_omit_force_integration(bool p_omit_force_integration) { omit_force_integration = p_omit_force_integration; }
@@ -299,8 +311,12 @@ public:
 	void set_axis_lock(PhysicsServer3D::BodyAxis p_axis, bool lock);
 	bool is_axis_locked(PhysicsServer3D::BodyAxis p_axis) const;
 
+	// Integration runs in parallel for all active bodies, the post_* functions apply
+	// what it can't (broadphase and space list updates) one body at a time.
 	void integrate_forces(real_t p_step);
+	void post_integrate_forces();
 	void integrate_velocities(real_t p_step);
+	void post_integrate_velocities();
 
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3 &rel_pos) const {
 		return linear_velocity + angular_velocity.cross(rel_pos - center_of_mass);
@@ -209,9 +209,23 @@ real_t combine_friction(Body3DSW *A, Body3DSW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
+void BodyPair3DSW::_get_shape_transforms(Transform &r_xform_A, Transform &r_xform_B) const {
+	//use local A coordinates to avoid numerical issues on collision detection
+	Vector3 offset_A = A->get_transform().get_origin();
+	r_xform_A = Transform(A->get_transform().basis, Vector3()) * A->get_shape_transform(shape_A);
+
+	Transform xform_Bu = B->get_transform();
+	xform_Bu.origin -= offset_A;
+	r_xform_B = xform_Bu * B->get_shape_transform(shape_B);
+}
+
 bool BodyPair3DSW::setup(real_t p_step) {
+	dynamic_A = (A->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC);
+	dynamic_B = (B->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC);
+	check_ccd = false;
+
 	//cannot collide
-	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
+	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (!dynamic_A && !dynamic_B && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
 		return false;
 	}
@@ -225,34 +239,48 @@ bool BodyPair3DSW::setup(real_t p_step) {
 
 	validate_contacts();
 
-	Vector3 offset_A = A->get_transform().get_origin();
-	Transform xform_Au = Transform(A->get_transform().basis, Vector3());
-	Transform xform_A = xform_Au * A->get_shape_transform(shape_A);
+	Transform xform_A;
+	Transform xform_B;
+	_get_shape_transforms(xform_A, xform_B);
 
-	Transform xform_Bu = B->get_transform();
-	xform_Bu.origin -= offset_A;
-	Transform xform_B = xform_Bu * B->get_shape_transform(shape_B);
+	collided = CollisionSolver3DSW::solve_static(A->get_shape(shape_A), xform_A, B->get_shape(shape_B), xform_B, _contact_added_callback, this, &sep_axis);
 
-	Shape3DSW *shape_A_ptr = A->get_shape(shape_A);
-	Shape3DSW *shape_B_ptr = B->get_shape(shape_B);
+	if (!collided) {
+		//test ccd (currently just a raycast), done in pre_solve() as it changes the body velocity
+		check_ccd = (A->is_continuous_collision_detection_enabled() && dynamic_A && !dynamic_B) || (B->is_continuous_collision_detection_enabled() && dynamic_B && !dynamic_A);
+		return false;
+	}
 
-	bool collided = CollisionSolver3DSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
-	this->collided = collided;
+	return true;
+}
 
+void BodyPair3DSW::pre_solve(real_t p_step) {
 	if (!collided) {
-		//test ccd (currently just a raycast)
+		if (check_ccd) {
+			Transform xform_A;
+			Transform xform_B;
+			_get_shape_transforms(xform_A, xform_B);
 
-		if (A->is_continuous_collision_detection_enabled() && A->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC) {
-			_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
-		}
+			if (A->is_continuous_collision_detection_enabled() && dynamic_A && !dynamic_B) {
+				_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
+			}
 
-		if (B->is_continuous_collision_detection_enabled() && B->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC && A->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC) {
-			_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A);
+			if (B->is_continuous_collision_detection_enabled() && dynamic_B && !dynamic_A) {
+				_test_ccd(p_step, B, shape_B, xform_B, A, shape_A, xform_A);
+			}
 		}
 
-		return false;
+		return;
 	}
 
+	Vector3 offset_A = A->get_transform().get_origin();
+	Transform xform_Au = Transform(A->get_transform().basis, Vector3());
+	Transform xform_Bu = B->get_transform();
+	xform_Bu.origin -= offset_A;
+
+	Shape3DSW *shape_A_ptr = A->get_shape(shape_A);
+	Shape3DSW *shape_B_ptr = B->get_shape(shape_B);
+
 	real_t max_penetration = space->get_contact_max_allowed_penetration();
 
 	real_t bias = (real_t)0.3;
@@ -321,8 +349,12 @@ bool BodyPair3DSW::setup(real_t p_step) {
 		c.depth = depth;
 
 		Vector3 j_vec = c.normal * c.acc_normal_impulse + c.acc_tangent_impulse;
-		A->apply_impulse(c.rA + A->get_center_of_mass(), -j_vec);
-		B->apply_impulse(c.rB + B->get_center_of_mass(), j_vec);
+		if (dynamic_A) {
+			A->apply_impulse(c.rA + A->get_center_of_mass(), -j_vec);
+		}
+		if (dynamic_B) {
+			B->apply_impulse(c.rB + B->get_center_of_mass(), j_vec);
+		}
 		c.acc_bias_impulse = 0;
 		c.acc_bias_impulse_center_of_mass = 0;
 
@@ -335,8 +367,6 @@ bool BodyPair3DSW::setup(real_t p_step) {
 			c.bounce = c.bounce * dv.dot(c.normal);
 		}
 	}
-
-	return true;
 }
 
 void BodyPair3DSW::solve(real_t p_step) {
@@ -367,8 +397,12 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 			Vector3 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-			A->apply_bias_impulse(c.rA + A->get_center_of_mass(), -jb, MAX_BIAS_ROTATION / p_step);
-			B->apply_bias_impulse(c.rB + B->get_center_of_mass(), jb, MAX_BIAS_ROTATION / p_step);
+			if (dynamic_A) {
+				A->apply_bias_impulse(c.rA + A->get_center_of_mass(), -jb, MAX_BIAS_ROTATION / p_step);
+			}
+			if (dynamic_B) {
+				B->apply_bias_impulse(c.rB + B->get_center_of_mass(), jb, MAX_BIAS_ROTATION / p_step);
+			}
 
 			crbA = A->get_biased_angular_velocity().cross(c.rA);
 			crbB = B->get_biased_angular_velocity().cross(c.rB);
@@ -383,8 +417,12 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 				Vector3 jb_com = c.normal * (c.acc_bias_impulse_center_of_mass - jbnOld_com);
 
-				A->apply_bias_impulse(A->get_center_of_mass(), -jb_com, 0.0f);
-				B->apply_bias_impulse(B->get_center_of_mass(), jb_com, 0.0f);
+				if (dynamic_A) {
+					A->apply_bias_impulse(A->get_center_of_mass(), -jb_com, 0.0f);
+				}
+				if (dynamic_B) {
+					B->apply_bias_impulse(B->get_center_of_mass(), jb_com, 0.0f);
+				}
 			}
 
 			c.active = true;
@@ -404,8 +442,12 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 			Vector3 j = c.normal * (c.acc_normal_impulse - jnOld);
 
-			A->apply_impulse(c.rA + A->get_center_of_mass(), -j);
-			B->apply_impulse(c.rB + B->get_center_of_mass(), j);
+			if (dynamic_A) {
+				A->apply_impulse(c.rA + A->get_center_of_mass(), -j);
+			}
+			if (dynamic_B) {
+				B->apply_impulse(c.rB + B->get_center_of_mass(), j);
+			}
 
 			c.active = true;
 		}
@@ -447,8 +489,12 @@ void BodyPair3DSW::solve(real_t p_step) {
 
 			jt = c.acc_tangent_impulse - jtOld;
 
-			A->apply_impulse(c.rA + A->get_center_of_mass(), -jt);
-			B->apply_impulse(c.rB + B->get_center_of_mass(), jt);
+			if (dynamic_A) {
+				A->apply_impulse(c.rA + A->get_center_of_mass(), -jt);
+			}
+			if (dynamic_B) {
+				B->apply_impulse(c.rB + B->get_center_of_mass(), jt);
+			}
 
 			c.active = true;
 		}
@@ -466,6 +512,9 @@ BodyPair3DSW::BodyPair3DSW(Body3DSW *p_A, int p_shape_A, Body3DSW *p_B, int p_sh
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	check_ccd = false;
+	dynamic_A = false;
+	dynamic_B = false;
 }
 
 BodyPair3DSW::~BodyPair3DSW() {
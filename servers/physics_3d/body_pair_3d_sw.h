@@ -75,18 +75,24 @@ class BodyPair3DSW : public Constraint3DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool check_ccd;
+	// Static and kinematic bodies are shared between islands solved in parallel, so impulses only go to dynamic ones.
+	bool dynamic_A;
+	bool dynamic_B;
 
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B);
 
 	void validate_contacts();
+	void _get_shape_transforms(Transform &r_xform_A, Transform &r_xform_B) const;
 	bool _test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform &p_xform_B);
 
 	Space3DSW *space;
 
 public:
 	bool setup(real_t p_step);
+	void pre_solve(real_t p_step);
 	void solve(real_t p_step);
 
 	BodyPair3DSW(Body3DSW *p_A, int p_shape_A, Body3DSW *p_B, int p_shape_B);
@@ -0,0 +1,630 @@
+/*************************************************************************/
+/*  broad_phase_3d_aabb_tree.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_3d_aabb_tree.h"
+#include "collision_object_3d_sw.h"
+
+real_t BroadPhase3DAABBTree::_get_surface(const AABB &p_aabb) {
+	const Vector3 &size = p_aabb.size;
+	return 2.0 * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AABB BroadPhase3DAABBTree::_get_fat_aabb(const AABB &p_aabb) {
+	// Enough room for most bodies to move for a few steps before having to be reinserted.
+	return p_aabb.grow(p_aabb.get_longest_axis_size() * 0.1);
+}
+
+uint32_t BroadPhase3DAABBTree::_alloc_node(Tree &p_tree) {
+	uint32_t index;
+	if (p_tree.free_node != INVALID_INDEX) {
+		index = p_tree.free_node;
+		p_tree.free_node = p_tree.nodes[index].parent;
+		p_tree.nodes[index] = Node();
+	} else {
+		index = p_tree.nodes.size();
+		p_tree.nodes.push_back(Node());
+	}
+	return index;
+}
+
+void BroadPhase3DAABBTree::_free_node(Tree &p_tree, uint32_t p_node) {
+	Node &node = p_tree.nodes[p_node];
+	node.height = -1;
+	node.parent = p_tree.free_node;
+	p_tree.free_node = p_node;
+}
+
+// Rotates the taller grandchild up if the children of p_node differ in height by more than one.
+// Returns the node now in the place of p_node.
+uint32_t BroadPhase3DAABBTree::_balance(Tree &p_tree, uint32_t p_node) {
+	Node *nodes = &p_tree.nodes[0];
+
+	uint32_t index_a = p_node;
+	Node *a = &nodes[index_a];
+	if (a->is_leaf() || a->height < 2) {
+		return index_a;
+	}
+
+	uint32_t index_b = a->children[0];
+	uint32_t index_c = a->children[1];
+	Node *b = &nodes[index_b];
+	Node *c = &nodes[index_c];
+
+	int balance = c->height - b->height;
+
+	if (balance > 1) {
+		// Rotate C up.
+		uint32_t index_f = c->children[0];
+		uint32_t index_g = c->children[1];
+		Node *f = &nodes[index_f];
+		Node *g = &nodes[index_g];
+
+		c->children[0] = index_a;
+		c->parent = a->parent;
+		a->parent = index_c;
+
+		if (c->parent != INVALID_INDEX) {
+			Node &parent = nodes[c->parent];
+			parent.children[parent.children[0] == index_a ? 0 : 1] = index_c;
+		} else {
+			p_tree.root = index_c;
+		}
+
+		if (f->height > g->height) {
+			c->children[1] = index_f;
+			a->children[1] = index_g;
+			g->parent = index_a;
+			a->aabb = b->aabb.merge(g->aabb);
+			c->aabb = a->aabb.merge(f->aabb);
+			a->height = 1 + MAX(b->height, g->height);
+			c->height = 1 + MAX(a->height, f->height);
+		} else {
+			c->children[1] = index_g;
+			a->children[1] = index_f;
+			f->parent = index_a;
+			a->aabb = b->aabb.merge(f->aabb);
+			c->aabb = a->aabb.merge(g->aabb);
+			a->height = 1 + MAX(b->height, f->height);
+			c->height = 1 + MAX(a->height, g->height);
+		}
+
+		return index_c;
+	}
+
+	if (balance < -1) {
+		// Rotate B up.
+		uint32_t index_d = b->children[0];
+		uint32_t index_e = b->children[1];
+		Node *d = &nodes[index_d];
+		Node *e = &nodes[index_e];
+
+		b->children[0] = index_a;
+		b->parent = a->parent;
+		a->parent = index_b;
+
+		if (b->parent != INVALID_INDEX) {
+			Node &parent = nodes[b->parent];
+			parent.children[parent.children[0] == index_a ? 0 : 1] = index_b;
+		} else {
+			p_tree.root = index_b;
+		}
+
+		if (d->height > e->height) {
+			b->children[1] = index_d;
+			a->children[0] = index_e;
+			e->parent = index_a;
+			a->aabb = c->aabb.merge(e->aabb);
+			b->aabb = a->aabb.merge(d->aabb);
+			a->height = 1 + MAX(c->height, e->height);
+			b->height = 1 + MAX(a->height, d->height);
+		} else {
+			b->children[1] = index_e;
+			a->children[0] = index_d;
+			d->parent = index_a;
+			a->aabb = c->aabb.merge(d->aabb);
+			b->aabb = a->aabb.merge(e->aabb);
+			a->height = 1 + MAX(c->height, d->height);
+			b->height = 1 + MAX(a->height, e->height);
+		}
+
+		return index_b;
+	}
+
+	return index_a;
+}
+
+// Fixes the bounds and heights of p_node and its ancestors, rebalancing them on the way up.
+void BroadPhase3DAABBTree::_refit_from(Tree &p_tree, uint32_t p_node) {
+	uint32_t index = p_node;
+	while (index != INVALID_INDEX) {
+		index = _balance(p_tree, index);
+
+		Node &node = p_tree.nodes[index];
+		const Node &child_0 = p_tree.nodes[node.children[0]];
+		const Node &child_1 = p_tree.nodes[node.children[1]];
+		node.height = 1 + MAX(child_0.height, child_1.height);
+		node.aabb = child_0.aabb.merge(child_1.aabb);
+
+		index = node.parent;
+	}
+}
+
+void BroadPhase3DAABBTree::_insert_leaf(Tree &p_tree, uint32_t p_leaf) {
+	if (p_tree.root == INVALID_INDEX) {
+		p_tree.root = p_leaf;
+		p_tree.nodes[p_leaf].parent = INVALID_INDEX;
+		return;
+	}
+
+	// Walk down to the sibling that makes the tree grow the least, by surface area.
+	AABB leaf_aabb = p_tree.nodes[p_leaf].aabb;
+	uint32_t index = p_tree.root;
+	while (!p_tree.nodes[index].is_leaf()) {
+		const Node &node = p_tree.nodes[index];
+
+		real_t area = _get_surface(node.aabb);
+		real_t combined_area = _get_surface(node.aabb.merge(leaf_aabb));
+
+		// Cost of pairing the leaf with this node, and the minimum cost pushed down to its children.
+		real_t cost = 2.0 * combined_area;
+		real_t inheritance_cost = 2.0 * (combined_area - area);
+
+		real_t child_costs[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = p_tree.nodes[node.children[i]];
+			real_t merged_area = _get_surface(leaf_aabb.merge(child.aabb));
+			if (child.is_leaf()) {
+				child_costs[i] = merged_area + inheritance_cost;
+			} else {
+				child_costs[i] = merged_area - _get_surface(child.aabb) + inheritance_cost;
+			}
+		}
+
+		if (cost < child_costs[0] && cost < child_costs[1]) {
+			break;
+		}
+
+		index = child_costs[0] < child_costs[1] ? node.children[0] : node.children[1];
+	}
+
+	uint32_t sibling = index;
+	uint32_t old_parent = p_tree.nodes[sibling].parent;
+	uint32_t new_parent = _alloc_node(p_tree);
+
+	Node &parent = p_tree.nodes[new_parent];
+	parent.parent = old_parent;
+	parent.aabb = leaf_aabb.merge(p_tree.nodes[sibling].aabb);
+	parent.height = p_tree.nodes[sibling].height + 1;
+	parent.children[0] = sibling;
+	parent.children[1] = p_leaf;
+
+	if (old_parent != INVALID_INDEX) {
+		Node &grandparent = p_tree.nodes[old_parent];
+		grandparent.children[grandparent.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		p_tree.root = new_parent;
+	}
+
+	p_tree.nodes[sibling].parent = new_parent;
+	p_tree.nodes[p_leaf].parent = new_parent;
+
+	_refit_from(p_tree, old_parent);
+}
+
+void BroadPhase3DAABBTree::_remove_leaf(Tree &p_tree, uint32_t p_leaf) {
+	if (p_leaf == p_tree.root) {
+		p_tree.root = INVALID_INDEX;
+		return;
+	}
+
+	uint32_t parent = p_tree.nodes[p_leaf].parent;
+	uint32_t grandparent = p_tree.nodes[parent].parent;
+	uint32_t sibling = p_tree.nodes[parent].children[p_tree.nodes[parent].children[0] == p_leaf ? 1 : 0];
+
+	// The sibling takes the place of the parent.
+	p_tree.nodes[sibling].parent = grandparent;
+	if (grandparent != INVALID_INDEX) {
+		Node &node = p_tree.nodes[grandparent];
+		node.children[node.children[0] == parent ? 0 : 1] = sibling;
+	} else {
+		p_tree.root = sibling;
+	}
+
+	_free_node(p_tree, parent);
+	_refit_from(p_tree, grandparent);
+}
+
+void BroadPhase3DAABBTree::_tree_insert(Tree &p_tree, ID p_id, Element &p_element) {
+	uint32_t leaf = _alloc_node(p_tree);
+	Node &node = p_tree.nodes[leaf];
+	node.aabb = _get_fat_aabb(p_element.aabb);
+	node.element = p_id;
+
+	_insert_leaf(p_tree, leaf);
+	p_element.leaf = leaf;
+	p_tree.leaf_count++;
+}
+
+void BroadPhase3DAABBTree::_tree_remove(Tree &p_tree, Element &p_element) {
+	_remove_leaf(p_tree, p_element.leaf);
+	_free_node(p_tree, p_element.leaf);
+	p_element.leaf = INVALID_INDEX;
+	p_tree.leaf_count--;
+}
+
+// Calls p_query.visit() for each leaf whose fat AABB passes p_query.overlaps(), until visit() returns false.
+template <class Q>
+void BroadPhase3DAABBTree::_cull(const Tree &p_tree, Q &p_query) const {
+	if (p_tree.root == INVALID_INDEX) {
+		return;
+	}
+
+	uint32_t stack[QUERY_STACK_SIZE];
+	uint32_t stack_size = 0;
+	stack[stack_size++] = p_tree.root;
+
+	while (stack_size) {
+		const Node &node = p_tree.nodes[stack[--stack_size]];
+		if (!p_query.overlaps(node.aabb)) {
+			continue;
+		}
+
+		if (node.is_leaf()) {
+			if (!p_query.visit(node.element)) {
+				return;
+			}
+		} else {
+			ERR_FAIL_COND(stack_size + 2 > QUERY_STACK_SIZE);
+			stack[stack_size++] = node.children[0];
+			stack[stack_size++] = node.children[1];
+		}
+	}
+}
+
+void BroadPhase3DAABBTree::_pair(ID p_a, ID p_b) {
+	uint32_t index;
+	if (free_pair != INVALID_INDEX) {
+		index = free_pair;
+		free_pair = pairs[index].b;
+	} else {
+		index = pairs.size();
+		pairs.push_back(Pair());
+	}
+
+	Element &a = elements[p_a - 1];
+	Element &b = elements[p_b - 1];
+
+	Pair &pair = pairs[index];
+	pair.a = p_a;
+	pair.b = p_b;
+	pair.index_in_a = a.pairs.size();
+	pair.index_in_b = b.pairs.size();
+	pair.data = nullptr;
+	a.pairs.push_back(index);
+	b.pairs.push_back(index);
+
+	if (pair_callback) {
+		void *data = pair_callback(a.owner, a.subindex, b.owner, b.subindex, pair_userdata);
+		pairs[index].data = data;
+	}
+}
+
+void BroadPhase3DAABBTree::_unpair(uint32_t p_pair) {
+	Pair pair = pairs[p_pair];
+
+	// Swap with the last pair of each element, so the lists stay packed.
+	for (int i = 0; i < 2; i++) {
+		ID id = i == 0 ? pair.a : pair.b;
+		uint32_t position = i == 0 ? pair.index_in_a : pair.index_in_b;
+		LocalVector<uint32_t> &list = elements[id - 1].pairs;
+
+		uint32_t last = list[list.size() - 1];
+		list[position] = last;
+		if (pairs[last].a == id) {
+			pairs[last].index_in_a = position;
+		} else {
+			pairs[last].index_in_b = position;
+		}
+		list.resize(list.size() - 1);
+	}
+
+	pairs[p_pair].a = 0;
+	pairs[p_pair].b = free_pair;
+	pairs[p_pair].data = nullptr;
+	free_pair = p_pair;
+
+	if (unpair_callback) {
+		const Element &a = elements[pair.a - 1];
+		const Element &b = elements[pair.b - 1];
+		unpair_callback(a.owner, a.subindex, b.owner, b.subindex, pair.data, unpair_userdata);
+	}
+}
+
+// Drops the pairs of p_id that stopped overlapping and reports the new ones.
+void BroadPhase3DAABBTree::_update_pairs(ID p_id) {
+	pass++;
+
+	Element &element = elements[p_id - 1];
+
+	// Iterating backwards, since unpairing moves the last pair into the removed slot.
+	for (int i = int(element.pairs.size()) - 1; i >= 0; i--) {
+		const Pair &pair = pairs[element.pairs[i]];
+		Element &other = elements[(pair.a == p_id ? pair.b : pair.a) - 1];
+
+		if (element.leaf == INVALID_INDEX || other.leaf == INVALID_INDEX || (element._static && other._static) || !element.aabb.intersects_inclusive(other.aabb)) {
+			_unpair(element.pairs[i]);
+		} else {
+			other.pass = pass; // Already paired.
+		}
+	}
+
+	if (element.leaf == INVALID_INDEX) {
+		return;
+	}
+
+	struct PairQuery {
+		BroadPhase3DAABBTree *self;
+		ID id;
+		AABB aabb;
+		CollisionObject3DSW *owner;
+
+		_FORCE_INLINE_ bool overlaps(const AABB &p_aabb) const {
+			return p_aabb.intersects_inclusive(aabb);
+		}
+
+		_FORCE_INLINE_ bool visit(ID p_other) {
+			const Element &other = self->elements[p_other - 1];
+			if (p_other != id && other.owner != owner && other.pass != self->pass && other.aabb.intersects_inclusive(aabb)) {
+				self->_pair(id, p_other);
+			}
+			return true;
+		}
+	};
+
+	PairQuery query;
+	query.self = this;
+	query.id = p_id;
+	query.aabb = element.aabb;
+	query.owner = element.owner;
+
+	_cull(trees[TREE_DYNAMIC], query);
+	if (!element._static) {
+		_cull(trees[TREE_STATIC], query);
+	}
+}
+
+void BroadPhase3DAABBTree::_unpair_all(ID p_id) {
+	LocalVector<uint32_t> &list = elements[p_id - 1].pairs;
+	while (list.size()) {
+		_unpair(list[list.size() - 1]);
+	}
+}
+
+BroadPhase3DSW::ID BroadPhase3DAABBTree::create(CollisionObject3DSW *p_object, int p_subindex) {
+	ERR_FAIL_COND_V(p_object == nullptr, 0);
+
+	ID id;
+	if (free_elements.size()) {
+		id = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	// Like the octree, elements start as static until set_static() is called.
+	Element &element = elements[id - 1];
+	element.owner = p_object;
+	element.subindex = p_subindex;
+	element.aabb = AABB();
+	element._static = true;
+	element.leaf = INVALID_INDEX;
+	element.pass = 0;
+
+	return id;
+}
+
+void BroadPhase3DAABBTree::move(ID p_id, const AABB &p_aabb) {
+	Element *element = _get_element(p_id);
+	ERR_FAIL_COND(!element);
+
+	element->aabb = p_aabb;
+	Tree &tree = _get_tree(*element);
+
+	if (p_aabb.has_no_surface()) {
+		if (element->leaf != INVALID_INDEX) {
+			_tree_remove(tree, *element);
+		}
+	} else if (element->leaf == INVALID_INDEX) {
+		_tree_insert(tree, p_id, *element);
+	} else if (!tree.nodes[element->leaf].aabb.encloses(p_aabb)) {
+		// Left its fat AABB, reinsert the same leaf with a new one.
+		_remove_leaf(tree, element->leaf);
+		tree.nodes[element->leaf].aabb = _get_fat_aabb(p_aabb);
+		_insert_leaf(tree, element->leaf);
+	}
+
+	_update_pairs(p_id);
+}
+
+void BroadPhase3DAABBTree::set_static(ID p_id, bool p_static) {
+	Element *element = _get_element(p_id);
+	ERR_FAIL_COND(!element);
+
+	if (element->_static == p_static) {
+		return;
+	}
+
+	if (element->leaf != INVALID_INDEX) {
+		_tree_remove(_get_tree(*element), *element);
+		element->_static = p_static;
+		_tree_insert(_get_tree(*element), p_id, *element);
+	} else {
+		element->_static = p_static;
+	}
+
+	_update_pairs(p_id);
+}
+
+void BroadPhase3DAABBTree::remove(ID p_id) {
+	Element *element = _get_element(p_id);
+	ERR_FAIL_COND(!element);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	_unpair_all(p_id);
+
+	if (element->leaf != INVALID_INDEX) {
+		_tree_remove(_get_tree(*element), *element);
+	}
+
+	element->owner = nullptr;
+	free_elements.push_back(p_id);
+}
+
+CollisionObject3DSW *BroadPhase3DAABBTree::get_object(ID p_id) const {
+	const Element *element = _get_element(p_id);
+	ERR_FAIL_COND_V(!element, nullptr);
+	return element->owner;
+}
+
+bool BroadPhase3DAABBTree::is_static(ID p_id) const {
+	const Element *element = _get_element(p_id);
+	ERR_FAIL_COND_V(!element, false);
+	return element->_static;
+}
+
+int BroadPhase3DAABBTree::get_subindex(ID p_id) const {
+	const Element *element = _get_element(p_id);
+	ERR_FAIL_COND_V(!element, -1);
+	return element->subindex;
+}
+
+// Collects the owners of the elements whose exact AABB passes p_test, up to p_max_results.
+template <class T>
+int BroadPhase3DAABBTree::_cull_elements(const T &p_test, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) const {
+	if (p_max_results <= 0) {
+		return 0;
+	}
+
+	struct CullQuery {
+		const T *test;
+		const BroadPhase3DAABBTree *self;
+		CollisionObject3DSW **results;
+		int *result_indices;
+		int max_results;
+		int count;
+
+		_FORCE_INLINE_ bool overlaps(const AABB &p_aabb) const {
+			return (*test)(p_aabb);
+		}
+
+		_FORCE_INLINE_ bool visit(ID p_id) {
+			const Element &element = self->elements[p_id - 1];
+			if (!(*test)(element.aabb)) {
+				return true;
+			}
+
+			results[count] = element.owner;
+			if (result_indices) {
+				result_indices[count] = element.subindex;
+			}
+			count++;
+			return count < max_results;
+		}
+	};
+
+	CullQuery query;
+	query.test = &p_test;
+	query.self = this;
+	query.results = p_results;
+	query.result_indices = p_result_indices;
+	query.max_results = p_max_results;
+	query.count = 0;
+
+	_cull(trees[TREE_DYNAMIC], query);
+	if (query.count < p_max_results) {
+		_cull(trees[TREE_STATIC], query);
+	}
+
+	return query.count;
+}
+
+struct BroadPhase3DAABBTreePointTest {
+	Vector3 point;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+};
+
+struct BroadPhase3DAABBTreeSegmentTest {
+	Vector3 from;
+	Vector3 to;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct BroadPhase3DAABBTreeAABBTest {
+	AABB aabb;
+	_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_inclusive(aabb); }
+};
+
+int BroadPhase3DAABBTree::cull_point(const Vector3 &p_point, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	BroadPhase3DAABBTreePointTest test;
+	test.point = p_point;
+	return _cull_elements(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhase3DAABBTree::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	BroadPhase3DAABBTreeSegmentTest test;
+	test.from = p_from;
+	test.to = p_to;
+	return _cull_elements(test, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhase3DAABBTree::cull_aabb(const AABB &p_aabb, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
+	BroadPhase3DAABBTreeAABBTest test;
+	test.aabb = p_aabb;
+	return _cull_elements(test, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhase3DAABBTree::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhase3DAABBTree::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+void BroadPhase3DAABBTree::update() {
+	// pairs are already up to date, they change as soon as elements move
+}
+
+BroadPhase3DSW *BroadPhase3DAABBTree::_create() {
+	return memnew(BroadPhase3DAABBTree);
+}
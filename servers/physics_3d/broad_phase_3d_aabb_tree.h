@@ -0,0 +1,170 @@
+/*************************************************************************/
+/*  broad_phase_3d_aabb_tree.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2020 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2020 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_3D_AABB_TREE_H
+#define BROAD_PHASE_3D_AABB_TREE_H
+
+#include "broad_phase_3d_sw.h"
+#include "core/local_vector.h"
+
+// Dynamic AABB tree broadphase.
+//
+// Static and dynamic elements live in separate trees, so static elements are
+// never tested against each other. Leaves store an enlarged ("fat") AABB, and
+// an element only has to be reinserted when it leaves it. Insertion picks the
+// sibling with the cheapest surface area increase, then refits the ancestors
+// and rebalances them with tree rotations.
+//
+// Pairs follow the exact AABBs and are reported as soon as an element moves,
+// like BroadPhaseOctree does.
+class BroadPhase3DAABBTree : public BroadPhase3DSW {
+	enum {
+		INVALID_INDEX = 0xFFFFFFFF,
+		QUERY_STACK_SIZE = 256,
+	};
+
+	enum TreeType {
+		TREE_STATIC,
+		TREE_DYNAMIC,
+		TREE_MAX
+	};
+
+	struct Node {
+		AABB aabb;
+		uint32_t parent = INVALID_INDEX; // Next free node while in the free list.
+		uint32_t children[2] = { INVALID_INDEX, INVALID_INDEX };
+		int height = 0; // 0 for leaves, -1 while in the free list.
+		ID element = 0;
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == INVALID_INDEX; }
+	};
+
+	struct Tree {
+		LocalVector<Node> nodes;
+		uint32_t root = INVALID_INDEX;
+		uint32_t free_node = INVALID_INDEX;
+		uint32_t leaf_count = 0;
+	};
+
+	struct Element {
+		CollisionObject3DSW *owner = nullptr;
+		AABB aabb; // Exact, pairs and queries are tested against this one.
+		int subindex = 0;
+		bool _static = true;
+		uint32_t leaf = INVALID_INDEX;
+		uint64_t pass = 0;
+		LocalVector<uint32_t> pairs;
+	};
+
+	struct Pair {
+		ID a = 0;
+		ID b = 0; // Next free pair while in the free list.
+		uint32_t index_in_a = 0;
+		uint32_t index_in_b = 0;
+		void *data = nullptr;
+	};
+
+	Tree trees[TREE_MAX];
+
+	LocalVector<Element> elements; // Indexed by ID - 1.
+	LocalVector<ID> free_elements;
+
+	LocalVector<Pair> pairs;
+	uint32_t free_pair = INVALID_INDEX;
+
+	uint64_t pass = 1;
+
+	PairCallback pair_callback = nullptr;
+	void *pair_userdata = nullptr;
+	UnpairCallback unpair_callback = nullptr;
+	void *unpair_userdata = nullptr;
+
+	_FORCE_INLINE_ Element *_get_element(ID p_id) {
+		ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].owner, nullptr);
+		return &elements[p_id - 1];
+	}
+
+	_FORCE_INLINE_ const Element *_get_element(ID p_id) const {
+		ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].owner, nullptr);
+		return &elements[p_id - 1];
+	}
+
+	_FORCE_INLINE_ Tree &_get_tree(const Element &p_element) {
+		return trees[p_element._static ? TREE_STATIC : TREE_DYNAMIC];
+	}
+
+	static real_t _get_surface(const AABB &p_aabb);
+	static AABB _get_fat_aabb(const AABB &p_aabb);
+
+	uint32_t _alloc_node(Tree &p_tree);
+	void _free_node(Tree &p_tree, uint32_t p_node);
+	uint32_t _balance(Tree &p_tree, uint32_t p_node);
+	void _refit_from(Tree &p_tree, uint32_t p_node);
+	void _insert_leaf(Tree &p_tree, uint32_t p_leaf);
+	void _remove_leaf(Tree &p_tree, uint32_t p_leaf);
+
+	void _tree_insert(Tree &p_tree, ID p_id, Element &p_element);
+	void _tree_remove(Tree &p_tree, Element &p_element);
+
+	template <class Q>
+	void _cull(const Tree &p_tree, Q &p_query) const;
+	template <class T>
+	int _cull_elements(const T &p_test, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) const;
+
+	void _pair(ID p_a, ID p_b);
+	void _unpair(uint32_t p_pair);
+	void _update_pairs(ID p_id);
+	void _unpair_all(ID p_id);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObject3DSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const AABB &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObject3DSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_point(const Vector3 &p_point, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+	virtual int cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+	virtual int cull_aabb(const AABB &p_aabb, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices = nullptr);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhase3DSW *_create();
+	BroadPhase3DAABBTree() {}
+};
+
+#endif // BROAD_PHASE_3D_AABB_TREE_H
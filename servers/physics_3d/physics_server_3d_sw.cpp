@@ -30,10 +30,12 @@
 
 #include "physics_server_3d_sw.h"
 
+#include "broad_phase_3d_aabb_tree.h"
 #include "broad_phase_3d_basic.h"
 #include "broad_phase_octree.h"
 #include "core/debugger/engine_debugger.h"
 #include "core/os/os.h"
+#include "core/project_settings.h"
 #include "joints/cone_twist_joint_3d_sw.h"
 #include "joints/generic_6dof_joint_3d_sw.h"
 #include "joints/hinge_joint_3d_sw.h"
@@ -1291,6 +1293,7 @@ void PhysicsServer3DSW::init() {
 	last_step = 0.001;
 	iterations = 8; // 8?
 	stepper = memnew(Step3DSW);
+	stepper->set_use_threads(GLOBAL_DEF("physics/3d/multithreaded_solver", true));
 	direct_state = memnew(PhysicsDirectBodyState3DSW);
 };
 
@@ -1396,6 +1399,14 @@ int PhysicsServer3DSW::get_process_info(ProcessInfo p_info) {
 	return 0;
 }
 
+void PhysicsServer3DSW::set_multithreaded_solver(bool p_enable) {
+	stepper->set_use_threads(p_enable);
+}
+
+bool PhysicsServer3DSW::is_multithreaded_solver() const {
+	return stepper->is_using_threads();
+}
+
 void PhysicsServer3DSW::_update_shapes() {
 	while (pending_shape_update_list.first()) {
 		pending_shape_update_list.first()->self()->_shape_changed();
@@ -1439,7 +1450,15 @@ void PhysicsServer3DSW::_shape_col_cbk(const Vector3 &p_point_A, const Vector3 &
 PhysicsServer3DSW *PhysicsServer3DSW::singleton = nullptr;
 PhysicsServer3DSW::PhysicsServer3DSW() {
 	singleton = this;
-	BroadPhase3DSW::create_func = BroadPhaseOctree::_create;
+
+	int broadphase = GLOBAL_DEF("physics/3d/broadphase", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/broadphase", PropertyInfo(Variant::INT, "physics/3d/broadphase", PROPERTY_HINT_ENUM, "Octree,AABB Tree"));
+	if (broadphase == 1) {
+		BroadPhase3DSW::create_func = BroadPhase3DAABBTree::_create;
+	} else {
+		BroadPhase3DSW::create_func = BroadPhaseOctree::_create;
+	}
+
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
@@ -373,6 +373,10 @@ public:
 
 	int get_process_info(ProcessInfo p_info);
 
+	// Set from the physics/3d/multithreaded_solver project setting, results don't depend on it.
+	void set_multithreaded_solver(bool p_enable);
+	bool is_multithreaded_solver() const;
+
 	PhysicsServer3DSW();
 	~PhysicsServer3DSW() {}
 };
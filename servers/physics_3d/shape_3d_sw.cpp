@@ -1422,6 +1422,41 @@ real_t HeightMapShape3DSW::get_cell_size() const {
 	return cell_size;
 }
 
+Vector3 HeightMapShape3DSW::_get_point(int p_x, int p_z) const {
+	return Vector3((p_x - (width - 1) * 0.5) * cell_size, heights[p_z * width + p_x], (p_z - (depth - 1) * 0.5) * cell_size);
+}
+
+void HeightMapShape3DSW::_get_cell_triangles(int p_x, int p_z, Vector3 r_triangles[2][3]) const {
+	Vector3 p00 = _get_point(p_x, p_z);
+	Vector3 p10 = _get_point(p_x + 1, p_z);
+	Vector3 p01 = _get_point(p_x, p_z + 1);
+	Vector3 p11 = _get_point(p_x + 1, p_z + 1);
+
+	// Split along the p00-p11 diagonal, both facing up.
+	r_triangles[0][0] = p00;
+	r_triangles[0][1] = p11;
+	r_triangles[0][2] = p01;
+
+	r_triangles[1][0] = p00;
+	r_triangles[1][1] = p10;
+	r_triangles[1][2] = p11;
+}
+
+AABB HeightMapShape3DSW::_get_tile_aabb(int p_level, int p_x, int p_z) const {
+	const MipLevel &level = mip_levels[p_level];
+	const MinMax &range = mip_ranges[level.offset + p_z * level.width + p_x];
+
+	int from_x = p_x << p_level;
+	int from_z = p_z << p_level;
+	int to_x = MIN((p_x + 1) << p_level, width - 1);
+	int to_z = MIN((p_z + 1) << p_level, depth - 1);
+
+	AABB aabb;
+	aabb.position = Vector3((from_x - (width - 1) * 0.5) * cell_size, range.min, (from_z - (depth - 1) * 0.5) * cell_size);
+	aabb.size = Vector3((to_x - from_x) * cell_size, range.max - range.min, (to_z - from_z) * cell_size);
+	return aabb;
+}
+
 void HeightMapShape3DSW::project_range(const Vector3 &p_normal, const Transform &p_transform, real_t &r_min, real_t &r_max) const {
 	//not very useful, but not very used either
 	p_transform.xform(get_aabb()).project_range_in_plane(Plane(p_normal, 0), r_min, r_max);
@@ -1432,19 +1467,305 @@ Vector3 HeightMapShape3DSW::get_support(const Vector3 &p_normal) const {
 	return get_aabb().get_support(p_normal);
 }
 
+void HeightMapShape3DSW::_cull_segment(int p_level, int p_x, int p_z, real_t p_t_min, real_t p_t_max, _SegmentCullParams *p_params) const {
+	if (p_level == 0) {
+		Vector3 triangles[2][3];
+		_get_cell_triangles(p_x, p_z, triangles);
+
+		for (int i = 0; i < 2; i++) {
+			Vector3 res;
+			if (!Geometry3D::segment_intersects_triangle(p_params->from, p_params->from + p_params->dir, triangles[i][0], triangles[i][1], triangles[i][2], &res)) {
+				continue;
+			}
+
+			real_t t = p_params->dir.dot(res - p_params->from) / p_params->dir.length_squared();
+			if (t < p_params->min_t) {
+				p_params->min_t = t;
+				p_params->result = res;
+				p_params->normal = Plane(triangles[i][0], triangles[i][1], triangles[i][2]).normal;
+			}
+		}
+		return;
+	}
+
+	// Visit the children the segment crosses, nearest first, and stop once
+	// a hit is closer than where the next child is entered.
+	int child_level = p_level - 1;
+	const MipLevel &level = mip_levels[child_level];
+	real_t margin = cell_size * 0.001;
+
+	int children[4][2];
+	real_t child_t[4][2];
+	int child_count = 0;
+
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			int x = p_x * 2 + j;
+			int z = p_z * 2 + i;
+			if (x >= level.width || z >= level.depth) {
+				continue;
+			}
+
+			AABB aabb = _get_tile_aabb(child_level, x, z).grow(margin);
+			real_t t_min = p_t_min;
+			real_t t_max = p_t_max;
+			bool crosses = true;
+
+			for (int k = 0; k < 3; k++) {
+				real_t from = p_params->from[k];
+				real_t dir = p_params->dir[k];
+				real_t slab_min = aabb.position[k];
+				real_t slab_max = aabb.position[k] + aabb.size[k];
+
+				if (Math::is_zero_approx(dir)) {
+					if (from < slab_min || from > slab_max) {
+						crosses = false;
+						break;
+					}
+					continue;
+				}
+
+				real_t t0 = (slab_min - from) / dir;
+				real_t t1 = (slab_max - from) / dir;
+				if (t0 > t1) {
+					SWAP(t0, t1);
+				}
+				t_min = MAX(t_min, t0);
+				t_max = MIN(t_max, t1);
+				if (t_min > t_max) {
+					crosses = false;
+					break;
+				}
+			}
+
+			if (!crosses) {
+				continue;
+			}
+
+			// Insertion sort by entry.
+			int pos = child_count;
+			while (pos > 0 && child_t[pos - 1][0] > t_min) {
+				children[pos][0] = children[pos - 1][0];
+				children[pos][1] = children[pos - 1][1];
+				child_t[pos][0] = child_t[pos - 1][0];
+				child_t[pos][1] = child_t[pos - 1][1];
+				pos--;
+			}
+			children[pos][0] = x;
+			children[pos][1] = z;
+			child_t[pos][0] = t_min;
+			child_t[pos][1] = t_max;
+			child_count++;
+		}
+	}
+
+	for (int i = 0; i < child_count; i++) {
+		if (child_t[i][0] > p_params->min_t) {
+			break;
+		}
+		_cull_segment(child_level, children[i][0], children[i][1], child_t[i][0], child_t[i][1], p_params);
+	}
+}
+
 bool HeightMapShape3DSW::intersect_segment(const Vector3 &p_begin, const Vector3 &p_end, Vector3 &r_point, Vector3 &r_normal) const {
-	return false;
+	if (mip_levels.size() == 0 || p_begin == p_end) {
+		return false;
+	}
+
+	_SegmentCullParams params;
+	params.from = p_begin;
+	params.dir = p_end - p_begin;
+	params.min_t = 1e20;
+
+	// Start from the whole map, which is the single tile at the top.
+	int top = mip_levels.size() - 1;
+	AABB aabb = _get_tile_aabb(top, 0, 0).grow(cell_size * 0.001);
+	if (!aabb.intersects_segment(p_begin, p_end)) {
+		return false;
+	}
+
+	_cull_segment(top + 1, 0, 0, 0, 1, &params);
+
+	if (params.min_t > 1) {
+		return false;
+	}
+
+	r_point = params.result;
+	r_normal = params.normal;
+	return true;
 }
 
 bool HeightMapShape3DSW::intersect_point(const Vector3 &p_point) const {
-	return false;
+	// Inside means under the surface and above the lowest point of the map.
+	if (mip_levels.size() == 0) {
+		return false;
+	}
+
+	real_t x = p_point.x / cell_size + (width - 1) * 0.5;
+	real_t z = p_point.z / cell_size + (depth - 1) * 0.5;
+	if (x < 0 || z < 0 || x > width - 1 || z > depth - 1) {
+		return false;
+	}
+
+	if (p_point.y < get_aabb().position.y) {
+		return false;
+	}
+
+	int cell_x = MIN((int)x, width - 2);
+	int cell_z = MIN((int)z, depth - 2);
+	real_t fx = x - cell_x;
+	real_t fz = z - cell_z;
+
+	real_t h00 = heights[cell_z * width + cell_x];
+	real_t h10 = heights[cell_z * width + cell_x + 1];
+	real_t h01 = heights[(cell_z + 1) * width + cell_x];
+	real_t h11 = heights[(cell_z + 1) * width + cell_x + 1];
+
+	real_t h;
+	if (fz > fx) {
+		h = h00 + (h11 - h01) * fx + (h01 - h00) * fz;
+	} else {
+		h = h00 + (h10 - h00) * fx + (h11 - h10) * fz;
+	}
+
+	return p_point.y <= h;
+}
+
+void HeightMapShape3DSW::_closest_point(int p_level, int p_x, int p_z, _ClosestPointParams *p_params) const {
+	if (p_level == 0) {
+		Vector3 triangles[2][3];
+		_get_cell_triangles(p_x, p_z, triangles);
+
+		for (int i = 0; i < 2; i++) {
+			Vector3 closest = Face3(triangles[i][0], triangles[i][1], triangles[i][2]).get_closest_point_to(p_params->point);
+			real_t distance_squared = closest.distance_squared_to(p_params->point);
+			if (distance_squared < p_params->min_distance_squared) {
+				p_params->min_distance_squared = distance_squared;
+				p_params->result = closest;
+			}
+		}
+		return;
+	}
+
+	// Visit the nearest children first, so farther ones can be skipped.
+	int child_level = p_level - 1;
+	const MipLevel &level = mip_levels[child_level];
+
+	int children[4][2];
+	real_t child_distance[4];
+	int child_count = 0;
+
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			int x = p_x * 2 + j;
+			int z = p_z * 2 + i;
+			if (x >= level.width || z >= level.depth) {
+				continue;
+			}
+
+			AABB aabb = _get_tile_aabb(child_level, x, z);
+			Vector3 closest = p_params->point;
+			for (int k = 0; k < 3; k++) {
+				closest[k] = CLAMP(closest[k], aabb.position[k], aabb.position[k] + aabb.size[k]);
+			}
+			real_t distance_squared = closest.distance_squared_to(p_params->point);
+
+			int pos = child_count;
+			while (pos > 0 && child_distance[pos - 1] > distance_squared) {
+				children[pos][0] = children[pos - 1][0];
+				children[pos][1] = children[pos - 1][1];
+				child_distance[pos] = child_distance[pos - 1];
+				pos--;
+			}
+			children[pos][0] = x;
+			children[pos][1] = z;
+			child_distance[pos] = distance_squared;
+			child_count++;
+		}
+	}
+
+	for (int i = 0; i < child_count; i++) {
+		if (child_distance[i] >= p_params->min_distance_squared) {
+			break;
+		}
+		_closest_point(child_level, children[i][0], children[i][1], p_params);
+	}
 }
 
 Vector3 HeightMapShape3DSW::get_closest_point_to(const Vector3 &p_point) const {
-	return Vector3();
+	if (mip_levels.size() == 0) {
+		return Vector3();
+	}
+
+	if (intersect_point(p_point)) {
+		return p_point; //it's inside, don't do anything else
+	}
+
+	_ClosestPointParams params;
+	params.point = p_point;
+	params.min_distance_squared = 1e20;
+
+	_closest_point(mip_levels.size(), 0, 0, &params);
+
+	return params.result;
+}
+
+void HeightMapShape3DSW::_cull(int p_level, int p_x, int p_z, _CullParams *p_params) const {
+	if (p_level == 0) {
+		Vector3 triangles[2][3];
+		_get_cell_triangles(p_x, p_z, triangles);
+
+		for (int i = 0; i < 2; i++) {
+			AABB aabb(triangles[i][0], Vector3());
+			aabb.expand_to(triangles[i][1]);
+			aabb.expand_to(triangles[i][2]);
+			if (!p_params->aabb.intersects_inclusive(aabb)) {
+				continue;
+			}
+
+			FaceShape3DSW *face = p_params->face;
+			face->normal = Plane(triangles[i][0], triangles[i][1], triangles[i][2]).normal;
+			face->vertex[0] = triangles[i][0];
+			face->vertex[1] = triangles[i][1];
+			face->vertex[2] = triangles[i][2];
+			p_params->callback(p_params->userdata, face);
+		}
+		return;
+	}
+
+	int child_level = p_level - 1;
+	const MipLevel &level = mip_levels[child_level];
+
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			int x = p_x * 2 + j;
+			int z = p_z * 2 + i;
+			if (x >= level.width || z >= level.depth) {
+				continue;
+			}
+
+			if (p_params->aabb.intersects_inclusive(_get_tile_aabb(child_level, x, z))) {
+				_cull(child_level, x, z, p_params);
+			}
+		}
+	}
 }
 
 void HeightMapShape3DSW::cull(const AABB &p_local_aabb, Callback p_callback, void *p_userdata) const {
+	if (mip_levels.size() == 0) {
+		return;
+	}
+
+	FaceShape3DSW face; // use this to send in the callback
+
+	_CullParams params;
+	params.aabb = p_local_aabb;
+	params.callback = p_callback;
+	params.userdata = p_userdata;
+	params.face = &face;
+
+	// Level mip_levels.size() stands for the whole map, its only child is the top tile.
+	_cull(mip_levels.size(), 0, 0, &params);
 }
 
 Vector3 HeightMapShape3DSW::get_moment_of_inertia(real_t p_mass) const {
@@ -1457,29 +1778,97 @@ Vector3 HeightMapShape3DSW::get_moment_of_inertia(real_t p_mass) const {
 			(p_mass / 3.0) * (extents.y * extents.y + extents.y * extents.y));
 }
 
+void HeightMapShape3DSW::_build_mips() {
+	mip_ranges.clear();
+	mip_levels.clear();
+
+	if (width < 2 || depth < 2) {
+		return; // no cells
+	}
+
+	const real_t *r = heights.ptr();
+
+	MipLevel level;
+	level.offset = 0;
+	level.width = width - 1;
+	level.depth = depth - 1;
+	mip_levels.push_back(level);
+	int total = level.width * level.depth;
+
+	while (level.width > 1 || level.depth > 1) {
+		level.offset += level.width * level.depth;
+		level.width = (level.width + 1) / 2;
+		level.depth = (level.depth + 1) / 2;
+		mip_levels.push_back(level);
+		total += level.width * level.depth;
+	}
+
+	mip_ranges.resize(total);
+	MinMax *w = mip_ranges.ptrw();
+
+	// Cells first, from their four corners.
+	for (int z = 0; z < depth - 1; z++) {
+		for (int x = 0; x < width - 1; x++) {
+			real_t h00 = r[z * width + x];
+			real_t h10 = r[z * width + x + 1];
+			real_t h01 = r[(z + 1) * width + x];
+			real_t h11 = r[(z + 1) * width + x + 1];
+
+			MinMax &range = w[z * (width - 1) + x];
+			range.min = MIN(MIN(h00, h10), MIN(h01, h11));
+			range.max = MAX(MAX(h00, h10), MAX(h01, h11));
+		}
+	}
+
+	// Then each tile from the (up to) four tiles below it.
+	for (int i = 1; i < mip_levels.size(); i++) {
+		const MipLevel &below = mip_levels[i - 1];
+		const MipLevel &current = mip_levels[i];
+
+		for (int z = 0; z < current.depth; z++) {
+			for (int x = 0; x < current.width; x++) {
+				MinMax range = w[below.offset + (z * 2) * below.width + x * 2];
+
+				for (int j = 0; j < 2; j++) {
+					for (int k = 0; k < 2; k++) {
+						int bx = x * 2 + k;
+						int bz = z * 2 + j;
+						if (bx >= below.width || bz >= below.depth) {
+							continue;
+						}
+						const MinMax &child = w[below.offset + bz * below.width + bx];
+						range.min = MIN(range.min, child.min);
+						range.max = MAX(range.max, child.max);
+					}
+				}
+
+				w[current.offset + z * current.width + x] = range;
+			}
+		}
+	}
+}
+
 void HeightMapShape3DSW::_setup(Vector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size) {
 	heights = p_heights;
 	width = p_width;
 	depth = p_depth;
 	cell_size = p_cell_size;
 
-	const real_t *r = heights.ptr();
+	_build_mips();
 
-	AABB aabb;
-
-	for (int i = 0; i < depth; i++) {
-		for (int j = 0; j < width; j++) {
-			real_t h = r[i * width + j];
+	const real_t *r = heights.ptr();
 
-			Vector3 pos(j * cell_size, h, i * cell_size);
-			if (i == 0 || j == 0) {
-				aabb.position = pos;
-			} else {
-				aabb.expand_to(pos);
-			}
-		}
+	real_t min_height = r[0];
+	real_t max_height = r[0];
+	for (int i = 1; i < heights.size(); i++) {
+		min_height = MIN(min_height, r[i]);
+		max_height = MAX(max_height, r[i]);
 	}
 
+	AABB aabb;
+	aabb.position = Vector3(-(width - 1) * 0.5 * cell_size, min_height, -(depth - 1) * 0.5 * cell_size);
+	aabb.size = Vector3((width - 1) * cell_size, max_height - min_height, (depth - 1) * cell_size);
+
 	configure(aabb);
 }
 
@@ -1488,14 +1877,18 @@ void HeightMapShape3DSW::set_data(const Variant &p_data) {
 	Dictionary d = p_data;
 	ERR_FAIL_COND(!d.has("width"));
 	ERR_FAIL_COND(!d.has("depth"));
-	ERR_FAIL_COND(!d.has("cell_size"));
 	ERR_FAIL_COND(!d.has("heights"));
 
 	int width = d["width"];
 	int depth = d["depth"];
-	real_t cell_size = d["cell_size"];
 	Vector<real_t> heights = d["heights"];
 
+	// HeightMapShape3D doesn't send a cell size, its samples are one unit apart.
+	real_t cell_size = 1.0;
+	if (d.has("cell_size")) {
+		cell_size = d["cell_size"];
+	}
+
 	ERR_FAIL_COND(width <= 0);
 	ERR_FAIL_COND(depth <= 0);
 	ERR_FAIL_COND(cell_size <= CMP_EPSILON);
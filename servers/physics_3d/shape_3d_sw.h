@@ -354,14 +354,63 @@ public:
 };
 
 struct HeightMapShape3DSW : public ConcaveShape3DSW {
+	// Heights are sampled on a width x depth grid centered on the origin, like
+	// the HeightMapShape3D debug mesh. Each cell between four samples is split
+	// in two triangles, which are generated only when a query reaches them.
 	Vector<real_t> heights;
 	int width;
 	int depth;
 	real_t cell_size;
 
-	//void _cull_segment(int p_idx,_SegmentCullParams *p_params) const;
-	//void _cull(int p_idx,_CullParams *p_params) const;
+	struct MinMax {
+		real_t min;
+		real_t max;
+	};
+
+	struct MipLevel {
+		int offset;
+		int width;
+		int depth;
+	};
+
+	// Height range of every cell, then of tiles of 2x2, 4x4... cells, up to a
+	// single tile covering the whole map. Queries descend from the top and skip
+	// every tile they can't touch.
+	Vector<MinMax> mip_ranges;
+	Vector<MipLevel> mip_levels;
+
+	struct _CullParams {
+		AABB aabb;
+		Callback callback;
+		void *userdata;
+		FaceShape3DSW *face;
+	};
+
+	struct _SegmentCullParams {
+		Vector3 from;
+		Vector3 dir;
+
+		Vector3 result;
+		Vector3 normal;
+		real_t min_t;
+	};
+
+	struct _ClosestPointParams {
+		Vector3 point;
+
+		Vector3 result;
+		real_t min_distance_squared;
+	};
+
+	_FORCE_INLINE_ Vector3 _get_point(int p_x, int p_z) const;
+	_FORCE_INLINE_ void _get_cell_triangles(int p_x, int p_z, Vector3 r_triangles[2][3]) const;
+	_FORCE_INLINE_ AABB _get_tile_aabb(int p_level, int p_x, int p_z) const;
+
+	void _cull(int p_level, int p_x, int p_z, _CullParams *p_params) const;
+	void _cull_segment(int p_level, int p_x, int p_z, real_t p_t_min, real_t p_t_max, _SegmentCullParams *p_params) const;
+	void _closest_point(int p_level, int p_x, int p_z, _ClosestPointParams *p_params) const;
 
+	void _build_mips();
 	void _setup(Vector<real_t> p_heights, int p_width, int p_depth, real_t p_cell_size);
 
 public:
@@ -32,13 +32,14 @@
 #include "joints_3d_sw.h"
 
 #include "core/os/os.h"
+#include "core/thread_work_pool.h"
 
 void Step3DSW::_populate_island(Body3DSW *p_body, Body3DSW **p_island, Constraint3DSW **p_constraint_island) {
 	p_body->set_island_step(_step);
 	p_body->set_island_next(*p_island);
 	*p_island = p_body;
 
-	for (Map<Constraint3DSW *, int>::Element *E = p_body->get_constraint_map().front(); E; E = E->next()) {
+	for (Body3DSW::ConstraintMap::Element *E = p_body->get_constraint_map().front(); E; E = E->next()) {
 		Constraint3DSW *c = (Constraint3DSW *)E->key();
 		if (c->get_island_step() == _step) {
 			continue; //already processed
@@ -60,23 +61,28 @@ void Step3DSW::_populate_island(Body3DSW *p_body, Body3DSW **p_island, Constrain
 	}
 }
 
-void Step3DSW::_setup_island(Constraint3DSW *p_island, real_t p_delta) {
-	Constraint3DSW *ci = p_island;
-	while (ci) {
-		ci->setup(p_delta);
-		//todo remove from island if process fails
-		ci = ci->get_island_next();
-	}
+void Step3DSW::_integrate_forces(uint32_t p_body_index, void *p_userdata) {
+	bodies[p_body_index]->integrate_forces(delta);
+}
+
+void Step3DSW::_integrate_velocities(uint32_t p_body_index, void *p_userdata) {
+	bodies[p_body_index]->integrate_velocities(delta);
 }
 
-void Step3DSW::_solve_island(Constraint3DSW *p_island, int p_iterations, real_t p_delta) {
+void Step3DSW::_setup_constraint(uint32_t p_constraint_index, void *p_userdata) {
+	constraints[p_constraint_index]->setup(delta);
+	//todo remove from island if process fails
+}
+
+void Step3DSW::_solve_island(uint32_t p_island_index, void *p_userdata) {
+	Constraint3DSW *island = constraint_islands[p_island_index];
 	int at_priority = 1;
 
-	while (p_island) {
-		for (int i = 0; i < p_iterations; i++) {
-			Constraint3DSW *ci = p_island;
+	while (island) {
+		for (int i = 0; i < iterations; i++) {
+			Constraint3DSW *ci = island;
 			while (ci) {
-				ci->solve(p_delta);
+				ci->solve(delta);
 				ci = ci->get_island_next();
 			}
 		}
@@ -84,14 +90,14 @@ void Step3DSW::_solve_island(Constraint3DSW *p_island, int p_iterations, real_t
 		at_priority++;
 
 		{
-			Constraint3DSW *ci = p_island;
+			Constraint3DSW *ci = island;
 			Constraint3DSW *prev = nullptr;
 			while (ci) {
 				if (ci->get_priority() < at_priority) {
 					if (prev) {
 						prev->set_island_next(ci->get_island_next()); //remove
 					} else {
-						p_island = ci->get_island_next();
+						island = ci->get_island_next();
 					}
 				} else {
 					prev = ci;
@@ -139,11 +145,27 @@ void Step3DSW::_check_suspend(Body3DSW *p_island, real_t p_delta) {
 	}
 }
 
+// Every element only touches data no other element does, so the result is the same whether it runs on one thread or many.
+template <class M>
+void Step3DSW::_run(uint32_t p_elements, M p_method) {
+	ThreadWorkPool *pool = ThreadWorkPool::get_singleton();
+	if (use_threads && pool && p_elements > 1) {
+		pool->do_work(p_elements, this, p_method, (void *)nullptr);
+	} else {
+		for (uint32_t i = 0; i < p_elements; i++) {
+			(this->*p_method)(i, nullptr);
+		}
+	}
+}
+
 void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	p_space->lock(); // can't access space during this
 
 	p_space->setup(); //update inertias, etc
 
+	delta = p_delta;
+	iterations = p_iterations;
+
 	const SelfList<Body3DSW>::List *body_list = &p_space->get_active_body_list();
 
 	/* INTEGRATE FORCES */
@@ -151,16 +173,20 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
 	uint64_t profile_endtime = 0;
 
-	int active_count = 0;
-
+	bodies.clear();
 	const SelfList<Body3DSW> *b = body_list->first();
 	while (b) {
-		b->self()->integrate_forces(p_delta);
+		bodies.push_back(b->self());
 		b = b->next();
-		active_count++;
 	}
 
-	p_space->set_active_objects(active_count);
+	_run(bodies.size(), &Step3DSW::_integrate_forces);
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		bodies[i]->post_integrate_forces();
+	}
+
+	p_space->set_active_objects(bodies.size());
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -214,6 +240,15 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 		p_space->area_remove_from_moved_list((SelfList<Area3DSW> *)aml.first()); //faster to remove here
 	}
 
+	constraint_islands.clear();
+	constraints.clear();
+	for (Constraint3DSW *ci = constraint_island_list; ci; ci = ci->get_island_list_next()) {
+		constraint_islands.push_back(ci);
+		for (Constraint3DSW *c = ci; c; c = c->get_island_next()) {
+			constraints.push_back(c);
+		}
+	}
+
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
 		p_space->set_elapsed_time(Space3DSW::ELAPSED_TIME_GENERATE_ISLANDS, profile_endtime - profile_begtime);
@@ -222,12 +257,12 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
-	{
-		Constraint3DSW *ci = constraint_island_list;
-		while (ci) {
-			_setup_island(ci, p_delta);
-			ci = ci->get_island_list_next();
-		}
+	_run(constraints.size(), &Step3DSW::_setup_constraint);
+
+	// Applies what setup can't do in parallel (contact reports, area queries, warm starting),
+	// in the same order the constraints were set up in when this ran on a single thread.
+	for (uint32_t i = 0; i < constraints.size(); i++) {
+		constraints[i]->pre_solve(p_delta);
 	}
 
 	{ //profile
@@ -238,14 +273,8 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
-	{
-		Constraint3DSW *ci = constraint_island_list;
-		while (ci) {
-			//iterating each island separatedly improves cache efficiency
-			_solve_island(ci, p_iterations, p_delta);
-			ci = ci->get_island_list_next();
-		}
-	}
+	// Islands share no dynamic bodies, so they can be solved at the same time.
+	_run(constraint_islands.size(), &Step3DSW::_solve_island);
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -255,11 +284,17 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
+	bodies.clear();
 	b = body_list->first();
 	while (b) {
-		const SelfList<Body3DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n;
+		bodies.push_back(b->self());
+		b = b->next();
+	}
+
+	_run(bodies.size(), &Step3DSW::_integrate_velocities);
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		bodies[i]->post_integrate_velocities(); //may deactivate the body
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
@@ -31,17 +31,35 @@
 #ifndef STEP_SW_H
 #define STEP_SW_H
 
+#include "core/local_vector.h"
 #include "space_3d_sw.h"
 
 class Step3DSW {
 	uint64_t _step;
+	bool use_threads = true;
+
+	real_t delta = 0.0;
+	int iterations = 0;
+
+	// Flattened for the work pool, in the order the serial solver visited them.
+	LocalVector<Body3DSW *> bodies;
+	LocalVector<Constraint3DSW *> constraints;
+	LocalVector<Constraint3DSW *> constraint_islands;
 
 	void _populate_island(Body3DSW *p_body, Body3DSW **p_island, Constraint3DSW **p_constraint_island);
-	void _setup_island(Constraint3DSW *p_island, real_t p_delta);
-	void _solve_island(Constraint3DSW *p_island, int p_iterations, real_t p_delta);
+	void _integrate_forces(uint32_t p_body_index, void *p_userdata);
+	void _integrate_velocities(uint32_t p_body_index, void *p_userdata);
+	void _setup_constraint(uint32_t p_constraint_index, void *p_userdata);
+	void _solve_island(uint32_t p_island_index, void *p_userdata);
 	void _check_suspend(Body3DSW *p_island, real_t p_delta);
 
+	template <class M>
+	void _run(uint32_t p_elements, M p_method);
+
 public:
+	void set_use_threads(bool p_enable) { use_threads = p_enable; }
+	bool is_using_threads() const { return use_threads; }
+
 	void step(Space3DSW *p_space, real_t p_delta, int p_iterations);
 	Step3DSW();
 };
@@ -30,6 +30,7 @@
 
 #include "rendering_server_viewport.h"
 
+#include "core/frame_arena.h"
 #include "core/project_settings.h"
 #include "rendering_server_canvas.h"
 #include "rendering_server_globals.h"
@@ -127,7 +128,7 @@ void RenderingServerViewport::_draw_viewport(Viewport *p_viewport, XRInterface::
 	if (!p_viewport->hide_canvas) {
 		int i = 0;
 
-		Map<Viewport::CanvasKey, Viewport::CanvasData *> canvas_map;
+		Map<Viewport::CanvasKey, Viewport::CanvasData *, Comparator<Viewport::CanvasKey>, FrameAllocator> canvas_map;
 
 		Rect2 clip_rect(0, 0, p_viewport->size.x, p_viewport->size.y);
 		RasterizerCanvas::Light *lights = nullptr;
@@ -238,7 +239,7 @@ void RenderingServerViewport::_draw_viewport(Viewport *p_viewport, XRInterface::
 			scenario_draw_canvas_bg = false;
 		}
 
-		for (Map<Viewport::CanvasKey, Viewport::CanvasData *>::Element *E = canvas_map.front(); E; E = E->next()) {
+		for (Map<Viewport::CanvasKey, Viewport::CanvasData *, Comparator<Viewport::CanvasKey>, FrameAllocator>::Element *E = canvas_map.front(); E; E = E->next()) {
 			RenderingServerCanvas::Canvas *canvas = static_cast<RenderingServerCanvas::Canvas *>(E->get()->canvas);
 
 			Transform2D xform = _canvas_get_transform(p_viewport, canvas, E->get(), clip_rect.size);
@@ -311,7 +312,7 @@ void RenderingServerViewport::draw_viewports() {
 	//sort viewports
 	active_viewports.sort_custom<ViewportSort>();
 
-	Map<DisplayServer::WindowID, Vector<Rasterizer::BlitToScreen>> blit_to_screen_list;
+	Map<DisplayServer::WindowID, FrameVector<Rasterizer::BlitToScreen>, Comparator<DisplayServer::WindowID>, FrameAllocator> blit_to_screen_list;
 	//draw viewports
 	RENDER_TIMESTAMP(">Render Viewports");
 
@@ -431,10 +432,6 @@ void RenderingServerViewport::draw_viewports() {
 					blit.rect.size = vp->size;
 				}
 
-				if (!blit_to_screen_list.has(vp->viewport_to_screen)) {
-					blit_to_screen_list[vp->viewport_to_screen] = Vector<Rasterizer::BlitToScreen>();
-				}
-
 				blit_to_screen_list[vp->viewport_to_screen].push_back(blit);
 			}
 		}
@@ -451,7 +448,7 @@ void RenderingServerViewport::draw_viewports() {
 	//this needs to be called to make screen swapping more efficient
 	RSG::rasterizer->prepare_for_blitting_render_targets();
 
-	for (Map<int, Vector<Rasterizer::BlitToScreen>>::Element *E = blit_to_screen_list.front(); E; E = E->next()) {
+	for (Map<DisplayServer::WindowID, FrameVector<Rasterizer::BlitToScreen>, Comparator<DisplayServer::WindowID>, FrameAllocator>::Element *E = blit_to_screen_list.front(); E; E = E->next()) {
 		RSG::rasterizer->blit_render_targets_to_screen(E->key(), E->get().ptr(), E->get().size());
 	}
 }
@@ -29,6 +29,7 @@
 /*************************************************************************/
 
 #include "rendering_server_wrap_mt.h"
+#include "core/frame_arena.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
 #include "servers/display_server.h"
@@ -41,6 +42,7 @@ void RenderingServerWrapMT::thread_draw(bool p_swap_buffers, double frame_step)
 	if (!atomic_decrement(&draw_pending)) {
 		rendering_server->draw(p_swap_buffers, frame_step);
 	}
+	FrameArena::get_current()->reset();
 }
 
 void RenderingServerWrapMT::thread_flush() {
@@ -70,6 +72,8 @@ void RenderingServerWrapMT::thread_loop() {
 	command_queue.flush_all(); // flush all
 
 	rendering_server->finish();
+
+	FrameArena::free_current();
 }
 
 /* EVENT QUEUING */
@@ -153,7 +157,7 @@ void RenderingServerWrapMT::set_use_vsync_callback(bool p_enable) {
 RenderingServerWrapMT *RenderingServerWrapMT::singleton_mt = nullptr;
 
 RenderingServerWrapMT::RenderingServerWrapMT(RenderingServer *p_contained, bool p_create_thread) :
-		command_queue(p_create_thread) {
+		command_queue(p_create_thread, GLOBAL_GET("memory/limits/multithreaded_server/lock_free_command_queue")) {
 	singleton_mt = this;
 	DisplayServer::switch_vsync_function = set_use_vsync_callback; //as this goes to another thread, make sure it goes properly
 